@@ -45,6 +45,7 @@
 #include <fp_text.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <geometry/shape_arc.h>
 #include <geometry/shape_segment.h>
 #include <geometry/geometry_utils.h>
 #include <geometry/shape_circle.h>
@@ -396,6 +397,36 @@ void BOARD_ADAPTER::createNewPadWithClearance( const PAD* aPad,
             }
                 break;
 
+            case SH_ARC:
+            {
+                const SHAPE_ARC*       arc = (SHAPE_ARC*) shape;
+                const SHAPE_LINE_CHAIN l = arc->ConvertToPolyline( ARC_HIGH_DEF );
+                const int              width = arc->GetWidth() + aClearanceValue.x * 2;
+
+                for( int i = 0; i < l.SegmentCount(); i++ )
+                {
+                    const SEG     seg = l.CSegment( i );
+                    const SFVEC2F start3DU(  seg.A.x * m_biuTo3Dunits,
+                                            -seg.A.y * m_biuTo3Dunits );
+                    const SFVEC2F end3DU  (  seg.B.x * m_biuTo3Dunits,
+                                            -seg.B.y * m_biuTo3Dunits );
+
+                    if( Is_segment_a_circle( start3DU, end3DU ) )
+                    {
+                        aDstContainer->Add( new CFILLEDCIRCLE2D( start3DU,
+                                                                 ( width / 2) * m_biuTo3Dunits,
+                                                                 *aPad ) );
+                    }
+                    else
+                    {
+                        aDstContainer->Add( new CROUNDSEGMENT2D( start3DU, end3DU,
+                                                                 width * m_biuTo3Dunits,
+                                                                 *aPad ) );
+                    }
+                }
+            }
+                break;
+
             case SH_RECT:
             {
                 SHAPE_RECT* rect = (SHAPE_RECT*) shape;
@@ -143,6 +143,17 @@ static const wxChar DebugPDFWriter[] = wxT( "DebugPDFWriter" );
 
 static const wxChar SkipBoundingBoxFpLoad[] = wxT( "SkipBoundingBoxFpLoad" );
 
+/**
+ * When true, Pcbnew autosaves boards as board snapshots rather than as board files
+ */
+static const wxChar SnapshotAutosave[] = wxT( "SnapshotAutosave" );
+
+/**
+ * When false, the router rebuilds its world from the board each time a router tool is
+ * activated instead of applying the board changes it was notified of
+ */
+static const wxChar IncrementalRouterSync[] = wxT( "IncrementalRouterSync" );
+
 } // namespace KEYS
 
 
@@ -243,6 +254,10 @@ ADVANCED_CFG::ADVANCED_CFG()
 
     m_SkipBoundingBoxOnFpLoad   = false;
 
+    m_SnapshotAutosave          = false;
+
+    m_IncrementalRouterSync     = true;
+
     loadFromConfigFile();
 }
 
@@ -326,6 +341,12 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::SkipBoundingBoxFpLoad,
                                                 &m_SkipBoundingBoxOnFpLoad, false ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::SnapshotAutosave,
+                                                &m_SnapshotAutosave, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::IncrementalRouterSync,
+                                                &m_IncrementalRouterSync, true ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     for( PARAM_CFG* param : configParams )
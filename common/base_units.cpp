@@ -67,7 +67,7 @@ std::string Double2Str( double aValue )
     {
         // For these small values, %f works fine,
         // and %g gives an exponent
-        len = sprintf( buf,  "%.16f", aValue );
+        len = FormatDoubleC( buf, sizeof( buf ), "%.16f", aValue );
 
         while( --len > 0 && buf[len] == '0' )
             buf[len] = '\0';
@@ -81,7 +81,7 @@ std::string Double2Str( double aValue )
     {
         // For these values, %g works fine, and sometimes %f
         // gives a bad value (try aValue = 1.222222222222, with %.16f format!)
-        len = sprintf( buf, "%.16g", aValue );
+        len = FormatDoubleC( buf, sizeof( buf ), "%.16g", aValue );
     }
 
     return std::string( buf, len );
@@ -525,59 +525,88 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS aUnit, EDA_DATA_TYPE aType )
 }
 
 
-std::string FormatInternalUnits( int aValue )
+/**
+ * The number of decimals of a value in internal units, written in millimetres.
+ */
+static constexpr int decimalsPerIU( double aIuPerMM )
 {
-    char    buf[50];
-    double  engUnits = aValue;
-    int     len;
+    return aIuPerMM < 10.0 ? 0 : 1 + decimalsPerIU( aIuPerMM / 10.0 );
+}
 
-    engUnits /= IU_PER_MM;
 
-    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
-    {
-        len = snprintf( buf, sizeof(buf), "%.10f", engUnits );
+static constexpr double exactPowerOf10( int aExponent )
+{
+    return aExponent == 0 ? 1.0 : 10.0 * exactPowerOf10( aExponent - 1 );
+}
 
-        while( --len > 0 && buf[len] == '0' )
-            buf[len] = '\0';
 
-        if( buf[len] == '.' )
-            buf[len] = '\0';
-        else
-            ++len;
-    }
-    else
-    {
-        len = snprintf( buf, sizeof(buf), "%.10g", engUnits );
-    }
+static constexpr int IU_DECIMALS = decimalsPerIU( IU_PER_MM );
+
+static_assert( exactPowerOf10( IU_DECIMALS ) == IU_PER_MM,
+               "FormatInternalUnits() needs internal units which are a power of ten of mm" );
+
+
+std::string FormatInternalUnits( int aValue )
+{
+    // A value in internal units is an exact decimal number of millimetres with at most 10
+    // significant digits.  Writing the digits directly gives the same text as the former
+    // "%.10g" (or "%.10f" for tiny values) without floating point or locale dependency.
+    char buf[32];
+    int  len = FormatScaledInt( buf, aValue, IU_DECIMALS );
 
     return std::string( buf, len );
 }
 
 
+int FormatInternalUnits( char* aBuffer, int aValue )
+{
+    return FormatScaledInt( aBuffer, aValue, IU_DECIMALS );
+}
+
+
 std::string FormatAngle( double aAngle )
 {
     char temp[50];
-    int len;
+    int  len;
 
-    len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
+    // Angles in tenths of degree are almost always integers
+    if( fabs( aAngle ) < 1e9 && aAngle == (double) (long long) aAngle )
+        len = FormatScaledInt( temp, (long long) aAngle, 1 );
+    else
+        len = FormatDoubleC( temp, sizeof( temp ), "%.10g", aAngle / 10.0 );
 
     return std::string( temp, len );
 }
 
 
+/**
+ * Format a pair of values separated by a space, in a single string.
+ */
+static std::string formatInternalUnitsPair( int aX, int aY )
+{
+    char buf[64];
+    int  len = FormatScaledInt( buf, aX, IU_DECIMALS );
+
+    buf[len++] = ' ';
+    len += FormatScaledInt( buf + len, aY, IU_DECIMALS );
+
+    return std::string( buf, len );
+}
+
+
 std::string FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return formatInternalUnitsPair( aPoint.x, aPoint.y );
 }
 
 
 std::string FormatInternalUnits( const VECTOR2I& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    return formatInternalUnitsPair( aPoint.x, aPoint.y );
 }
 
 
 std::string FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    return formatInternalUnitsPair( aSize.GetWidth(), aSize.GetHeight() );
 }
@@ -28,6 +28,7 @@
 #include <cstdio>
 #include <cstdlib>         // bsearch()
 #include <cctype>
+#include <cstring>
 
 #include <dsnlexer.h>
 
@@ -75,6 +76,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    tokenBegin( NULL ),
+    tokenEnd( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -91,6 +94,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    tokenBegin( NULL ),
+    tokenEnd( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -108,6 +113,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    tokenBegin( NULL ),
+    tokenEnd( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -125,6 +132,8 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    tokenBegin( NULL ),
+    tokenEnd( NULL ),
     keywords( empty_keywords ),
     keywordCount( 0 )
 {
@@ -177,7 +186,8 @@ bool DSNLEXER::SyncLineReaderWith( DSNLEXER& aLexer )
 
     // Sync these parameters is not mandatory, but could help
     // for instance in debug
-    curText = aLexer.curText;
+    curText = aLexer.CurStr();
+    tokenBegin = NULL;
     curOffset = aLexer.curOffset;
 
     return true;
@@ -186,6 +196,9 @@ bool DSNLEXER::SyncLineReaderWith( DSNLEXER& aLexer )
 
 void DSNLEXER::PushReader( LINE_READER* aLineReader )
 {
+    // The current token must outlive its line
+    loadCurText();
+
     readerStack.push_back( aLineReader );
     reader = aLineReader;
     start  = (const char*) (*reader);
@@ -200,6 +213,8 @@ LINE_READER* DSNLEXER::PopReader()
 {
     LINE_READER*    ret = 0;
 
+    loadCurText();
+
     if( readerStack.size() )
     {
         ret = reader;
@@ -236,6 +251,27 @@ int DSNLEXER::findToken( const std::string& tok ) const
 }
 
 
+int DSNLEXER::findToken( const char* aBegin, const char* aEnd ) const
+{
+    // The keywords table wants a nul terminated key, and keywords are short
+    char   key[64];
+    size_t len = aEnd - aBegin;
+
+    if( len >= sizeof( key ) )
+        return findToken( std::string( aBegin, aEnd ) );
+
+    memcpy( key, aBegin, len );
+    key[len] = 0;
+
+    KEYWORD_MAP::const_iterator it = keyword_hash.find( key );
+
+    if( it != keyword_hash.end() )
+        return it->second;
+
+    return DSN_SYMBOL;      // not a keyword, some arbitrary symbol.
+}
+
+
 const char* DSNLEXER::Syntax( int aTok )
 {
     const char* ret;
@@ -518,6 +554,9 @@ int DSNLEXER::NextTok()
     if( cur >= limit )
     {
 L_read:
+        // The current token stays CurText() at the end of the file
+        loadCurText();
+
         // blank lines are returned as "\n" and will have a len of 1.
         // EOF will have a len of 0 and so is detectable.
         int len = readLine();
@@ -548,6 +587,7 @@ L_read:
 
                 curText.clear();
                 curText.append( start, limit );
+                tokenBegin = NULL;
 
                 cur     = start;        // ensure a good curOffset below
                 curTok  = DSN_COMMENT;
@@ -570,7 +610,8 @@ L_read:
 
     if( *cur == '(' )
     {
-        curText = *cur;
+        tokenBegin = cur;
+        tokenEnd = cur+1;
         curTok = DSN_LEFT;
         head = cur+1;
         goto exit;
@@ -578,7 +619,8 @@ L_read:
 
     if( *cur == ')' )
     {
-        curText = *cur;
+        tokenBegin = cur;
+        tokenEnd = cur+1;
         curTok = DSN_RIGHT;
         head = cur+1;
         goto exit;
@@ -593,6 +635,7 @@ L_read:
         {
             // copy the token, character by character so we can remove doubled up quotes.
             curText.clear();
+            tokenBegin = NULL;
 
             ++cur;  // skip over the leading delimiter, which is always " in non-specctraMode
 
@@ -665,7 +708,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain characters up to the next escape or delimiter
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -685,6 +736,7 @@ L_read:
         if( *cur == '-' && cur>start && !isSpace( cur[-1] ) )
         {
             curText = '-';
+            tokenBegin = NULL;
             curTok = DSN_DASH;
             head = cur+1;
             goto exit;
@@ -707,6 +759,7 @@ L_read:
             }
 
             curText = cc;
+            tokenBegin = NULL;
 
             head = cur+1;
 
@@ -737,6 +790,7 @@ L_read:
 
             curText.clear();
             curText.append( cur, head );
+            tokenBegin = NULL;
 
             ++head;     // skip over the trailing delimiter
 
@@ -745,26 +799,27 @@ L_read:
         }
     }           // specctraMode
 
-    // non-quoted token, read it into curText.
-    curText.clear();
-
+    // non-quoted token, left in the line until CurText() is asked for.
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    tokenBegin = cur;
+    tokenEnd = head;
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
     }
 
-    if( specctraMode && curText == "string_quote" )
+    if( specctraMode && head - cur == 12 && !strncmp( cur, "string_quote", 12 ) )
     {
         curTok = DSN_STRING_QUOTE;
         goto exit;
     }
 
-    curTok = findToken( curText );
+    curTok = findToken( cur, head );
 
 exit:   // single point of exit, no returns elsewhere please.
 
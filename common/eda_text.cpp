@@ -186,13 +186,11 @@ bool EDA_TEXT::Replace( wxFindReplaceData& aSearchData )
 
 int EDA_TEXT::LenSize( const wxString& aLine, int aThickness ) const
 {
-    basic_gal.SetFontItalic( IsItalic() );
-    basic_gal.SetFontBold( IsBold() );
-    basic_gal.SetFontUnderlined( false );
-    basic_gal.SetLineWidth( (float) aThickness );
-    basic_gal.SetGlyphSize( VECTOR2D( GetTextSize() ) );
-
-    VECTOR2D tsize = basic_gal.GetTextLineSize( aLine );
+    // Texts are measured on worker threads (e.g. when loading schematic sheets in parallel),
+    // so the attributes are passed to the font instead of being set on the shared basic_gal
+    const KIGFX::STROKE_FONT& font = basic_gal.GetStrokeFont();
+    VECTOR2D tsize = font.ComputeStringBoundaryLimits( aLine, VECTOR2D( GetTextSize() ),
+                                                       aThickness, IsItalic() );
 
     return KiROUND( tsize.x );
 }
@@ -258,7 +256,8 @@ EDA_RECT EDA_TEXT::GetTextBox( int aLine, bool aInvertY ) const
     const auto& font = basic_gal.GetStrokeFont();
     VECTOR2D    fontSize( GetTextSize() );
     double      penWidth( thickness );
-    int         dx = KiROUND( font.ComputeStringBoundaryLimits( text, fontSize, penWidth ).x );
+    int         dx = KiROUND( font.ComputeStringBoundaryLimits( text, fontSize, penWidth,
+                                                                IsItalic() ).x );
     int         dy = GetInterline();
 
     // Creates bounding box (rectangle) for horizontal, left and top justified text. The
@@ -297,7 +296,8 @@ EDA_RECT EDA_TEXT::GetTextBox( int aLine, bool aInvertY ) const
         for( unsigned ii = 1; ii < strings.GetCount(); ii++ )
         {
             text = strings.Item( ii );
-            dx = KiROUND( font.ComputeStringBoundaryLimits( text, fontSize, penWidth ).x );
+            dx = KiROUND( font.ComputeStringBoundaryLimits( text, fontSize, penWidth,
+                                                            IsItalic() ).x );
             textsize.x = std::max( textsize.x, dx );
             textsize.y += dy;
         }
@@ -521,6 +521,14 @@ VECTOR2D STROKE_FONT::computeTextLineSize( const UTF8& aText ) const
 
 VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
                                                    double aGlyphThickness ) const
+{
+    return ComputeStringBoundaryLimits( aText, aGlyphSize, aGlyphThickness,
+                                        m_gal->IsFontItalic() );
+}
+
+
+VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
+                                                   double aGlyphThickness, bool aItalic ) const
 {
     VECTOR2D string_bbox;
     int line_count = 1;
@@ -610,7 +618,7 @@ VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECT
     string_bbox.y = line_count * GetInterline( aGlyphSize.y );
 
     // For italic correction, take in account italic tilt
-    if( m_gal->IsFontItalic() )
+    if( aItalic )
         string_bbox.x += string_bbox.y * STROKE_FONT::ITALIC_TILT;
 
     return string_bbox;
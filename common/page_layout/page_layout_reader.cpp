@@ -30,6 +30,7 @@
  */
 
 #include <eda_item.h>
+#include <kicad_string.h>
 #include <locale_io.h>
 #include <page_layout/ws_data_item.h>
 #include <page_layout/ws_data_model.h>
@@ -760,7 +761,7 @@ double PAGE_LAYOUT_READER_PARSER::parseDouble()
     if( token != T_NUMBER )
         Expecting( T_NUMBER );
 
-    double val = strtod( CurText(), NULL );
+    double val = StrToDoubleC( CurText(), NULL );
 
     return val;
 }
@@ -23,7 +23,9 @@
 
 #include "altium_parser.h"
 
+#include <algorithm>
 #include <compoundfilereader.h>
+#include <cstring>
 #include <ki_exception.h>
 #include <sstream>
 #include <utf.h>
@@ -64,17 +66,72 @@ const CFB::COMPOUND_FILE_ENTRY* FindStream(
 }
 
 
+constexpr size_t ALTIUM_PARSER::BUFFER_SIZE;
+
+
 ALTIUM_PARSER::ALTIUM_PARSER(
-        const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry )
+        const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry ) :
+        m_reader( aReader ),
+        m_entry( aEntry )
+{
+    m_subrecord_end  = 0;
+    m_size           = static_cast<size_t>( aEntry->size );
+    m_error          = false;
+    m_capacity       = std::min( m_size, BUFFER_SIZE );
+    m_content_offset = 0;
+    m_content.reset( new char[m_capacity] );
+    m_pos         = m_content.get();
+    m_content_end = m_pos;
+
+    // read the start of the file into the buffer
+    refill( 0 );
+}
+
+
+void ALTIUM_PARSER::refill( size_t aLength )
+{
+    size_t offset    = GetOffset();
+    size_t available = m_content_end - m_pos;
+    size_t capacity  = std::max( aLength, std::min( m_size - offset, BUFFER_SIZE ) );
+
+    // keep the bytes not read yet at the start of the buffer
+    if( capacity > m_capacity )
+    {
+        std::unique_ptr<char[]> content( new char[capacity] );
+
+        memcpy( content.get(), m_pos, available );
+        m_content  = std::move( content );
+        m_capacity = capacity;
+    }
+    else
+    {
+        memmove( m_content.get(), m_pos, available );
+    }
+
+    size_t length = std::min( m_capacity, m_size - offset ) - available;
+
+    m_reader.ReadFile( m_entry, offset + available, m_content.get() + available, length );
+
+    m_content_offset = offset;
+    m_pos            = m_content.get();
+    m_content_end    = m_pos + available + length;
+}
+
+
+void ALTIUM_PARSER::seek( size_t aOffset )
 {
-    m_subrecord_end = nullptr;
-    m_size          = static_cast<size_t>( aEntry->size );
-    m_error         = false;
-    m_content.reset( new char[m_size] );
-    m_pos = m_content.get();
-
-    // read file into buffer
-    aReader.ReadFile( aEntry, 0, m_content.get(), m_size );
+    if( aOffset >= m_content_offset
+            && aOffset <= m_content_offset + ( m_content_end - m_content.get() ) )
+    {
+        m_pos = m_content.get() + ( aOffset - m_content_offset );
+    }
+    else
+    {
+        // the bytes are read once they are needed
+        m_content_offset = aOffset;
+        m_pos            = m_content.get();
+        m_content_end    = m_pos;
+    }
 }
 
 
@@ -83,7 +140,15 @@ std::map<wxString, wxString> ALTIUM_PARSER::ReadProperties()
     std::map<wxString, wxString> kv;
 
     uint32_t length = Read<uint32_t>();
-    if( length > GetRemainingBytes() || m_pos[length - 1] != '\0' )
+    if( length > GetRemainingBytes() )
+    {
+        m_error = true;
+        return kv;
+    }
+
+    ensureBuffered( length );
+
+    if( length == 0 || m_pos[length - 1] != '\0' )
     {
         m_error = true;
         return kv;
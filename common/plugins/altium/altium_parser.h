@@ -43,6 +43,12 @@ const CFB::COMPOUND_FILE_ENTRY* FindStream(
         const CFB::CompoundFileReader& aReader, const char* aStreamName );
 
 
+/**
+ * Reads the records of a stream of a compound file.
+ *
+ * The stream is read through a buffer of bounded size, which is refilled from the compound file
+ * as the records are consumed, so that large streams are never copied as a whole.
+ */
 class ALTIUM_PARSER
 {
 public:
@@ -54,6 +60,8 @@ public:
     {
         if( GetRemainingBytes() >= sizeof( Type ) )
         {
+            ensureBuffered( sizeof( Type ) );
+
             Type val = *(Type*) ( m_pos );
             m_pos += sizeof( Type );
             return val;
@@ -70,6 +78,7 @@ public:
         uint8_t len = Read<uint8_t>();
         if( GetRemainingBytes() >= len )
         {
+            ensureBuffered( len );
 
             //altium uses LATIN1/ISO 8859-1, convert it
             wxString val = wxString( m_pos, wxConvISO8859_1, len );
@@ -115,7 +124,7 @@ public:
     size_t ReadAndSetSubrecordLength()
     {
         uint32_t length = Read<uint32_t>();
-        m_subrecord_end = m_pos + length;
+        m_subrecord_end = GetOffset() + length;
         return length;
     }
 
@@ -147,7 +156,7 @@ public:
     {
         if( GetRemainingBytes() >= aLength )
         {
-            m_pos += aLength;
+            seek( GetOffset() + aLength );
         }
         else
         {
@@ -157,26 +166,34 @@ public:
 
     void SkipSubrecord()
     {
-        if( m_subrecord_end == nullptr || m_subrecord_end < m_pos )
+        if( m_subrecord_end == 0 || m_subrecord_end < GetOffset() )
         {
             m_error = true;
         }
         else
         {
-            m_pos = m_subrecord_end;
+            seek( m_subrecord_end );
         }
     };
 
+    /**
+     * @return the position of the next byte to read in the stream.
+     */
+    size_t GetOffset() const
+    {
+        return m_content_offset + ( m_pos - m_content.get() );
+    }
+
     size_t GetRemainingBytes() const
     {
-        return m_pos == nullptr ? 0 : m_size - ( m_pos - m_content.get() );
+        return m_size - GetOffset();
     }
 
     size_t GetRemainingSubrecordBytes() const
     {
-        return m_pos == nullptr || m_subrecord_end == nullptr || m_subrecord_end <= m_pos ?
-                       0 :
-                       m_subrecord_end - m_pos;
+        size_t offset = GetOffset();
+
+        return m_subrecord_end == 0 || m_subrecord_end <= offset ? 0 : m_subrecord_end - offset;
     };
 
     bool HasParsingError()
@@ -185,12 +202,36 @@ public:
     }
 
 private:
-    std::unique_ptr<char[]> m_content;
-    size_t                  m_size;
+    /**
+     * Make sure that the next \a aLength bytes of the stream are in the buffer.  The caller
+     * checks that the stream has that many bytes left.
+     */
+    void ensureBuffered( size_t aLength )
+    {
+        if( m_pos + aLength > m_content_end )
+            refill( aLength );
+    }
+
+    void refill( size_t aLength );
+
+    /// Move the read position to \a aOffset of the stream.
+    void seek( size_t aOffset );
 
-    char* m_pos;           // current read pointer
-    char* m_subrecord_end; // pointer which points to next subrecord start
-    bool  m_error;
+    ///< The size the buffer is refilled to, unless a single record needs more.
+    static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+
+    const CFB::CompoundFileReader&  m_reader;
+    const CFB::COMPOUND_FILE_ENTRY* m_entry;
+
+    std::unique_ptr<char[]> m_content;
+    size_t                  m_capacity;       // size of m_content
+    size_t                  m_content_offset; // stream offset of the start of m_content
+    char*                   m_content_end;    // end of the bytes read into m_content
+    size_t                  m_size;           // size of the stream
+
+    char*  m_pos;           // current read pointer
+    size_t m_subrecord_end; // stream offset of the next subrecord start, 0 if there is none
+    bool   m_error;
 };
 
 
@@ -52,7 +52,7 @@ wxString RC_ITEM::ShowCoord( EDA_UNITS aUnits, const wxPoint& aPos )
 
 
 wxString RC_ITEM::ShowReport( EDA_UNITS aUnits, SEVERITY aSeverity,
-                              const std::map<KIID, EDA_ITEM*>& aItemMap ) const
+                              const std::function<EDA_ITEM*( const KIID& )>& aGetItem ) const
 {
     wxString severity;
 
@@ -68,18 +68,8 @@ wxString RC_ITEM::ShowReport( EDA_UNITS aUnits, SEVERITY aSeverity,
     if( m_parent && m_parent->IsExcluded() )
         severity += wxT( " (excluded)" );
 
-    EDA_ITEM* mainItem = nullptr;
-    EDA_ITEM* auxItem = nullptr;
-
-    auto ii = aItemMap.find( GetMainItemID() );
-
-    if( ii != aItemMap.end() )
-        mainItem = ii->second;
-
-    ii = aItemMap.find( GetAuxItemID() );
-
-    if( ii != aItemMap.end() )
-        auxItem = ii->second;
+    EDA_ITEM* mainItem = aGetItem( GetMainItemID() );
+    EDA_ITEM* auxItem = aGetItem( GetAuxItemID() );
 
     // Note: some customers machine-process these.  So:
     // 1) don't translate
@@ -24,6 +24,7 @@
 #ifndef RC_ITEM_H
 #define RC_ITEM_H
 
+#include <functional>
 #include <wx/dataview.h>
 #include <eda_item.h>
 #include <reporter.h>
@@ -154,10 +155,11 @@ public:
     /**
      * Translate this object into a text string suitable for saving to disk in a report.
      *
+     * @param aGetItem returns the item with the given KIID, or nullptr if there is none.
      * @return wxString - the simple multi-line report text.
      */
     virtual wxString ShowReport( EDA_UNITS aUnits, SEVERITY aSeverity,
-                                 const std::map<KIID, EDA_ITEM*>& aItemMap ) const;
+                                 const std::function<EDA_ITEM*( const KIID& )>& aGetItem ) const;
 
     int GetErrorCode() const { return m_errorCode; }
     void SetErrorCode( int aCode ) { m_errorCode = aCode; }
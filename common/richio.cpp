@@ -23,7 +23,9 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
+#include <cstring>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
@@ -32,6 +34,22 @@
 #include <wx/file.h>
 #include <wx/translation.h>
 
+#ifdef __WINDOWS__
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/vfs.h>
+#else
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -229,13 +247,277 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
+/**
+ * Files smaller than this are read rather than mapped: mapping them costs more than reading
+ * them, and their content can be shared without holding on to a mapping.
+ */
+static const size_t MIN_MAPPED_FILE_SIZE = 65536;
+
+
+#ifndef __WINDOWS__
+/**
+ * Tests if aFd is a file on a local file system.  A file on a network file system can be
+ * truncated from another machine at any time, and reading a mapping of it past its new end
+ * raises SIGBUS.
+ */
+static bool isLocalFile( int aFd )
+{
+    struct statfs fs;
+
+    if( fstatfs( aFd, &fs ) != 0 )
+        return false;
+
+#ifdef __linux__
+    switch( (unsigned long) fs.f_type )
+    {
+    case 0x00006969:    // NFS
+    case 0x0000517B:    // SMB
+    case 0xFE534D42:    // SMB2
+    case 0xFF534D42:    // CIFS
+    case 0x01021997:    // 9P
+    case 0x00C36400:    // Ceph
+    case 0x5346414F:    // AFS
+    case 0x73757245:    // Coda
+    case 0x65735546:    // FUSE, e.g. sshfs
+        return false;
+
+    default:
+        return true;
+    }
+#elif defined( MNT_LOCAL )
+    return ( fs.f_flags & MNT_LOCAL ) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+
+/**
+ * Maps aFileName privately (copy on write) in memory.
+ * @return the mapping, or nullptr if the file is small, is not on a local drive or could not
+ *  be mapped.
+ */
+static char* mapFile( const wxString& aFileName, size_t& aSize )
+{
+    char* data = nullptr;
+
+#ifdef __WINDOWS__
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if( file == INVALID_HANDLE_VALUE )
+        return nullptr;
+
+    // A file on a network share can be truncated by another machine at any time, and reading
+    // a mapping of it past its new end raises an in-page error.  Local files cannot be
+    // truncated while they are mapped.
+    wchar_t       volume[MAX_PATH];
+    bool          local = GetVolumePathNameW( aFileName.wc_str(), volume, MAX_PATH )
+                                && GetDriveTypeW( volume ) != DRIVE_REMOTE;
+    LARGE_INTEGER size;
+
+    if( local && GetFileSizeEx( file, &size )
+            && size.QuadPart >= (LONGLONG) MIN_MAPPED_FILE_SIZE )
+    {
+        HANDLE mapping = CreateFileMappingW( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+
+        if( mapping )
+        {
+            data = (char*) MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+            aSize = size.QuadPart;
+            CloseHandle( mapping );
+        }
+    }
+
+    CloseHandle( file );
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        return nullptr;
+
+    struct stat st;
+
+    if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode )
+            && st.st_size >= (off_t) MIN_MAPPED_FILE_SIZE && isLocalFile( fd ) )
+    {
+        void* mapping = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+
+        if( mapping != MAP_FAILED )
+        {
+            data = (char*) mapping;
+            aSize = st.st_size;
+            madvise( mapping, aSize, MADV_SEQUENTIAL );
+        }
+    }
+
+    close( fd );
+#endif
+
+    return data;
+}
+
+
+static void unmapFile( char* aData, size_t aSize )
+{
+#ifdef __WINDOWS__
+    UnmapViewOfFile( aData );
+#else
+    munmap( aData, aSize );
+#endif
+}
+
+
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+                                                  unsigned aStartingLineNumber,
+                                                  unsigned aMaxLineLength ) :
+    LINE_READER( 0 ),       // no line buffer, the lines are handed out in place
+    m_data( nullptr ),
+    m_size( 0 ),
+    m_offset( 0 ),
+    m_terminator( nullptr ),
+    m_savedChar( 0 )
+{
+    m_maxLineLength = aMaxLineLength;
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+    m_empty[0] = 0;
+
+    size_t size = 0;
+    char*  mapping = mapFile( aFileName, size );
+
+    if( mapping )
+    {
+        m_content.reset( mapping,
+                         [size]( char* aData )
+                         {
+                             unmapFile( aData, size );
+                         } );
+        m_data = mapping;
+        m_size = size;
+        m_line = m_empty;
+        return;
+    }
+
+    // Small files, and files which cannot be mapped, are read the usual way
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    auto   buffer = std::make_shared<std::vector<char>>();
+    char   chunk[65536];
+    size_t count;
+
+    while( ( count = fread( chunk, 1, sizeof( chunk ), fp ) ) > 0 )
+        buffer->insert( buffer->end(), chunk, chunk + count );
+
+    fclose( fp );
+
+    m_content = std::shared_ptr<char>( buffer, buffer->data() );
+    m_data = m_content.get();
+    m_size = buffer->size();
+
+    // Only set once nothing can throw, ~LINE_READER() would delete it otherwise
+    m_line = m_empty;
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+    // The content may outlive the reader, see Content()
+    if( m_terminator )
+        *m_terminator = m_savedChar;
+
+    // m_line was never allocated by LINE_READER
+    m_line = nullptr;
+}
+
+
+char* MAPPED_FILE_LINE_READER::ReadLine()
+{
+    // Put back the byte replaced by the nul ending the previous line
+    if( m_terminator )
+    {
+        *m_terminator = m_savedChar;
+        m_terminator = nullptr;
+    }
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    if( m_offset >= m_size )
+    {
+        m_length = 0;
+        m_line = m_empty;
+        return NULL;
+    }
+
+    char*  begin = m_data + m_offset;
+    char*  newline = (char*) memchr( begin, '\n', m_size - m_offset );
+    size_t length = newline ? newline - begin + 1 : m_size - m_offset;
+
+    if( length > m_maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_offset += length;
+    m_length = length;
+
+    if( m_offset < m_size )
+    {
+        m_terminator = m_data + m_offset;
+        m_savedChar = *m_terminator;
+        *m_terminator = 0;
+        m_line = begin;
+    }
+    else
+    {
+        // There is no byte after the last line to hold its nul
+        m_lastLine.assign( begin, begin + length );
+        m_lastLine.push_back( 0 );
+        m_line = m_lastLine.data();
+    }
+
+    return m_line;
+}
+
+
+void MAPPED_FILE_LINE_READER::Rewind()
+{
+    Seek( 0, 1 );
+}
+
+
+void MAPPED_FILE_LINE_READER::Seek( size_t aOffset, unsigned aLineNumber )
+{
+    if( m_terminator )
+    {
+        *m_terminator = m_savedChar;
+        m_terminator = nullptr;
+    }
+
+    m_offset = std::min( aOffset, m_size );
+    m_length = 0;
+    m_lineNum = aLineNumber - 1;
+    m_line = m_empty;
+}
+
+
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    m_source = aSource;
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
 }
 
 
@@ -393,39 +675,44 @@ int OUTPUTFORMATTER::vprint( const char* fmt,  va_list ap )
 }
 
 
-int OUTPUTFORMATTER::sprint( const char* fmt, ... )
+#define NESTWIDTH           2   ///< how many spaces per nestLevel
+
+int OUTPUTFORMATTER::indent( int nestLevel )
 {
-    va_list     args;
+    static const char spaces[] = "                                                                ";
+    const int         chunk = sizeof( spaces ) - 1;
 
-    va_start( args, fmt );
-    int ret = vprint( fmt, args);
-    va_end( args );
+    int total = nestLevel * NESTWIDTH;
 
-    return ret;
+    // no error checking needed, an exception indicates an error.
+    for( int remaining = total; remaining > 0; remaining -= chunk )
+        write( spaces, std::min( remaining, chunk ) );
+
+    return std::max( total, 0 );
 }
 
 
 int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 {
-#define NESTWIDTH           2   ///< how many spaces per nestLevel
+    int total = indent( nestLevel );
 
-    va_list     args;
+    // A format without conversions is written as it is, without vsnprintf()
+    if( !strchr( fmt, '%' ) )
+    {
+        int len = strlen( fmt );
 
-    va_start( args, fmt );
+        if( len > 0 )
+            write( fmt, len );
 
-    int result = 0;
-    int total  = 0;
+        return total + len;
+    }
 
-    for( int i=0; i<nestLevel;  ++i )
-    {
-        // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+    va_list     args;
 
-        total += result;
-    }
+    va_start( args, fmt );
 
     // no error checking needed, an exception indicates an error.
-    result = vprint( fmt, args );
+    int result = vprint( fmt, args );
 
     va_end( args );
 
@@ -434,6 +721,15 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 }
 
 
+void OUTPUTFORMATTER::PrintRaw( int nestLevel, const char* aText, int aCount )
+{
+    indent( nestLevel );
+
+    if( aCount > 0 )
+        write( aText, aCount );
+}
+
+
 std::string OUTPUTFORMATTER::Quotes( const std::string& aWrapee )
 {
     std::string ret;
@@ -517,23 +813,82 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName, const wxC
 
     if( !m_fp )
         THROW_IO_ERROR( strerror( errno ) );
+
+    m_pending.reserve( FILEFMTBUFZ );
 }
 
 
 FILE_OUTPUTFORMATTER::~FILE_OUTPUTFORMATTER()
 {
     if( m_fp )
+    {
+        try
+        {
+            flush();
+        }
+        catch( const IO_ERROR& )
+        {
+            // Nowhere to report it from a destructor: callers wanting to know use Finish()
+        }
+
         fclose( m_fp );
+    }
 }
 
 
-void FILE_OUTPUTFORMATTER::write( const char* aOutBuf, int aCount )
+void FILE_OUTPUTFORMATTER::Finish()
+{
+    if( !m_fp )
+        return;
+
+    flush();
+
+    FILE* fp = m_fp;
+
+    m_fp = nullptr;
+
+    if( fclose( fp ) != 0 )
+        THROW_IO_ERROR( strerror( errno ) );
+}
+
+
+void FILE_OUTPUTFORMATTER::flush()
 {
-    if( fwrite( aOutBuf, (unsigned) aCount, 1, m_fp ) != 1 )
+    if( m_pending.empty() )
+        return;
+
+    bool ok = fwrite( m_pending.data(), m_pending.size(), 1, m_fp ) == 1;
+
+    // Not written again by the destructor after an error
+    m_pending.clear();
+
+    if( !ok )
         THROW_IO_ERROR( strerror( errno ) );
 }
 
 
+void FILE_OUTPUTFORMATTER::write( const char* aOutBuf, int aCount )
+{
+    wxCHECK_RET( m_fp, "FILE_OUTPUTFORMATTER output after Finish()" );
+
+    if( m_pending.size() + aCount > FILEFMTBUFZ )
+    {
+        flush();
+
+        // Large blocks are not worth copying
+        if( aCount >= FILEFMTBUFZ )
+        {
+            if( fwrite( aOutBuf, (unsigned) aCount, 1, m_fp ) != 1 )
+                THROW_IO_ERROR( strerror( errno ) );
+
+            return;
+        }
+    }
+
+    m_pending.append( aOutBuf, aCount );
+}
+
+
 //-----<STREAM_OUTPUTFORMATTER>--------------------------------------
 
 void STREAM_OUTPUTFORMATTER::write( const char* aOutBuf, int aCount )
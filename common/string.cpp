@@ -26,7 +26,11 @@
  * @brief Some useful functions to handle strings.
  */
 
+#include <cerrno>
 #include <clocale>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <macros.h>
 #include <richio.h>                        // StrPrintf
 #include <kicad_string.h>
@@ -836,3 +840,207 @@ void StripTrailingZeros( wxString& aStringValue, unsigned aTrailingZeroAllowed )
         }
     }
 }
+
+
+/**
+ * Powers of ten which are exact doubles
+ */
+static const double s_exactPowersOf10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+/**
+ * strtod() on a copy of \a aText using the decimal point of the current locale.
+ */
+static double localeStrToDouble( const char* aText, char** aEndPtr )
+{
+    char sep = localeconv()->decimal_point[0];
+
+    if( sep == '.' )
+        return strtod( aText, aEndPtr );
+
+    std::string text( aText );
+    size_t      dot = text.find( '.' );
+
+    if( dot != std::string::npos )
+        text[dot] = sep;
+
+    char*  end;
+    double value = strtod( text.c_str(), &end );
+
+    if( aEndPtr )
+        *aEndPtr = const_cast<char*>( aText ) + ( end - text.c_str() );
+
+    return value;
+}
+
+
+double StrToDoubleC( const char* aText, char** aEndPtr )
+{
+    const char* p = aText;
+
+    while( *p == ' ' || ( *p >= '\t' && *p <= '\r' ) )
+        p++;
+
+    bool negative = *p == '-';
+
+    if( *p == '-' || *p == '+' )
+        p++;
+
+    // Accumulate up to 19 significant digits in mantissa, and the power of ten to apply
+    uint64_t mantissa = 0;
+    int      significant = 0;
+    int      exponent = 0;
+    bool     anyDigit = false;
+
+    for( ; *p >= '0' && *p <= '9'; p++ )
+    {
+        anyDigit = true;
+
+        if( significant < 19 )
+        {
+            mantissa = mantissa * 10 + ( *p - '0' );
+            significant += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+
+    if( *p == '.' )
+    {
+        for( p++; *p >= '0' && *p <= '9'; p++ )
+        {
+            anyDigit = true;
+
+            if( significant < 19 )
+            {
+                mantissa = mantissa * 10 + ( *p - '0' );
+                significant += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+
+    // Infinities, NaNs, hexadecimal numbers and "." without digits are left to strtod()
+    if( !anyDigit || *p == 'x' || *p == 'X' )
+        return localeStrToDouble( aText, aEndPtr );
+
+    if( *p == 'e' || *p == 'E' )
+    {
+        const char* e = p + 1;
+        bool        negativeExp = *e == '-';
+
+        if( *e == '-' || *e == '+' )
+            e++;
+
+        if( *e >= '0' && *e <= '9' )
+        {
+            int value = 0;
+
+            for( ; *e >= '0' && *e <= '9'; e++ )
+            {
+                if( value < 100000 )
+                    value = value * 10 + ( *e - '0' );
+            }
+
+            exponent += negativeExp ? -value : value;
+            p = e;
+        }
+    }
+
+    // A mantissa which is an exact double and an exact power of ten give a correctly rounded
+    // result with a single multiplication or division.  Other values are left to strtod().
+    if( mantissa > ( UINT64_C( 1 ) << 53 ) || exponent < -22 || exponent > 22 )
+        return localeStrToDouble( aText, aEndPtr );
+
+    double value = (double) mantissa;
+
+    if( exponent < 0 )
+        value /= s_exactPowersOf10[-exponent];
+    else
+        value *= s_exactPowersOf10[exponent];
+
+    if( aEndPtr )
+        *aEndPtr = const_cast<char*>( p );
+
+    return negative ? -value : value;
+}
+
+
+int FormatScaledInt( char* aBuffer, long long aValue, int aDecimals )
+{
+    // Work on the magnitude as an unsigned value: -LLONG_MIN does not fit in a long long
+    unsigned long long magnitude = aValue < 0 ? 0ULL - aValue : aValue;
+    char               digits[24];
+    int                count = 0;
+
+    do
+    {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while( magnitude );
+
+    // Drop the trailing zeros of the decimals
+    int first = 0;
+
+    while( aDecimals > 0 && first < count && digits[first] == '0' )
+    {
+        first++;
+        aDecimals--;
+    }
+
+    if( first == count )
+    {
+        aBuffer[0] = '0';
+        aBuffer[1] = '\0';
+        return 1;
+    }
+
+    char* out = aBuffer;
+
+    if( aValue < 0 )
+        *out++ = '-';
+
+    if( count - first <= aDecimals )
+    {
+        *out++ = '0';
+        *out++ = '.';
+
+        for( int i = count - first; i < aDecimals; i++ )
+            *out++ = '0';
+    }
+
+    for( int i = count - 1; i >= first; i-- )
+    {
+        *out++ = digits[i];
+
+        if( i == first + aDecimals && i != first )
+            *out++ = '.';
+    }
+
+    *out = '\0';
+
+    return out - aBuffer;
+}
+
+
+int FormatDoubleC( char* aBuffer, size_t aSize, const char* aFormat, double aValue )
+{
+    int  len = snprintf( aBuffer, aSize, aFormat, aValue );
+    char sep = localeconv()->decimal_point[0];
+
+    if( sep != '.' )
+    {
+        char* p = strchr( aBuffer, sep );
+
+        if( p )
+            *p = '.';
+    }
+
+    return len;
+}
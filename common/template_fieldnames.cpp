@@ -26,6 +26,8 @@
 #include <template_fieldnames.h>
 #include <pgm_base.h>
 
+#include <mutex>
+
 using namespace TFIELD_T;
 
 #define REFCANONICAL "Reference"
@@ -41,6 +43,7 @@ const wxString TEMPLATE_FIELDNAME::GetDefaultFieldName( int aFieldNdx, bool aTra
     static wxString footprintDefault;
     static wxString datasheetDefault;
     static wxString fieldDefault;
+    static std::mutex mutex;
 
     if( !aTranslate )
     {
@@ -53,6 +56,9 @@ const wxString TEMPLATE_FIELDNAME::GetDefaultFieldName( int aFieldNdx, bool aTra
         }
     }
 
+    // Schematic sheets are loaded on several threads
+    std::lock_guard<std::mutex> lock( mutex );
+
     // Fetching translations can take a surprising amount of time when loading libraries,
     // so only do it when necessary.
     if( Pgm().GetLocale() != locale )
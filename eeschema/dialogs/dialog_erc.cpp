@@ -707,6 +707,13 @@ bool DIALOG_ERC::writeReport( const wxString& aFullFileName )
 
     sheetList.FillItemMap( itemMap );
 
+    auto getItem =
+            [&]( const KIID& aId ) -> EDA_ITEM*
+            {
+                auto ii = itemMap.find( aId );
+                return ii != itemMap.end() ? ii->second : nullptr;
+            };
+
     ERC_SETTINGS& settings = m_parent->Schematic().ErcSettings();
 
     for( unsigned i = 0;  i < sheetList.size(); i++ )
@@ -731,7 +738,7 @@ bool DIALOG_ERC::writeReport( const wxString& aFullFileName )
             default:                                 break;
             }
 
-            msg << marker->GetRCItem()->ShowReport( GetUserUnits(), severity, itemMap );
+            msg << marker->GetRCItem()->ShowReport( GetUserUnits(), severity, getItem );
         }
     }
 
@@ -862,7 +862,6 @@ void SCH_EAGLE_PLUGIN::loadSegments(
     while( currentSegment )
     {
         bool      labelled = false; // has a label been added to this continously connected segment
-        NODE_MAP  segmentChildren = MapChildren( currentSegment );
         SCH_LINE* firstWire       = nullptr;
         m_segments.emplace_back();
         SEG_DESC& segDesc = m_segments.back();
@@ -882,20 +881,33 @@ void SCH_EAGLE_PLUGIN::loadSegments(
                 // Test for intersections with other wires
                 SEG thisWire( wire->GetStartPoint(), wire->GetEndPoint() );
 
-                for( auto& desc : m_segments )
-                {
-                    if( !desc.labels.empty() && desc.labels.front()->GetText() == netName )
-                        continue; // no point in saving intersections of the same net
+                BOX2I bbox( thisWire.A, thisWire.B - thisWire.A );
+                bbox.Normalize();
 
-                    for( const auto& seg : desc.segs )
-                    {
-                        auto intersection = thisWire.Intersect( seg, true );
+                int   bmin[2] = { bbox.GetX(), bbox.GetY() };
+                int   bmax[2] = { bbox.GetRight(), bbox.GetBottom() };
 
-                        if( intersection )
-                            m_wireIntersections.push_back( *intersection );
-                    }
-                }
+                auto visitor =
+                        [&]( size_t aWire ) -> bool
+                        {
+                            const SEG_DESC& desc = m_segments[m_wires[aWire].first];
+
+                            // no point in saving intersections of the same net
+                            if( !desc.labels.empty() && desc.labels.front()->GetText() == netName )
+                                return true;
+
+                            auto intersection = thisWire.Intersect( m_wires[aWire].second, true );
+
+                            if( intersection )
+                                m_wireIntersections.push_back( *intersection );
+
+                            return true;
+                        };
+
+                m_wireIndex.Search( bmin, bmax, visitor );
 
+                m_wireIndex.Insert( bmin, bmax, m_wires.size() );
+                m_wires.emplace_back( m_segments.size() - 1, thisWire );
                 segDesc.segs.push_back( thisWire );
                 screen->Append( wire );
             }
@@ -1946,6 +1958,8 @@ void SCH_EAGLE_PLUGIN::adjustNetLabels()
     }
 
     m_segments.clear();
+    m_wires.clear();
+    m_wireIndex.RemoveAll();
     m_wireIntersections.clear();
 }
 
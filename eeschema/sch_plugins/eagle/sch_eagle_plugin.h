@@ -29,6 +29,7 @@
 #include <sch_io_mgr.h>
 #include <plugins/eagle/eagle_parser.h>
 #include <lib_item.h>
+#include <geometry/rtree.h>
 #include <geometry/seg.h>
 
 #include <boost/ptr_container/ptr_map.hpp>
@@ -79,6 +80,8 @@ typedef boost::ptr_map<wxString, EPART> EPART_LIST;
  */
 class SCH_EAGLE_PLUGIN : public SCH_PLUGIN
 {
+    friend class TEST_SCH_EAGLE_PLUGIN_FIXTURE; // so that loadSegments() can be tested alone
+
 public:
     SCH_EAGLE_PLUGIN();
     ~SCH_EAGLE_PLUGIN();
@@ -216,6 +219,11 @@ private:
     ///> Segments representing wires for intersection checking
     std::vector<SEG_DESC> m_segments;
 
+    ///> Wires of m_segments with the index of their segment, and their spatial index, to find
+    ///> the intersections of a new wire
+    std::vector<std::pair<size_t, SEG>> m_wires;
+    RTree<size_t, int, 2, double>       m_wireIndex;
+
     ///> Positions of pins and wire endings mapped to its parent
     std::map<wxPoint, std::set<const EDA_ITEM*>> m_connPoints;
 
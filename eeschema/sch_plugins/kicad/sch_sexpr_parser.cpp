@@ -32,6 +32,7 @@
 #include <wx/tokenzr.h>
 
 #include <common.h>
+#include <kicad_string.h>
 #include <lib_id.h>
 
 #include <class_libentry.h>
@@ -395,11 +396,12 @@ LIB_ITEM* SCH_SEXPR_PARSER::ParseDrawItem()
 
 double SCH_SEXPR_PARSER::parseDouble()
 {
-    char* tmp;
+    const char* text = CurTokenText();
+    char*       tmp;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    double fval = StrToDoubleC( text, &tmp );
 
     if( errno )
     {
@@ -410,7 +412,7 @@ double SCH_SEXPR_PARSER::parseDouble()
         THROW_IO_ERROR( error );
     }
 
-    if( CurText() == tmp )
+    if( text == tmp )
     {
         wxString error;
         error.Printf( _( "Missing floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
@@ -89,12 +89,12 @@ class SCH_SEXPR_PARSER : public SCHEMATIC_LEXER
     inline long parseHex()
     {
         NextTok();
-        return strtol( CurText(), NULL, 16 );
+        return strtol( CurTokenText(), NULL, 16 );
     }
 
     inline int parseInt()
     {
-        return (int)strtol( CurText(), NULL, 10 );
+        return (int)strtol( CurTokenText(), NULL, 10 );
     }
 
     inline int parseInt( const char* aExpected )
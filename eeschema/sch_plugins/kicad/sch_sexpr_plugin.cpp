@@ -20,6 +20,10 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <map>
+#include <thread>
 
 // For some reason wxWidgets is built with wxUSE_BASE64 unset so expose the wxWidgets
 // base64 code.
@@ -28,6 +32,8 @@
 #include <wx/mstream.h>
 #include <advanced_config.h>
 #include <pgm_base.h>
+#include <settings/settings_manager.h>
+#include <symbol_editor/symbol_editor_settings.h>
 #include <trace_helpers.h>
 #include <locale_io.h>
 #include <sch_bitmap.h>
@@ -458,81 +464,147 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, SCHEMATIC* aSchema
 }
 
 
-// Everything below this comment is recursive.  Modify with care.
-
 void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 {
-    SCH_SCREEN* screen = NULL;
+    // The sheets whose screen is not loaded yet, with the path their file name is relative to.
+    // Sub-sheet file names are relative to the path of the file of their parent sheet, which
+    // allows for sheet schematic files to be nested in folders.
+    std::vector<std::pair<SCH_SHEET*, wxString>> pending;
+
+    // The screens loaded so far, by full file name
+    std::map<wxString, SCH_SCREEN*> screens;
+
+    pending.emplace_back( aSheet, m_currentPath.top() );
 
-    if( !aSheet->GetScreen() )
+    // LIB_PIN reads the symbol editor settings, which are registered on their first use.
+    // That must not happen on a worker thread.
+    if( PGM_BASE* pgm = PgmOrNull() )
+        pgm->GetSettingsManager().GetAppSettings<SYMBOL_EDITOR_SETTINGS>();
+
+    // Load the hierarchy one level at a time, so that the files of a level are parsed in
+    // parallel.  A file used by several sheets is loaded once, and its screen shared.
+    while( !pending.empty() )
     {
-        // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object only
-        // stores the file name and extension.  Add the project path to the file name and
-        // extension to compare when calling SCH_SHEET::SearchHierarchy().
-        wxFileName fileName = aSheet->GetFileName();
+        std::vector<SCH_SHEET*> loading;
 
-        if( !fileName.IsAbsolute() )
-            fileName.MakeAbsolute( m_currentPath.top() );
+        for( const std::pair<SCH_SHEET*, wxString>& entry : pending )
+        {
+            SCH_SHEET* sheet = entry.first;
 
-        // Save the current path so that it gets restored when decending and ascending the
-        // sheet hierarchy which allows for sheet schematic files to be nested in folders
-        // relative to the last path a schematic was loaded from.
-        wxLogTrace( traceSchLegacyPlugin, "Saving path    \"%s\"", m_currentPath.top() );
-        m_currentPath.push( fileName.GetPath() );
-        wxLogTrace( traceSchLegacyPlugin, "Current path   \"%s\"", m_currentPath.top() );
-        wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fileName.GetFullPath() );
+            if( sheet->GetScreen() )
+                continue;
 
-        m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+            // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object
+            // only stores the file name and extension.
+            wxFileName fileName = sheet->GetFileName();
+
+            if( !fileName.IsAbsolute() )
+                fileName.MakeAbsolute( entry.second );
+
+            wxString    fullName = fileName.GetFullPath();
+            SCH_SCREEN* screen = nullptr;
+            auto        it = screens.find( fullName );
+
+            if( it != screens.end() )
+                screen = it->second;
+            else
+                m_rootSheet->SearchHierarchy( fullName, &screen );
 
-        if( screen )
+            if( screen )
+            {
+                sheet->SetScreen( screen );
+                sheet->GetScreen()->SetParent( m_schematic );
+                // Do not need to load the sub-sheets - this has already been done.
+                continue;
+            }
+
+            wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fullName );
+
+            sheet->SetScreen( new SCH_SCREEN( m_schematic ) );
+            sheet->GetScreen()->SetFileName( fullName );
+            screens[fullName] = sheet->GetScreen();
+            loading.push_back( sheet );
+        }
+
+        std::vector<std::exception_ptr> errors( loading.size() );
+        std::atomic<size_t>             nextFile( 0 );
+
+        auto load_lambda =
+                [&]() -> size_t
+                {
+                    for( size_t ii = nextFile++; ii < loading.size(); ii = nextFile++ )
+                    {
+                        try
+                        {
+                            loadFile( loading[ii]->GetScreen()->GetFileName(), loading[ii] );
+                        }
+                        catch( ... )
+                        {
+                            errors[ii] = std::current_exception();
+                        }
+                    }
+
+                    return 1;
+                };
+
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       loading.size() );
+
+        if( parallelThreadCount <= 1 )
         {
-            aSheet->SetScreen( screen );
-            aSheet->GetScreen()->SetParent( m_schematic );
-            // Do not need to load the sub-sheets - this has already been done.
+            load_lambda();
         }
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_schematic ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            std::vector<std::future<size_t>> returns( parallelThreadCount );
 
-            try
-            {
-                loadFile( fileName.GetFullPath(), aSheet );
-            }
-            catch( const IO_ERROR& ioe )
-            {
-                // If there is a problem loading the root sheet, there is no recovery.
-                if( aSheet == m_rootSheet )
-                    throw( ioe );
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii] = std::async( std::launch::async, load_lambda );
+
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii].wait();
+        }
 
-                // For all subsheets, queue up the error message for the caller.
-                if( !m_error.IsEmpty() )
-                    m_error += "\n";
+        pending.clear();
 
-                m_error += ioe.What();
-            }
+        for( size_t ii = 0; ii < loading.size(); ++ii )
+        {
+            SCH_SHEET* sheet = loading[ii];
 
-            // This was moved out of the try{} block so that any sheets definitionsthat
-            // the plugin fully parsed before the exception was raised will be loaded.
-            for( auto aItem : aSheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
+            if( errors[ii] )
             {
-                wxCHECK2( aItem->Type() == SCH_SHEET_T, /* do nothing */ );
-                auto sheet = static_cast<SCH_SHEET*>( aItem );
+                try
+                {
+                    std::rethrow_exception( errors[ii] );
+                }
+                catch( const IO_ERROR& ioe )
+                {
+                    // If there is a problem loading the root sheet, there is no recovery.
+                    if( sheet == m_rootSheet )
+                        throw;
 
-                // Recursion starts here.
-                loadHierarchy( sheet );
+                    // For all subsheets, queue up the error message for the caller.
+                    if( !m_error.IsEmpty() )
+                        m_error += "\n";
+
+                    m_error += ioe.What();
+                }
             }
-        }
 
-        m_currentPath.pop();
-        wxLogTrace( traceSchLegacyPlugin, "Restoring path \"%s\"", m_currentPath.top() );
+            // Any sheet definitions that the plugin fully parsed before an exception was
+            // raised are loaded as well.
+            wxString path = wxFileName( sheet->GetScreen()->GetFileName() ).GetPath();
+
+            for( SCH_ITEM* item : sheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
+                pending.emplace_back( static_cast<SCH_SHEET*>( item ), path );
+        }
     }
 }
 
 
 void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
 {
-    FILE_LINE_READER reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     SCH_SEXPR_PARSER parser( &reader );
 
@@ -572,6 +644,8 @@ void SCH_SEXPR_PLUGIN::Save( const wxString& aFileName, SCH_SHEET* aSheet, SCHEM
     m_out = &formatter;     // no ownership
 
     Format( aSheet );
+
+    formatter.Finish();
 }
 
 
@@ -1509,6 +1583,7 @@ void SCH_SEXPR_PLUGIN_CACHE::Save()
 
     formatter->Print( 0, ")\n" );
 
+    formatter->Finish();
     formatter.reset();
 
     m_fileModTime = fn.GetModificationTime();
@@ -127,6 +127,11 @@ public:
     static void FormatPart( LIB_PART* aPart, OUTPUTFORMATTER& aFormatter );
 
 private:
+    /**
+     * Load the screen of \a aSheet and of all the sheets below it, one hierarchy level at a
+     * time.  The files of a level are parsed in parallel, and a file used by several sheets
+     * is loaded once and its screen shared.
+     */
     void loadHierarchy( SCH_SHEET* aSheet );
     void loadFile( const wxString& aFileName, SCH_SHEET* aSheet );
 
@@ -40,6 +40,8 @@
 #include <trace_helpers.h>
 #include <pgm_base.h>
 
+#include <mutex>
+
 
 const wxString SCH_SHEET::GetDefaultFieldName( int aFieldNdx )
 {
@@ -47,6 +49,10 @@ const wxString SCH_SHEET::GetDefaultFieldName( int aFieldNdx )
     static wxString sheetnameDefault;
     static wxString sheetfilenameDefault;
     static wxString fieldDefault;
+    static std::mutex mutex;
+
+    // Schematic sheets are loaded on several threads
+    std::lock_guard<std::mutex> lock( mutex );
 
     // Fetching translations can take a surprising amount of time when loading libraries,
     // so only do it when necessary.
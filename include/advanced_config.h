@@ -149,6 +149,19 @@ public:
      */
     bool m_SkipBoundingBoxOnFpLoad;
 
+    /**
+     * Autosave boards as board snapshots, which are quicker to write than board files.
+     * Older versions of Pcbnew cannot read the autosave files.
+     */
+    bool m_SnapshotAutosave;
+
+    /**
+     * Update the router world from the board change notifications rather than rebuilding
+     * it each time a router tool is activated.  Turn off if board edits that don't send
+     * notifications (e.g. from the scripting console) leave the router out of date.
+     */
+    bool m_IncrementalRouterSync;
+
 private:
     ADVANCED_CFG();
 
@@ -200,6 +200,17 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS aUnit, EDA_DATA_TYPE aType = EDA_DA
  */
 std::string FormatInternalUnits( int aValue );
 
+/**
+ * Function FormatInternalUnits
+ * writes \a aValue from internal units to \a aBuffer, like FormatInternalUnits( int ) but
+ * without building a std::string.
+ *
+ * @param aBuffer must hold at least 32 characters.
+ * @param aValue A coordinate value to convert.
+ * @return the number of characters written, not including the terminating nul.
+ */
+int FormatInternalUnits( char* aBuffer, int aValue );
+
 /**
  * Function FormatAngle
  * converts \a aAngle from board units to a string appropriate for writing to file.
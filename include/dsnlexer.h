@@ -107,7 +107,12 @@ protected:
     int                 curOffset;              ///< offset within current line of the current token
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
-    std::string         curText;                ///< the text of the current token
+
+    /// The text of the current token.  A token which is in the line as it is, that is
+    /// anything but a quoted string or a comment, is only copied here when asked for.
+    mutable std::string curText;
+    mutable const char* tokenBegin;             ///< the current token in the line, or NULL
+    const char*         tokenEnd;               ///< when it is in curText
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
@@ -145,6 +150,25 @@ protected:
      */
     int findToken( const std::string& aToken ) const;
 
+    /**
+     * Function findToken
+     * looks up the string [@a aBegin, @a aEnd) in the keywords table.
+     */
+    int findToken( const char* aBegin, const char* aEnd ) const;
+
+    /**
+     * Function loadCurText
+     * copies the current token into curText, if it is still only in the line.
+     */
+    void loadCurText() const
+    {
+        if( tokenBegin )
+        {
+            curText.assign( tokenBegin, tokenEnd );
+            tokenBegin = NULL;
+        }
+    }
+
     bool isStringTerminator( char cc ) const
     {
         if( !space_in_quoted_tokens && cc == ' ' )
@@ -338,6 +362,9 @@ public:
      */
     int GetCurStrAsToken() const
     {
+        if( tokenBegin )
+            return findToken( tokenBegin, tokenEnd );
+
         return findToken( curText );
     }
 
@@ -488,15 +515,30 @@ public:
      */
     const char* CurText() const
     {
+        loadCurText();
         return curText.c_str();
     }
 
+    /**
+     * Function CurTokenText
+     * returns a pointer to the current token's text without copying it out of the line, as
+     * CurText() does.  Unless the token is a quoted string it is not nul terminated, but
+     * followed by a separator, so it can be converted by strtod() and the like.  It stays
+     * valid until the next line is read, which with a MAPPED_FILE_LINE_READER means while
+     * the reader exists.
+     */
+    const char* CurTokenText() const
+    {
+        return tokenBegin ? tokenBegin : curText.c_str();
+    }
+
     /**
      * Function CurStr
      * returns a reference to current token in std::string form.
      */
     const std::string& CurStr() const
     {
+        loadCurText();
         return curText;
     }
 
@@ -507,6 +549,9 @@ public:
      */
     wxString FromUTF8() const
     {
+        if( tokenBegin )
+            return wxString::FromUTF8( tokenBegin, tokenEnd - tokenBegin );
+
         return wxString::FromUTF8( curText.c_str() );
     }
 
@@ -94,6 +94,13 @@ public:
     VECTOR2D ComputeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
                                           double aGlyphThickness ) const;
 
+    /**
+     * Same as above, for italic text if \a aItalic, instead of the text attributes of the GAL.
+     * This one does not use the state of the GAL, so it can be called from any thread.
+     */
+    VECTOR2D ComputeStringBoundaryLimits( const UTF8& aText, const VECTOR2D& aGlyphSize,
+                                          double aGlyphThickness, bool aItalic ) const;
+
     /**
      * Compute the vertical position of an overbar, sometimes used in texts.
      * This is the distance between the text base line and the overbar.
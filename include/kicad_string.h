@@ -318,4 +318,37 @@ void wxStringSplit( const wxString& aText, wxArrayString& aStrings, wxChar aSpli
  */
 void StripTrailingZeros( wxString& aStringValue, unsigned aTrailingZeroAllowed = 1 );
 
+/**
+ * Convert the number at the beginning of \a aText to a double, like strtod() would in the
+ * "C" locale, whatever the current locale is.
+ *
+ * Plain decimal numbers with up to 15 significant digits, which is what KiCad writes, are
+ * converted without calling strtod().  On overflow errno is set to ERANGE.
+ *
+ * @param aText is the text to convert.
+ * @param aEndPtr if not NULL, is set to the first character after the number, or to \a aText
+ *                if there is no number.
+ * @return the converted value, or 0.0 if there is no number.
+ */
+double StrToDoubleC( const char* aText, char** aEndPtr );
+
+/**
+ * Write \a aValue / 10^\a aDecimals to \a aBuffer in plain decimal notation, without trailing
+ * zeros and without using the locale.
+ *
+ * @param aBuffer must hold at least 32 characters.
+ * @param aValue is the scaled value to write.
+ * @param aDecimals is the number of decimals in \a aValue, from 0 to 9.
+ * @return the number of characters written, not including the terminating nul.
+ */
+int FormatScaledInt( char* aBuffer, long long aValue, int aDecimals );
+
+/**
+ * snprintf() a single floating point value with a "C" locale decimal point, whatever the
+ * current locale is.
+ *
+ * @return the number of characters written, not including the terminating nul.
+ */
+int FormatDoubleC( char* aBuffer, size_t aSize, const char* aFormat, double aValue );
+
 #endif  // KICAD_STRING_H_
@@ -27,6 +27,7 @@
 #define KIID_H
 
 #include <boost/uuid/uuid.hpp>
+#include <functional>
 #include <macros_swig.h>
 
 class wxString;
@@ -90,6 +91,21 @@ private:
 };
 
 
+#ifndef SWIG
+/// Required to use KIID as key type in unordered containers
+namespace std
+{
+    template<> struct hash<KIID>
+    {
+        size_t operator()( const KIID& aId ) const
+        {
+            return aId.Hash();
+        }
+    };
+}
+#endif
+
+
 extern KIID niluuid;
 
 KIID& NilUuid();
@@ -29,6 +29,7 @@
 // "richio" after its author, Richard Hollenbeck, aka Dick Hollenbeck.
 
 
+#include <memory>
 #include <vector>
 #include <utf8.h>
 
@@ -248,6 +249,98 @@ public:
 };
 
 
+/**
+ * MAPPED_FILE_LINE_READER
+ * is a LINE_READER that maps a whole file in memory and hands out its lines in place,
+ * without copying them into a line buffer.  The line ending is kept, as with
+ * FILE_LINE_READER, and the line is nul terminated by temporarily overwriting the first
+ * byte of the next line, which is put back by the next ReadLine().  The mapping is private
+ * (copy on write), so the file itself is never modified.
+ * <p>
+ * Small files, files on network drives and files which cannot be mapped are read into
+ * memory instead.  Reading a mapping past the end of a file which was truncated after it was
+ * mapped raises SIGBUS, and a network file can be truncated by another machine at any time.
+ * On Windows local files cannot be truncated while they are mapped; elsewhere, a local file
+ * must not be truncated by another process while its content is in use.
+ */
+class MAPPED_FILE_LINE_READER : public LINE_READER
+{
+protected:
+    std::shared_ptr<char> m_content;    ///< the mapping or the buffer holding the file
+    char*       m_data;         ///< the content of the file
+    size_t      m_size;         ///< no. bytes in m_data
+    size_t      m_offset;       ///< offset of the next line in m_data
+
+    std::vector<char> m_lastLine;   ///< copy of a last line not ending with a newline
+
+    char*       m_terminator;   ///< where the nul ending the current line was written
+    char        m_savedChar;    ///< the byte overwritten by the nul
+    char        m_empty[1];     ///< Line() at end of file
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * opens and maps @a aFileName.
+     *
+     * @param aFileName is the name of the file to open and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error, see
+     *  FILE_LINE_READER.
+     * @param aMaxLineLength is the maximum length of a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName, unsigned aStartingLineNumber = 0,
+                             unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MAPPED_FILE_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the start of the file and resets the line number back to zero.
+     */
+    void Rewind();
+
+    /**
+     * Function Seek
+     * goes to the line starting at @a aOffset in Data(), whose number is @a aLineNumber.
+     */
+    void Seek( size_t aOffset, unsigned aLineNumber );
+
+    /**
+     * Function Content
+     * returns shared ownership of Data(), which then stays valid after the reader is
+     * destroyed.  The byte borrowed to terminate the current line is put back by the
+     * reader's destructor.
+     */
+    std::shared_ptr<const char> Content() const
+    {
+        return m_content;
+    }
+
+    /**
+     * Function Data
+     * returns the whole content of the file.  The byte following the current line is
+     * replaced by a nul until the next ReadLine().
+     */
+    const char* Data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Function Size
+     * returns the size of the file in bytes.
+     */
+    size_t Size() const
+    {
+        return m_size;
+    }
+};
+
+
 /**
  * STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -269,8 +362,12 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, which is
+     *  useful when aString was taken from the middle of a larger source.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -308,6 +405,7 @@ public:
 
 
 #define OUTPUTFMTBUFZ    500        ///< default buffer size for any OUTPUT_FORMATTER
+#define FILEFMTBUFZ      (256*1024) ///< output buffer size of FILE_OUTPUTFORMATTER
 
 /**
  * OUTPUTFORMATTER
@@ -330,9 +428,11 @@ class OUTPUTFORMATTER
     std::vector<char>   m_buffer;
     char                quoteChar[2];
 
-    int sprint( const char* fmt, ... );
     int vprint( const char* fmt,  va_list ap );
 
+    /// Write the spaces of \a nestLevel and return their count.
+    int indent( int nestLevel );
+
 
 protected:
     OUTPUTFORMATTER( int aReserve = OUTPUTFMTBUFZ, char aQuoteChar = '"' ) :
@@ -397,6 +497,19 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... );
 
+    /**
+     * Function PrintRaw
+     * writes \a aCount characters of already formatted text to the output stream, with
+     * no printf() processing.  This is much cheaper than Print() for the bulk of a file,
+     * such as polygon points.
+     *
+     * @param nestLevel The multiple of spaces to precede the output with.
+     * @param aText is the text to write, which does not need a nul terminator.
+     * @param aCount is the number of characters to write.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void PrintRaw( int nestLevel, const char* aText, int aCount );
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
@@ -489,6 +602,9 @@ protected:
  * FILE_OUTPUTFORMATTER
  * may be used for text file output.  It is about 8 times faster than
  * STREAM_OUTPUTFORMATTER for file streams.
+ * <p>
+ * Output is collected in a FILEFMTBUFZ buffer and written in large blocks.  Call Finish()
+ * to be told about errors of the last writes; the destructor can only ignore them.
  */
 class FILE_OUTPUTFORMATTER : public OUTPUTFORMATTER
 {
@@ -509,13 +625,25 @@ public:
 
     ~FILE_OUTPUTFORMATTER();
 
+    /**
+     * Function Finish
+     * writes the buffered output and closes the file.  Nothing may be output after it.
+     *
+     * @throw IO_ERROR if the output cannot be written.
+     */
+    void Finish();
+
 protected:
     //-----<OUTPUTFORMATTER>------------------------------------------------
     void write( const char* aOutBuf, int aCount ) override;
     //-----</OUTPUTFORMATTER>-----------------------------------------------
 
+    /// Write the buffered output to the file.
+    void flush();
+
     FILE*       m_fp;               ///< takes ownership
     wxString    m_filename;
+    std::string m_pending;          ///< output not yet written to m_fp
 };
 
 
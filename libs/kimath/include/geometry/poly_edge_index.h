@@ -0,0 +1,133 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_EDGE_INDEX_H
+#define __POLY_EDGE_INDEX_H
+
+#include <vector>
+
+#include <geometry/seg.h>
+#include <math/vector2d.h>
+
+class SHAPE_POLY_SET;
+
+/**
+ * POLY_EDGE_INDEX
+ *
+ * Spatial index of the edges of a SHAPE_POLY_SET, used by the set for its point-in-polygon,
+ * collision and distance queries once it is large enough.  The edges are binned twice:
+ * in horizontal bands for the ray casting parity test, and in a uniform grid of cells for
+ * the distance searches, which visit the cells in growing rings around the query.
+ *
+ * The queries give exactly the same results as the brute force loops of SHAPE_POLY_SET
+ * (including which nearest point is reported when several edges are at the same distance),
+ * so the set can switch between the two at any time.  The index holds a copy of the edges
+ * and has to be rebuilt when the set changes.
+ */
+class POLY_EDGE_INDEX
+{
+public:
+    /**
+     * Function CanIndex()
+     * @return true if all the contours of aPolySet are closed and have at least 3 points,
+     * and there are at least aMinSegments edges.
+     */
+    static bool CanIndex( const SHAPE_POLY_SET& aPolySet, int aMinSegments );
+
+    POLY_EDGE_INDEX( const SHAPE_POLY_SET& aPolySet );
+
+    /**
+     * Function Contains()
+     * Same as SHAPE_POLY_SET::Contains( aP, -1, aAccuracy ).
+     */
+    bool Contains( const VECTOR2I& aP, int aAccuracy = 0 ) const;
+
+    /**
+     * Function SquaredDistance()
+     * Same as SHAPE_POLY_SET::SquaredDistance( aP, aNearest ), but if aLimit is not negative
+     * the search is stopped as soon as it is known that the distance is at least aLimit, and
+     * the returned value is then only guaranteed to be at least aLimit squared.
+     */
+    SEG::ecoord SquaredDistance( const VECTOR2I& aP, VECTOR2I* aNearest = nullptr,
+                                 int aLimit = -1 ) const;
+
+    SEG::ecoord SquaredDistance( const SEG& aSeg, VECTOR2I* aNearest = nullptr,
+                                 int aLimit = -1 ) const;
+
+private:
+    struct EDGE
+    {
+        VECTOR2I m_a;
+        VECTOR2I m_b;
+        int      m_polygon;
+        int      m_contour;     ///< global contour index
+        int      m_index;       ///< index of the segment in its contour
+    };
+
+    /// Key ordering the candidates of a distance search like the brute force loops do
+    struct CANDIDATE
+    {
+        SEG::ecoord m_dist;
+        int         m_polygon;
+        int         m_contour;  ///< -1 when the query lies inside the polygon
+        int         m_index;
+        int         m_edge;
+
+        bool operator<( const CANDIDATE& aOther ) const;
+    };
+
+    int cellX( int64_t aX ) const;
+    int cellY( int64_t aY ) const;
+    int64_t cellStartX( int aCol ) const;
+    int64_t cellStartY( int aRow ) const;
+    int band( int aY ) const;
+
+    template <typename FUNC>
+    void forEachCell( const EDGE& aEdge, FUNC aFunc ) const;
+
+    /// Returns the index of the first polygon containing aP (ray test only), or -1.
+    int firstContaining( const VECTOR2I& aP ) const;
+
+    /// Collects the contours the horizontal ray from aP crosses an odd number of times.
+    void oddContours( const VECTOR2I& aP, std::vector<int>& aContours ) const;
+
+    template <typename QUERY>
+    void search( const QUERY& aQuery, const VECTOR2I& aMin, const VECTOR2I& aMax,
+                 CANDIDATE& aBest, int aLimit ) const;
+
+    std::vector<EDGE> m_edges;
+    std::vector<int>  m_contourPolygon;     ///< polygon of each global contour
+    std::vector<int>  m_firstContour;       ///< global index of the outline of each polygon
+
+    int64_t m_minX, m_minY, m_width, m_height;
+
+    int              m_cols, m_rows;
+    std::vector<int> m_cellStart;           ///< m_cellEdges range of each cell (CSR)
+    std::vector<int> m_cellEdges;
+
+    int              m_bands;
+    std::vector<int> m_bandStart;           ///< m_bandEdges range of each band (CSR)
+    std::vector<int> m_bandEdges;
+};
+
+#endif // __POLY_EDGE_INDEX_H
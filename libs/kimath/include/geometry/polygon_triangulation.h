@@ -47,8 +47,8 @@
 #define __POLYGON_TRIANGULATION_H
 
 #include <algorithm>
-#include <deque>
 #include <cmath>
+#include <vector>
 
 #include <clipper.hpp>
 #include <geometry/shape_line_chain.h>
@@ -72,6 +72,7 @@ private:
                 i( aIndex ), x( aX ), y( aY ), parent( aParent )
         {
         }
+        Vertex( Vertex&& ) = default;  // only needed by std::vector, the pool never moves them
         Vertex& operator=( const Vertex& ) = delete;
         Vertex& operator=( Vertex&& ) = delete;
 
@@ -95,10 +96,8 @@ private:
          */
         Vertex* split( Vertex* b )
         {
-            parent->m_vertices.emplace_back( i, x, y, parent );
-            Vertex* a2 = &parent->m_vertices.back();
-            parent->m_vertices.emplace_back( b->i, b->x, b->y, parent );
-            Vertex* b2 = &parent->m_vertices.back();
+            Vertex* a2 = parent->newVertex( i, x, y );
+            Vertex* b2 = parent->newVertex( b->i, b->x, b->y );
             Vertex* an = next;
             Vertex* bp = b->prev;
 
@@ -179,17 +178,15 @@ private:
          */
         void zSort()
         {
-            std::deque<Vertex*> queue;
+            std::vector<Vertex*>& queue = parent->m_zQueue;
 
+            queue.clear();
             queue.push_back( this );
 
             for( auto p = next; p && p != this; p = p->next )
                 queue.push_back( p );
 
-            std::sort( queue.begin(), queue.end(), []( const Vertex* a, const Vertex* b)
-            {
-                return a->z < b->z;
-            } );
+            parent->sortByZ( queue );
 
             Vertex* prev_elem = nullptr;
             for( auto elem : queue )
@@ -233,9 +230,69 @@ private:
     };
 
     BOX2I m_bbox;
-    std::deque<Vertex> m_vertices;
     SHAPE_POLY_SET::TRIANGULATED_POLYGON& m_result;
 
+    // The vertices are allocated in blocks which are never reallocated, as the lists link
+    // them by pointer.  The first block is sized for the polygon and its usual splits, so
+    // the vertices are almost always contiguous.
+    std::vector<std::vector<Vertex>> m_vertices;
+    size_t m_blockSize = 0;
+
+    // Buffers of zSort(), kept to avoid reallocating them for every split
+    std::vector<Vertex*> m_zQueue;
+    std::vector<Vertex*> m_zBuffer;
+
+    Vertex* newVertex( size_t aIndex, double aX, double aY )
+    {
+        if( m_vertices.empty() || m_vertices.back().size() == m_vertices.back().capacity() )
+        {
+            m_vertices.emplace_back();
+            m_vertices.back().reserve( std::max<size_t>( m_blockSize, 16 ) );
+        }
+
+        m_vertices.back().emplace_back( aIndex, aX, aY, this );
+        return &m_vertices.back().back();
+    }
+
+    /**
+     * Function sortByZ
+     * Sorts the vertices by their z-order value.  The values are 30 bits wide (two interleaved
+     * 15 bit coordinates), so large lists are sorted with three 10 bit radix passes.
+     */
+    void sortByZ( std::vector<Vertex*>& aQueue )
+    {
+        const size_t radixBits = 10;
+        const size_t radixSize = 1 << radixBits;
+
+        if( aQueue.size() < 2 * radixSize )
+        {
+            std::sort( aQueue.begin(), aQueue.end(), []( const Vertex* a, const Vertex* b )
+            {
+                return a->z < b->z;
+            } );
+
+            return;
+        }
+
+        m_zBuffer.resize( aQueue.size() );
+
+        for( size_t shift = 0; shift < 30; shift += radixBits )
+        {
+            size_t count[radixSize + 1] = {};
+
+            for( const Vertex* p : aQueue )
+                count[( ( p->z >> shift ) & ( radixSize - 1 ) ) + 1]++;
+
+            for( size_t ii = 1; ii <= radixSize; ii++ )
+                count[ii] += count[ii - 1];
+
+            for( Vertex* p : aQueue )
+                m_zBuffer[count[( p->z >> shift ) & ( radixSize - 1 )]++] = p;
+
+            aQueue.swap( m_zBuffer );
+        }
+    }
+
     /**
      * Calculate the Morton code of the Vertex
      * http://www.graphics.stanford.edu/~seander/bithacks.html#InterleaveBMN
@@ -635,9 +692,9 @@ private:
     Vertex* insertVertex( const VECTOR2I& pt, Vertex* last )
     {
         m_result.AddVertex( pt );
-        m_vertices.emplace_back( m_result.GetVertexCount() - 1, pt.x, pt.y, this );
 
-        Vertex* p = &m_vertices.back();
+        Vertex* p = newVertex( m_result.GetVertexCount() - 1, pt.x, pt.y );
+
         if( !last )
         {
             p->prev = p;
@@ -661,6 +718,10 @@ public:
         m_bbox = aPoly.BBox();
         m_result.Clear();
 
+        // Room for the polygon and a few splits (each one adds two vertices)
+        m_vertices.clear();
+        m_blockSize = aPoly.PointCount() + aPoly.PointCount() / 4 + 16;
+
         if( !m_bbox.GetWidth() || !m_bbox.GetHeight() )
             return false;
 
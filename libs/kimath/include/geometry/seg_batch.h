@@ -0,0 +1,101 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file seg_batch.h
+ * @brief batched distance tests of a point or a segment against the segments of a polyline.
+ *
+ * The kernels are filters for the exact (integer) tests of SEG: they evaluate several
+ * segments at once in double precision (with SSE2 or AVX2 when the CPU has them) and
+ * return the next segment that may lie closer than a given distance.  A segment that is
+ * skipped is guaranteed to be at least that distance away as computed by SEG, so callers
+ * only run the exact tests on the returned segments and get the same results as when
+ * testing every segment.
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <geometry/seg.h>
+#include <math/vector2d.h>
+
+/**
+ * Instruction sets the batched kernels can be run with.
+ */
+enum class SEG_BATCH_ISA
+{
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+/**
+ * Function SegBatchIsaSupported()
+ *
+ * @return true if the batched kernels can be run with instruction set aIsa on this CPU.
+ */
+bool SegBatchIsaSupported( SEG_BATCH_ISA aIsa );
+
+/**
+ * Function SegBatchBestIsa()
+ *
+ * @return the fastest instruction set supported by this CPU, used by the kernels when
+ * none is given.
+ */
+SEG_BATCH_ISA SegBatchBestIsa();
+
+/**
+ * Function FindSegmentNear()
+ *
+ * Finds the first segment of a polyline, starting from segment aStart, that may lie closer
+ * than aDist to point aP.  Segment i of the polyline runs from aPts[i] to aPts[i + 1].
+ * All the skipped segments are such that SEG::SquaredDistance( aP ) >= aDist * aDist and
+ * is non-zero.
+ * @param aPts the vertices of the polyline
+ * @param aPointCount number of vertices (the polyline has aPointCount - 1 segments)
+ * @param aStart index of the first segment to test
+ * @param aP the point to test
+ * @param aDist the distance
+ * @return index of the segment, or aPointCount - 1 if there is no such segment
+ */
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const VECTOR2I& aP,
+                     int aDist );
+
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const VECTOR2I& aP,
+                     int aDist, SEG_BATCH_ISA aIsa );
+
+/**
+ * Function FindSegmentNear()
+ *
+ * Finds the first segment of a polyline, starting from segment aStart, that may lie closer
+ * than aDist to segment aSeg, or intersect it.  All the skipped segments are such that
+ * SEG::SquaredDistance( aSeg ) >= aDist * aDist and is non-zero.
+ * @return index of the segment, or aPointCount - 1 if there is no such segment
+ */
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const SEG& aSeg,
+                     int aDist );
+
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const SEG& aSeg,
+                     int aDist, SEG_BATCH_ISA aIsa );
+
+#endif // __SEG_BATCH_H
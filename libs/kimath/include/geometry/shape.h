@@ -292,6 +292,26 @@ public:
 
     SEG::ecoord SquaredDistance( const VECTOR2I& aP, bool aOutlineOnly = false ) const;
 
+    /**
+     * Function NextSegmentNear()
+     *
+     * Returns the index of the first segment, starting from aStart, that may lie closer than
+     * aDist to point aP.  The segments that are skipped are farther than aDist (see
+     * FindSegmentNear()), so loops testing the segments for collisions only need to test
+     * the returned ones.
+     * @return index of the segment, or GetSegmentCount() if there is none
+     */
+    int NextSegmentNear( int aStart, const VECTOR2I& aP, int aDist ) const;
+
+    /**
+     * Function NextSegmentNear()
+     *
+     * Returns the index of the first segment, starting from aStart, that may lie closer than
+     * aDist to segment aSeg or intersect it.
+     * @return index of the segment, or GetSegmentCount() if there is none
+     */
+    int NextSegmentNear( int aStart, const SEG& aSeg, int aDist ) const;
+
     /**
      * Function PointInside()
      *
@@ -327,6 +347,10 @@ public:
     virtual size_t         GetPointCount() const          = 0;
     virtual size_t         GetSegmentCount() const        = 0;
     virtual bool IsClosed() const = 0;
+
+    ///> Returns the points as a contiguous array (segment i running from point i to point
+    ///> i + 1), or nullptr if they are not stored that way
+    virtual const VECTOR2I* GetPointData() const { return nullptr; }
 };
 
 #endif // __SHAPE_H
@@ -89,11 +89,40 @@ public:
 
     const BOX2I BBox( int aClearance = 0 ) const override;
 
+    bool Collide( const SHAPE* aShape, int aClearance, VECTOR2I* aMTV ) const override
+    {
+        return SHAPE::Collide( aShape, aClearance, aMTV );
+    }
+
+    bool Collide( const SHAPE* aShape, int aClearance = 0, int* aActual = nullptr,
+                  VECTOR2I* aLocation = nullptr ) const override
+    {
+        return SHAPE::Collide( aShape, aClearance, aActual, aLocation );
+    }
+
     bool Collide( const SEG& aSeg, int aClearance = 0, int* aActual = nullptr,
                   VECTOR2I* aLocation = nullptr ) const override;
     bool Collide( const VECTOR2I& aP, int aClearance = 0, int* aActual = nullptr,
                   VECTOR2I* aLocation = nullptr ) const override;
 
+    /**
+     * Function SquaredDistance()
+     * Computes the squared distance between the arc and a point, a segment or another arc
+     * directly on the arc rather than on a polyline approximation of it.  The width of the
+     * arcs is not taken into account.
+     * @param aNearest if not null, receives the point of this arc nearest to the other shape.
+     */
+    ecoord SquaredDistance( const VECTOR2I& aP, VECTOR2I* aNearest = nullptr ) const;
+    ecoord SquaredDistance( const SEG& aSeg, VECTOR2I* aNearest = nullptr ) const;
+    ecoord SquaredDistance( const SHAPE_ARC& aArc, VECTOR2I* aNearest = nullptr ) const;
+
+    /**
+     * Function SliceContainsPoint()
+     * @return true if the half line from the arc center through aP crosses the arc, i.e. if
+     * aP lies in the angular sector swept by the arc.
+     */
+    bool SliceContainsPoint( const VECTOR2I& aP ) const;
+
     void SetWidth( int aWidth )
     {
         m_width = aWidth;
@@ -154,6 +183,14 @@ private:
 
     void update_bbox();
 
+    bool sliceContains( const VECTOR2I& aCenter, const VECTOR2I& aP ) const;
+
+    /// Returns the point of the circle of the arc in the direction of aP (aP != aCenter).
+    VECTOR2I radialPoint( const VECTOR2I& aCenter, double aRadius, const VECTOR2I& aP ) const;
+
+    ecoord squaredDistance( const VECTOR2I& aCenter, double aRadius, const VECTOR2I& aP,
+                            VECTOR2I* aNearest ) const;
+
 
     VECTOR2I m_start;
     VECTOR2I m_mid;
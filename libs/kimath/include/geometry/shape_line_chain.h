@@ -116,6 +116,8 @@ public:
               m_bbox( aShape.m_bbox )
     {}
 
+    SHAPE_LINE_CHAIN( SHAPE_LINE_CHAIN&& ) = default;
+
     SHAPE_LINE_CHAIN( const std::vector<int>& aV);
 
     SHAPE_LINE_CHAIN( const std::vector<wxPoint>& aV, bool aClosed = false )
@@ -125,15 +127,12 @@ public:
 
         for( auto pt : aV )
             m_points.emplace_back( pt.x, pt.y );
-
-        m_shapes = std::vector<ssize_t>( aV.size(), ssize_t( SHAPE_IS_PT ) );
     }
 
     SHAPE_LINE_CHAIN( const std::vector<VECTOR2I>& aV, bool aClosed = false )
             : SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ), m_closed( aClosed ), m_width( 0 )
     {
         m_points = aV;
-        m_shapes = std::vector<ssize_t>( aV.size(), ssize_t( SHAPE_IS_PT ) );
     }
 
     SHAPE_LINE_CHAIN( const SHAPE_ARC& aArc, bool aClosed = false )
@@ -152,7 +151,6 @@ public:
         m_width( 0 )
     {
         m_points.reserve( aPath.size() );
-        m_shapes = std::vector<ssize_t>( aPath.size(), ssize_t( SHAPE_IS_PT ) );
 
         for( const auto& point : aPath )
             m_points.emplace_back( point.X, point.Y );
@@ -162,6 +160,7 @@ public:
     {}
 
     SHAPE_LINE_CHAIN& operator=(const SHAPE_LINE_CHAIN&) = default;
+    SHAPE_LINE_CHAIN& operator=( SHAPE_LINE_CHAIN&& ) = default;
 
     SHAPE* Clone() const override;
 
@@ -297,7 +296,7 @@ public:
 
         m_points[aIndex] = aPos;
 
-        if( m_shapes[aIndex] != SHAPE_IS_PT )
+        if( ArcIndex( aIndex ) != SHAPE_IS_PT )
             convertArc( m_shapes[aIndex] );
     }
 
@@ -340,10 +339,14 @@ public:
     }
 
     /**
-     * @return the vector of values indicating shape type and location
+     * @return the vector of values indicating shape type and location (built on the fly for
+     * chains without arcs, which don't store it)
      */
-    const std::vector<ssize_t>& CShapes() const
+    const std::vector<ssize_t> CShapes() const
     {
+        if( m_shapes.empty() )
+            return std::vector<ssize_t>( m_points.size(), ssize_t( SHAPE_IS_PT ) );
+
         return m_shapes;
     }
 
@@ -430,7 +433,10 @@ public:
         if( m_points.size() == 0 || aAllowDuplication || CPoint( -1 ) != aP )
         {
             m_points.push_back( aP );
-            m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
+            if( !m_shapes.empty() )
+                m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
             m_bbox.Merge( aP );
         }
     }
@@ -723,11 +729,19 @@ public:
     virtual const SEG GetSegment( int aIndex ) const override { return CSegment(aIndex); }
     virtual size_t GetPointCount() const override { return PointCount(); }
     virtual size_t GetSegmentCount() const override { return SegmentCount(); }
+    virtual const VECTOR2I* GetPointData() const override { return m_points.data(); }
 
 private:
 
     constexpr static ssize_t SHAPE_IS_PT = -1;
 
+    /// Stores the shape indices of all the points, before arcs get added to the chain.
+    void storeShapes()
+    {
+        if( m_shapes.empty() )
+            m_shapes.assign( m_points.size(), ssize_t( SHAPE_IS_PT ) );
+    }
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
@@ -735,6 +749,8 @@ private:
      * Array of indices that refer to the index of the shape if the point is part of a larger
      * shape, e.g. arc or spline.
      * If the value is -1, the point is just a point.
+     * The array is empty when the chain has no arcs, which is the case of most chains, and
+     * otherwise has one entry per point.
      */
     std::vector<ssize_t> m_shapes;
 
@@ -26,6 +26,7 @@
 #ifndef __SHAPE_POLY_SET_H
 #define __SHAPE_POLY_SET_H
 
+#include <atomic>
 #include <cstdio>
 #include <deque>                        // for deque
 #include <vector>                       // for vector
@@ -44,6 +45,8 @@
 #include <math/vector2d.h>              // for VECTOR2I
 #include <md5_hash.h>
 
+class POLY_EDGE_INDEX;
+
 
 /**
  * SHAPE_POLY_SET
@@ -291,7 +294,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             const T& Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].CPoint(
+                return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CPoint(
                         m_currentVertex );
             }
 
@@ -414,7 +417,8 @@ class SHAPE_POLY_SET : public SHAPE
 
             T Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+                return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CSegment(
+                        m_currentSegment );
             }
 
             T operator*()
@@ -637,6 +641,7 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            invalidateEdgeIndex();
             return m_polys[aIndex][0];
         }
 
@@ -659,12 +664,14 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            invalidateEdgeIndex();
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            invalidateEdgeIndex();
             return m_polys[aIndex];
         }
 
@@ -707,6 +714,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             ITERATOR iter;
 
+            invalidateEdgeIndex();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -819,6 +828,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             SEGMENT_ITERATOR iter;
 
+            invalidateEdgeIndex();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -977,6 +988,17 @@ class SHAPE_POLY_SET : public SHAPE
         ///> with holes.
         void Unfracture( POLYGON_MODE aFastMode );
 
+        /**
+         * Sets the number of vertices from which the PM_FAST boolean operations and Fracture()
+         * split their work between several threads.  The plane is then cut in vertical strips
+         * processed in parallel, and the strips are stitched back together.  Once simplified,
+         * the result is the serial one.
+         * @param aVertexCount - the minimum vertex count, 0 to always run serially
+         */
+        static void SetParallelThreshold( int aVertexCount );
+
+        static int GetParallelThreshold();
+
         ///> Returns true if the polygon set has any holes.
         bool HasHoles() const;
 
@@ -1137,6 +1159,11 @@ class SHAPE_POLY_SET : public SHAPE
         /**
          * Returns true if a given subpolygon contains the point aP
          *
+         * Checking all the subpolygons of a large set several times builds an index of its
+         * edges, which is also used by the distance and collision queries with points and
+         * segments.  The index is dropped by the editing actions and the non-const accessors,
+         * so the references they return must not be kept to edit the set later on.
+         *
          * @param aP is the point to check
          * @param aSubpolyIndex is the subpolygon to check, or -1 to check all
          * @param aUseBBoxCaches gives faster performance when multiple calls are made with no
@@ -1329,6 +1356,13 @@ class SHAPE_POLY_SET : public SHAPE
         void booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+        /**
+         * Runs booleanOp() on vertical strips of the plane in parallel.
+         * @return false if the shapes are too small to be split, the result is then unchanged
+         */
+        bool parallelBooleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
+                                const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
+
         /**
          * containsSingle function
          * Checks whether the point aP is inside the aSubpolyIndex-th polygon of the polyset. If
@@ -1401,10 +1435,31 @@ class SHAPE_POLY_SET : public SHAPE
 
         MD5_HASH checksum() const;
 
+        /**
+         * Returns the edge index for the queries on the whole set, building it if this is the
+         * EDGE_INDEX_MIN_QUERIES-th query since the last change of a large enough set.
+         * @return the index, or nullptr if the queries have to use the brute force loops.
+         */
+        std::shared_ptr<const POLY_EDGE_INDEX> edgeIndex() const;
+
+        ///> Drops the edge index; to be called by everything that may modify the set
+        void invalidateEdgeIndex()
+        {
+            // The index is only built after some queries, so there is nothing to drop if
+            // none was made since the last change
+            if( m_edgeIndexQueries.load( std::memory_order_relaxed ) )
+                resetEdgeIndex();
+        }
+
+        void resetEdgeIndex();
+
         std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        mutable std::shared_ptr<const POLY_EDGE_INDEX> m_edgeIndex;
+        mutable std::atomic<int> m_edgeIndexQueries{ 0 };
+
 };
 
 #endif
@@ -185,6 +185,7 @@ public:
     virtual const SEG GetSegment( int aIndex ) const override { return m_points.CSegment(aIndex); }
     virtual size_t GetPointCount() const override { return m_points.PointCount(); }
     virtual size_t GetSegmentCount() const override { return m_points.SegmentCount(); }
+    virtual const VECTOR2I* GetPointData() const override { return m_points.CPoints().data(); }
 
     bool IsClosed() const override
     {
@@ -0,0 +1,556 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+
+#include <geometry/poly_edge_index.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+// Average number of edges in a grid cell and in a band, and the index size limits
+static const int EDGES_PER_CELL = 4;
+static const int EDGES_PER_BAND = 8;
+static const int MAX_GRID_SIZE = 1024;
+static const int MAX_BANDS = 65536;
+static const int MAX_BAND_ENTRIES_PER_EDGE = 16;
+
+
+bool POLY_EDGE_INDEX::CANDIDATE::operator<( const CANDIDATE& aOther ) const
+{
+    if( m_dist != aOther.m_dist )
+        return m_dist < aOther.m_dist;
+
+    if( m_polygon != aOther.m_polygon )
+        return m_polygon < aOther.m_polygon;
+
+    if( m_contour != aOther.m_contour )
+        return m_contour < aOther.m_contour;
+
+    return m_index < aOther.m_index;
+}
+
+
+bool POLY_EDGE_INDEX::CanIndex( const SHAPE_POLY_SET& aPolySet, int aMinSegments )
+{
+    int segments = 0;
+
+    for( int ii = 0; ii < aPolySet.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aPolySet.CPolygon( ii );
+
+        if( poly.empty() )
+            return false;
+
+        // The brute force queries treat open or degenerate contours specially
+        for( const SHAPE_LINE_CHAIN& path : poly )
+        {
+            if( !path.IsClosed() || path.PointCount() < 3 )
+                return false;
+
+            segments += path.SegmentCount();
+        }
+    }
+
+    return segments >= aMinSegments;
+}
+
+
+POLY_EDGE_INDEX::POLY_EDGE_INDEX( const SHAPE_POLY_SET& aPolySet )
+{
+    int64_t maxX = INT_MIN;
+    int64_t maxY = INT_MIN;
+
+    m_minX = INT_MAX;
+    m_minY = INT_MAX;
+
+    for( int ii = 0; ii < aPolySet.OutlineCount(); ii++ )
+    {
+        m_firstContour.push_back( m_contourPolygon.size() );
+
+        for( const SHAPE_LINE_CHAIN& path : aPolySet.CPolygon( ii ) )
+        {
+            int contour = m_contourPolygon.size();
+
+            m_contourPolygon.push_back( ii );
+
+            for( int jj = 0; jj < path.SegmentCount(); jj++ )
+            {
+                SEG seg = path.CSegment( jj );
+
+                m_edges.push_back( { seg.A, seg.B, ii, contour, jj } );
+
+                m_minX = std::min<int64_t>( m_minX, seg.A.x );
+                m_minY = std::min<int64_t>( m_minY, seg.A.y );
+                maxX = std::max<int64_t>( maxX, seg.A.x );
+                maxY = std::max<int64_t>( maxY, seg.A.y );
+            }
+        }
+    }
+
+    if( m_edges.empty() )
+    {
+        m_minX = m_minY = 0;
+        maxX = maxY = 0;
+    }
+
+    m_width = maxX - m_minX + 1;
+    m_height = maxY - m_minY + 1;
+
+    // Roughly square cells, with a few edges in each
+    double cells = std::max( 1.0, (double) m_edges.size() / EDGES_PER_CELL );
+    double cols = std::sqrt( cells * m_width / m_height );
+
+    m_cols = std::max( 1, (int) std::min<double>( cols, MAX_GRID_SIZE ) );
+    m_rows = std::max( 1, (int) std::min<double>( cells / m_cols, MAX_GRID_SIZE ) );
+
+    m_cellStart.assign( m_cols * m_rows + 1, 0 );
+
+    for( const EDGE& edge : m_edges )
+        forEachCell( edge, [&]( int aCell ) { m_cellStart[aCell + 1]++; } );
+
+    for( size_t ii = 1; ii < m_cellStart.size(); ii++ )
+        m_cellStart[ii] += m_cellStart[ii - 1];
+
+    std::vector<int> cellFill( m_cellStart.begin(), m_cellStart.end() - 1 );
+
+    m_cellEdges.resize( m_cellStart.back() );
+
+    for( size_t ii = 0; ii < m_edges.size(); ii++ )
+        forEachCell( m_edges[ii], [&]( int aCell ) { m_cellEdges[cellFill[aCell]++] = ii; } );
+
+    // Horizontal edges never change the parity of the ray test, so they are left out of the
+    // bands.  Use fewer bands if long vertical edges would be listed in too many of them.
+    m_bands = std::max<int>( 1, std::min<size_t>( m_edges.size() / EDGES_PER_BAND, MAX_BANDS ) );
+
+    auto bandSpan =
+            [&]( const EDGE& aEdge )
+            {
+                if( aEdge.m_a.y == aEdge.m_b.y )
+                    return 0;
+
+                return band( std::max( aEdge.m_a.y, aEdge.m_b.y ) )
+                       - band( std::min( aEdge.m_a.y, aEdge.m_b.y ) ) + 1;
+            };
+
+    while( m_bands > 1 )
+    {
+        size_t entries = 0;
+
+        for( const EDGE& edge : m_edges )
+            entries += bandSpan( edge );
+
+        if( entries <= MAX_BAND_ENTRIES_PER_EDGE * m_edges.size() )
+            break;
+
+        m_bands /= 2;
+    }
+
+    m_bandStart.assign( m_bands + 1, 0 );
+
+    for( const EDGE& edge : m_edges )
+    {
+        if( edge.m_a.y == edge.m_b.y )
+            continue;
+
+        for( int b = band( std::min( edge.m_a.y, edge.m_b.y ) );
+             b <= band( std::max( edge.m_a.y, edge.m_b.y ) ); b++ )
+        {
+            m_bandStart[b + 1]++;
+        }
+    }
+
+    for( size_t ii = 1; ii < m_bandStart.size(); ii++ )
+        m_bandStart[ii] += m_bandStart[ii - 1];
+
+    std::vector<int> bandFill( m_bandStart.begin(), m_bandStart.end() - 1 );
+
+    m_bandEdges.resize( m_bandStart.back() );
+
+    for( size_t ii = 0; ii < m_edges.size(); ii++ )
+    {
+        const EDGE& edge = m_edges[ii];
+
+        if( edge.m_a.y == edge.m_b.y )
+            continue;
+
+        for( int b = band( std::min( edge.m_a.y, edge.m_b.y ) );
+             b <= band( std::max( edge.m_a.y, edge.m_b.y ) ); b++ )
+        {
+            m_bandEdges[bandFill[b]++] = ii;
+        }
+    }
+}
+
+
+int POLY_EDGE_INDEX::cellX( int64_t aX ) const
+{
+    int64_t offset = std::max<int64_t>( 0, aX - m_minX );
+
+    return std::min<int64_t>( offset * m_cols / m_width, m_cols - 1 );
+}
+
+
+int POLY_EDGE_INDEX::cellY( int64_t aY ) const
+{
+    int64_t offset = std::max<int64_t>( 0, aY - m_minY );
+
+    return std::min<int64_t>( offset * m_rows / m_height, m_rows - 1 );
+}
+
+
+int64_t POLY_EDGE_INDEX::cellStartX( int aCol ) const
+{
+    // The smallest x such that cellX( x ) == aCol
+    return m_minX + ( aCol * m_width + m_cols - 1 ) / m_cols;
+}
+
+
+int64_t POLY_EDGE_INDEX::cellStartY( int aRow ) const
+{
+    return m_minY + ( aRow * m_height + m_rows - 1 ) / m_rows;
+}
+
+
+int POLY_EDGE_INDEX::band( int aY ) const
+{
+    return ( aY - m_minY ) * m_bands / m_height;
+}
+
+
+template <typename FUNC>
+void POLY_EDGE_INDEX::forEachCell( const EDGE& aEdge, FUNC aFunc ) const
+{
+    const VECTOR2I& a = aEdge.m_a;
+    const VECTOR2I& b = aEdge.m_b;
+
+    int64_t minX = std::min( a.x, b.x );
+    int64_t maxX = std::max( a.x, b.x );
+    int64_t minY = std::min( a.y, b.y );
+    int64_t maxY = std::max( a.y, b.y );
+
+    int c0 = cellX( minX );
+    int c1 = cellX( maxX );
+    int r0 = cellY( minY );
+    int r1 = cellY( maxY );
+
+    if( c0 == c1 || r0 == r1 )
+    {
+        for( int row = r0; row <= r1; row++ )
+        {
+            for( int col = c0; col <= c1; col++ )
+                aFunc( row * m_cols + col );
+        }
+
+        return;
+    }
+
+    // A slanted edge is only stored in the cells it crosses, column by column.  The y range
+    // of the edge in each column is widened a bit to cover the rounding of the computation.
+    double slope = (double) ( b.y - a.y ) / ( b.x - a.x );
+
+    for( int col = c0; col <= c1; col++ )
+    {
+        int64_t x0 = std::max( minX, cellStartX( col ) );
+        int64_t x1 = std::min( maxX, cellStartX( col + 1 ) );
+        double  y0 = a.y + ( x0 - a.x ) * slope;
+        double  y1 = a.y + ( x1 - a.x ) * slope;
+
+        int64_t bottom = std::max<int64_t>( minY, std::floor( std::min( y0, y1 ) ) - 2 );
+        int64_t top = std::min<int64_t>( maxY, std::ceil( std::max( y0, y1 ) ) + 2 );
+
+        for( int row = cellY( bottom ); row <= cellY( top ); row++ )
+            aFunc( row * m_cols + col );
+    }
+}
+
+
+void POLY_EDGE_INDEX::oddContours( const VECTOR2I& aP, std::vector<int>& aContours ) const
+{
+    aContours.clear();
+
+    if( aP.y < m_minY || aP.y >= m_minY + m_height )
+        return;
+
+    int b = band( aP.y );
+
+    for( int ii = m_bandStart[b]; ii < m_bandStart[b + 1]; ii++ )
+    {
+        const EDGE&     edge = m_edges[m_bandEdges[ii]];
+        const VECTOR2I& p1 = edge.m_a;
+        const VECTOR2I& p2 = edge.m_b;
+
+        // Same test as SHAPE_LINE_CHAIN_BASE::PointInside()
+        if( ( p1.y > aP.y ) != ( p2.y > aP.y ) )
+        {
+            const VECTOR2I diff = p2 - p1;
+            const int      d = rescale( diff.x, ( aP.y - p1.y ), diff.y );
+
+            if( aP.x - p1.x < d )
+                aContours.push_back( edge.m_contour );
+        }
+    }
+
+    std::sort( aContours.begin(), aContours.end() );
+
+    // Keep the contours listed an odd number of times
+    size_t count = 0;
+
+    for( size_t ii = 0; ii < aContours.size(); )
+    {
+        size_t next = ii;
+
+        while( next < aContours.size() && aContours[next] == aContours[ii] )
+            next++;
+
+        if( ( next - ii ) % 2 )
+            aContours[count++] = aContours[ii];
+
+        ii = next;
+    }
+
+    aContours.resize( count );
+}
+
+
+int POLY_EDGE_INDEX::firstContaining( const VECTOR2I& aP ) const
+{
+    std::vector<int> odd;
+
+    oddContours( aP, odd );
+
+    // The contours of a polygon have consecutive indices, the outline first.  A polygon
+    // contains the point if its outline is the only one of its contours in the list.
+    for( size_t ii = 0; ii < odd.size(); ii++ )
+    {
+        int polygon = m_contourPolygon[odd[ii]];
+
+        if( odd[ii] != m_firstContour[polygon] )
+            continue;
+
+        if( ii + 1 == odd.size() || m_contourPolygon[odd[ii + 1]] != polygon )
+            return polygon;
+    }
+
+    return -1;
+}
+
+
+bool POLY_EDGE_INDEX::Contains( const VECTOR2I& aP, int aAccuracy ) const
+{
+    if( firstContaining( aP ) >= 0 )
+        return true;
+
+    // SHAPE_POLY_SET::containsSingle() also accepts points near an outline (as long as they
+    // are not inside a hole) when the accuracy is more than 1
+    if( aAccuracy <= 1 )
+        return false;
+
+    std::vector<int> odd;
+
+    oddContours( aP, odd );
+
+    int64_t margin = (int64_t) aAccuracy + 3;
+    int     c0 = cellX( aP.x - margin );
+    int     c1 = cellX( aP.x + margin );
+    int     r0 = cellY( aP.y - margin );
+    int     r1 = cellY( aP.y + margin );
+
+    for( int row = r0; row <= r1; row++ )
+    {
+        for( int col = c0; col <= c1; col++ )
+        {
+            int cell = row * m_cols + col;
+
+            for( int ii = m_cellStart[cell]; ii < m_cellStart[cell + 1]; ii++ )
+            {
+                const EDGE& edge = m_edges[m_cellEdges[ii]];
+
+                if( edge.m_contour != m_firstContour[edge.m_polygon] )
+                    continue;
+
+                const SEG s( edge.m_a, edge.m_b );
+
+                if( s.A != aP && s.B != aP && s.Distance( aP ) > aAccuracy + 1 )
+                    continue;
+
+                bool inHole = std::any_of( odd.begin(), odd.end(),
+                                           [&]( int aContour )
+                                           {
+                                               return m_contourPolygon[aContour] == edge.m_polygon
+                                                      && aContour != edge.m_contour;
+                                           } );
+
+                if( !inHole )
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <typename QUERY>
+void POLY_EDGE_INDEX::search( const QUERY& aQuery, const VECTOR2I& aMin, const VECTOR2I& aMax,
+                              CANDIDATE& aBest, int aLimit ) const
+{
+    int c0 = cellX( aMin.x );
+    int c1 = cellX( aMax.x );
+    int r0 = cellY( aMin.y );
+    int r1 = cellY( aMax.y );
+
+    // The block of cells visited by the previous iteration, empty at first
+    int prevC0 = c0, prevC1 = c0 - 1;
+    int prevR0 = r0, prevR1 = r0 - 1;
+
+    while( true )
+    {
+        for( int row = r0; row <= r1; row++ )
+        {
+            for( int col = c0; col <= c1; col++ )
+            {
+                if( row >= prevR0 && row <= prevR1 && col >= prevC0 && col <= prevC1 )
+                    continue;
+
+                int cell = row * m_cols + col;
+
+                for( int ii = m_cellStart[cell]; ii < m_cellStart[cell + 1]; ii++ )
+                {
+                    const EDGE& edge = m_edges[m_cellEdges[ii]];
+                    CANDIDATE   candidate = { SEG( edge.m_a, edge.m_b ).SquaredDistance( aQuery ),
+                                              edge.m_polygon, edge.m_contour, edge.m_index,
+                                              m_cellEdges[ii] };
+
+                    if( candidate < aBest )
+                        aBest = candidate;
+                }
+            }
+        }
+
+        // All the edges not visited yet lie outside of the block, at least this far away from
+        // the query (cells on the sides of the grid extend to infinity)
+        int64_t gap = std::numeric_limits<int64_t>::max();
+
+        if( c0 > 0 )
+            gap = std::min<int64_t>( gap, aMin.x - cellStartX( c0 ) );
+
+        if( c1 < m_cols - 1 )
+            gap = std::min<int64_t>( gap, cellStartX( c1 + 1 ) - aMax.x );
+
+        if( r0 > 0 )
+            gap = std::min<int64_t>( gap, aMin.y - cellStartY( r0 ) );
+
+        if( r1 < m_rows - 1 )
+            gap = std::min<int64_t>( gap, cellStartY( r1 + 1 ) - aMax.y );
+
+        if( gap == std::numeric_limits<int64_t>::max() )
+            return;
+
+        // SEG rounds the nearest points it computes the distances with to integer coordinates
+        gap -= 1;
+
+        if( gap >= 0 )
+        {
+            SEG::ecoord gapSq = gap < 3037000499LL ? gap * gap : VECTOR2I::ECOORD_MAX;
+
+            if( aBest.m_dist <= gapSq || ( aLimit >= 0 && aLimit <= gap ) )
+                return;
+        }
+
+        prevC0 = c0;
+        prevC1 = c1;
+        prevR0 = r0;
+        prevR1 = r1;
+
+        c0 = std::max( 0, c0 - 1 );
+        c1 = std::min( m_cols - 1, c1 + 1 );
+        r0 = std::max( 0, r0 - 1 );
+        r1 = std::min( m_rows - 1, r1 + 1 );
+    }
+}
+
+
+SEG::ecoord POLY_EDGE_INDEX::SquaredDistance( const VECTOR2I& aP, VECTOR2I* aNearest,
+                                              int aLimit ) const
+{
+    CANDIDATE best = { VECTOR2I::ECOORD_MAX, INT_MAX, INT_MAX, INT_MAX, -1 };
+    int       inside = firstContaining( aP );
+
+    if( inside >= 0 )
+        best = { 0, inside, -1, -1, -1 };
+
+    // Nothing can come before being inside the first polygon
+    if( inside != 0 )
+        search( aP, aP, aP, best, aLimit );
+
+    if( aNearest )
+    {
+        if( best.m_edge >= 0 )
+        {
+            const EDGE& edge = m_edges[best.m_edge];
+
+            *aNearest = SEG( edge.m_a, edge.m_b ).NearestPoint( aP );
+        }
+        else if( inside >= 0 )
+            *aNearest = aP;
+    }
+
+    return best.m_dist;
+}
+
+
+SEG::ecoord POLY_EDGE_INDEX::SquaredDistance( const SEG& aSeg, VECTOR2I* aNearest,
+                                              int aLimit ) const
+{
+    CANDIDATE best = { VECTOR2I::ECOORD_MAX, INT_MAX, INT_MAX, INT_MAX, -1 };
+    int       inside = firstContaining( aSeg.A );
+
+    if( inside >= 0 )
+        best = { 0, inside, -1, -1, -1 };
+
+    if( inside != 0 )
+    {
+        VECTOR2I bboxMin( std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ) );
+        VECTOR2I bboxMax( std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) );
+
+        search( aSeg, bboxMin, bboxMax, best, aLimit );
+    }
+
+    if( aNearest )
+    {
+        if( best.m_edge >= 0 )
+        {
+            const EDGE& edge = m_edges[best.m_edge];
+
+            *aNearest = SEG( edge.m_a, edge.m_b ).NearestPoint( aSeg );
+        }
+        else if( inside >= 0 )
+            *aNearest = ( aSeg.A + aSeg.B ) / 2;
+    }
+
+    return best.m_dist;
+}
@@ -0,0 +1,510 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file seg_batch.cpp
+ *
+ * All the kernels compute the same thing, in double precision, for one (scalar), two
+ * (SSE2) or four (AVX2) segments at a time.
+ *
+ * Point/segment distance: the true distance D and the distance De computed by SEG (whose
+ * nearest point is rounded towards zero on both axes) differ by less than sqrt(2).  The
+ * coordinate differences fit in 33 bits and are exact in a double, so the distance
+ * computed here is within 1e-5 of D.  A segment with De < aDist therefore always has a
+ * computed distance below aDist + 2.
+ *
+ * Segment/segment distance: SEG returns 0 for intersecting segments and the smallest of
+ * the four endpoint/segment distances otherwise.  The endpoint distances are bounded as
+ * above.  Intersection is tested with the signs of the cross products of the segments,
+ * each computed with an error below 2^13: a segment is only considered not to intersect
+ * when the cross products show it clearly on one side of the other segment.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <geometry/seg_batch.h>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define SEG_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define SEG_BATCH_AVX2
+#define SEG_BATCH_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#include <immintrin.h>
+#endif
+
+
+static_assert( sizeof( VECTOR2I ) == 2 * sizeof( int32_t ),
+               "the kernels load VECTOR2I arrays as pairs of int32" );
+
+///> Tolerance on the cross products of the intersection test
+static const double CROSS_EPSILON = 65536.0;
+
+///> Extra distance covering the rounding of SEG::NearestPoint() and of the kernels
+static const double DIST_MARGIN = 2.0;
+
+
+static double limitSquared( int aDist )
+{
+    double limit = std::abs( (double) aDist ) + DIST_MARGIN;
+
+    return limit * limit;
+}
+
+
+static inline double pointSegDistSq( double aPx, double aPy, double aAx, double aAy,
+                                     double aBx, double aBy )
+{
+    double dx = aBx - aAx;
+    double dy = aBy - aAy;
+    double qx = aPx - aAx;
+    double qy = aPy - aAy;
+    double l2 = dx * dx + dy * dy;
+    double t = std::min( std::max( dx * qx + dy * qy, 0.0 ), l2 );
+    double u = t / std::max( l2, 1.0 );
+    double ex = qx - u * dx;
+    double ey = qy - u * dy;
+
+    return ex * ex + ey * ey;
+}
+
+
+static inline bool separated( double aO1, double aO2 )
+{
+    return std::min( aO1, aO2 ) > CROSS_EPSILON || std::max( aO1, aO2 ) < -CROSS_EPSILON;
+}
+
+
+static inline bool segSegNear( const SEG& aSeg, double aLimitSq, double aAx, double aAy,
+                               double aBx, double aBy )
+{
+    double sax = aSeg.A.x, say = aSeg.A.y, sbx = aSeg.B.x, sby = aSeg.B.y;
+    double sdx = sbx - sax, sdy = sby - say;
+    double dx = aBx - aAx, dy = aBy - aAy;
+
+    double o1 = sdx * ( aAy - say ) - sdy * ( aAx - sax );
+    double o2 = sdx * ( aBy - say ) - sdy * ( aBx - sax );
+    double o3 = dx * ( say - aAy ) - dy * ( sax - aAx );
+    double o4 = dx * ( sby - aAy ) - dy * ( sbx - aAx );
+
+    if( !separated( o1, o2 ) && !separated( o3, o4 ) )
+        return true;
+
+    double d2 = std::min( std::min( pointSegDistSq( sax, say, aAx, aAy, aBx, aBy ),
+                                    pointSegDistSq( sbx, sby, aAx, aAy, aBx, aBy ) ),
+                          std::min( pointSegDistSq( aAx, aAy, sax, say, sbx, sby ),
+                                    pointSegDistSq( aBx, aBy, sax, say, sbx, sby ) ) );
+
+    return d2 <= aLimitSq;
+}
+
+
+static int findNearPointScalar( const VECTOR2I* aPts, int aSegCount, int aStart,
+                                const VECTOR2I& aP, double aLimitSq )
+{
+    for( int i = aStart; i < aSegCount; i++ )
+    {
+        if( pointSegDistSq( aP.x, aP.y, aPts[i].x, aPts[i].y, aPts[i + 1].x,
+                            aPts[i + 1].y ) <= aLimitSq )
+        {
+            return i;
+        }
+    }
+
+    return aSegCount;
+}
+
+
+static int findNearSegScalar( const VECTOR2I* aPts, int aSegCount, int aStart,
+                              const SEG& aSeg, double aLimitSq )
+{
+    for( int i = aStart; i < aSegCount; i++ )
+    {
+        if( segSegNear( aSeg, aLimitSq, aPts[i].x, aPts[i].y, aPts[i + 1].x, aPts[i + 1].y ) )
+            return i;
+    }
+
+    return aSegCount;
+}
+
+
+static inline int firstLane( int aMask )
+{
+    int lane = 0;
+
+    while( !( aMask & ( 1 << lane ) ) )
+        lane++;
+
+    return lane;
+}
+
+
+#ifdef SEG_BATCH_SSE2
+
+///> Loads two consecutive points as their x and y coordinates
+static inline void loadSse2( const VECTOR2I* aPts, __m128d& aX, __m128d& aY )
+{
+    __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aPts ) );
+
+    v = _mm_shuffle_epi32( v, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+    aX = _mm_cvtepi32_pd( v );
+    aY = _mm_cvtepi32_pd( _mm_srli_si128( v, 8 ) );
+}
+
+
+static inline __m128d pointSegDistSqSse2( __m128d aPx, __m128d aPy, __m128d aAx, __m128d aAy,
+                                          __m128d aBx, __m128d aBy )
+{
+    __m128d dx = _mm_sub_pd( aBx, aAx );
+    __m128d dy = _mm_sub_pd( aBy, aAy );
+    __m128d qx = _mm_sub_pd( aPx, aAx );
+    __m128d qy = _mm_sub_pd( aPy, aAy );
+    __m128d l2 = _mm_add_pd( _mm_mul_pd( dx, dx ), _mm_mul_pd( dy, dy ) );
+    __m128d t = _mm_add_pd( _mm_mul_pd( dx, qx ), _mm_mul_pd( dy, qy ) );
+
+    t = _mm_min_pd( _mm_max_pd( t, _mm_setzero_pd() ), l2 );
+
+    __m128d u = _mm_div_pd( t, _mm_max_pd( l2, _mm_set1_pd( 1.0 ) ) );
+    __m128d ex = _mm_sub_pd( qx, _mm_mul_pd( u, dx ) );
+    __m128d ey = _mm_sub_pd( qy, _mm_mul_pd( u, dy ) );
+
+    return _mm_add_pd( _mm_mul_pd( ex, ex ), _mm_mul_pd( ey, ey ) );
+}
+
+
+static inline __m128d separatedSse2( __m128d aO1, __m128d aO2 )
+{
+    return _mm_or_pd( _mm_cmpgt_pd( _mm_min_pd( aO1, aO2 ), _mm_set1_pd( CROSS_EPSILON ) ),
+                      _mm_cmplt_pd( _mm_max_pd( aO1, aO2 ), _mm_set1_pd( -CROSS_EPSILON ) ) );
+}
+
+
+static int findNearPointSse2( const VECTOR2I* aPts, int aSegCount, int aStart,
+                              const VECTOR2I& aP, double aLimitSq )
+{
+    const __m128d px = _mm_set1_pd( aP.x );
+    const __m128d py = _mm_set1_pd( aP.y );
+    const __m128d limit = _mm_set1_pd( aLimitSq );
+    int           i = aStart;
+
+    for( ; i + 2 <= aSegCount; i += 2 )
+    {
+        __m128d ax, ay, bx, by;
+
+        loadSse2( aPts + i, ax, ay );
+        loadSse2( aPts + i + 1, bx, by );
+
+        __m128d d2 = pointSegDistSqSse2( px, py, ax, ay, bx, by );
+        int     mask = _mm_movemask_pd( _mm_cmple_pd( d2, limit ) );
+
+        if( mask )
+            return i + firstLane( mask );
+    }
+
+    return findNearPointScalar( aPts, aSegCount, i, aP, aLimitSq );
+}
+
+
+static int findNearSegSse2( const VECTOR2I* aPts, int aSegCount, int aStart, const SEG& aSeg,
+                            double aLimitSq )
+{
+    const __m128d sax = _mm_set1_pd( aSeg.A.x );
+    const __m128d say = _mm_set1_pd( aSeg.A.y );
+    const __m128d sbx = _mm_set1_pd( aSeg.B.x );
+    const __m128d sby = _mm_set1_pd( aSeg.B.y );
+    const __m128d sdx = _mm_sub_pd( sbx, sax );
+    const __m128d sdy = _mm_sub_pd( sby, say );
+    const __m128d limit = _mm_set1_pd( aLimitSq );
+    int           i = aStart;
+
+    for( ; i + 2 <= aSegCount; i += 2 )
+    {
+        __m128d ax, ay, bx, by;
+
+        loadSse2( aPts + i, ax, ay );
+        loadSse2( aPts + i + 1, bx, by );
+
+        __m128d dx = _mm_sub_pd( bx, ax );
+        __m128d dy = _mm_sub_pd( by, ay );
+
+        __m128d o1 = _mm_sub_pd( _mm_mul_pd( sdx, _mm_sub_pd( ay, say ) ),
+                                 _mm_mul_pd( sdy, _mm_sub_pd( ax, sax ) ) );
+        __m128d o2 = _mm_sub_pd( _mm_mul_pd( sdx, _mm_sub_pd( by, say ) ),
+                                 _mm_mul_pd( sdy, _mm_sub_pd( bx, sax ) ) );
+        __m128d o3 = _mm_sub_pd( _mm_mul_pd( dx, _mm_sub_pd( say, ay ) ),
+                                 _mm_mul_pd( dy, _mm_sub_pd( sax, ax ) ) );
+        __m128d o4 = _mm_sub_pd( _mm_mul_pd( dx, _mm_sub_pd( sby, ay ) ),
+                                 _mm_mul_pd( dy, _mm_sub_pd( sbx, ax ) ) );
+
+        __m128d sep = _mm_or_pd( separatedSse2( o1, o2 ), separatedSse2( o3, o4 ) );
+
+        __m128d d2 = _mm_min_pd( _mm_min_pd( pointSegDistSqSse2( sax, say, ax, ay, bx, by ),
+                                             pointSegDistSqSse2( sbx, sby, ax, ay, bx, by ) ),
+                                 _mm_min_pd( pointSegDistSqSse2( ax, ay, sax, say, sbx, sby ),
+                                             pointSegDistSqSse2( bx, by, sax, say, sbx, sby ) ) );
+
+        // Lanes that are near, or not clearly separated (sep is all zeros for them)
+        int nearMask = _mm_movemask_pd( _mm_cmple_pd( d2, limit ) );
+        int mask = nearMask | ( ~_mm_movemask_pd( sep ) & 0x3 );
+
+        if( mask )
+            return i + firstLane( mask );
+    }
+
+    return findNearSegScalar( aPts, aSegCount, i, aSeg, aLimitSq );
+}
+
+#endif // SEG_BATCH_SSE2
+
+
+#ifdef SEG_BATCH_AVX2
+
+///> Loads four consecutive points as their x and y coordinates
+SEG_BATCH_TARGET_AVX2
+static inline void loadAvx2( const VECTOR2I* aPts, __m256d& aX, __m256d& aY )
+{
+    const __m256i deinterleave = _mm256_setr_epi32( 0, 2, 4, 6, 1, 3, 5, 7 );
+
+    __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( aPts ) );
+
+    v = _mm256_permutevar8x32_epi32( v, deinterleave );
+    aX = _mm256_cvtepi32_pd( _mm256_castsi256_si128( v ) );
+    aY = _mm256_cvtepi32_pd( _mm256_extracti128_si256( v, 1 ) );
+}
+
+
+SEG_BATCH_TARGET_AVX2
+static inline __m256d pointSegDistSqAvx2( __m256d aPx, __m256d aPy, __m256d aAx, __m256d aAy,
+                                          __m256d aBx, __m256d aBy )
+{
+    __m256d dx = _mm256_sub_pd( aBx, aAx );
+    __m256d dy = _mm256_sub_pd( aBy, aAy );
+    __m256d qx = _mm256_sub_pd( aPx, aAx );
+    __m256d qy = _mm256_sub_pd( aPy, aAy );
+    __m256d l2 = _mm256_add_pd( _mm256_mul_pd( dx, dx ), _mm256_mul_pd( dy, dy ) );
+    __m256d t = _mm256_add_pd( _mm256_mul_pd( dx, qx ), _mm256_mul_pd( dy, qy ) );
+
+    t = _mm256_min_pd( _mm256_max_pd( t, _mm256_setzero_pd() ), l2 );
+
+    __m256d u = _mm256_div_pd( t, _mm256_max_pd( l2, _mm256_set1_pd( 1.0 ) ) );
+    __m256d ex = _mm256_sub_pd( qx, _mm256_mul_pd( u, dx ) );
+    __m256d ey = _mm256_sub_pd( qy, _mm256_mul_pd( u, dy ) );
+
+    return _mm256_add_pd( _mm256_mul_pd( ex, ex ), _mm256_mul_pd( ey, ey ) );
+}
+
+
+SEG_BATCH_TARGET_AVX2
+static inline __m256d separatedAvx2( __m256d aO1, __m256d aO2 )
+{
+    return _mm256_or_pd( _mm256_cmp_pd( _mm256_min_pd( aO1, aO2 ),
+                                        _mm256_set1_pd( CROSS_EPSILON ), _CMP_GT_OQ ),
+                         _mm256_cmp_pd( _mm256_max_pd( aO1, aO2 ),
+                                        _mm256_set1_pd( -CROSS_EPSILON ), _CMP_LT_OQ ) );
+}
+
+
+SEG_BATCH_TARGET_AVX2
+static int findNearPointAvx2( const VECTOR2I* aPts, int aSegCount, int aStart,
+                              const VECTOR2I& aP, double aLimitSq )
+{
+    const __m256d px = _mm256_set1_pd( aP.x );
+    const __m256d py = _mm256_set1_pd( aP.y );
+    const __m256d limit = _mm256_set1_pd( aLimitSq );
+    int           i = aStart;
+
+    for( ; i + 4 <= aSegCount; i += 4 )
+    {
+        __m256d ax, ay, bx, by;
+
+        loadAvx2( aPts + i, ax, ay );
+        loadAvx2( aPts + i + 1, bx, by );
+
+        __m256d d2 = pointSegDistSqAvx2( px, py, ax, ay, bx, by );
+        int     mask = _mm256_movemask_pd( _mm256_cmp_pd( d2, limit, _CMP_LE_OQ ) );
+
+        if( mask )
+            return i + firstLane( mask );
+    }
+
+    return findNearPointScalar( aPts, aSegCount, i, aP, aLimitSq );
+}
+
+
+SEG_BATCH_TARGET_AVX2
+static int findNearSegAvx2( const VECTOR2I* aPts, int aSegCount, int aStart, const SEG& aSeg,
+                            double aLimitSq )
+{
+    const __m256d sax = _mm256_set1_pd( aSeg.A.x );
+    const __m256d say = _mm256_set1_pd( aSeg.A.y );
+    const __m256d sbx = _mm256_set1_pd( aSeg.B.x );
+    const __m256d sby = _mm256_set1_pd( aSeg.B.y );
+    const __m256d sdx = _mm256_sub_pd( sbx, sax );
+    const __m256d sdy = _mm256_sub_pd( sby, say );
+    const __m256d limit = _mm256_set1_pd( aLimitSq );
+    int           i = aStart;
+
+    for( ; i + 4 <= aSegCount; i += 4 )
+    {
+        __m256d ax, ay, bx, by;
+
+        loadAvx2( aPts + i, ax, ay );
+        loadAvx2( aPts + i + 1, bx, by );
+
+        __m256d dx = _mm256_sub_pd( bx, ax );
+        __m256d dy = _mm256_sub_pd( by, ay );
+
+        __m256d o1 = _mm256_sub_pd( _mm256_mul_pd( sdx, _mm256_sub_pd( ay, say ) ),
+                                    _mm256_mul_pd( sdy, _mm256_sub_pd( ax, sax ) ) );
+        __m256d o2 = _mm256_sub_pd( _mm256_mul_pd( sdx, _mm256_sub_pd( by, say ) ),
+                                    _mm256_mul_pd( sdy, _mm256_sub_pd( bx, sax ) ) );
+        __m256d o3 = _mm256_sub_pd( _mm256_mul_pd( dx, _mm256_sub_pd( say, ay ) ),
+                                    _mm256_mul_pd( dy, _mm256_sub_pd( sax, ax ) ) );
+        __m256d o4 = _mm256_sub_pd( _mm256_mul_pd( dx, _mm256_sub_pd( sby, ay ) ),
+                                    _mm256_mul_pd( dy, _mm256_sub_pd( sbx, ax ) ) );
+
+        __m256d sep = _mm256_or_pd( separatedAvx2( o1, o2 ), separatedAvx2( o3, o4 ) );
+
+        __m256d d2 = _mm256_min_pd(
+                _mm256_min_pd( pointSegDistSqAvx2( sax, say, ax, ay, bx, by ),
+                               pointSegDistSqAvx2( sbx, sby, ax, ay, bx, by ) ),
+                _mm256_min_pd( pointSegDistSqAvx2( ax, ay, sax, say, sbx, sby ),
+                               pointSegDistSqAvx2( bx, by, sax, say, sbx, sby ) ) );
+
+        // Lanes that are near, or not clearly separated (sep is all zeros for them)
+        int nearMask = _mm256_movemask_pd( _mm256_cmp_pd( d2, limit, _CMP_LE_OQ ) );
+        int mask = nearMask | ( ~_mm256_movemask_pd( sep ) & 0xf );
+
+        if( mask )
+            return i + firstLane( mask );
+    }
+
+    return findNearSegScalar( aPts, aSegCount, i, aSeg, aLimitSq );
+}
+
+#endif // SEG_BATCH_AVX2
+
+
+bool SegBatchIsaSupported( SEG_BATCH_ISA aIsa )
+{
+    switch( aIsa )
+    {
+    case SEG_BATCH_ISA::SCALAR:
+        return true;
+
+    case SEG_BATCH_ISA::SSE2:
+#ifdef SEG_BATCH_SSE2
+        return true;
+#else
+        return false;
+#endif
+
+    case SEG_BATCH_ISA::AVX2:
+#ifdef SEG_BATCH_AVX2
+        __builtin_cpu_init();
+        return __builtin_cpu_supports( "avx2" );
+#else
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+
+SEG_BATCH_ISA SegBatchBestIsa()
+{
+    static const SEG_BATCH_ISA best = SegBatchIsaSupported( SEG_BATCH_ISA::AVX2 )
+                                              ? SEG_BATCH_ISA::AVX2
+                                              : SegBatchIsaSupported( SEG_BATCH_ISA::SSE2 )
+                                                        ? SEG_BATCH_ISA::SSE2
+                                                        : SEG_BATCH_ISA::SCALAR;
+
+    return best;
+}
+
+
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const VECTOR2I& aP,
+                     int aDist, SEG_BATCH_ISA aIsa )
+{
+    int    segCount = std::max( aPointCount - 1, 0 );
+    double limitSq = limitSquared( aDist );
+
+    switch( aIsa )
+    {
+#ifdef SEG_BATCH_AVX2
+    case SEG_BATCH_ISA::AVX2:
+        return findNearPointAvx2( aPts, segCount, aStart, aP, limitSq );
+#endif
+
+#ifdef SEG_BATCH_SSE2
+    case SEG_BATCH_ISA::SSE2:
+        return findNearPointSse2( aPts, segCount, aStart, aP, limitSq );
+#endif
+
+    default:
+        return findNearPointScalar( aPts, segCount, aStart, aP, limitSq );
+    }
+}
+
+
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const VECTOR2I& aP,
+                     int aDist )
+{
+    return FindSegmentNear( aPts, aPointCount, aStart, aP, aDist, SegBatchBestIsa() );
+}
+
+
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const SEG& aSeg,
+                     int aDist, SEG_BATCH_ISA aIsa )
+{
+    int    segCount = std::max( aPointCount - 1, 0 );
+    double limitSq = limitSquared( aDist );
+
+    switch( aIsa )
+    {
+#ifdef SEG_BATCH_AVX2
+    case SEG_BATCH_ISA::AVX2:
+        return findNearSegAvx2( aPts, segCount, aStart, aSeg, limitSq );
+#endif
+
+#ifdef SEG_BATCH_SSE2
+    case SEG_BATCH_ISA::SSE2:
+        return findNearSegSse2( aPts, segCount, aStart, aSeg, limitSq );
+#endif
+
+    default:
+        return findNearSegScalar( aPts, segCount, aStart, aSeg, limitSq );
+    }
+}
+
+
+int FindSegmentNear( const VECTOR2I* aPts, int aPointCount, int aStart, const SEG& aSeg,
+                     int aDist )
+{
+    return FindSegmentNear( aPts, aPointCount, aStart, aSeg, aDist, SegBatchBestIsa() );
+}
@@ -172,70 +172,269 @@ SHAPE_ARC::SHAPE_ARC( const SHAPE_ARC& aOther )
 
 bool SHAPE_ARC::Collide( const SEG& aSeg, int aClearance, int* aActual, VECTOR2I* aLocation ) const
 {
-    int minDist = aClearance + m_width / 2;
-    VECTOR2I center = GetCenter();
-    ecoord dist_sq;
-    ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    int      minDist = aClearance + m_width / 2;
     VECTOR2I nearest;
+    ecoord   dist_sq = SquaredDistance( aSeg, &nearest );
+
+    if( dist_sq == 0 || dist_sq < SEG::Square( minDist ) )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = std::max( 0, (int) sqrt( dist_sq ) - m_width / 2 );
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool SHAPE_ARC::SliceContainsPoint( const VECTOR2I& aP ) const
+{
+    return sliceContains( GetCenter(), aP );
+}
+
+
+bool SHAPE_ARC::sliceContains( const VECTOR2I& aCenter, const VECTOR2I& aP ) const
+{
+    // A closed arc is a full circle
+    if( m_start == m_end )
+        return true;
 
-    VECTOR2I ab = ( aSeg.B - aSeg.A );
-    VECTOR2I ac = ( center - aSeg.A );
+    VECTOR2I s = m_start - aCenter;
+    VECTOR2I e = m_end - aCenter;
+    VECTOR2I v = aP - aCenter;
 
-    ecoord lenAbSq = ab.SquaredEuclideanNorm();
-    double lambda = (double) ac.Dot( ab ) / (double) lenAbSq;
+    // Walk the arc from s to e in the positive direction of the cross product
+    if( ( m_mid - m_start ).Cross( m_end - m_mid ) < 0 )
+        std::swap( s, e );
 
-    if( lambda >= 0.0 && lambda <= 1.0 )
+    // Up to a half turn the sector is the intersection of two half planes, beyond it is
+    // their union
+    if( s.Cross( e ) >= 0 )
+        return s.Cross( v ) >= 0 && v.Cross( e ) >= 0;
+    else
+        return s.Cross( v ) >= 0 || v.Cross( e ) >= 0;
+}
+
+
+VECTOR2I SHAPE_ARC::radialPoint( const VECTOR2I& aCenter, double aRadius,
+                                 const VECTOR2I& aP ) const
+{
+    VECTOR2D v( aP - aCenter );
+    double   scale = aRadius / v.EuclideanNorm();
+
+    return aCenter + VECTOR2I( KiROUND( v.x * scale ), KiROUND( v.y * scale ) );
+}
+
+
+SHAPE_ARC::ecoord SHAPE_ARC::squaredDistance( const VECTOR2I& aCenter, double aRadius,
+                                              const VECTOR2I& aP, VECTOR2I* aNearest ) const
+{
+    VECTOR2I nearest;
+    ecoord   dist_sq;
+
+    if( aP == aCenter )
+    {
+        // Every point of the arc is at the same distance
+        nearest = m_start;
+        dist_sq = ( m_start - aP ).SquaredEuclideanNorm();
+    }
+    else if( sliceContains( aCenter, aP ) )
     {
-        VECTOR2I p;
+        nearest = radialPoint( aCenter, aRadius, aP );
+        dist_sq = ( nearest - aP ).SquaredEuclideanNorm();
+    }
+    else
+    {
+        ecoord start_sq = ( m_start - aP ).SquaredEuclideanNorm();
+        ecoord end_sq = ( m_end - aP ).SquaredEuclideanNorm();
 
-        p.x = (double) aSeg.A.x * lambda + (double) aSeg.B.x * (1.0 - lambda);
-        p.y = (double) aSeg.A.y * lambda + (double) aSeg.B.y * (1.0 - lambda);
+        nearest = start_sq <= end_sq ? m_start : m_end;
+        dist_sq = std::min( start_sq, end_sq );
+    }
 
-        dist_sq = ( m_start - p ).SquaredEuclideanNorm();
+    if( aNearest )
+        *aNearest = nearest;
 
-        if( dist_sq < closest_dist_sq )
-        {
-            closest_dist_sq = dist_sq;
-            nearest = p;
-        }
+    return dist_sq;
+}
 
-        dist_sq = ( m_end - p ).SquaredEuclideanNorm();
 
-        if( dist_sq < closest_dist_sq )
+SHAPE_ARC::ecoord SHAPE_ARC::SquaredDistance( const VECTOR2I& aP, VECTOR2I* aNearest ) const
+{
+    VECTOR2I center = GetCenter();
+
+    return squaredDistance( center, VECTOR2D( m_start - center ).EuclideanNorm(), aP, aNearest );
+}
+
+
+SHAPE_ARC::ecoord SHAPE_ARC::SquaredDistance( const SEG& aSeg, VECTOR2I* aNearest ) const
+{
+    VECTOR2I center = GetCenter();
+    double   r = VECTOR2D( m_start - center ).EuclideanNorm();
+    VECTOR2D f( aSeg.A - center );
+    VECTOR2D d( aSeg.B - aSeg.A );
+    double   a = d.Dot( d );
+
+    // Crossings of the segment and the circle of the arc, if they lie on the arc
+    if( a > 0.0 )
+    {
+        double b = f.Dot( d );
+        double disc = b * b - a * ( f.Dot( f ) - r * r );
+
+        if( disc >= 0.0 )
         {
-            closest_dist_sq = dist_sq;
-            nearest = p;
+            for( double t : { ( -b - sqrt( disc ) ) / a, ( -b + sqrt( disc ) ) / a } )
+            {
+                if( t < 0.0 || t > 1.0 )
+                    continue;
+
+                VECTOR2I p( KiROUND( aSeg.A.x + t * d.x ), KiROUND( aSeg.A.y + t * d.y ) );
+
+                if( sliceContains( center, p ) )
+                {
+                    if( aNearest )
+                        *aNearest = p;
+
+                    return 0;
+                }
+            }
         }
     }
 
-    dist_sq = aSeg.SquaredDistance( m_start );
+    // Otherwise the nearest points are an end of one of the shapes, or the point of the arc
+    // on the perpendicular from its center to the segment
+    VECTOR2I nearest;
+    VECTOR2I pn;
+    ecoord   dist_sq = squaredDistance( center, r, aSeg.A, &nearest );
+    ecoord   d_sq = squaredDistance( center, r, aSeg.B, &pn );
 
-    if( dist_sq < closest_dist_sq )
-    {
-        closest_dist_sq = dist_sq;
-        nearest = m_start;
-    }
+    auto update =
+            [&]()
+            {
+                if( d_sq < dist_sq )
+                {
+                    dist_sq = d_sq;
+                    nearest = pn;
+                }
+            };
+
+    update();
+
+    pn = m_start;
+    d_sq = aSeg.SquaredDistance( pn );
+    update();
 
-    dist_sq = aSeg.SquaredDistance( m_end );
+    pn = m_end;
+    d_sq = aSeg.SquaredDistance( pn );
+    update();
 
-    if( dist_sq < closest_dist_sq )
+    VECTOR2I foot = aSeg.NearestPoint( center );
+
+    if( foot != center && sliceContains( center, foot ) )
     {
-        closest_dist_sq = dist_sq;
-        nearest = m_end;
+        pn = radialPoint( center, r, foot );
+        d_sq = aSeg.SquaredDistance( pn );
+        update();
     }
 
-    if( closest_dist_sq == 0 || closest_dist_sq < SEG::Square( minDist ) )
+    if( aNearest )
+        *aNearest = nearest;
+
+    return dist_sq;
+}
+
+
+SHAPE_ARC::ecoord SHAPE_ARC::SquaredDistance( const SHAPE_ARC& aArc, VECTOR2I* aNearest ) const
+{
+    VECTOR2I c1 = GetCenter();
+    VECTOR2I c2 = aArc.GetCenter();
+    double   r1 = VECTOR2D( m_start - c1 ).EuclideanNorm();
+    double   r2 = VECTOR2D( aArc.m_start - c2 ).EuclideanNorm();
+    VECTOR2D u( c2 - c1 );
+    double   d = u.EuclideanNorm();
+
+    if( d > 0.0 )
+        u = u / d;
+
+    // Crossings of the two circles, if they lie on both arcs
+    if( d > 0.0 && d <= r1 + r2 && d >= std::abs( r1 - r2 ) )
     {
-        if( aLocation )
-            *aLocation = nearest;
+        double   a = ( r1 * r1 - r2 * r2 + d * d ) / ( 2.0 * d );
+        double   h = sqrt( std::max( 0.0, r1 * r1 - a * a ) );
+        VECTOR2D base = VECTOR2D( c1 ) + u * a;
 
-        if( aActual )
-            *aActual = std::max( 0, (int) sqrt( closest_dist_sq ) - m_width / 2 );
+        for( double side : { -1.0, 1.0 } )
+        {
+            VECTOR2I p( KiROUND( base.x - side * h * u.y ), KiROUND( base.y + side * h * u.x ) );
 
-        return true;
+            if( sliceContains( c1, p ) && aArc.sliceContains( c2, p ) )
+            {
+                if( aNearest )
+                    *aNearest = p;
+
+                return 0;
+            }
+        }
     }
 
-    return false;
+    // Otherwise the nearest points are an end of one of the arcs, or points of both arcs on
+    // the line joining their centers
+    VECTOR2I nearest;
+    VECTOR2I pn;
+    ecoord   dist_sq = squaredDistance( c1, r1, aArc.m_start, &nearest );
+    ecoord   d_sq = squaredDistance( c1, r1, aArc.m_end, &pn );
+
+    auto update =
+            [&]()
+            {
+                if( d_sq < dist_sq )
+                {
+                    dist_sq = d_sq;
+                    nearest = pn;
+                }
+            };
+
+    update();
+
+    pn = m_start;
+    d_sq = aArc.squaredDistance( c2, r2, pn, nullptr );
+    update();
+
+    pn = m_end;
+    d_sq = aArc.squaredDistance( c2, r2, pn, nullptr );
+    update();
+
+    if( d > 0.0 )
+    {
+        for( double s1 : { -r1, r1 } )
+        {
+            VECTOR2I p1( KiROUND( c1.x + u.x * s1 ), KiROUND( c1.y + u.y * s1 ) );
+
+            if( !sliceContains( c1, p1 ) )
+                continue;
+
+            for( double s2 : { -r2, r2 } )
+            {
+                VECTOR2I p2( KiROUND( c2.x + u.x * s2 ), KiROUND( c2.y + u.y * s2 ) );
+
+                if( aArc.sliceContains( c2, p2 ) )
+                {
+                    pn = p1;
+                    d_sq = ( p2 - p1 ).SquaredEuclideanNorm();
+                    update();
+                }
+            }
+        }
+    }
+
+    if( aNearest )
+        *aNearest = nearest;
+
+    return dist_sq;
 }
 
 
@@ -285,8 +484,9 @@ const BOX2I SHAPE_ARC::BBox( int aClearance ) const
 {
     BOX2I bbox( m_bbox );
 
-    if( aClearance != 0 )
-        bbox.Inflate( aClearance );
+    // Like the segments, the arc box includes its width
+    if( aClearance + ( m_width + 1 ) / 2 != 0 )
+        bbox.Inflate( aClearance + ( m_width + 1 ) / 2 );
 
     return bbox;
 }
@@ -296,24 +496,21 @@ bool SHAPE_ARC::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
                          VECTOR2I* aLocation ) const
 {
     int minDist = aClearance + m_width / 2;
-    auto bbox = BBox( minDist );
+    auto bbox = BBox( aClearance );
 
     if( !bbox.Contains( aP ) )
         return false;
 
-    ecoord min_dist_sq = SEG::Square( minDist );
-    ecoord r_sq = SEG::Square( GetRadius() );
-
-    ecoord dist_sq = ( aP - GetCenter() ).SquaredEuclideanNorm();
-    ecoord dist_to_edge_sq = abs( dist_sq - r_sq );
+    VECTOR2I nearest;
+    ecoord   dist_sq = SquaredDistance( aP, &nearest );
 
-    if( dist_to_edge_sq == 0 || dist_to_edge_sq < min_dist_sq )
+    if( dist_sq == 0 || dist_sq < SEG::Square( minDist ) )
     {
         if( aLocation )
-            *aLocation = ( aP + GetCenter() ) / 2;
+            *aLocation = nearest;
 
         if( aActual )
-            *aActual = std::max( 0, (int) sqrt( dist_to_edge_sq ) - m_width / 2 );
+            *aActual = std::max( 0, (int) sqrt( dist_sq ) - m_width / 2 );
 
         return true;
     }
@@ -184,7 +184,10 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_LINE_CHAIN_BASE&
     }
     else
     {
-        for( int s = 0; s < aB.GetSegmentCount(); s++ )
+        int dist = aClearance + aA.GetRadius();
+
+        for( int s = aB.NextSegmentNear( 0, aA.GetCenter(), dist ); s < aB.GetSegmentCount();
+                s = aB.NextSegmentNear( s + 1, aA.GetCenter(), dist ) )
         {
             int collision_dist = 0;
             VECTOR2I pn;
@@ -327,7 +330,13 @@ static inline bool Collide( const SHAPE_RECT& aA, const SHAPE_LINE_CHAIN_BASE& a
     }
     else
     {
-        for( int s = 0; s < aB.GetSegmentCount(); s++ )
+        // Segments farther from the centre than the clearance plus half the diagonal can't
+        // collide with the rectangle (a few units are added to cover the rounding of the
+        // centre, of the diagonal and of the distances computed by SEG)
+        int dist = aClearance + aA.GetSize().EuclideanNorm() / 2 + 5;
+
+        for( int s = aB.NextSegmentNear( 0, aA.Centre(), dist ); s < aB.GetSegmentCount();
+                s = aB.NextSegmentNear( s + 1, aA.Centre(), dist ) )
         {
             int collision_dist = 0;
             VECTOR2I pn;
@@ -424,53 +433,193 @@ static inline bool Collide( const SHAPE_RECT& aA, const SHAPE_RECT& aB, int aCle
     return Collide( aA.Outline(), aB.Outline(), aClearance, aActual, aLocation, aMTV );
 }
 
+// The arc collisions work directly on SHAPE_ARC rather than on a polyline approximation of
+// the arc, and include the width of the arc like the segment collisions do.
+
+/**
+ * Translation moving aB out of the arc aA, as for the circle/circle case, given the nearest
+ * points of both shapes.  When the shapes touch or cross, the nearest points don't give a
+ * direction and aB is pushed away from the center of the arc instead, which is only an
+ * estimate of the shortest way out.
+ */
+static VECTOR2I arcPushout( const SHAPE_ARC& aA, const VECTOR2I& aNearestA,
+                            const VECTOR2I& aNearestB, int aMinDist )
+{
+    VECTOR2I delta = aNearestB - aNearestA;
+    int      dist = delta.EuclideanNorm();
+
+    if( dist == 0 )
+        delta = aNearestA - aA.GetCenter();
+
+    return delta.Resize( aMinDist - dist + 1 );
+}
+
+
+static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_LINE_CHAIN_BASE& aB, int aClearance,
+                            int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
+{
+    int closest_dist = INT_MAX;
+    VECTOR2I nearest;
+    VECTOR2I nearestB;
+
+    if( aB.IsClosed() && aB.PointInside( aA.GetP0() ) )
+    {
+        nearest = aA.GetP0();
+        nearestB = nearest;
+        closest_dist = 0;
+    }
+    else
+    {
+        // Segments farther from the centre of the arc bounding box (which includes the arc
+        // width) than the clearance plus half its diagonal can't collide with the arc (a few
+        // units are added to cover the rounding of the arc points and of the distances)
+        const BOX2I bbox = aA.BBox();
+        int dist = aClearance + bbox.GetSize().EuclideanNorm() / 2 + 5;
+
+        for( int s = aB.NextSegmentNear( 0, bbox.Centre(), dist ); s < aB.GetSegmentCount();
+                s = aB.NextSegmentNear( s + 1, bbox.Centre(), dist ) )
+        {
+            int collision_dist = 0;
+            VECTOR2I pn;
+
+            if( aA.Collide( aB.GetSegment( s ), aClearance,
+                            aActual || aLocation || aMTV ? &collision_dist : nullptr,
+                            aLocation || aMTV ? &pn : nullptr ) )
+            {
+                if( collision_dist < closest_dist )
+                {
+                    nearest = pn;
+                    nearestB = aB.GetSegment( s ).NearestPoint( pn );
+                    closest_dist = collision_dist;
+                }
+
+                if( closest_dist == 0 )
+                    break;
+
+                // If we're not looking for aActual or aMTV then any collision will do
+                if( !aActual && !aMTV )
+                    break;
+            }
+        }
+    }
+
+    if( closest_dist == 0 || closest_dist < aClearance )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = closest_dist;
+
+        if( aMTV )
+            *aMTV = arcPushout( aA, nearest, nearestB, aClearance + aA.GetWidth() / 2 );
+
+        return true;
+    }
+
+    return false;
+}
+
 static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_RECT& aB, int aClearance,
                             int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
-    const auto lc = aA.ConvertToPolyline();
-    return Collide( lc, aB.Outline(), aClearance, aActual, aLocation, aMTV );
+    return Collide( aA, aB.Outline(), aClearance, aActual, aLocation, aMTV );
 }
 
 static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_CIRCLE& aB, int aClearance,
                             int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
-    const auto lc = aA.ConvertToPolyline();
-    bool rv = Collide( aB, lc, aClearance, aActual, aLocation, aMTV );
+    if( aMTV )
+    {
+        // The push-out force is only computed against line chains
+        const SHAPE_LINE_CHAIN lc = aA.ConvertToPolyline();
+        bool rv = Collide( aB, lc, aClearance + aA.GetWidth() / 2, aActual, aLocation, aMTV );
 
-    if( rv && aMTV )
-        *aMTV = - *aMTV ;
+        if( rv && aActual )
+            *aActual = std::max( 0, *aActual - aA.GetWidth() / 2 );
 
-    return rv;
+        if( rv )
+            *aMTV = - *aMTV;
+
+        return rv;
+    }
+
+    if( aA.Collide( aB.GetCenter(), aClearance + aB.GetRadius(), aActual, aLocation ) )
+    {
+        if( aActual )
+            *aActual = std::max( 0, *aActual - aB.GetRadius() );
+
+        return true;
+    }
+
+    return false;
 }
 
 static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
-    const auto lc = aA.ConvertToPolyline();
-    return Collide( lc, aB, aClearance, aActual, aLocation, aMTV );
+    return Collide( aA, static_cast<const SHAPE_LINE_CHAIN_BASE&>( aB ), aClearance, aActual,
+                    aLocation, aMTV );
 }
 
 static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_SEGMENT& aB, int aClearance,
                             int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
-    const auto lc = aA.ConvertToPolyline();
-    return Collide( lc, aB, aClearance, aActual, aLocation, aMTV );
-}
+    int      minDist = aClearance + aB.GetWidth() / 2;
+    VECTOR2I nearest;
 
-static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_LINE_CHAIN_BASE& aB, int aClearance,
-                            int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
-{
-    const auto lc = aA.ConvertToPolyline();
+    if( aA.Collide( aB.GetSeg(), minDist, aActual, aMTV ? &nearest : aLocation ) )
+    {
+        if( aActual )
+            *aActual = std::max( 0, *aActual - aB.GetWidth() / 2 );
+
+        if( aMTV )
+        {
+            if( aLocation )
+                *aLocation = nearest;
 
-    return Collide( lc, aB, aClearance, aActual, aLocation, aMTV );
+            *aMTV = arcPushout( aA, nearest, aB.GetSeg().NearestPoint( nearest ),
+                                minDist + aA.GetWidth() / 2 );
+        }
+
+        return true;
+    }
+
+    return false;
 }
 
 static inline bool Collide( const SHAPE_ARC& aA, const SHAPE_ARC& aB, int aClearance,
                             int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
-    const auto lcA = aA.ConvertToPolyline();
-    const auto lcB = aB.ConvertToPolyline();
-    return Collide( lcA, lcB, aClearance, aActual, aLocation, aMTV );
+    int      halfWidths = aA.GetWidth() / 2 + aB.GetWidth() / 2;
+    int      minDist = aClearance + halfWidths;
+    VECTOR2I nearest;
+
+    if( !aA.BBox( aClearance + 1 ).Intersects( aB.BBox() ) )
+        return false;
+
+    SEG::ecoord dist_sq = aA.SquaredDistance( aB, &nearest );
+
+    if( dist_sq == 0 || dist_sq < SEG::Square( minDist ) )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = std::max( 0, (int) sqrt( dist_sq ) - halfWidths );
+
+        if( aMTV )
+        {
+            VECTOR2I nearestB;
+
+            aB.SquaredDistance( nearest, &nearestB );
+            *aMTV = arcPushout( aA, nearest, nearestB, minDist );
+        }
+
+        return true;
+    }
+
+    return false;
 }
 
 template<class T_a, class T_b>
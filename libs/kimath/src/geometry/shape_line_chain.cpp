@@ -29,6 +29,7 @@
 
 #include <clipper.hpp>
 #include <geometry/seg.h>    // for SEG, OPT_VECTOR2I
+#include <geometry/seg_batch.h>
 #include <geometry/shape_line_chain.h>
 #include <math/box2.h>       // for BOX2I
 #include <math/util.h>  // for rescale
@@ -82,6 +83,10 @@ void SHAPE_LINE_CHAIN::convertArc( ssize_t aArcIndex )
     }
 
     m_arcs.erase( m_arcs.begin() + aArcIndex );
+
+    // Chains without arcs don't store the shape indices
+    if( m_arcs.empty() )
+        m_shapes.clear();
 }
 
 
@@ -103,7 +108,10 @@ bool SHAPE_LINE_CHAIN_BASE::Collide( const VECTOR2I& aP, int aClearance, int* aA
     SEG::ecoord clearance_sq = SEG::Square( aClearance );
     VECTOR2I nearest;
 
-    for( int i = 0; i < GetSegmentCount(); i++ )
+    // The segments skipped by NextSegmentNear() are not closer than aClearance, so they
+    // can't be the nearest colliding one
+    for( int i = NextSegmentNear( 0, aP, aClearance ); i < GetSegmentCount();
+            i = NextSegmentNear( i + 1, aP, aClearance ) )
     {
         const SEG& s = GetSegment( i );
         VECTOR2I pn = s.NearestPoint( aP );
@@ -170,10 +178,11 @@ bool SHAPE_LINE_CHAIN_BASE::Collide( const SEG& aSeg, int aClearance, int* aActu
     SEG::ecoord clearance_sq = SEG::Square( aClearance );
     VECTOR2I nearest;
 
-    for( int i = 0; i < GetSegmentCount(); i++ )
+    for( int i = NextSegmentNear( 0, aSeg, aClearance ); i < GetSegmentCount();
+            i = NextSegmentNear( i + 1, aSeg, aClearance ) )
     {
         const SEG& s = GetSegment( i );
-        SEG::ecoord dist_sq =s.SquaredDistance( aSeg );
+        SEG::ecoord dist_sq = s.SquaredDistance( aSeg );
 
         if( dist_sq < closest_dist_sq )
         {
@@ -206,6 +215,45 @@ bool SHAPE_LINE_CHAIN_BASE::Collide( const SEG& aSeg, int aClearance, int* aActu
 }
 
 
+int SHAPE_LINE_CHAIN_BASE::NextSegmentNear( int aStart, const VECTOR2I& aP, int aDist ) const
+{
+    const VECTOR2I* pts = GetPointData();
+    int             batched = pts ? std::min( (int) GetSegmentCount(), (int) GetPointCount() - 1 ) : 0;
+
+    // The closing segment of a closed chain isn't part of the point array
+    if( aStart < batched )
+    {
+        int i = FindSegmentNear( pts, batched + 1, aStart, aP, aDist );
+
+        if( i < batched )
+            return i;
+
+        aStart = batched;
+    }
+
+    return std::min( aStart, (int) GetSegmentCount() );
+}
+
+
+int SHAPE_LINE_CHAIN_BASE::NextSegmentNear( int aStart, const SEG& aSeg, int aDist ) const
+{
+    const VECTOR2I* pts = GetPointData();
+    int             batched = pts ? std::min( (int) GetSegmentCount(), (int) GetPointCount() - 1 ) : 0;
+
+    if( aStart < batched )
+    {
+        int i = FindSegmentNear( pts, batched + 1, aStart, aSeg, aDist );
+
+        if( i < batched )
+            return i;
+
+        aStart = batched;
+    }
+
+    return std::min( aStart, (int) GetSegmentCount() );
+}
+
+
 const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 {
     SHAPE_LINE_CHAIN a( *this );
@@ -267,7 +315,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
     // N.B. This works because convertArc changes m_shapes on the first run
     for( int ind = aStartIndex; ind <= aEndIndex; ind++ )
     {
-        if( m_shapes[ind] != SHAPE_IS_PT )
+        if( ArcIndex( ind ) != SHAPE_IS_PT )
             convertArc( ind );
     }
 
@@ -278,10 +326,14 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
         m_points.erase( m_points.begin() + aStartIndex + 1, m_points.begin() + aEndIndex + 1 );
         m_points[aStartIndex] = aP;
 
-        m_shapes.erase( m_shapes.begin() + aStartIndex + 1, m_shapes.begin() + aEndIndex + 1 );
+        if( !m_shapes.empty() )
+        {
+            m_shapes.erase( m_shapes.begin() + aStartIndex + 1,
+                            m_shapes.begin() + aEndIndex + 1 );
+        }
     }
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -295,24 +347,38 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
     Remove( aStartIndex, aEndIndex );
 
-    // The total new arcs index is added to the new arc indices
-    size_t prev_arc_count = m_arcs.size();
-    auto   new_shapes = aLine.m_shapes;
+    if( !aLine.m_arcs.empty() )
+    {
+        storeShapes();
+
+        // The total new arcs index is added to the new arc indices
+        size_t prev_arc_count = m_arcs.size();
+        auto   new_shapes = aLine.CShapes();
 
-    for( auto& shape : new_shapes )
-        shape += prev_arc_count;
+        for( auto& shape : new_shapes )
+        {
+            if( shape != SHAPE_IS_PT )
+                shape += prev_arc_count;
+        }
+
+        m_shapes.insert( m_shapes.begin() + aStartIndex, new_shapes.begin(), new_shapes.end() );
+    }
+    else if( !m_shapes.empty() )
+    {
+        m_shapes.insert( m_shapes.begin() + aStartIndex, aLine.m_points.size(),
+                         ssize_t( SHAPE_IS_PT ) );
+    }
 
-    m_shapes.insert( m_shapes.begin() + aStartIndex, new_shapes.begin(), new_shapes.end() );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
     m_arcs.insert( m_arcs.end(), aLine.m_arcs.begin(), aLine.m_arcs.end() );
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -328,16 +394,18 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
     // Remove any overlapping arcs in the point range
     for( int i = aStartIndex; i < aEndIndex; i++ )
     {
-        if( m_shapes[i] != SHAPE_IS_PT )
+        if( ArcIndex( i ) != SHAPE_IS_PT )
             extra_arcs.insert( m_shapes[i] );
     }
 
     for( auto arc : extra_arcs )
         convertArc( arc );
 
-    m_shapes.erase( m_shapes.begin() + aStartIndex, m_shapes.begin() + aEndIndex + 1 );
+    if( !m_shapes.empty() )
+        m_shapes.erase( m_shapes.begin() + aStartIndex, m_shapes.begin() + aEndIndex + 1 );
+
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -391,7 +459,9 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     if( ii >= 0 )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
-        m_shapes.insert( m_shapes.begin() + ii + 1, ssize_t( SHAPE_IS_PT ) );
+
+        if( !m_shapes.empty() )
+            m_shapes.insert( m_shapes.begin() + ii + 1, ssize_t( SHAPE_IS_PT ) );
 
         return ii + 1;
     }
@@ -439,16 +509,22 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 {
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 
     if( aOtherLine.PointCount() == 0 )
         return;
 
-    else if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
+    if( !aOtherLine.m_arcs.empty() )
+        storeShapes();
+
+    if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
     {
         const VECTOR2I p = aOtherLine.CPoint( 0 );
         m_points.push_back( p );
-        m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
+        if( !m_shapes.empty() )
+            m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
         m_bbox.Merge( p );
     }
 
@@ -464,13 +540,13 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 
         if( arcIndex != ssize_t( SHAPE_IS_PT ) )
             m_shapes.push_back( num_arcs + arcIndex );
-        else
+        else if( !m_shapes.empty() )
             m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
 
         m_bbox.Merge( p );
     }
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -478,6 +554,8 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 {
     auto& chain = aArc.ConvertToPolyline();
 
+    storeShapes();
+
     for( auto& pt : chain.CPoints() )
     {
         m_points.push_back( pt );
@@ -492,21 +570,25 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 {
-    if( m_shapes[aVertex] != SHAPE_IS_PT )
+    if( ArcIndex( aVertex ) != SHAPE_IS_PT )
         convertArc( aVertex );
 
     m_points.insert( m_points.begin() + aVertex, aP );
-    m_shapes.insert( m_shapes.begin() + aVertex, ssize_t( SHAPE_IS_PT ) );
 
-    assert( m_shapes.size() == m_points.size() );
+    if( !m_shapes.empty() )
+        m_shapes.insert( m_shapes.begin() + aVertex, ssize_t( SHAPE_IS_PT ) );
+
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
 {
-    if( m_shapes[aVertex] != SHAPE_IS_PT )
+    if( ArcIndex( aVertex ) != SHAPE_IS_PT )
         convertArc( aVertex );
 
+    storeShapes();
+
     /// Step 1: Find the position for the new arc in the existing arc vector
     size_t arc_pos = m_arcs.size();
 
@@ -824,8 +906,13 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     else if( PointCount() == 2 )
     {
         if( m_points[0] == m_points[1] )
+        {
             m_points.pop_back();
 
+            if( !m_shapes.empty() )
+                m_shapes.pop_back();
+        }
+
         return *this;
     }
 
@@ -837,19 +924,31 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     {
         int j = i + 1;
 
-        while( j < np && m_points[i] == m_points[j] && m_shapes[i] == m_shapes[j] )
+        while( j < np && m_points[i] == m_points[j] && ArcIndex( i ) == ArcIndex( j ) )
             j++;
 
         pts_unique.push_back( CPoint( i ) );
-        shapes_unique.push_back( m_shapes[i] );
+        shapes_unique.push_back( ArcIndex( i ) );
 
         i = j;
     }
 
+    // Chains without arcs keep on not storing the shape indices
+    bool storeIndices = !m_shapes.empty();
+
     m_points.clear();
     m_shapes.clear();
     np = pts_unique.size();
 
+    auto push =
+            [&]( int aIndex )
+            {
+                m_points.push_back( pts_unique[aIndex] );
+
+                if( storeIndices )
+                    m_shapes.push_back( shapes_unique[aIndex] );
+            };
+
     i = 0;
 
     // stage 1: eliminate collinear segments
@@ -864,16 +963,14 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
                         || SEG( p0, p1 ).Collinear( SEG( p1, pts_unique[n + 2] ) ) ) )
             n++;
 
-        m_points.push_back( p0 );
-        m_shapes.push_back( shapes_unique[i] );
+        push( i );
 
         if( n > i )
             i = n;
 
         if( n == np )
         {
-            m_points.push_back( pts_unique[n - 1] );
-            m_shapes.push_back( shapes_unique[n - 1] );
+            push( n - 1 );
             return *this;
         }
 
@@ -881,15 +978,11 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     }
 
     if( np > 1 )
-    {
-        m_points.push_back( pts_unique[np - 2] );
-        m_shapes.push_back( shapes_unique[np - 2] );
-    }
+        push( np - 2 );
 
-    m_points.push_back( pts_unique[np - 1] );
-    m_shapes.push_back( shapes_unique[np - 1] );
+    push( np - 1 );
 
-    assert( m_points.size() == m_shapes.size() );
+    assert( m_shapes.empty() || m_points.size() == m_shapes.size() );
 
     return *this;
 }
@@ -1020,6 +1113,8 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
     size_t n_arcs;
 
     m_points.clear();
+    m_shapes.clear();
+    m_arcs.clear();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
@@ -1058,6 +1153,9 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
         m_arcs.emplace_back( pc, p0, angle );
     }
 
+    if( m_arcs.empty() )
+        m_shapes.clear();
+
     return true;
 }
 
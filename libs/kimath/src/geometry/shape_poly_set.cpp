@@ -28,19 +28,25 @@
 
 #include <algorithm>
 #include <assert.h>                          // for assert
+#include <atomic>
 #include <cmath>                             // for sqrt, cos, hypot, isinf
 #include <cstdio>
+#include <functional>
+#include <future>
 #include <istream>                           // for operator<<, operator>>
 #include <limits>                            // for numeric_limits
 #include <memory>
 #include <set>
 #include <string>                            // for char_traits, operator!=
+#include <thread>
 #include <type_traits>                       // for swap, move
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <clipper.hpp>                       // for Clipper, PolyNode, Clipp...
 #include <geometry/geometry_utils.h>
+#include <geometry/poly_edge_index.h>
 #include <geometry/polygon_triangulation.h>
 #include <geometry/seg.h>                    // for SEG, OPT_VECTOR2I
 #include <geometry/shape.h>
@@ -187,6 +193,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -199,6 +207,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -216,6 +226,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -239,6 +251,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    invalidateEdgeIndex();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -424,6 +438,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -438,6 +454,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -455,6 +473,513 @@ int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 }
 
 
+// Parallel mode of the boolean operations.
+//
+// The plane is cut in vertical strips holding about the same number of vertices.  Each strip
+// runs the operation on the paths whose extent overlaps it: the other paths are at a non-zero
+// distance of the strip, so they can't change the result inside the strip or on its borders.
+// The result of each strip is clipped to the strip, and the pieces touching a border between
+// two strips are merged with a union.  The vertices created on the borders by the clipping are
+// then removed, which gives back the edges of the serial result.
+
+static std::atomic<int> s_parallelThreshold( 50000 );
+
+///> Number of threads running parallel operations, over all the polygon sets
+static std::atomic<int> s_busyThreads( 0 );
+
+///> Minimum number of vertices worth a thread
+static const size_t PARALLEL_MIN_VERTICES = 5000;
+
+
+void SHAPE_POLY_SET::SetParallelThreshold( int aVertexCount )
+{
+    s_parallelThreshold = aVertexCount;
+}
+
+
+int SHAPE_POLY_SET::GetParallelThreshold()
+{
+    return s_parallelThreshold;
+}
+
+
+/**
+ * Reserves the threads of a parallel operation, the calling thread included.  Operations
+ * started while the other cores already run parallel operations (e.g. from the threads of
+ * the zone filler) get a single thread, and run serially.
+ */
+class THREAD_RESERVATION
+{
+public:
+    THREAD_RESERVATION( size_t aVertexCount ) :
+        m_count( 1 )
+    {
+        int threshold = s_parallelThreshold;
+
+        if( threshold <= 0 || aVertexCount < (size_t) threshold )
+            return;
+
+        int cores = std::max( 2u, std::thread::hardware_concurrency() );
+        int wanted = std::max<size_t>( 2, std::min<size_t>( cores,
+                                                            aVertexCount / PARALLEL_MIN_VERTICES ) );
+        int busy = s_busyThreads;
+
+        do
+        {
+            m_count = std::min( wanted, cores - busy );
+
+            if( m_count < 2 )
+            {
+                m_count = 1;
+                return;
+            }
+        } while( !s_busyThreads.compare_exchange_weak( busy, busy + m_count ) );
+    }
+
+    ~THREAD_RESERVATION()
+    {
+        if( m_count > 1 )
+            s_busyThreads -= m_count;
+    }
+
+    int Count() const { return m_count; }
+
+private:
+    int m_count;
+};
+
+
+///> Calls aFunc( i ) for i in [0, aCount), from aThreads threads including the calling one
+static void parallelFor( size_t aCount, int aThreads, const std::function<void( size_t )>& aFunc )
+{
+    std::atomic<size_t> next( 0 );
+
+    auto worker =
+            [&]()
+            {
+                for( size_t i = next++; i < aCount; i = next++ )
+                    aFunc( i );
+            };
+
+    std::vector<std::future<void>> threads;
+
+    for( size_t i = 1; i < (size_t) aThreads && i < aCount; i++ )
+        threads.push_back( std::async( std::launch::async, worker ) );
+
+    worker();
+
+    for( std::future<void>& thread : threads )
+        thread.wait();
+}
+
+
+///> A path of the input of a parallel operation, with its horizontal extent
+struct STRIP_PATH
+{
+    Path     m_path;
+    PolyType m_type;
+    cInt     m_minX;
+    cInt     m_maxX;
+};
+
+
+typedef std::function<void( const std::vector<const STRIP_PATH*>&, Paths& )> STRIP_OPERATION;
+
+
+static void addStripPath( std::vector<STRIP_PATH>& aPaths, Path&& aPath, PolyType aType )
+{
+    // Clipper ignores the degenerate paths as well
+    if( aPath.size() < 3 )
+        return;
+
+    STRIP_PATH path;
+
+    path.m_path = std::move( aPath );
+    path.m_type = aType;
+    path.m_minX = std::numeric_limits<cInt>::max();
+    path.m_maxX = std::numeric_limits<cInt>::min();
+
+    for( const IntPoint& pt : path.m_path )
+    {
+        path.m_minX = std::min( path.m_minX, pt.X );
+        path.m_maxX = std::max( path.m_maxX, pt.X );
+    }
+
+    aPaths.push_back( std::move( path ) );
+}
+
+
+struct INT_POINT_HASH
+{
+    size_t operator()( const IntPoint& aPt ) const
+    {
+        return std::hash<cInt>()( aPt.X ) ^ ( std::hash<cInt>()( aPt.Y ) * 31 );
+    }
+};
+
+
+static bool intPointLess( const IntPoint& aA, const IntPoint& aB )
+{
+    return aA.X < aB.X || ( aA.X == aB.X && aA.Y < aB.Y );
+}
+
+
+/**
+ * Runs aOperation on vertical strips of the plane in parallel and stitches the results.
+ * @param aPaths the input of the operation
+ * @param aThreads number of threads (and strips)
+ * @param aResult the polygons of the result
+ * @return false if the paths can't be split in at least two strips
+ */
+static bool runOnStrips( const std::vector<STRIP_PATH>& aPaths, int aThreads,
+                         const STRIP_OPERATION& aOperation,
+                         std::vector<SHAPE_POLY_SET::POLYGON>& aResult )
+{
+    std::vector<std::pair<cInt, size_t>> centres;
+    size_t                               vertexCount = 0;
+    cInt                                 minX = std::numeric_limits<cInt>::max();
+    cInt                                 maxX = std::numeric_limits<cInt>::min();
+    cInt                                 minY = std::numeric_limits<cInt>::max();
+    cInt                                 maxY = std::numeric_limits<cInt>::min();
+
+    for( const STRIP_PATH& path : aPaths )
+    {
+        centres.emplace_back( path.m_minX + ( path.m_maxX - path.m_minX ) / 2,
+                              path.m_path.size() );
+        vertexCount += path.m_path.size();
+        minX = std::min( minX, path.m_minX );
+        maxX = std::max( maxX, path.m_maxX );
+
+        for( const IntPoint& pt : path.m_path )
+        {
+            minY = std::min( minY, pt.Y );
+            maxY = std::max( maxY, pt.Y );
+        }
+    }
+
+    // The borders between the strips split the path centres in groups of the same vertex
+    // count
+    std::vector<cInt> borders;
+    size_t            count = 0;
+    size_t            strip = 1;
+
+    std::sort( centres.begin(), centres.end() );
+
+    for( const std::pair<cInt, size_t>& centre : centres )
+    {
+        count += centre.second;
+
+        for( ; strip < (size_t) aThreads && count * aThreads >= strip * vertexCount; strip++ )
+        {
+            if( centre.first > minX && centre.first < maxX
+                    && ( borders.empty() || centre.first > borders.back() ) )
+            {
+                borders.push_back( centre.first );
+            }
+        }
+    }
+
+    if( borders.empty() )
+        return false;
+
+    std::vector<cInt> edges;
+
+    edges.push_back( minX - 1 );
+    edges.insert( edges.end(), borders.begin(), borders.end() );
+    edges.push_back( maxX + 1 );
+
+    Path rect( 4 );
+
+    rect[0].Y = rect[1].Y = minY - 1;
+    rect[2].Y = rect[3].Y = maxY + 1;
+
+    struct STRIP
+    {
+        ///> Polygons of the result away from the borders
+        std::vector<SHAPE_POLY_SET::POLYGON> m_inner;
+
+        ///> Outlines and holes touching the borders
+        Paths m_border;
+
+        ///> Holes away from the borders, with the index of their outline in m_border
+        std::vector<std::pair<size_t, Path>> m_holes;
+
+        ///> Vertices of the result (before clipping) lying on the borders
+        std::vector<IntPoint> m_kept;
+    };
+
+    std::vector<STRIP> strips( edges.size() - 1 );
+
+    auto runStrip =
+            [&]( size_t aIndex )
+            {
+                STRIP& s = strips[aIndex];
+                cInt   left = aIndex > 0 ? edges[aIndex] : minX - 2;
+                cInt   right = aIndex < borders.size() ? edges[aIndex + 1] : maxX + 2;
+
+                auto onBorder =
+                        [&]( const Path& aPath )
+                        {
+                            for( const IntPoint& pt : aPath )
+                            {
+                                if( pt.X == left || pt.X == right )
+                                    return true;
+                            }
+
+                            return false;
+                        };
+
+                std::vector<const STRIP_PATH*> selected;
+
+                for( const STRIP_PATH& path : aPaths )
+                {
+                    if( path.m_maxX >= edges[aIndex] && path.m_minX <= edges[aIndex + 1] )
+                        selected.push_back( &path );
+                }
+
+                Paths result;
+
+                aOperation( selected, result );
+
+                for( const Path& path : result )
+                {
+                    for( const IntPoint& pt : path )
+                    {
+                        if( pt.X == left || pt.X == right )
+                            s.m_kept.push_back( pt );
+                    }
+                }
+
+                Clipper  clip;
+                Path     stripRect( rect );
+                PolyTree tree;
+
+                stripRect[0].X = stripRect[3].X = edges[aIndex];
+                stripRect[1].X = stripRect[2].X = edges[aIndex + 1];
+
+                clip.AddPaths( result, ptSubject, true );
+                clip.AddPath( stripRect, ptClip, true );
+                clip.Execute( ctIntersection, tree, pftNonZero, pftNonZero );
+
+                for( PolyNode* n = tree.GetFirst(); n; n = n->GetNext() )
+                {
+                    if( n->IsHole() )
+                        continue;
+
+                    if( !onBorder( n->Contour ) )
+                    {
+                        SHAPE_POLY_SET::POLYGON poly;
+
+                        poly.reserve( n->Childs.size() + 1 );
+                        poly.push_back( n->Contour );
+
+                        for( PolyNode* hole : n->Childs )
+                            poly.push_back( hole->Contour );
+
+                        s.m_inner.push_back( std::move( poly ) );
+                        continue;
+                    }
+
+                    size_t outline = s.m_border.size();
+
+                    s.m_border.push_back( n->Contour );
+
+                    for( PolyNode* hole : n->Childs )
+                    {
+                        if( onBorder( hole->Contour ) )
+                            s.m_border.push_back( hole->Contour );
+                        else
+                            s.m_holes.emplace_back( outline, hole->Contour );
+                    }
+                }
+            };
+
+    parallelFor( strips.size(), aThreads, runStrip );
+
+    // Merge the pieces touching the borders
+    Clipper               merge;
+    PolyTree              merged;
+    std::vector<IntPoint> kept;
+
+    for( STRIP& s : strips )
+    {
+        merge.AddPaths( s.m_border, ptSubject, true );
+        kept.insert( kept.end(), s.m_kept.begin(), s.m_kept.end() );
+    }
+
+    merge.Execute( ctUnion, merged, pftNonZero, pftNonZero );
+
+    std::sort( kept.begin(), kept.end(), intPointLess );
+
+    auto onBorders =
+            [&]( const IntPoint& aPt )
+            {
+                return std::binary_search( borders.begin(), borders.end(), aPt.X );
+            };
+
+    auto removeCuts =
+            [&]( const Path& aPath )
+            {
+                Path path;
+
+                path.reserve( aPath.size() );
+
+                for( const IntPoint& pt : aPath )
+                {
+                    if( !onBorders( pt )
+                            || std::binary_search( kept.begin(), kept.end(), pt, intPointLess ) )
+                    {
+                        path.push_back( pt );
+                    }
+                }
+
+                return path;
+            };
+
+    aResult.clear();
+
+    for( STRIP& s : strips )
+    {
+        for( SHAPE_POLY_SET::POLYGON& poly : s.m_inner )
+            aResult.push_back( std::move( poly ) );
+    }
+
+    size_t firstMerged = aResult.size();
+
+    // Owner of each vertex of the merged outlines, -1 if shared by several outlines
+    std::unordered_map<IntPoint, int, INT_POINT_HASH> owners;
+
+    for( PolyNode* n = merged.GetFirst(); n; n = n->GetNext() )
+    {
+        if( n->IsHole() )
+            continue;
+
+        Path outline = removeCuts( n->Contour );
+
+        if( outline.size() < 3 )
+            continue;
+
+        int index = aResult.size() - firstMerged;
+
+        for( const IntPoint& pt : outline )
+        {
+            auto it = owners.emplace( pt, index );
+
+            if( !it.second && it.first->second != index )
+                it.first->second = -1;
+        }
+
+        SHAPE_POLY_SET::POLYGON poly;
+
+        poly.push_back( outline );
+
+        for( PolyNode* hole : n->Childs )
+        {
+            Path path = removeCuts( hole->Contour );
+
+            if( path.size() >= 3 )
+                poly.push_back( path );
+        }
+
+        aResult.push_back( std::move( poly ) );
+    }
+
+    // Give back the holes away from the borders to the merged outlines of their pieces
+    for( STRIP& s : strips )
+    {
+        for( std::pair<size_t, Path>& hole : s.m_holes )
+        {
+            int index = -1;
+
+            for( const IntPoint& pt : s.m_border[hole.first] )
+            {
+                auto it = owners.find( pt );
+
+                if( !onBorders( pt ) && it != owners.end() && it->second >= 0 )
+                {
+                    index = it->second;
+                    break;
+                }
+            }
+
+            if( index < 0 )
+            {
+                // Only when all the vertices are shared: take the smallest outline around
+                VECTOR2I pt( hole.second[0].X, hole.second[0].Y );
+                double   area = std::numeric_limits<double>::max();
+
+                for( size_t i = firstMerged; i < aResult.size(); i++ )
+                {
+                    const SHAPE_LINE_CHAIN& outline = aResult[i][0];
+
+                    if( outline.Area() < area
+                            && ( outline.PointInside( pt ) || outline.PointOnEdge( pt ) ) )
+                    {
+                        index = i - firstMerged;
+                        area = outline.Area();
+                    }
+                }
+            }
+
+            if( index >= 0 )
+                aResult[firstMerged + index].push_back( hole.second );
+        }
+    }
+
+    return true;
+}
+
+
+bool SHAPE_POLY_SET::parallelBooleanOp( ClipperLib::ClipType aType,
+                                        const SHAPE_POLY_SET& aShape,
+                                        const SHAPE_POLY_SET& aOtherShape,
+                                        POLYGON_MODE aFastMode )
+{
+    // Clipper doesn't always split the strictly simple polygons the same way when their
+    // neighbours are in other strips: only the PM_FAST results are the serial ones
+    if( aFastMode != PM_FAST )
+        return false;
+
+    THREAD_RESERVATION threads( aShape.TotalVertices() + aOtherShape.TotalVertices() );
+
+    if( threads.Count() < 2 )
+        return false;
+
+    std::vector<STRIP_PATH> paths;
+
+    for( const POLYGON& poly : aShape.m_polys )
+    {
+        for( size_t i = 0; i < poly.size(); i++ )
+            addStripPath( paths, poly[i].convertToClipper( i == 0 ), ptSubject );
+    }
+
+    for( const POLYGON& poly : aOtherShape.m_polys )
+    {
+        for( size_t i = 0; i < poly.size(); i++ )
+            addStripPath( paths, poly[i].convertToClipper( i == 0 ), ptClip );
+    }
+
+    auto operation =
+            [&]( const std::vector<const STRIP_PATH*>& aPaths, Paths& aResult )
+            {
+                Clipper c;
+
+                for( const STRIP_PATH* path : aPaths )
+                    c.AddPath( path->m_path, path->m_type, true );
+
+                c.Execute( aType, aResult, pftNonZero, pftNonZero );
+            };
+
+    POLYSET result;
+
+    if( !runOnStrips( paths, threads.Count(), operation, result ) )
+        return false;
+
+    m_polys.swap( result );
+    return true;
+}
+
+
 void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
         POLYGON_MODE aFastMode )
 {
@@ -467,6 +992,11 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
         const SHAPE_POLY_SET& aOtherShape,
         POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
+    if( parallelBooleanOp( aType, aShape, aOtherShape, aFastMode ) )
+        return;
+
     Clipper c;
 
     c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
@@ -545,11 +1075,7 @@ void SHAPE_POLY_SET::InflateWithLinkedHoles( int aFactor, int aCircleSegmentsCou
 void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
                               CORNER_STRATEGY aCornerStrategy )
 {
-    // A static table to avoid repetitive calculations of the coefficient
-    // 1.0 - cos( M_PI / aCircleSegmentsCount )
-    // aCircleSegmentsCount is most of time <= 64 and usually 8, 12, 16, 32
-    #define SEG_CNT_MAX 64
-    static double arc_tolerance_factor[SEG_CNT_MAX + 1];
+    invalidateEdgeIndex();
 
     ClipperOffset c;
 
@@ -604,17 +1130,8 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
     if( aCircleSegmentsCount < 6 ) // avoid incorrect aCircleSegmentsCount values
         aCircleSegmentsCount = 6;
 
-    double coeff;
-
-    if( aCircleSegmentsCount > SEG_CNT_MAX || arc_tolerance_factor[aCircleSegmentsCount] == 0 )
-    {
-        coeff = 1.0 - cos( M_PI / aCircleSegmentsCount );
-
-        if( aCircleSegmentsCount <= SEG_CNT_MAX )
-            arc_tolerance_factor[aCircleSegmentsCount] = coeff;
-    }
-    else
-        coeff = arc_tolerance_factor[aCircleSegmentsCount];
+    // Not cached in a static table: Inflate() is called from several threads
+    double coeff = 1.0 - cos( M_PI / aCircleSegmentsCount );
 
     c.ArcTolerance = std::abs( aAmount ) * coeff;
     c.MiterLimit = miterLimit;
@@ -857,12 +1374,18 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
-    for( POLYGON& paths : m_polys )
-    {
-        fractureSingle( paths );
-    }
+    THREAD_RESERVATION threads( TotalVertices() );
+
+    // The polygons are fractured independently
+    parallelFor( m_polys.size(), threads.Count(),
+                 [&]( size_t aIndex )
+                 {
+                     fractureSingle( m_polys[aIndex] );
+                 } );
 }
 
 
@@ -1044,6 +1567,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1063,6 +1588,8 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
+    invalidateEdgeIndex();
+
     // We are expecting only one main outline, but this main outline can have holes
     // if holes: combine holes and remove them from the main outline.
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
@@ -1127,6 +1654,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateEdgeIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1237,8 +1766,15 @@ bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance, int* aActual,
                               VECTOR2I* aLocation ) const
 {
-    VECTOR2I nearest;
-    ecoord dist_sq = SquaredDistance( aSeg, aLocation ? &nearest : nullptr );
+    VECTOR2I  nearest;
+    VECTOR2I* nearestPtr = aLocation ? &nearest : nullptr;
+    ecoord    dist_sq;
+
+    // The index can stop searching as soon as it knows there is no collision
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        dist_sq = index->SquaredDistance( aSeg, nearestPtr, std::abs( aClearance ) );
+    else
+        dist_sq = SquaredDistance( aSeg, nearestPtr );
 
     if( dist_sq == 0 || dist_sq < SEG::Square( aClearance ) )
     {
@@ -1258,8 +1794,15 @@ bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance, int* aActual,
 bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
                               VECTOR2I* aLocation ) const
 {
-    VECTOR2I nearest;
-    ecoord dist_sq = SquaredDistance( aP, aLocation ? &nearest : nullptr );
+    VECTOR2I  nearest;
+    VECTOR2I* nearestPtr = aLocation ? &nearest : nullptr;
+    ecoord    dist_sq;
+
+    // The index can stop searching as soon as it knows there is no collision
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        dist_sq = index->SquaredDistance( aP, nearestPtr, std::abs( aClearance ) );
+    else
+        dist_sq = SquaredDistance( aP, nearestPtr );
 
     if( dist_sq == 0 || dist_sq < SEG::Square( aClearance ) )
     {
@@ -1356,12 +1899,16 @@ bool SHAPE_POLY_SET::Collide( const SHAPE* aShape, int aClearance, int* aActual,
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateEdgeIndex();
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    invalidateEdgeIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1372,6 +1919,8 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 
 int SHAPE_POLY_SET::RemoveNullSegments()
 {
+    invalidateEdgeIndex();
+
     int removed = 0;
 
     ITERATOR iterator = IterateWithHoles();
@@ -1425,12 +1974,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateEdgeIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateEdgeIndex();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1513,10 +2066,9 @@ void SHAPE_POLY_SET::BuildBBoxCaches()
 {
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        Outline( polygonIdx ).GenerateBBoxCache();
-
-        for( int holeIdx = 0; holeIdx < HoleCount( polygonIdx ); holeIdx++ )
-            Hole( polygonIdx, holeIdx ).GenerateBBoxCache();
+        // The caches don't change the contours, so don't go through Outline() and Hole()
+        for( SHAPE_LINE_CHAIN& path : m_polys[polygonIdx] )
+            path.GenerateBBoxCache();
     }
 }
 
@@ -1531,6 +2083,9 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, int aAccur
     if( aSubpolyIndex >= 0 )
         return containsSingle( aP, aSubpolyIndex, aAccuracy, aUseBBoxCaches );
 
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        return index->Contains( aP, aAccuracy );
+
     // In any other case, check it against all polygons in the set
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
@@ -1556,6 +2111,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -1573,6 +2130,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -1603,6 +2162,8 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1618,6 +2179,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1630,6 +2193,8 @@ void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1688,6 +2253,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( VECTOR2I aPoint, int aPoly
 
     SEG::ecoord minDistance = (*iterator).SquaredDistance( aPoint );
 
+    if( aNearest )
+        *aNearest = (*iterator).NearestPoint( aPoint );
+
     for( iterator++; iterator && minDistance > 0; iterator++ )
     {
         SEG::ecoord currentDistance = (*iterator).SquaredDistance( aPoint );
@@ -1723,6 +2291,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( const SEG& aSegment, int a
     CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
     SEG::ecoord            minDistance = (*iterator).SquaredDistance( aSegment );
 
+    if( aNearest )
+        *aNearest = (*iterator).NearestPoint( aSegment );
+
     for( iterator++; iterator && minDistance > 0; iterator++ )
     {
         SEG::ecoord currentDistance = (*iterator).SquaredDistance( aSegment );
@@ -1743,6 +2314,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( const SEG& aSegment, int a
 
 SEG::ecoord SHAPE_POLY_SET::SquaredDistance( VECTOR2I aPoint, VECTOR2I* aNearest ) const
 {
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        return index->SquaredDistance( aPoint, aNearest );
+
     SEG::ecoord currentDistance_sq;
     SEG::ecoord minDistance_sq = VECTOR2I::ECOORD_MAX;
     VECTOR2I nearest;
@@ -1768,6 +2342,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistance( VECTOR2I aPoint, VECTOR2I* aNearest
 
 SEG::ecoord SHAPE_POLY_SET::SquaredDistance( const SEG& aSegment, VECTOR2I* aNearest ) const
 {
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        return index->SquaredDistance( aSegment, aNearest );
+
     SEG::ecoord currentDistance_sq;
     SEG::ecoord minDistance_sq = VECTOR2I::ECOORD_MAX;
     VECTOR2I nearest;
@@ -1989,6 +2566,8 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
 
 SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
 {
+    invalidateEdgeIndex();
+
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
     m_triangulatedPolys.clear();
@@ -2007,6 +2586,36 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     return *this;
 }
 
+// Sets with fewer edges are queried with the brute force loops.  The edge index is only built
+// after a few queries so that sets edited between each query don't pay for it.
+static const int EDGE_INDEX_MIN_SEGMENTS = 128;
+static const int EDGE_INDEX_MIN_QUERIES = 4;
+
+
+std::shared_ptr<const POLY_EDGE_INDEX> SHAPE_POLY_SET::edgeIndex() const
+{
+    std::shared_ptr<const POLY_EDGE_INDEX> index = std::atomic_load( &m_edgeIndex );
+
+    if( index || ++m_edgeIndexQueries != EDGE_INDEX_MIN_QUERIES )
+        return index;
+
+    if( POLY_EDGE_INDEX::CanIndex( *this, EDGE_INDEX_MIN_SEGMENTS ) )
+    {
+        index = std::make_shared<const POLY_EDGE_INDEX>( *this );
+        std::atomic_store( &m_edgeIndex, index );
+    }
+
+    return index;
+}
+
+
+void SHAPE_POLY_SET::resetEdgeIndex()
+{
+    std::atomic_store( &m_edgeIndex, std::shared_ptr<const POLY_EDGE_INDEX>() );
+    m_edgeIndexQueries = 0;
+}
+
+
 MD5_HASH SHAPE_POLY_SET::GetHash() const
 {
     if( !m_hash.IsValid() )
@@ -2137,23 +2746,47 @@ void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
     m_triangulatedPolys.clear();
     m_triangulationValid = true;
 
-    while( tmpSet.OutlineCount() > 0 )
+    // The polygons are independent, so large sets are triangulated in parallel.  If the
+    // tesselation fails, we re-fracture the failed polygons, which will first simplify them
+    // before fracturing and removing the holes, and try once more.  This may result in
+    // multiple, disjoint polygons.
+    for( int attempt = 0; attempt < 2 && tmpSet.OutlineCount() > 0; attempt++ )
     {
-        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        PolygonTriangulation tess( *m_triangulatedPolys.back() );
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> results( tmpSet.OutlineCount() );
+        std::vector<char>                                  done( tmpSet.OutlineCount(), false );
+        THREAD_RESERVATION                                 threads( tmpSet.TotalVertices() );
+
+        parallelFor( results.size(), threads.Count(),
+                     [&]( size_t aIndex )
+                     {
+                         results[aIndex] = std::make_unique<TRIANGULATED_POLYGON>();
+                         PolygonTriangulation tess( *results[aIndex] );
+
+                         done[aIndex] = tess.TesselatePolygon( tmpSet.CPolygon( aIndex ).front() );
+                     } );
+
+        SHAPE_POLY_SET failed;
 
-        // If the tesselation fails, we re-fracture the polygon, which will
-        // first simplify the system before fracturing and removing the holes
-        // This may result in multiple, disjoint polygons.
-        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front() ) )
+        m_triangulationValid = true;
+
+        for( size_t ii = 0; ii < results.size(); ii++ )
         {
-            tmpSet.Fracture( PM_FAST );
-            m_triangulationValid = false;
-            continue;
+            if( !done[ii] )
+            {
+                failed.m_polys.push_back( tmpSet.m_polys[ii] );
+                m_triangulationValid = false;
+            }
+
+            // The partial triangulations of the last attempt are better than nothing
+            if( done[ii] || attempt == 1 )
+                m_triangulatedPolys.push_back( std::move( results[ii] ) );
         }
 
-        tmpSet.DeletePolygon( 0 );
-        m_triangulationValid = true;
+        if( failed.OutlineCount() == 0 )
+            break;
+
+        failed.Fracture( PM_FAST );
+        tmpSet = failed;
     }
 
     if( m_triangulationValid )
@@ -633,6 +633,10 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, ADD_MODE aMode )
 
     aBoardItem->SetParent( this );
     aBoardItem->ClearEditFlags();
+
+    if( aBoardItem->Type() != PCB_NETINFO_T )
+        cacheItem( aBoardItem );
+
     m_connectivity->Add( aBoardItem );
 
     InvokeListeners( &BOARD_LISTENER::OnBoardItemAdded, *this, aBoardItem );
@@ -714,6 +718,9 @@ void BOARD::Remove( BOARD_ITEM* aBoardItem )
         wxFAIL_MSG( wxT( "BOARD::Remove() needs more ::Type() support" ) );
     }
 
+    if( aBoardItem->Type() != PCB_NETINFO_T )
+        uncacheItem( aBoardItem );
+
     m_connectivity->Remove( aBoardItem );
 
     InvokeListeners( &BOARD_LISTENER::OnBoardItemRemoved, *this, aBoardItem );
@@ -730,7 +737,10 @@ void BOARD::DeleteMARKERs()
 {
     // the vector does not know how to delete the PCB_MARKER, it holds pointers
     for( PCB_MARKER* marker : m_markers )
+    {
+        uncacheItem( marker );
         delete marker;
+    }
 
     m_markers.clear();
 }
@@ -746,6 +756,7 @@ void BOARD::DeleteMARKERs( bool aWarningsAndErrors, bool aExclusions )
         if( ( marker->IsExcluded() && aExclusions )
                 || ( !marker->IsExcluded() && aWarningsAndErrors ) )
         {
+            uncacheItem( marker );
             delete marker;
         }
         else
@@ -758,11 +769,131 @@ void BOARD::DeleteMARKERs( bool aWarningsAndErrors, bool aExclusions )
 }
 
 
+void BOARD::cacheItem( BOARD_ITEM* aItem )
+{
+    m_itemByIdCache[ aItem->m_Uuid ] = aItem;
+
+    if( aItem->Type() == PCB_FOOTPRINT_T )
+    {
+        const KIID& footprintId = aItem->m_Uuid;
+
+        static_cast<FOOTPRINT*>( aItem )->RunOnChildren(
+                [&]( BOARD_ITEM* aChild )
+                {
+                    m_footprintByChildId[ aChild->m_Uuid ] = footprintId;
+                } );
+    }
+}
+
+
+void BOARD::uncacheItem( const BOARD_ITEM* aItem )
+{
+    auto it = m_itemByIdCache.find( aItem->m_Uuid );
+
+    if( it != m_itemByIdCache.end() && it->second == aItem )
+    {
+        m_itemByIdCache.erase( it );
+    }
+    else
+    {
+        // The KIID of the item was changed after it was added; the index must not keep a
+        // pointer to it under the old one.
+        for( it = m_itemByIdCache.begin(); it != m_itemByIdCache.end(); )
+        {
+            if( it->second == aItem )
+                it = m_itemByIdCache.erase( it );
+            else
+                ++it;
+        }
+    }
+
+    if( aItem->Type() == PCB_FOOTPRINT_T )
+    {
+        static_cast<const FOOTPRINT*>( aItem )->RunOnChildren(
+                [&]( BOARD_ITEM* aChild )
+                {
+                    auto owner = m_footprintByChildId.find( aChild->m_Uuid );
+
+                    if( owner != m_footprintByChildId.end() && owner->second == aItem->m_Uuid )
+                        m_footprintByChildId.erase( owner );
+                } );
+    }
+}
+
+
+/**
+ * Returns the child of aFootprint with the given KIID, or nullptr.
+ */
+static BOARD_ITEM* findFootprintChild( FOOTPRINT* aFootprint, const KIID& aID )
+{
+    for( PAD* pad : aFootprint->Pads() )
+    {
+        if( pad->m_Uuid == aID )
+            return pad;
+    }
+
+    if( aFootprint->Reference().m_Uuid == aID )
+        return &aFootprint->Reference();
+
+    if( aFootprint->Value().m_Uuid == aID )
+        return &aFootprint->Value();
+
+    for( BOARD_ITEM* drawing : aFootprint->GraphicalItems() )
+    {
+        if( drawing->m_Uuid == aID )
+            return drawing;
+    }
+
+    for( BOARD_ITEM* zone : aFootprint->Zones() )
+    {
+        if( zone->m_Uuid == aID )
+            return zone;
+    }
+
+    for( PCB_GROUP* group : aFootprint->Groups() )
+    {
+        if( group->m_Uuid == aID )
+            return group;
+    }
+
+    return nullptr;
+}
+
+
 BOARD_ITEM* BOARD::GetItem( const KIID& aID ) const
 {
     if( aID == niluuid )
         return nullptr;
 
+    // The KIID is checked again as it can be changed after the item was added
+    auto it = m_itemByIdCache.find( aID );
+
+    if( it != m_itemByIdCache.end() && it->second->m_Uuid == aID )
+        return it->second;
+
+    if( m_Uuid == aID )
+        return const_cast<BOARD*>( this );
+
+    // Footprint children are indexed by their footprint
+    auto owner = m_footprintByChildId.find( aID );
+
+    if( owner != m_footprintByChildId.end() )
+    {
+        it = m_itemByIdCache.find( owner->second );
+
+        if( it != m_itemByIdCache.end() && it->second->Type() == PCB_FOOTPRINT_T
+                && it->second->m_Uuid == owner->second )
+        {
+            if( BOARD_ITEM* child = findFootprintChild( static_cast<FOOTPRINT*>( it->second ),
+                                                        aID ) )
+            {
+                return child;
+            }
+        }
+    }
+
+    // Footprint children added after their footprint, and items whose KIID was changed after
+    // they were added, are not in the index.
     for( TRACK* track : Tracks() )
     {
         if( track->m_Uuid == aID )
@@ -774,35 +905,8 @@ BOARD_ITEM* BOARD::GetItem( const KIID& aID ) const
         if( footprint->m_Uuid == aID )
             return footprint;
 
-        for( PAD* pad : footprint->Pads() )
-        {
-            if( pad->m_Uuid == aID )
-                return pad;
-        }
-
-        if( footprint->Reference().m_Uuid == aID )
-            return &footprint->Reference();
-
-        if( footprint->Value().m_Uuid == aID )
-            return &footprint->Value();
-
-        for( BOARD_ITEM* drawing : footprint->GraphicalItems() )
-        {
-            if( drawing->m_Uuid == aID )
-                return drawing;
-        }
-
-        for( BOARD_ITEM* zone : footprint->Zones() )
-        {
-            if( zone->m_Uuid == aID )
-                return zone;
-        }
-
-        for( PCB_GROUP* group : footprint->Groups() )
-        {
-            if( group->m_Uuid == aID )
-                return group;
-        }
+        if( BOARD_ITEM* child = findFootprintChild( footprint, aID ) )
+            return child;
     }
 
     for( ZONE* zone : Zones() )
@@ -829,9 +933,6 @@ BOARD_ITEM* BOARD::GetItem( const KIID& aID ) const
             return group;
     }
 
-    if( m_Uuid == aID )
-        return const_cast<BOARD*>( this );
-
     // Not found; weak reference has been deleted.
     return DELETED_BOARD_ITEM::GetInstance();
 }
@@ -1760,6 +1861,7 @@ ZONE* BOARD::AddArea( PICKED_ITEMS_LIST* aNewZonesList, int aNetcode, PCB_LAYER_
     new_area->SetLayer( aLayer );
 
     m_zones.push_back( new_area );
+    cacheItem( new_area );
 
     new_area->SetHatchStyle( (ZONE_BORDER_DISPLAY_STYLE) aHatch );
 
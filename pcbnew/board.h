@@ -36,6 +36,8 @@
 #include <title_block.h>
 #include <tools/pcbnew_selection.h>
 
+#include <unordered_map>
+
 class BOARD_COMMIT;
 class PCB_BASE_FRAME;
 class PCB_EDIT_FRAME;
@@ -230,12 +232,24 @@ private:
 
     std::vector<BOARD_LISTENER*> m_listeners;
 
+    /// The items held directly by the board, by KIID.  Kept up to date by Add(), Remove()
+    /// and the other functions changing the item containers.
+    std::unordered_map<KIID, BOARD_ITEM*> m_itemByIdCache;
+
+    /// The KIID of the footprint owning each pad, field, graphic item, zone and group of the
+    /// board footprints, as they were when the footprint was added.  Footprints can change
+    /// their children without the board knowing, so this is only a hint checked by GetItem().
+    std::unordered_map<KIID, KIID>        m_footprintByChildId;
+
     // The default copy constructor & operator= are inadequate,
     // either write one or do not use it at all
     BOARD( const BOARD& aOther ) = delete;
 
     BOARD& operator=( const BOARD& aOther ) = delete;
 
+    void cacheItem( BOARD_ITEM* aItem );
+    void uncacheItem( const BOARD_ITEM* aItem );
+
     template <typename Func, typename... Args>
     void InvokeListeners( Func&& aFunc, Args&&... args )
     {
@@ -356,7 +370,10 @@ public:
     void DeleteAllFootprints()
     {
         for( FOOTPRINT* footprint : m_footprints )
+        {
+            uncacheItem( footprint );
             delete footprint;
+        }
 
         m_footprints.clear();
     }
@@ -367,6 +384,16 @@ public:
      */
     BOARD_ITEM* GetItem( const KIID& aID ) const;
 
+    /**
+     * Removes aItem from the KIID index used by GetItem().  Only needed by code taking items
+     * out of the board containers directly instead of calling Remove().
+     */
+    void UncacheItemById( const BOARD_ITEM* aItem ) { uncacheItem( aItem ); }
+
+    /**
+     * Fill \a aMap with every item of the board keyed by its KIID.  Kept for the scripting API;
+     * C++ code should look items up with GetItem() instead.
+     */
     void FillItemMap( std::map<KIID, EDA_ITEM*>& aMap );
 
     /**
@@ -683,8 +683,14 @@ bool DIALOG_DRC::writeReport( const wxString& aFullFileName )
     if( fp == NULL )
         return false;
 
-    std::map<KIID, EDA_ITEM*> itemMap;
-    m_brdEditor->GetBoard()->FillItemMap( itemMap );
+    BOARD* board = m_brdEditor->GetBoard();
+
+    auto getItem =
+            [&]( const KIID& aId ) -> EDA_ITEM*
+            {
+                BOARD_ITEM* item = board->GetItem( aId );
+                return item && item->Type() != NOT_USED ? item : nullptr;
+            };
 
     EDA_UNITS              units = GetUserUnits();
     BOARD_DESIGN_SETTINGS& bds = m_brdEditor->GetBoard()->GetDesignSettings();
@@ -705,7 +711,7 @@ bool DIALOG_DRC::writeReport( const wxString& aFullFileName )
         const std::shared_ptr<RC_ITEM>& item = m_markersProvider->GetItem( i );
         SEVERITY severity = (SEVERITY) bds.GetSeverity( item->GetErrorCode() );
 
-        fprintf( fp, "%s", TO_UTF8( item->ShowReport( units, severity, itemMap ) ) );
+        fprintf( fp, "%s", TO_UTF8( item->ShowReport( units, severity, getItem ) ) );
     }
 
     count = m_unconnectedItemsProvider->GetCount();
@@ -717,7 +723,7 @@ bool DIALOG_DRC::writeReport( const wxString& aFullFileName )
         const std::shared_ptr<RC_ITEM>& item = m_unconnectedItemsProvider->GetItem( i );
         SEVERITY severity = (SEVERITY) bds.GetSeverity( item->GetErrorCode() );
 
-        fprintf( fp, "%s", TO_UTF8( item->ShowReport( units, severity, itemMap ) ) );
+        fprintf( fp, "%s", TO_UTF8( item->ShowReport( units, severity, getItem ) ) );
     }
 
     count = m_footprintWarningsProvider->GetCount();
@@ -729,7 +735,7 @@ bool DIALOG_DRC::writeReport( const wxString& aFullFileName )
         const std::shared_ptr<RC_ITEM>& item = m_footprintWarningsProvider->GetItem( i );
         SEVERITY severity = (SEVERITY) bds.GetSeverity( item->GetErrorCode() );
 
-        fprintf( fp, "%s", TO_UTF8( item->ShowReport( units, severity, itemMap ) ) );
+        fprintf( fp, "%s", TO_UTF8( item->ShowReport( units, severity, getItem ) ) );
     }
 
 
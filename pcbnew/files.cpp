@@ -54,6 +54,8 @@
 #include <plugins/cadstar/cadstar_pcb_archive_plugin.h>
 #include <plugins/eagle/eagle_plugin.h>
 #include <dialogs/dialog_imported_layers.h>
+#include <advanced_config.h>
+#include <plugins/kicad/kicad_plugin.h>
 
 
 //#define     USE_INSTRUMENTATION     1
@@ -1036,7 +1038,28 @@ bool PCB_EDIT_FRAME::doAutoSave()
 
     wxLogTrace( traceAutoSave, "Creating auto save file <" + autoSaveFileName.GetFullPath() + ">" );
 
-    if( SavePcbFile( autoSaveFileName.GetFullPath(), false, false ) )
+    bool saved = false;
+
+    if( ADVANCED_CFG::GetCfg().m_SnapshotAutosave )
+    {
+        GetBoard()->SynchronizeNetsAndNetClasses();
+
+        try
+        {
+            PCB_IO().SaveSnapshot( autoSaveFileName.GetFullPath(), GetBoard() );
+            saved = true;
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            wxLogTrace( traceAutoSave, "Auto save failed: " + ioe.What() );
+        }
+    }
+    else
+    {
+        saved = SavePcbFile( autoSaveFileName.GetFullPath(), false, false );
+    }
+
+    if( saved )
     {
         GetScreen()->SetModify();
         GetBoard()->SetFileName( tmpFileName.GetFullPath() );
@@ -28,6 +28,7 @@
 #include <confirm.h>
 #include <refdes_utils.h>
 #include <bitmaps.h>
+#include <mutex>
 #include <unordered_set>
 #include <kicad_string.h>
 #include <pcb_edit_frame.h>
@@ -71,6 +72,9 @@ FOOTPRINT::FOOTPRINT( BOARD* parent ) :
 FOOTPRINT::FOOTPRINT( const FOOTPRINT& aFootprint ) :
     BOARD_ITEM_CONTAINER( aFootprint )
 {
+    // The bounding box of a deferred footprint is only calculated with its body
+    aFootprint.loadBody();
+
     m_pos          = aFootprint.m_pos;
     m_fpid         = aFootprint.m_fpid;
     m_attributes   = aFootprint.m_attributes;
@@ -149,7 +153,7 @@ FOOTPRINT::FOOTPRINT( const FOOTPRINT& aFootprint ) :
     }
 
     // Copy auxiliary data: 3D_Drawings info
-    m_3D_Drawings = aFootprint.m_3D_Drawings;
+    m_3D_Drawings = aFootprint.Models();
 
     m_doc         = aFootprint.m_doc;
     m_keywords     = aFootprint.m_keywords;
@@ -201,10 +205,77 @@ FOOTPRINT::~FOOTPRINT()
 }
 
 
+void FOOTPRINT::SetDeferredBody( std::function<void( FOOTPRINT* )> aLoader )
+{
+    loadBody();
+
+    m_deferredBody = std::move( aLoader );
+    m_hasDeferredBody.store( (bool) m_deferredBody, std::memory_order_release );
+}
+
+
+void FOOTPRINT::loadDeferredBody() const
+{
+    try
+    {
+        LoadDeferredBody();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        wxLogError( ioe.What() );
+    }
+}
+
+
+void FOOTPRINT::LoadDeferredBody() const
+{
+    // One lock for all footprints: each body is loaded only once
+    static std::mutex mutex;
+
+    // The loader adds the items through Add(), which calls loadBody() again
+    static thread_local const FOOTPRINT* loading = nullptr;
+
+    if( loading == this )
+        return;
+
+    std::lock_guard<std::mutex> lock( mutex );
+
+    // Another thread may have loaded it while this one was waiting
+    if( !m_hasDeferredBody.load( std::memory_order_relaxed ) )
+        return;
+
+    std::function<void( FOOTPRINT* )> loader = std::move( m_deferredBody );
+
+    m_deferredBody = nullptr;
+    loading = this;
+
+    try
+    {
+        loader( const_cast<FOOTPRINT*>( this ) );
+    }
+    catch( ... )
+    {
+        loading = nullptr;
+        m_hasDeferredBody.store( false, std::memory_order_release );
+        throw;
+    }
+
+    loading = nullptr;
+    m_hasDeferredBody.store( false, std::memory_order_release );
+}
+
+
 FOOTPRINT& FOOTPRINT::operator=( FOOTPRINT&& aOther )
 {
+    // The bounding box of a deferred footprint is only calculated with its body
+    aOther.loadBody();
+
     BOARD_ITEM::operator=( aOther );
 
+    // The body of this footprint is replaced, loaded or not
+    m_deferredBody = nullptr;
+    m_hasDeferredBody.store( false, std::memory_order_release );
+
     m_pos           = aOther.m_pos;
     m_fpid          = aOther.m_fpid;
     m_attributes    = aOther.m_attributes;
@@ -274,7 +345,7 @@ FOOTPRINT& FOOTPRINT::operator=( FOOTPRINT&& aOther )
 
     // Copy auxiliary data: 3D_Drawings info
     m_3D_Drawings.clear();
-    m_3D_Drawings = aOther.m_3D_Drawings;
+    m_3D_Drawings = aOther.Models();
     m_doc         = aOther.m_doc;
     m_keywords     = aOther.m_keywords;
     m_properties  = aOther.m_properties;
@@ -298,8 +369,15 @@ FOOTPRINT& FOOTPRINT::operator=( FOOTPRINT&& aOther )
 
 FOOTPRINT& FOOTPRINT::operator=( const FOOTPRINT& aOther )
 {
+    // The bounding box of a deferred footprint is only calculated with its body
+    aOther.loadBody();
+
     BOARD_ITEM::operator=( aOther );
 
+    // The body of this footprint is replaced, loaded or not
+    m_deferredBody = nullptr;
+    m_hasDeferredBody.store( false, std::memory_order_release );
+
     m_pos           = aOther.m_pos;
     m_fpid          = aOther.m_fpid;
     m_attributes    = aOther.m_attributes;
@@ -380,7 +458,7 @@ FOOTPRINT& FOOTPRINT::operator=( const FOOTPRINT& aOther )
 
     // Copy auxiliary data: 3D_Drawings info
     m_3D_Drawings.clear();
-    m_3D_Drawings = aOther.m_3D_Drawings;
+    m_3D_Drawings = aOther.Models();
     m_doc         = aOther.m_doc;
     m_keywords     = aOther.m_keywords;
     m_properties  = aOther.m_properties;
@@ -441,6 +519,8 @@ void FOOTPRINT::ClearAllNets()
 
 void FOOTPRINT::Add( BOARD_ITEM* aBoardItem, ADD_MODE aMode )
 {
+    loadBody();
+
     switch( aBoardItem->Type() )
     {
     case PCB_FP_TEXT_T:
@@ -494,6 +574,8 @@ void FOOTPRINT::Add( BOARD_ITEM* aBoardItem, ADD_MODE aMode )
 
 void FOOTPRINT::Remove( BOARD_ITEM* aBoardItem )
 {
+    loadBody();
+
     switch( aBoardItem->Type() )
     {
     case PCB_FP_TEXT_T:
@@ -570,6 +652,8 @@ void FOOTPRINT::CalculateBoundingBox()
 
 double FOOTPRINT::GetArea( int aPadding ) const
 {
+    loadBody();
+
     double w = std::abs( static_cast<double>( m_boundingBox.GetWidth() ) ) + aPadding;
     double h = std::abs( static_cast<double>( m_boundingBox.GetHeight() ) ) + aPadding;
     return w * h;
@@ -578,6 +662,8 @@ double FOOTPRINT::GetArea( int aPadding ) const
 
 EDA_RECT FOOTPRINT::GetFootprintRect() const
 {
+    loadBody();
+
     EDA_RECT area;
 
     area.SetOrigin( m_pos );
@@ -724,6 +810,8 @@ SHAPE_POLY_SET FOOTPRINT::GetBoundingPoly() const
 
 void FOOTPRINT::GetMsgPanelInfo( EDA_DRAW_FRAME* aFrame, std::vector<MSG_PANEL_ITEM>& aList )
 {
+    loadBody();
+
     wxString msg, msg2;
 
     aList.emplace_back( m_reference->GetShownText(), m_value->GetShownText(), DARKCYAN );
@@ -792,6 +880,8 @@ void FOOTPRINT::GetMsgPanelInfo( EDA_DRAW_FRAME* aFrame, std::vector<MSG_PANEL_I
 
 bool FOOTPRINT::HitTest( const wxPoint& aPosition, int aAccuracy ) const
 {
+    loadBody();
+
     EDA_RECT rect = m_boundingBox;//.GetBoundingBoxRotated( GetPosition(), m_Orient );
     return rect.Inflate( aAccuracy ).Contains( aPosition );
 }
@@ -805,6 +895,8 @@ bool FOOTPRINT::HitTestAccurate( const wxPoint& aPosition, int aAccuracy ) const
 
 bool FOOTPRINT::HitTest( const EDA_RECT& aRect, bool aContained, int aAccuracy ) const
 {
+    loadBody();
+
     EDA_RECT arect = aRect;
     arect.Inflate( aAccuracy );
 
@@ -944,6 +1036,8 @@ unsigned FOOTPRINT::GetUniquePadCount( INCLUDE_NPTH_T aIncludeNPTH ) const
 
 void FOOTPRINT::Add3DModel( FP_3DMODEL* a3DModel )
 {
+    loadBody();
+
     if( NULL == a3DModel )
         return;
 
@@ -957,6 +1051,8 @@ void FOOTPRINT::Add3DModel( FP_3DMODEL* a3DModel )
 // see footprint.h
 SEARCH_RESULT FOOTPRINT::Visit( INSPECTOR inspector, void* testData, const KICAD_T scanTypes[] )
 {
+    loadBody();
+
     KICAD_T        stype;
     SEARCH_RESULT  result = SEARCH_RESULT::CONTINUE;
     const KICAD_T* p    = scanTypes;
@@ -1065,6 +1161,8 @@ EDA_ITEM* FOOTPRINT::Clone() const
 
 void FOOTPRINT::RunOnChildren( const std::function<void ( BOARD_ITEM*)>& aFunction ) const
 {
+    loadBody();
+
     try
     {
         for( PAD* pad : m_pads )
@@ -1091,6 +1189,8 @@ void FOOTPRINT::RunOnChildren( const std::function<void ( BOARD_ITEM*)>& aFuncti
 
 void FOOTPRINT::GetAllDrawingLayers( int aLayers[], int& aCount, bool aIncludePads ) const
 {
+    loadBody();
+
     std::unordered_set<int> layers;
 
     for( BOARD_ITEM* item : m_drawings )
@@ -1118,6 +1218,8 @@ void FOOTPRINT::GetAllDrawingLayers( int aLayers[], int& aCount, bool aIncludePa
 
 void FOOTPRINT::ViewGetLayers( int aLayers[], int& aCount ) const
 {
+    loadBody();
+
     aCount = 2;
     aLayers[0] = LAYER_ANCHOR;
 
@@ -1235,6 +1337,8 @@ void FOOTPRINT::Move( const wxPoint& aMoveVector )
 
 void FOOTPRINT::Rotate( const wxPoint& aRotCentre, double aAngle )
 {
+    loadBody();
+
     double  orientation = GetOrientation();
     double  newOrientation = orientation + aAngle;
     wxPoint newpos = m_pos;
@@ -1257,6 +1361,8 @@ void FOOTPRINT::Rotate( const wxPoint& aRotCentre, double aAngle )
 
 void FOOTPRINT::Flip( const wxPoint& aCentre, bool aFlipLeftRight )
 {
+    loadBody();
+
     // Move footprint to its final position:
     wxPoint finalPos = m_pos;
 
@@ -1322,6 +1428,8 @@ void FOOTPRINT::Flip( const wxPoint& aCentre, bool aFlipLeftRight )
 
 void FOOTPRINT::SetPosition( const wxPoint& aPos )
 {
+    loadBody();
+
     wxPoint delta = aPos - m_pos;
 
     m_pos += delta;
@@ -1422,6 +1530,8 @@ void FOOTPRINT::MoveAnchorPosition( const wxPoint& aMoveVector )
 
 void FOOTPRINT::SetOrientation( double aNewAngle )
 {
+    loadBody();
+
     double angleChange = aNewAngle - m_orient;  // change in rotation
 
     NORMALIZE_ANGLE_180( aNewAngle );
@@ -39,6 +39,7 @@
 #include <convert_drawsegment_list_to_polygon.h>
 #include <fp_text.h>
 #include <zone.h>
+#include <atomic>
 #include <functional>
 
 class LINE_READER;
@@ -182,8 +183,8 @@ public:
     PADS& Pads()             { return m_pads; }
     const PADS& Pads() const { return m_pads; }
 
-    DRAWINGS& GraphicalItems()             { return m_drawings; }
-    const DRAWINGS& GraphicalItems() const { return m_drawings; }
+    DRAWINGS& GraphicalItems()             { loadBody(); return m_drawings; }
+    const DRAWINGS& GraphicalItems() const { loadBody(); return m_drawings; }
 
     FP_ZONES& Zones()             { return m_fp_zones; }
     const FP_ZONES& Zones() const { return m_fp_zones; }
@@ -193,8 +194,29 @@ public:
 
     bool HasThroughHolePads() const;
 
-    std::list<FP_3DMODEL>& Models()             { return m_3D_Drawings; }
-    const std::list<FP_3DMODEL>& Models() const { return m_3D_Drawings; }
+    std::list<FP_3DMODEL>& Models()             { loadBody(); return m_3D_Drawings; }
+    const std::list<FP_3DMODEL>& Models() const { loadBody(); return m_3D_Drawings; }
+
+    /**
+     * Defers the graphic items and 3D models of the footprint until they are first needed.
+     * @a aLoader is then called once, from whichever thread needs them, to add them to the
+     * footprint; until then the footprint has only its pads, zones, groups, reference and
+     * value.  Used to enumerate large footprint libraries quickly.
+     */
+    void SetDeferredBody( std::function<void( FOOTPRINT* )> aLoader );
+
+    /**
+     * @return true if the graphic items and 3D models of the footprint are not loaded yet.
+     */
+    bool HasDeferredBody() const { return m_hasDeferredBody.load( std::memory_order_acquire ); }
+
+    /**
+     * Loads the deferred graphic items and 3D models now, if any, rather than when they are
+     * first used, where parse errors can only be logged.
+     *
+     * @throw IO_ERROR if they cannot be parsed; the items before the error are kept.
+     */
+    void LoadDeferredBody() const;
 
     void SetPosition( const wxPoint& aPos ) override;
     wxPoint GetPosition() const override { return m_pos; }
@@ -692,6 +714,18 @@ public:
 #endif
 
 private:
+    /**
+     * Loads the deferred graphic items and 3D models, if any, and logs parse errors.
+     * Everything using m_drawings or m_3D_Drawings calls this first.
+     */
+    void loadBody() const
+    {
+        if( HasDeferredBody() )
+            loadDeferredBody();
+    }
+
+    void loadDeferredBody() const;
+
     DRAWINGS        m_drawings;          // BOARD_ITEMs for drawings on the board, owned by pointer.
     PADS            m_pads;              // PAD items, owned by pointer
     FP_ZONES        m_fp_zones;          // FP_ZONE items, owned by pointer
@@ -730,6 +764,9 @@ private:
 
     SHAPE_POLY_SET  m_poly_courtyard_front;  // Note that a footprint can have both front and back
     SHAPE_POLY_SET  m_poly_courtyard_back;   // courtyards populated.
+
+    mutable std::function<void( FOOTPRINT* )> m_deferredBody;     // see SetDeferredBody()
+    mutable std::atomic<bool>                 m_hasDeferredBody { false };
 };
 
 #endif     // FOOTPRINT_H
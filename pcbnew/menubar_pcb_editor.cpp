@@ -352,6 +352,7 @@ void PCB_EDIT_FRAME::ReCreateMenuBar()
     routeMenu->Add( PCB_ACTIONS::routerTuneSingleTrace );
     routeMenu->Add( PCB_ACTIONS::routerTuneDiffPair );
     routeMenu->Add( PCB_ACTIONS::routerTuneDiffPairSkew );
+    routeMenu->Add( PCB_ACTIONS::routerTuneSelectedNets );
 
     routeMenu->AppendSeparator();
     routeMenu->Add( PCB_ACTIONS::routerSettingsDialog );
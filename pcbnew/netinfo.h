@@ -485,10 +485,9 @@ public:
     ///> board storing net list available.
     static NETINFO_ITEM* OrphanedItem()
     {
-        static NETINFO_ITEM* g_orphanedItem;
-
-        if( !g_orphanedItem )
-            g_orphanedItem = new NETINFO_ITEM( nullptr, wxEmptyString, NETINFO_LIST::UNCONNECTED );
+        // Initialized once even when items are first created on several threads
+        static NETINFO_ITEM* g_orphanedItem =
+                new NETINFO_ITEM( nullptr, wxEmptyString, NETINFO_LIST::UNCONNECTED );
 
         return g_orphanedItem;
     }
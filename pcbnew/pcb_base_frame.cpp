@@ -68,6 +68,10 @@ PCB_BASE_FRAME::~PCB_BASE_FRAME()
     // Ensure m_canvasType is up to date, to save it in config
     m_canvasType = GetCanvas()->GetBackend();
 
+    // Delete the tools before the board: some of them (the router) listen to it
+    delete m_toolManager;
+    m_toolManager = nullptr;
+
     delete m_pcb;
 }
 
@@ -46,6 +46,7 @@
 #include <convert_basic_shapes_to_polygon.h>
 #include <gal/graphics_abstraction_layer.h>
 #include <geometry/geometry_utils.h>
+#include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_rect.h>
 #include <geometry/shape_segment.h>
@@ -964,6 +965,7 @@ void PCB_PAINTER::draw( const PAD* aPad, int aLayer )
             switch( shape->Type() )
             {
             case SH_SEGMENT:
+            case SH_ARC:
             case SH_CIRCLE:
             case SH_RECT:
             case SH_SIMPLE:
@@ -991,6 +993,18 @@ void PCB_PAINTER::draw( const PAD* aPad, int aLayer )
                 }
                     break;
 
+                case SH_ARC:
+                {
+                    const SHAPE_ARC* arc = (SHAPE_ARC*) shape;
+                    double start_angle = DEG2RAD( arc->GetStartAngle() );
+                    double angle = DEG2RAD( arc->GetCentralAngle() );
+
+                    m_gal->DrawArcSegment( arc->GetCenter(), arc->GetRadius(), start_angle,
+                                           start_angle + angle,
+                                           arc->GetWidth() + 2 * margin.x );
+                }
+                    break;
+
                 case SH_CIRCLE:
                 {
                     const SHAPE_CIRCLE* circle = (SHAPE_CIRCLE*) shape;
@@ -1060,18 +1060,9 @@ std::vector<SHAPE*> PCB_SHAPE::MakeEffectiveShapes() const
     switch( m_shape )
     {
     case S_ARC:
-    {
-        SHAPE_ARC        arc( GetCenter(), GetArcStart(), (double) GetAngle() / 10.0 );
-        SHAPE_LINE_CHAIN l = arc.ConvertToPolyline();
-
-        for( int i = 0; i < l.SegmentCount(); i++ )
-        {
-            effectiveShapes.emplace_back( new SHAPE_SEGMENT( l.Segment( i ).A,
-                                                             l.Segment( i ).B, m_width ) );
-        }
-
+        effectiveShapes.emplace_back( new SHAPE_ARC( GetCenter(), GetArcStart(),
+                                                     (double) GetAngle() / 10.0, m_width ) );
         break;
-    }
 
     case S_SEGMENT:
         effectiveShapes.emplace_back( new SHAPE_SEGMENT( GetStart(), GetEnd(), m_width ) );
@@ -1105,15 +1096,12 @@ std::vector<SHAPE*> PCB_SHAPE::MakeEffectiveShapes() const
 
         if( m_width > 0 || !IsFilled() )
         {
-            // SHAPE_CIRCLE has no ConvertToPolyline() method, so use a 360.0 SHAPE_ARC
-            SHAPE_ARC        circle( GetCenter(), GetEnd(), 360.0 );
-            SHAPE_LINE_CHAIN l = circle.ConvertToPolyline();
+            // SHAPE_CIRCLE is solid, so the outline is made of two half circle arcs
+            SHAPE_ARC* half = new SHAPE_ARC( GetCenter(), GetEnd(), 180.0, m_width );
 
-            for( int i = 0; i < l.SegmentCount(); i++ )
-            {
-                effectiveShapes.emplace_back( new SHAPE_SEGMENT( l.Segment( i ).A,
-                                                                 l.Segment( i ).B, m_width ) );
-            }
+            effectiveShapes.emplace_back( half );
+            effectiveShapes.emplace_back( new SHAPE_ARC( GetCenter(), half->GetP1(), 180.0,
+                                                         m_width ) );
         }
 
         break;
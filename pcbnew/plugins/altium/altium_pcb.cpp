@@ -39,8 +39,14 @@
 #include <board_stackup_manager/stackup_predefined_prms.h>
 
 #include <compoundfilereader.h>
+#include <condition_variable>
 #include <convert_basic_shapes_to_polygon.h>
+#include <core/optional.h>
+#include <deque>
+#include <future>
+#include <mutex>
 #include <project.h>
+#include <richio.h>
 #include <trigo.h>
 #include <utf.h>
 #include <wx/docview.h>
@@ -52,38 +58,23 @@
 void ParseAltiumPcb( BOARD* aBoard, const wxString& aFileName,
                      const std::map<ALTIUM_PCB_DIR, std::string>& aFileMapping )
 {
-    // Open file
-    FILE* fp = wxFopen( aFileName, "rb" );
+    // Map the file: the compound file reader needs random access to its sectors, but only
+    // the pages of the streams being read have to be in memory
+    std::unique_ptr<MAPPED_FILE_LINE_READER> file;
 
-    if( fp == nullptr )
-    {
-        wxLogError( wxString::Format( _( "Cannot open file '%s'" ), aFileName ) );
-        return;
-    }
-
-    fseek( fp, 0, SEEK_END );
-    long len = ftell( fp );
-
-    if( len < 0 )
+    try
     {
-        fclose( fp );
-        THROW_IO_ERROR( "Reading error, cannot determine length of file" );
+        file = std::make_unique<MAPPED_FILE_LINE_READER>( aFileName );
     }
-
-    std::unique_ptr<unsigned char[]> buffer( new unsigned char[len] );
-    fseek( fp, 0, SEEK_SET );
-
-    size_t bytesRead = fread( buffer.get(), sizeof( unsigned char ), len, fp );
-    fclose( fp );
-
-    if( static_cast<size_t>( len ) != bytesRead )
+    catch( const IO_ERROR& )
     {
-        THROW_IO_ERROR( "Reading error" );
+        wxLogError( wxString::Format( _( "Cannot open file '%s'" ), aFileName ) );
+        return;
     }
 
     try
     {
-        CFB::CompoundFileReader reader( buffer.get(), bytesRead );
+        CFB::CompoundFileReader reader( file->Data(), file->Size() );
 
         // Parse File
         ALTIUM_PCB pcb( aBoard );
@@ -303,9 +294,207 @@ ALTIUM_PCB::~ALTIUM_PCB()
 {
 }
 
+
+/**
+ * Decodes the records of a binary stream on a worker thread, while ALTIUM_PCB::Parse() builds
+ * the board from the records already decoded.  The decoding waits while MAX_BATCHES batches of
+ * records are queued, so that the records of a stream are never all in memory at once.
+ */
+template <typename RECORD>
+class ALTIUM_RECORD_QUEUE
+{
+public:
+    /**
+     * Start decoding the stream.
+     *
+     * @param aEntry is the stream to decode, or nullptr if the file has no such stream.
+     * @param aStreamName is used in the error message when the stream is not fully parsed.
+     */
+    ALTIUM_RECORD_QUEUE( const CFB::CompoundFileReader& aReader,
+                         const CFB::COMPOUND_FILE_ENTRY* aEntry, const char* aStreamName ) :
+            m_next( 0 ),
+            m_done( false ),
+            m_cancelled( false )
+    {
+        m_decoder = std::async( std::launch::async,
+                                [this, &aReader, aEntry, aStreamName]()
+                                {
+                                    decode( aReader, aEntry, aStreamName );
+                                } );
+    }
+
+    ~ALTIUM_RECORD_QUEUE()
+    {
+        // The records are not all used when another stream fails to parse
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_cancelled = true;
+        }
+
+        m_changed.notify_all();
+        m_decoder.wait();
+    }
+
+    /**
+     * Wait for the next record of the stream.
+     *
+     * @return the record, or nothing at the end of the stream.
+     * @throw IO_ERROR if the stream could not be decoded.
+     */
+    OPT<RECORD> Pop()
+    {
+        if( m_next == m_current.size() )
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+
+            m_changed.wait( lock,
+                            [this]()
+                            {
+                                return !m_batches.empty() || m_done;
+                            } );
+
+            if( m_batches.empty() )
+            {
+                if( m_error )
+                    std::rethrow_exception( m_error );
+
+                return NULLOPT;
+            }
+
+            m_current = std::move( m_batches.front() );
+            m_next = 0;
+            m_batches.pop_front();
+            m_changed.notify_all();
+        }
+
+        return OPT<RECORD>( std::move( m_current[m_next++] ) );
+    }
+
+private:
+    void decode( const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry,
+                 const char* aStreamName )
+    {
+        try
+        {
+            if( aEntry )
+            {
+                ALTIUM_PARSER       reader( aReader, aEntry );
+                std::vector<RECORD> batch;
+
+                while( reader.GetRemainingBytes() >= 4 /* TODO: use Header section of file */ )
+                {
+                    batch.emplace_back( reader );
+
+                    if( batch.size() == BATCH_SIZE || reader.GetRemainingBytes() < 4 )
+                    {
+                        if( !queue( batch ) )
+                            return;
+                    }
+                }
+
+                if( reader.GetRemainingBytes() != 0 )
+                {
+                    THROW_IO_ERROR( wxString::Format( "%s stream is not fully parsed",
+                                                      aStreamName ) );
+                }
+            }
+        }
+        catch( ... )
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_done = true;
+        }
+
+        m_changed.notify_all();
+    }
+
+    /**
+     * Wait for room in the queue and move \a aBatch to it.
+     *
+     * @return false if the records are not needed anymore.
+     */
+    bool queue( std::vector<RECORD>& aBatch )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        m_changed.wait( lock,
+                        [this]()
+                        {
+                            return m_batches.size() < MAX_BATCHES || m_cancelled;
+                        } );
+
+        if( m_cancelled )
+            return false;
+
+        m_batches.push_back( std::move( aBatch ) );
+        aBatch.clear();
+        m_changed.notify_all();
+
+        return true;
+    }
+
+    ///< Records are queued by batches, to keep the locking out of the way
+    static constexpr size_t BATCH_SIZE = 256;
+
+    ///< The number of batches the decoding gets ahead of the board construction
+    static constexpr size_t MAX_BATCHES = 4;
+
+    std::vector<RECORD> m_current;      ///< the batch being used by Pop()
+    size_t              m_next;         ///< the index of the next record of m_current
+
+    std::mutex                      m_mutex;
+    std::condition_variable         m_changed;   ///< a batch was queued or used, or the
+                                                 ///< decoding ended
+    std::deque<std::vector<RECORD>> m_batches;
+    bool                            m_done;
+    bool                            m_cancelled; ///< the records are not needed anymore
+    std::exception_ptr              m_error;     ///< why the decoding stopped, if it failed
+    std::future<void>               m_decoder;
+};
+
+
+/**
+ * Start decoding the records of a stream on a worker thread.
+ */
+template <typename RECORD>
+static std::unique_ptr<ALTIUM_RECORD_QUEUE<RECORD>> decodeRecords(
+        const CFB::CompoundFileReader&               aReader,
+        const std::map<ALTIUM_PCB_DIR, std::string>& aFileMapping, ALTIUM_PCB_DIR aDirectory,
+        const char* aStreamName )
+{
+    const CFB::COMPOUND_FILE_ENTRY* file = nullptr;
+    const auto&                     mappedDirectory = aFileMapping.find( aDirectory );
+
+    // A missing stream is reported by ALTIUM_PCB::Parse() when its turn comes
+    if( mappedDirectory != aFileMapping.end() )
+        file = FindStream( aReader, mappedDirectory->second.c_str() );
+
+    return std::make_unique<ALTIUM_RECORD_QUEUE<RECORD>>( aReader, file, aStreamName );
+}
+
+
 void ALTIUM_PCB::Parse( const CFB::CompoundFileReader& aReader,
                         const std::map<ALTIUM_PCB_DIR, std::string>&   aFileMapping )
 {
+    // The records of these streams depend neither on each other nor on the board, so they are
+    // decoded on worker threads, ahead of their use.  The board itself is only ever changed
+    // from this thread, in the order below.
+    std::unique_ptr<ALTIUM_RECORD_QUEUE<APOLYGON6>> polygons = decodeRecords<APOLYGON6>(
+            aReader, aFileMapping, ALTIUM_PCB_DIR::POLYGONS6, "Polygons6" );
+    std::unique_ptr<ALTIUM_RECORD_QUEUE<AARC6>> arcs = decodeRecords<AARC6>(
+            aReader, aFileMapping, ALTIUM_PCB_DIR::ARCS6, "Arcs6" );
+    std::unique_ptr<ALTIUM_RECORD_QUEUE<APAD6>> pads = decodeRecords<APAD6>(
+            aReader, aFileMapping, ALTIUM_PCB_DIR::PADS6, "Pads6" );
+    std::unique_ptr<ALTIUM_RECORD_QUEUE<AVIA6>> vias = decodeRecords<AVIA6>(
+            aReader, aFileMapping, ALTIUM_PCB_DIR::VIAS6, "Vias6" );
+    std::unique_ptr<ALTIUM_RECORD_QUEUE<ATRACK6>> tracks = decodeRecords<ATRACK6>(
+            aReader, aFileMapping, ALTIUM_PCB_DIR::TRACKS6, "Tracks6" );
+
     // this vector simply declares in which order which functions to call.
     const std::vector<std::tuple<bool, ALTIUM_PCB_DIR, PARSE_FUNCTION_POINTER_fp>> parserOrder = {
         { true, ALTIUM_PCB_DIR::FILE_HEADER,
@@ -347,24 +536,24 @@ void ALTIUM_PCB::Parse( const CFB::CompoundFileReader& aReader,
                     this->ParseDimensions6Data( aReader, fileHeader );
                 } },
         { true, ALTIUM_PCB_DIR::POLYGONS6,
-                [this]( auto aReader, auto fileHeader ) {
-                    this->ParsePolygons6Data( aReader, fileHeader );
+                [this, &polygons]( auto aReader, auto fileHeader ) {
+                    this->ParsePolygons6Data( *polygons );
                 } },
         { true, ALTIUM_PCB_DIR::ARCS6,
-                [this]( auto aReader, auto fileHeader ) {
-                    this->ParseArcs6Data( aReader, fileHeader );
+                [this, &arcs]( auto aReader, auto fileHeader ) {
+                    this->ParseArcs6Data( *arcs );
                 } },
         { true, ALTIUM_PCB_DIR::PADS6,
-                [this]( auto aReader, auto fileHeader ) {
-                    this->ParsePads6Data( aReader, fileHeader );
+                [this, &pads]( auto aReader, auto fileHeader ) {
+                    this->ParsePads6Data( *pads );
                 } },
         { true, ALTIUM_PCB_DIR::VIAS6,
-                [this]( auto aReader, auto fileHeader ) {
-                    this->ParseVias6Data( aReader, fileHeader );
+                [this, &vias]( auto aReader, auto fileHeader ) {
+                    this->ParseVias6Data( *vias );
                 } },
         { true, ALTIUM_PCB_DIR::TRACKS6,
-                [this]( auto aReader, auto fileHeader ) {
-                    this->ParseTracks6Data( aReader, fileHeader );
+                [this, &tracks]( auto aReader, auto fileHeader ) {
+                    this->ParseTracks6Data( *tracks );
                 } },
         { true, ALTIUM_PCB_DIR::TEXTS6,
                 [this]( auto aReader, auto fileHeader ) {
@@ -1193,14 +1382,11 @@ void ALTIUM_PCB::ParseNets6Data( const CFB::CompoundFileReader& aReader,
     }
 }
 
-void ALTIUM_PCB::ParsePolygons6Data( const CFB::CompoundFileReader& aReader,
-                                     const CFB::COMPOUND_FILE_ENTRY* aEntry )
+void ALTIUM_PCB::ParsePolygons6Data( ALTIUM_RECORD_QUEUE<APOLYGON6>& aPolygons )
 {
-    ALTIUM_PARSER reader( aReader, aEntry );
-
-    while( reader.GetRemainingBytes() >= 4 /* TODO: use Header section of file */ )
+    while( OPT<APOLYGON6> record = aPolygons.Pop() )
     {
-        APOLYGON6 elem( reader );
+        const APOLYGON6& elem = *record;
 
         PCB_LAYER_ID klayer = GetKicadLayer( elem.layer );
         if( klayer == UNDEFINED_LAYER )
@@ -1314,11 +1500,6 @@ void ALTIUM_PCB::ParsePolygons6Data( const CFB::CompoundFileReader& aReader,
         zone->SetBorderDisplayStyle( ZONE_BORDER_DISPLAY_STYLE::DIAGONAL_EDGE,
                                      ZONE::GetDefaultHatchPitch(), true );
     }
-
-    if( reader.GetRemainingBytes() != 0 )
-    {
-        THROW_IO_ERROR( "Polygons6 stream is not fully parsed" );
-    }
 }
 
 void ALTIUM_PCB::ParseRules6Data( const CFB::CompoundFileReader& aReader,
@@ -1534,14 +1715,11 @@ void ALTIUM_PCB::ParseRegions6Data( const CFB::CompoundFileReader& aReader,
 }
 
 
-void ALTIUM_PCB::ParseArcs6Data( const CFB::CompoundFileReader& aReader,
-                                 const CFB::COMPOUND_FILE_ENTRY* aEntry )
+void ALTIUM_PCB::ParseArcs6Data( ALTIUM_RECORD_QUEUE<AARC6>& aArcs )
 {
-    ALTIUM_PARSER reader( aReader, aEntry );
-
-    while( reader.GetRemainingBytes() >= 4 /* TODO: use Header section of file */ )
+    while( OPT<AARC6> record = aArcs.Pop() )
     {
-        AARC6 elem( reader );
+        const AARC6& elem = *record;
 
         if( elem.is_polygonoutline || elem.subpolyindex != ALTIUM_POLYGON_NONE )
             continue;
@@ -1660,22 +1838,14 @@ void ALTIUM_PCB::ParseArcs6Data( const CFB::CompoundFileReader& aReader,
             HelperDrawsegmentSetLocalCoord( shape, elem.component );
         }
     }
-
-    if( reader.GetRemainingBytes() != 0 )
-    {
-        THROW_IO_ERROR( "Arcs6 stream is not fully parsed" );
-    }
 }
 
 
-void ALTIUM_PCB::ParsePads6Data( const CFB::CompoundFileReader& aReader,
-                                 const CFB::COMPOUND_FILE_ENTRY* aEntry )
+void ALTIUM_PCB::ParsePads6Data( ALTIUM_RECORD_QUEUE<APAD6>& aPads )
 {
-    ALTIUM_PARSER reader( aReader, aEntry );
-
-    while( reader.GetRemainingBytes() >= 4 /* TODO: use Header section of file */ )
+    while( OPT<APAD6> record = aPads.Pop() )
     {
-        APAD6 elem( reader );
+        const APAD6& elem = *record;
 
         // It is possible to place altium pads on non-copper layers -> we need to interpolate them using drawings!
         if( !IsAltiumLayerCopper( elem.layer ) && !IsAltiumLayerAPlane( elem.layer )
@@ -1880,11 +2050,6 @@ void ALTIUM_PCB::ParsePads6Data( const CFB::CompoundFileReader& aReader,
             pad->SetLayerSet( pad->GetLayerSet().reset( B_Mask ) );
         }
     }
-
-    if( reader.GetRemainingBytes() != 0 )
-    {
-        THROW_IO_ERROR( "Pads6 stream is not fully parsed" );
-    }
 }
 
 
@@ -2076,14 +2241,11 @@ void ALTIUM_PCB::HelperParsePad6NonCopper( const APAD6& aElem )
     }
 }
 
-void ALTIUM_PCB::ParseVias6Data( const CFB::CompoundFileReader& aReader,
-                                 const CFB::COMPOUND_FILE_ENTRY* aEntry )
+void ALTIUM_PCB::ParseVias6Data( ALTIUM_RECORD_QUEUE<AVIA6>& aVias )
 {
-    ALTIUM_PARSER reader( aReader, aEntry );
-
-    while( reader.GetRemainingBytes() >= 4 /* TODO: use Header section of file */ )
+    while( OPT<AVIA6> record = aVias.Pop() )
     {
-        AVIA6 elem( reader );
+        const AVIA6& elem = *record;
 
         VIA* via = new VIA( m_board );
         m_board->Add( via, ADD_MODE::APPEND );
@@ -2125,21 +2287,13 @@ void ALTIUM_PCB::ParseVias6Data( const CFB::CompoundFileReader& aReader,
         // we need VIATYPE set!
         via->SetLayerPair( start_klayer, end_klayer );
     }
-
-    if( reader.GetRemainingBytes() != 0 )
-    {
-        THROW_IO_ERROR( "Vias6 stream is not fully parsed" );
-    }
 }
 
-void ALTIUM_PCB::ParseTracks6Data( const CFB::CompoundFileReader& aReader,
-                                   const CFB::COMPOUND_FILE_ENTRY* aEntry )
+void ALTIUM_PCB::ParseTracks6Data( ALTIUM_RECORD_QUEUE<ATRACK6>& aTracks )
 {
-    ALTIUM_PARSER reader( aReader, aEntry );
-
-    while( reader.GetRemainingBytes() >= 4 /* TODO: use Header section of file */ )
+    while( OPT<ATRACK6> record = aTracks.Pop() )
     {
-        ATRACK6 elem( reader );
+        const ATRACK6& elem = *record;
 
         if( elem.is_polygonoutline || elem.subpolyindex != ALTIUM_POLYGON_NONE )
             continue;
@@ -2223,13 +2377,6 @@ void ALTIUM_PCB::ParseTracks6Data( const CFB::CompoundFileReader& aReader,
             shape->SetLayer( klayer );
             HelperDrawsegmentSetLocalCoord( shape, elem.component );
         }
-
-        reader.SkipSubrecord();
-    }
-
-    if( reader.GetRemainingBytes() != 0 )
-    {
-        THROW_IO_ERROR( "Tracks6 stream is not fully parsed" );
     }
 }
 
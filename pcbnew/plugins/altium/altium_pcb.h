@@ -104,6 +104,10 @@ class CompoundFileReader;
 struct COMPOUND_FILE_ENTRY;
 } // namespace CFB
 
+// the records of a binary stream, decoded on a worker thread
+template <typename RECORD>
+class ALTIUM_RECORD_QUEUE;
+
 
 // type declaration required for a helper method
 class ALTIUM_PCB;
@@ -142,22 +146,17 @@ private:
             const CFB::COMPOUND_FILE_ENTRY* aEntry, const wxString aRootDir );
     void ParseNets6Data(
             const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
-    void ParsePolygons6Data(
-            const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
+    void ParsePolygons6Data( ALTIUM_RECORD_QUEUE<APOLYGON6>& aPolygons );
     void ParseRules6Data(
             const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
 
     // Binary Format
-    void ParseArcs6Data(
-            const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
+    void ParseArcs6Data( ALTIUM_RECORD_QUEUE<AARC6>& aArcs );
     void ParseComponentsBodies6Data(
             const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
-    void ParsePads6Data(
-            const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
-    void ParseVias6Data(
-            const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
-    void ParseTracks6Data(
-            const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
+    void ParsePads6Data( ALTIUM_RECORD_QUEUE<APAD6>& aPads );
+    void ParseVias6Data( ALTIUM_RECORD_QUEUE<AVIA6>& aVias );
+    void ParseTracks6Data( ALTIUM_RECORD_QUEUE<ATRACK6>& aTracks );
     void ParseTexts6Data(
             const CFB::CompoundFileReader& aReader, const CFB::COMPOUND_FILE_ENTRY* aEntry );
     void ParseFills6Data(
@@ -50,7 +50,10 @@ Load() TODO's
 
 */
 
+#include <atomic>
 #include <cerrno>
+#include <future>
+#include <thread>
 
 #include <wx/string.h>
 #include <wx/xml/xml.h>
@@ -470,6 +473,14 @@ void EAGLE_PLUGIN::loadAllSections( wxXmlNode* aDoc )
         wxXmlNode*  libs = boardChildren["libraries"];
         loadLibraries( libs );
 
+        // The packages now live in m_templates; free their XML before the elements are
+        // copied from them to keep the peak memory of big imports down.
+        if( libs )
+        {
+            libs->GetParent()->RemoveChild( libs );
+            delete libs;
+        }
+
         wxXmlNode* elems = boardChildren["elements"];
         loadElements( elems );
 
@@ -919,24 +930,77 @@ void EAGLE_PLUGIN::loadLibrary( wxXmlNode* aLib, const wxString* aLibName )
     // to instantiate needed footprints in our BOARD.  Save the FOOTPRINT templates in
     // a FOOTPRINT_MAP using a single lookup key consisting of libname+pkgname.
 
-    // Get the first package and iterate
-    wxXmlNode* package = packages->GetChildren();
+    // The packages do not depend on each other, so they are converted on worker threads and
+    // added to the map afterwards, in file order.
+    std::vector<wxXmlNode*> packageNodes;
+
+    for( wxXmlNode* package = packages->GetChildren(); package; package = package->GetNext() )
+        packageNodes.push_back( package );
+
+    std::vector<wxString>                   packageRefs( packageNodes.size() );
+    std::vector<std::unique_ptr<FOOTPRINT>> footprints( packageNodes.size() );
+    std::vector<std::exception_ptr>         errors( packageNodes.size() );
+    std::atomic<size_t>                     nextPackage( 0 );
+
+    auto convert_lambda =
+            [&]() -> size_t
+            {
+                size_t num = 0;
+
+                for( size_t i = nextPackage++; i < packageNodes.size(); i = nextPackage++ )
+                {
+                    packageRefs[i] = packageNodes[i]->GetAttribute( "name" );
+                    ReplaceIllegalFileNameChars( packageRefs[i], '_' );
+
+                    try
+                    {
+                        footprints[i].reset( makeFootprint( packageNodes[i], packageRefs[i] ) );
+                    }
+                    catch( ... )
+                    {
+                        errors[i] = std::current_exception();
+                    }
+
+                    num++;
+                }
 
-    while( package )
+                return num;
+            };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   packageNodes.size() );
+
+    if( parallelThreadCount <= 1 )
+    {
+        convert_lambda();
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, convert_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    for( size_t i = 0; i < packageNodes.size(); i++ )
     {
         m_xpath->push( "package", "name" );
 
-        wxString pack_ref = package->GetAttribute( "name" );
-        ReplaceIllegalFileNameChars( pack_ref, '_' );
+        const wxString& pack_ref = packageRefs[i];
 
         m_xpath->Value( pack_ref.ToUTF8() );
 
-        wxString key = aLibName ? makeKey( *aLibName, pack_ref ) : pack_ref;
+        if( errors[i] )
+            std::rethrow_exception( errors[i] );
 
-        FOOTPRINT* m = makeFootprint( package, pack_ref );
+        wxString key = aLibName ? makeKey( *aLibName, pack_ref ) : pack_ref;
 
         // add the templating FOOTPRINT to the FOOTPRINT template factory "m_templates"
-        std::pair<FOOTPRINT_MAP::iterator, bool> r = m_templates.insert( {key, m} );
+        std::pair<FOOTPRINT_MAP::iterator, bool> r = m_templates.insert( { key,
+                                                                            footprints[i].get() } );
 
         if( !r.second /* && !( m_props && m_props->Value( "ignore_duplicates" ) ) */ )
         {
@@ -948,9 +1012,9 @@ void EAGLE_PLUGIN::loadLibrary( wxXmlNode* aLib, const wxString* aLibName )
             THROW_IO_ERROR( emsg );
         }
 
-        m_xpath->pop();
+        footprints[i].release();
 
-        package = package->GetNext();
+        m_xpath->pop();
     }
 
     m_xpath->pop();     // "packages"
@@ -1676,8 +1740,11 @@ void EAGLE_PLUGIN::packagePad( FOOTPRINT* aFootprint, wxXmlNode* aTree )
     pad->SetDrillSize( wxSize( eagleDrillz, eagleDrillz ) );
     pad->SetLayerSet( LSET::AllCuMask() );
 
-    if( eagleDrillz < m_min_hole )
-        m_min_hole = eagleDrillz;
+    // Pads are made on several threads by loadLibrary()
+    int minHole = m_min_hole;
+
+    while( eagleDrillz < minHole && !m_min_hole.compare_exchange_weak( minHole, eagleDrillz ) )
+        ;
 
     // Solder mask
     if( !e.stop || *e.stop == true )         // enabled by default
@@ -30,6 +30,7 @@
 #include <plugins/eagle/eagle_parser.h>
 #include <plugins/common/plugin_common_layer_mapping.h>
 
+#include <atomic>
 #include <map>
 #include <tuple>
 #include <wx/xml/xml.h>
@@ -205,7 +206,7 @@ private:
     BOARD*      m_board;            ///< which BOARD is being worked on, no ownership here
 
     int         m_min_trace;        ///< smallest trace we find on Load(), in BIU.
-    int         m_min_hole;         ///< smallest diameter hole we find on Load(), in BIU.
+    std::atomic<int> m_min_hole;    ///< smallest diameter hole we find on Load(), in BIU.
     int         m_min_via;          ///< smallest via we find on Load(), in BIU.
     int         m_min_annulus;      ///< smallest via annulus we find on Load(), in BIU.
 
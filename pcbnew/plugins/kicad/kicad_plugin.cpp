@@ -48,9 +48,39 @@
 #include <kiface_i.h>
 #include <wx_filename.h>
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <thread>
+
 using namespace PCB_KEYS_T;
 
 
+/**
+ * Write a polygon point as "(xy x y)", preceded by a space if \a aSeparate.  Polygon points
+ * are the bulk of a board file, so they skip the printf() formatting of Print().
+ */
+static void formatXY( OUTPUTFORMATTER* aOut, int aNestLevel, bool aSeparate,
+                      const VECTOR2I& aPoint )
+{
+    char buf[80];
+    int  len = 0;
+
+    if( aSeparate )
+        buf[len++] = ' ';
+
+    memcpy( buf + len, "(xy ", 4 );
+    len += 4;
+    len += FormatInternalUnits( buf + len, aPoint.x );
+    buf[len++] = ' ';
+    len += FormatInternalUnits( buf + len, aPoint.y );
+    buf[len++] = ')';
+
+    aOut->PrintRaw( aNestLevel, buf, len );
+}
+
+
 /**
  * Helper class for creating a footprint library cache.
  *
@@ -195,6 +225,8 @@ void FP_CACHE::Save( FOOTPRINT* aFootprint )
 
             m_owner->SetOutputFormatter( &formatter );
             m_owner->Format( (BOARD_ITEM*) it->second->GetFootprint() );
+
+            formatter.Finish();
         }
 
 #ifdef USE_TMP_FILE
@@ -249,6 +281,10 @@ void FP_CACHE::Load()
     {
         wxString cacheError;
 
+        // Most footprints of a library are only enumerated, so their graphics are parsed
+        // when they are first used.  Their errors are reported by FootprintLoad().
+        m_owner->m_parser->SetDeferFootprintBodies( true );
+
         do
         {
             fn.SetFullName( fullName );
@@ -256,7 +292,7 @@ void FP_CACHE::Load()
             // Queue I/O errors so only files that fail to parse don't get loaded.
             try
             {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+                MAPPED_FILE_LINE_READER reader( fn.GetFullPath() );
 
                 m_owner->m_parser->SetLineReader( &reader );
 
@@ -277,6 +313,8 @@ void FP_CACHE::Load()
             }
         } while( dir.GetNext( &fullName ) );
 
+        m_owner->m_parser->SetDeferFootprintBodies( false );
+
         if( !cacheError.IsEmpty() )
             THROW_IO_ERROR( cacheError );
     }
@@ -359,6 +397,8 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
     Format( aBoard, 1 );
 
     m_out->Print( 0, ")\n" );
+
+    formatter.Finish();
 }
 
 
@@ -810,8 +850,7 @@ void PCB_IO::format( PCB_SHAPE* aShape, int aNestLevel ) const
                     m_out->Print( 0, "\n" );
                 }
 
-                m_out->Print( nestLevel, "%s(xy %s)",
-                              nestLevel ? "" : " ", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                formatXY( m_out, nestLevel, nestLevel == 0, outline.CPoint( ii ) );
             }
 
             m_out->Print( 0, ")" );
@@ -906,8 +945,7 @@ void PCB_IO::format( FP_SHAPE* aFPShape, int aNestLevel ) const
                     m_out->Print( 0, "\n" );
                 }
 
-                m_out->Print( nestLevel, "%s(xy %s)",
-                              nestLevel ? "" : " ", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                formatXY( m_out, nestLevel, nestLevel == 0, outline.CPoint( ii ) );
             }
 
             m_out->Print( 0, ")" );
@@ -1521,11 +1559,9 @@ void PCB_IO::format( PAD* aPad, int aNestLevel ) const
                 for( const VECTOR2I &pt : primitive->GetPolyShape().COutline( 0 ).CPoints() )
                 {
                     if( newLine == 0 )
-                        m_out->Print( nested_level+1, "(xy %s)",
-                                      FormatInternalUnits( (wxPoint) pt ).c_str() );
+                        formatXY( m_out, nested_level+1, false, pt );
                     else
-                        m_out->Print( 0, " (xy %s)",
-                                      FormatInternalUnits( (wxPoint) pt ).c_str() );
+                        formatXY( m_out, 0, true, pt );
 
                     if( ++newLine > 4 || !ADVANCED_CFG::GetCfg().m_CompactSave )
                     {
@@ -1932,13 +1968,9 @@ void PCB_IO::format( ZONE* aZone, int aNestLevel ) const
             }
 
             if( newLine == 0 )
-                m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(),
-                              FormatInternalUnits( iterator->y ).c_str() );
+                formatXY( m_out, aNestLevel+3, false, *iterator );
             else
-                m_out->Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(),
-                              FormatInternalUnits( iterator->y ).c_str() );
+                formatXY( m_out, 0, true, *iterator );
 
             if( newLine < 4 && ADVANCED_CFG::GetCfg().m_CompactSave )
             {
@@ -2004,12 +2036,9 @@ void PCB_IO::format( ZONE* aZone, int aNestLevel ) const
                 }
 
                 if( newLine == 0 )
-                    m_out->Print( aNestLevel + 3, "(xy %s %s)",
-                            FormatInternalUnits( it->x ).c_str(),
-                            FormatInternalUnits( it->y ).c_str() );
+                    formatXY( m_out, aNestLevel + 3, false, *it );
                 else
-                    m_out->Print( 0, " (xy %s %s)", FormatInternalUnits( it->x ).c_str(),
-                            FormatInternalUnits( it->y ).c_str() );
+                    formatXY( m_out, 0, true, *it );
 
                 if( newLine < 4 && ADVANCED_CFG::GetCfg().m_CompactSave )
                 {
@@ -2083,9 +2112,14 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
-    BOARD* board = DoLoad( reader, aAppendToMe, aProperties );
+    BOARD* board;
+
+    if( IsSnapshot( reader.Data(), reader.Size() ) )
+        board = loadSnapshot( reader, aAppendToMe, aProperties );
+    else
+        board = DoLoad( reader, aAppendToMe, aProperties );
 
     // Give the filename to the board if it's new
     if( !aAppendToMe )
@@ -2133,6 +2167,210 @@ BOARD* PCB_IO::DoLoad( LINE_READER& aReader, BOARD* aAppendToMe, const PROPERTIE
 }
 
 
+/// The start of a board snapshot, see PCB_IO::SaveSnapshot()
+static const char     BOARD_SNAPSHOT_MAGIC[] = "KiCadPcbSnapshot";
+static const size_t   BOARD_SNAPSHOT_MAGIC_LEN = sizeof( BOARD_SNAPSHOT_MAGIC ) - 1;
+
+/// The version of the snapshot records.  The s-expressions in them have their own version.
+static const uint32_t BOARD_SNAPSHOT_VERSION = 1;
+
+
+/**
+ * Snapshot numbers are written in the byte order of the machine: snapshots are not meant to
+ * be moved to another one.
+ */
+static void writeSnapshotU32( OUTPUTFORMATTER& aOut, uint32_t aValue )
+{
+    char buf[sizeof( aValue )];
+
+    memcpy( buf, &aValue, sizeof( aValue ) );
+    aOut.PrintRaw( 0, buf, sizeof( buf ) );
+}
+
+
+static uint32_t readSnapshotU32( const char*& aData, const char* aEnd, const wxString& aSource )
+{
+    uint32_t value;
+
+    if( aEnd - aData < (ptrdiff_t) sizeof( value ) )
+        THROW_IO_ERROR( wxString::Format( _( "Board snapshot \"%s\" is truncated" ), aSource ) );
+
+    memcpy( &value, aData, sizeof( value ) );
+    aData += sizeof( value );
+
+    return value;
+}
+
+
+bool PCB_IO::IsSnapshot( const char* aData, size_t aSize )
+{
+    return aSize >= BOARD_SNAPSHOT_MAGIC_LEN
+           && memcmp( aData, BOARD_SNAPSHOT_MAGIC, BOARD_SNAPSHOT_MAGIC_LEN ) == 0;
+}
+
+
+void PCB_IO::SaveSnapshot( const wxString& aFileName, BOARD* aBoard )
+{
+    // Held for the worker threads as well, so that their Format() calls never switch the
+    // process locale
+    LOCALE_IO toggle;
+
+    init( nullptr );
+
+    m_board = aBoard;
+    m_mapping->SetBoard( aBoard );
+
+    // The board items in the order of a board file, but not sorted: a snapshot restores the
+    // board as it was
+    std::vector<BOARD_ITEM*> items;
+
+    items.reserve( aBoard->Footprints().size() + aBoard->Drawings().size()
+                   + aBoard->Tracks().size() + aBoard->Zones().size()
+                   + aBoard->Groups().size() );
+
+    items.insert( items.end(), aBoard->Footprints().begin(), aBoard->Footprints().end() );
+    items.insert( items.end(), aBoard->Drawings().begin(), aBoard->Drawings().end() );
+    items.insert( items.end(), aBoard->Tracks().begin(), aBoard->Tracks().end() );
+    items.insert( items.end(), aBoard->Zones().begin(), aBoard->Zones().end() );
+    items.insert( items.end(), aBoard->Groups().begin(), aBoard->Groups().end() );
+
+    std::vector<std::string> records( items.size() + 1 );
+    STRING_FORMATTER         header;
+
+    m_out = &header;
+    m_out->Print( 0, "(kicad_pcb (version %d) (generator pcbnew)\n", SEXPR_BOARD_FILE_VERSION );
+    formatHeader( aBoard, 1 );
+    m_out = &m_sf;
+
+    records[0] = header.GetString();
+
+    // Each thread formats items with its own PCB_IO, sharing the net code mapping
+    std::atomic<size_t> nextItem( 0 );
+
+    auto formatItems =
+            [&]( PCB_IO* aIO ) -> size_t
+            {
+                STRING_FORMATTER formatter;
+                size_t           count = 0;
+
+                aIO->m_out = &formatter;
+
+                for( size_t ii = nextItem++; ii < items.size(); ii = nextItem++ )
+                {
+                    formatter.Clear();
+                    aIO->Format( items[ii], 1 );
+                    records[ii + 1] = formatter.GetString();
+                    count++;
+                }
+
+                aIO->m_out = &aIO->m_sf;
+
+                return count;
+            };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   ( items.size() + 63 ) / 64 );
+
+    parallelThreadCount = std::max<size_t>( parallelThreadCount, 1 );
+
+    if( parallelThreadCount == 1 )
+    {
+        formatItems( this );
+    }
+    else
+    {
+        std::vector<std::unique_ptr<PCB_IO>> workers;
+        std::vector<std::future<size_t>>     returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            workers.push_back( std::make_unique<PCB_IO>( m_ctl ) );
+            workers.back()->m_board = aBoard;
+            *workers.back()->m_mapping = *m_mapping;
+        }
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, formatItems, workers[ii].get() );
+
+        // get() rethrows the exceptions of the workers
+        for( std::future<size_t>& ret : returns )
+            ret.get();
+    }
+
+    FILE_OUTPUTFORMATTER formatter( aFileName, wxT( "wb" ) );
+
+    formatter.PrintRaw( 0, BOARD_SNAPSHOT_MAGIC, BOARD_SNAPSHOT_MAGIC_LEN );
+    writeSnapshotU32( formatter, BOARD_SNAPSHOT_VERSION );
+    writeSnapshotU32( formatter, (uint32_t) records.size() );
+
+    for( const std::string& record : records )
+    {
+        writeSnapshotU32( formatter, (uint32_t) record.size() );
+        formatter.PrintRaw( 0, record.data(), (int) record.size() );
+    }
+
+    formatter.Finish();
+}
+
+
+BOARD* PCB_IO::loadSnapshot( MAPPED_FILE_LINE_READER& aReader, BOARD* aAppendToMe,
+                             const PROPERTIES* aProperties )
+{
+    const wxString& source = aReader.GetSource();
+    const char*     data = aReader.Data() + BOARD_SNAPSHOT_MAGIC_LEN;
+    const char*     end = aReader.Data() + aReader.Size();
+
+    uint32_t version = readSnapshotU32( data, end, source );
+
+    if( version != BOARD_SNAPSHOT_VERSION )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Board snapshot \"%s\" has unsupported version %u" ),
+                                          source, version ) );
+    }
+
+    uint32_t count = readSnapshotU32( data, end, source );
+
+    std::vector<PCB_PARSER::BOARD_SECTION> sections;
+
+    for( uint32_t ii = 0; ii < count; ++ii )
+    {
+        uint32_t size = readSnapshotU32( data, end, source );
+
+        if( (size_t) ( end - data ) < size )
+            THROW_IO_ERROR( wxString::Format( _( "Board snapshot \"%s\" is truncated" ), source ) );
+
+        // Each record is parsed as if it started a file
+        sections.push_back( { data, data + size, 1, 0, T_NONE } );
+        data += size;
+    }
+
+    if( sections.empty() )
+        THROW_IO_ERROR( wxString::Format( _( "Board snapshot \"%s\" is empty" ), source ) );
+
+    // The header record is a board without items
+    std::string        headerText( sections[0].begin, sections[0].end );
+    STRING_LINE_READER header( headerText + ")", source );
+
+    BOARD* board = DoLoad( header, aAppendToMe, aProperties );
+
+    sections.erase( sections.begin() );
+
+    try
+    {
+        m_parser->ParseBoardSections( sections );
+    }
+    catch( ... )
+    {
+        if( !aAppendToMe )
+            delete board;
+
+        throw;
+    }
+
+    return board;
+}
+
+
 void PCB_IO::init( const PROPERTIES* aProperties )
 {
     m_board = NULL;
@@ -2238,7 +2476,24 @@ FOOTPRINT* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString&
                                   const PROPERTIES* aProperties )
 {
     const FOOTPRINT* footprint = getFootprint( aLibraryPath, aFootprintName, aProperties, true );
-    return footprint ? (FOOTPRINT*) footprint->Duplicate() : nullptr;
+
+    if( !footprint )
+        return nullptr;
+
+    try
+    {
+        // The graphics of a cached footprint are parsed when it is first loaded, which is
+        // where their errors are reported
+        footprint->LoadDeferredBody();
+    }
+    catch( const IO_ERROR& )
+    {
+        // Like a footprint which fails to parse with its library, it is left out of the cache
+        m_cache->GetFootprints().erase( aFootprintName );
+        throw;
+    }
+
+    return (FOOTPRINT*) footprint->Duplicate();
 }
 
 
@@ -2253,6 +2508,9 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const FOOTPRINT* aFoot
     // called for saving into a library path.
     m_ctl = CTL_FOR_LIBRARY;
 
+    // Don't save a footprint whose deferred graphics fail to parse
+    aFootprint->LoadDeferredBody();
+
     validateCache( aLibraryPath );
 
     if( !m_cache->IsWritable() )
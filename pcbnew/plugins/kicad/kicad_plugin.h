@@ -212,6 +212,26 @@ public:
 
     BOARD_ITEM* Parse( const wxString& aClipboardSourceInput );
 
+    /**
+     * Write \a aBoard to \a aFileName as a board snapshot, which is much quicker to write and
+     * to read back than a board file.  Snapshots are meant for autosaves and for handing a
+     * board to another process; Load() reads them as well as board files.
+     *
+     * A snapshot starts with a magic string, a format version and a record count, followed
+     * by records made of a 32 bit length and that many bytes.  The first record holds the
+     * board header up to the net classes, each other record one top level board item.  The
+     * records are s-expressions formatted on worker threads, and the board items are parsed
+     * on worker threads from a memory mapping of the file when it is loaded.
+     *
+     * @throw IO_ERROR on write error.
+     */
+    void SaveSnapshot( const wxString& aFileName, BOARD* aBoard );
+
+    /**
+     * @return true if the \a aSize bytes of \a aData start like a board snapshot.
+     */
+    static bool IsSnapshot( const char* aData, size_t aSize );
+
 protected:
 
     wxString        m_error;        ///< for throwing exceptions
@@ -238,6 +258,10 @@ protected:
 
     void init( const PROPERTIES* aProperties );
 
+    /// Read the board snapshot of \a aReader, see SaveSnapshot().
+    BOARD* loadSnapshot( MAPPED_FILE_LINE_READER& aReader, BOARD* aAppendToMe,
+                         const PROPERTIES* aProperties );
+
     /// formats the board setup information
     void formatSetup( BOARD* aBoard, int aNestLevel = 0 ) const;
 
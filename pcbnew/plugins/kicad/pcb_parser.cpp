@@ -27,9 +27,13 @@
  * @brief Pcbnew s-expression file format parser implementation.
  */
 
+#include <atomic>
 #include <cerrno>
+#include <future>
+#include <thread>
 #include <common.h>
 #include <confirm.h>
+#include <kicad_string.h>
 #include <macros.h>
 #include <title_block.h>
 #include <trigo.h>
@@ -49,7 +53,6 @@
 #include <plugins/kicad/kicad_plugin.h>
 #include <pcb_plot_params_parser.h>
 #include <pcb_plot_params.h>
-#include <locale_io.h>
 #include <zones.h>
 #include <plugins/kicad/pcb_parser.h>
 #include <convert_basic_shapes_to_polygon.h>    // for RECT_CHAMFER_POSITIONS definition
@@ -138,11 +141,12 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble()
 {
-    char* tmp;
+    const char* text = CurTokenText();
+    char*       tmp;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    double fval = StrToDoubleC( text, &tmp );
 
     if( errno )
     {
@@ -153,7 +157,7 @@ double PCB_PARSER::parseDouble()
         THROW_IO_ERROR( error );
     }
 
-    if( CurText() == tmp )
+    if( text == tmp )
     {
         wxString error;
         error.Printf( _( "Missing floating point number in\nfile: \"%s\"\nline: %d\noffset: %d" ),
@@ -473,8 +477,9 @@ BOARD_ITEM* PCB_PARSER::Parse()
 {
     T               token;
     BOARD_ITEM*     item;
-    LOCALE_IO       toggle;
 
+    // No LOCALE_IO here: numbers are read with StrToDoubleC(), which does not depend on the
+    // locale, and switching the process locale is not safe while other threads are running.
     m_groupInfos.clear();
 
     // FOOTPRINTS can be prefixed with an initial block of single line comments and these are
@@ -536,101 +541,20 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 
     parseHeader();
 
-    for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
-    {
-        if( token != T_LEFT )
-            Expecting( T_LEFT );
+    std::vector<BOARD_SECTION> sections;
 
-        token = NextTok();
-
-        if( token == T_page && m_requiredVersion <= 20200119 )
-            token = T_paper;
-
-        switch( token )
+    if( splitBoardSections( sections ) )
+    {
+        parseBoardSections( sections, properties );
+    }
+    else
+    {
+        for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
         {
-        case T_general:
-            parseGeneralSection();
-            break;
-
-        case T_paper:
-            parsePAGE_INFO();
-            break;
+            if( token != T_LEFT )
+                Expecting( T_LEFT );
 
-        case T_title_block:
-            parseTITLE_BLOCK();
-            break;
-
-        case T_layers:
-            parseLayers();
-            break;
-
-        case T_setup:
-            parseSetup();
-            break;
-
-        case T_property:
-            properties.insert( parseProperty() );
-            break;
-
-        case T_net:
-            parseNETINFO_ITEM();
-            break;
-
-        case T_net_class:
-            parseNETCLASS();
-            m_board->m_LegacyNetclassesLoaded = true;
-            break;
-
-        case T_gr_arc:
-        case T_gr_curve:
-        case T_gr_line:
-        case T_gr_poly:
-        case T_gr_circle:
-        case T_gr_rect:
-            m_board->Add( parsePCB_SHAPE(), ADD_MODE::APPEND );
-            break;
-
-        case T_gr_text:
-            m_board->Add( parsePCB_TEXT(), ADD_MODE::APPEND );
-            break;
-
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_MODE::APPEND );
-            break;
-
-        case T_module:      // legacy token
-        case T_footprint:
-            m_board->Add( parseFOOTPRINT(), ADD_MODE::APPEND );
-            break;
-
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_MODE::APPEND );
-            break;
-
-        case T_arc:
-            m_board->Add( parseARC(), ADD_MODE::APPEND );
-            break;
-
-        case T_group:
-            parseGROUP( m_board );
-            break;
-
-        case T_via:
-            m_board->Add( parseVIA(), ADD_MODE::APPEND );
-            break;
-
-        case T_zone:
-            m_board->Add( parseZONE( m_board ), ADD_MODE::APPEND );
-            break;
-
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_MODE::APPEND );
-            break;
-
-        default:
-            wxString err;
-            err.Printf( _( "Unknown token \"%s\"" ), FromUTF8() );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            parseBoardSection( NextTok(), properties );
         }
     }
 
@@ -719,6 +643,570 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+void PCB_PARSER::parseBoardSection( T aToken, std::map<wxString, wxString>& aProperties )
+{
+    if( aToken == T_page && m_requiredVersion <= 20200119 )
+        aToken = T_paper;
+
+    switch( aToken )
+    {
+    case T_general:
+        parseGeneralSection();
+        break;
+
+    case T_paper:
+        parsePAGE_INFO();
+        break;
+
+    case T_title_block:
+        parseTITLE_BLOCK();
+        break;
+
+    case T_layers:
+        parseLayers();
+        break;
+
+    case T_setup:
+        parseSetup();
+        break;
+
+    case T_property:
+        aProperties.insert( parseProperty() );
+        break;
+
+    case T_net:
+        parseNETINFO_ITEM();
+        break;
+
+    case T_net_class:
+        parseNETCLASS();
+        m_board->m_LegacyNetclassesLoaded = true;
+        break;
+
+    case T_group:
+        parseGROUP( m_board );
+        break;
+
+    default:
+        m_board->Add( parseBoardItem( aToken ), ADD_MODE::APPEND );
+        break;
+    }
+}
+
+
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+    case T_gr_circle:
+    case T_gr_rect:
+        return parsePCB_SHAPE();
+
+    case T_gr_text:
+        return parsePCB_TEXT();
+
+    case T_dimension:
+        return parseDIMENSION();
+
+    case T_module:      // legacy token
+    case T_footprint:
+        return parseFOOTPRINT();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_arc:
+        return parseARC();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE( m_board );
+
+    case T_target:
+        return parsePCB_TARGET();
+
+    default:
+        wxString err;
+        err.Printf( _( "Unknown token \"%s\"" ), FromUTF8() );
+        THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+    }
+}
+
+
+bool PCB_PARSER::isBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+    case T_gr_circle:
+    case T_gr_rect:
+    case T_gr_text:
+    case T_dimension:
+    case T_module:
+    case T_footprint:
+    case T_segment:
+    case T_arc:
+    case T_via:
+    case T_zone:
+    case T_target:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+/**
+ * Tests for the whitespace of DSNLEXER.
+ */
+static inline bool isSectionSpace( char cc )
+{
+    return cc == ' ' || cc == '\t' || cc == '\n' || cc == '\r' || cc == '\0';
+}
+
+
+/**
+ * Finds the parenthesis closing the one at @a aBegin by scanning for balanced parentheses,
+ * which is much faster than tokenizing.  It mirrors the lexer: a '#' starts a comment only
+ * as the first non blank of a line, and a '"' starts a string only at the start of a token.
+ * Strings end with their line.
+ *
+ * @param aLine is the line number of @a aBegin, and is set to that of the result.
+ * @param aLineStart is the start of that line, and is set to that of the result.
+ * @return the closing parenthesis, or nullptr if there is none before @a aEnd.
+ */
+static const char* findClosingParen( const char* aBegin, const char* aEnd, int& aLine,
+                                     const char*& aLineStart )
+{
+    const char* p = aBegin;
+    bool        atLineStart = false;
+    int         depth = 0;
+
+    while( p < aEnd )
+    {
+        char cc = *p;
+
+        if( cc == '\n' )
+        {
+            ++aLine;
+            aLineStart = ++p;
+            atLineStart = true;
+        }
+        else if( isSectionSpace( cc ) )
+        {
+            ++p;
+        }
+        else if( atLineStart && cc == '#' )
+        {
+            while( p < aEnd && *p != '\n' )
+                ++p;
+        }
+        else if( cc == '(' )
+        {
+            atLineStart = false;
+            ++depth;
+            ++p;
+        }
+        else if( cc == ')' )
+        {
+            if( --depth == 0 )
+                return p;
+
+            atLineStart = false;
+            ++p;
+        }
+        else if( cc == '"' )
+        {
+            atLineStart = false;
+
+            for( ++p; p < aEnd && *p != '\n'; ++p )
+            {
+                if( *p == '\\' && p + 1 < aEnd && p[1] != '\n' )
+                    ++p;
+                else if( *p == '"' )
+                    break;
+            }
+
+            if( p < aEnd && *p == '"' )
+                ++p;
+        }
+        else
+        {
+            atLineStart = false;
+
+            while( p < aEnd && !isSectionSpace( *p ) && *p != '(' && *p != ')' )
+                ++p;
+        }
+    }
+
+    return nullptr;
+}
+
+
+bool PCB_PARSER::splitBoardSections( std::vector<BOARD_SECTION>& aSections )
+{
+    MAPPED_FILE_LINE_READER* mapped = dynamic_cast<MAPPED_FILE_LINE_READER*>( reader );
+
+    if( !mapped || readerStack.size() != 1 )
+        return false;
+
+    const char* data = mapped->Data();
+    const char* end  = data + mapped->Size();
+
+    // The last line of a file without a trailing newline is not read in place
+    if( start < data || start >= end )
+        return false;
+
+    const char* p = next;
+    const char* lineStart = start;
+    int         line = CurLineNumber();
+
+    // The lexer won't read any further, and this puts back the byte the reader borrowed from
+    // the next line to terminate the current one.
+    mapped->Rewind();
+
+    bool atLineStart = false;
+
+    while( p < end )
+    {
+        char cc = *p;
+
+        if( cc == '\n' )
+        {
+            ++line;
+            lineStart = ++p;
+            atLineStart = true;
+        }
+        else if( isSectionSpace( cc ) )
+        {
+            ++p;
+        }
+        else if( atLineStart && cc == '#' )
+        {
+            while( p < end && *p != '\n' )
+                ++p;
+        }
+        else if( cc == '(' )
+        {
+            const char* keyword = p + 1;
+            const char* keywordEnd;
+
+            while( keyword < end && isSectionSpace( *keyword ) )
+                ++keyword;
+
+            for( keywordEnd = keyword; keywordEnd < end; ++keywordEnd )
+            {
+                if( isSectionSpace( *keywordEnd ) || *keywordEnd == '(' || *keywordEnd == ')' )
+                    break;
+            }
+
+            BOARD_SECTION section;
+
+            section.begin  = p;
+            section.line   = line;
+            section.column = (int) ( p - lineStart );
+            section.token  = (T) findToken( std::string( keyword, keywordEnd ) );
+
+            p = findClosingParen( p, end, line, lineStart );
+
+            if( !p )
+                break;
+
+            section.end = ++p;
+            aSections.push_back( section );
+            atLineStart = false;
+        }
+        else if( cc == ')' )
+        {
+            // The end of the board
+            return true;
+        }
+        else
+        {
+            // Anything else between sections is an error for the sequential parser to report
+            break;
+        }
+    }
+
+    // Unbalanced parentheses or stray tokens: parse sequentially from the start again, so
+    // the errors are the usual ones.
+    aSections.clear();
+
+    SetLineReader( mapped );
+    NextTok();      // T_LEFT
+    NextTok();      // T_kicad_pcb
+    parseHeader();
+
+    return false;
+}
+
+
+std::string PCB_PARSER::sectionText( const BOARD_SECTION& aSection )
+{
+    std::string text( aSection.column, ' ' );
+
+    text.append( aSection.begin, aSection.end );
+
+    return text;
+}
+
+
+void PCB_PARSER::parseSectionText( const BOARD_SECTION& aSection,
+                                   std::map<wxString, wxString>& aProperties )
+{
+    STRING_LINE_READER sectionReader( sectionText( aSection ), CurSource(), aSection.line - 1 );
+
+    PushReader( &sectionReader );
+
+    try
+    {
+        NextTok();      // T_LEFT
+        parseBoardSection( NextTok(), aProperties );
+    }
+    catch( ... )
+    {
+        PopReader();
+        throw;
+    }
+
+    PopReader();
+}
+
+
+void PCB_PARSER::parseBoardSections( const std::vector<BOARD_SECTION>& aSections,
+                                     std::map<wxString, wxString>& aProperties )
+{
+    size_t ii = 0;
+
+    while( ii < aSections.size() )
+    {
+        if( isBoardItem( aSections[ii].token ) )
+        {
+            size_t last = ii;
+
+            while( last < aSections.size() && isBoardItem( aSections[last].token ) )
+                ++last;
+
+            parseBoardItems( aSections, ii, last );
+            ii = last;
+        }
+        else
+        {
+            parseSectionText( aSections[ii++], aProperties );
+        }
+    }
+}
+
+
+void PCB_PARSER::ParseBoardSections( std::vector<BOARD_SECTION>& aSections )
+{
+    wxCHECK_RET( m_board, "ParseBoardSections() needs the board of a previous Parse()" );
+
+    for( BOARD_SECTION& section : aSections )
+    {
+        if( section.begin == section.end || *section.begin != '(' )
+        {
+            THROW_PARSE_ERROR( _( "Invalid board section" ), CurSource(), "", section.line,
+                               section.column );
+        }
+
+        const char* keyword = section.begin + 1;
+        const char* keywordEnd;
+
+        while( keyword < section.end && isSectionSpace( *keyword ) )
+            ++keyword;
+
+        for( keywordEnd = keyword; keywordEnd < section.end; ++keywordEnd )
+        {
+            if( isSectionSpace( *keywordEnd ) || *keywordEnd == '(' || *keywordEnd == ')' )
+                break;
+        }
+
+        section.token = (T) findToken( std::string( keyword, keywordEnd ) );
+    }
+
+    std::map<wxString, wxString> properties = m_board->GetProperties();
+
+    m_groupInfos.clear();
+
+    parseBoardSections( aSections, properties );
+
+    m_board->SetProperties( properties );
+    resolveGroups( m_board );
+}
+
+
+struct PCB_PARSER::PARSED_ITEM
+{
+    PARSED_ITEM() :
+        item( nullptr ),
+        deferred( false )
+    {
+    }
+
+    BOARD_ITEM*             item;
+    bool                    deferred;       ///< to be parsed again by the main thread
+    std::exception_ptr      error;
+    std::vector<GROUP_INFO> groupInfos;     ///< the groups of a footprint
+    KIID_MAP                resetKIIDMap;
+};
+
+
+void PCB_PARSER::initWorker( const PCB_PARSER& aParser )
+{
+    m_board                 = aParser.m_board;
+    m_layerIndices          = aParser.m_layerIndices;
+    m_layerMasks            = aParser.m_layerMasks;
+    m_netCodes              = aParser.m_netCodes;
+    m_tooRecent             = aParser.m_tooRecent;
+    m_requiredVersion       = aParser.m_requiredVersion;
+    m_resetKIIDs            = aParser.m_resetKIIDs;
+    m_showLegacyZoneWarning = aParser.m_showLegacyZoneWarning;
+    m_isWorker              = true;
+}
+
+
+void PCB_PARSER::parseBoardItems( const std::vector<BOARD_SECTION>& aSections, size_t aFirst,
+                                  size_t aLast )
+{
+    size_t                   count = aLast - aFirst;
+    std::vector<PARSED_ITEM> results( count );
+    const wxString           source = CurSource();
+
+    // We don't want to spin up a new thread for fewer than 64 items (overhead costs)
+    size_t parallelThreadCount = std::max<size_t>( 1,
+                                     std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       ( count + 63 ) / 64 ) );
+
+    std::vector<std::unique_ptr<PCB_PARSER>> parsers;
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    {
+        parsers.push_back( std::make_unique<PCB_PARSER>() );
+        parsers.back()->initWorker( *this );
+    }
+
+    std::atomic<size_t> nextItem( 0 );
+
+    auto parse_lambda =
+            [&]( PCB_PARSER* aParser ) -> size_t
+            {
+                for( size_t ii = nextItem++; ii < count; ii = nextItem++ )
+                {
+                    const BOARD_SECTION& section = aSections[aFirst + ii];
+                    PARSED_ITEM&         result = results[ii];
+
+                    try
+                    {
+                        STRING_LINE_READER sectionReader( sectionText( section ), source,
+                                                          section.line - 1 );
+
+                        aParser->SetLineReader( &sectionReader );
+                        aParser->NextTok();     // T_LEFT
+                        result.item = aParser->parseBoardItem( aParser->NextTok() );
+                        aParser->PopReader();
+
+                        std::swap( result.groupInfos, aParser->m_groupInfos );
+                        std::swap( result.resetKIIDMap, aParser->m_resetKIIDMap );
+                        continue;
+                    }
+                    catch( const DEFERRED_ITEM& )
+                    {
+                        result.deferred = true;
+                    }
+                    catch( ... )
+                    {
+                        result.error = std::current_exception();
+                    }
+
+                    aParser->PopReader();
+                    aParser->m_groupInfos.clear();
+                    aParser->m_resetKIIDMap.clear();
+                }
+
+                return 1;
+            };
+
+    if( parallelThreadCount == 1 )
+    {
+        parse_lambda( parsers[0].get() );
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, parse_lambda, parsers[ii].get() );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    for( const std::unique_ptr<PCB_PARSER>& parser : parsers )
+        m_undefinedLayers.insert( parser->m_undefinedLayers.begin(),
+                                  parser->m_undefinedLayers.end() );
+
+    // Add the items in file order, so the board is the same as one parsed sequentially
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        PARSED_ITEM& result = results[ii];
+
+        if( result.deferred )
+        {
+            std::vector<int>             netCodes = m_netCodes;
+            std::map<wxString, wxString> noProperties;
+
+            try
+            {
+                parseSectionText( aSections[aFirst + ii], noProperties );
+            }
+            catch( ... )
+            {
+                for( size_t jj = ii + 1; jj < count; ++jj )
+                    delete results[jj].item;
+
+                throw;
+            }
+
+            // The following items were parsed with the previous net codes
+            if( m_netCodes != netCodes )
+            {
+                for( size_t jj = ii + 1; jj < count; ++jj )
+                    delete results[jj].item;
+
+                parseBoardItems( aSections, aFirst + ii + 1, aLast );
+                return;
+            }
+        }
+        else if( result.error )
+        {
+            for( size_t jj = ii + 1; jj < count; ++jj )
+                delete results[jj].item;
+
+            std::rethrow_exception( result.error );
+        }
+        else
+        {
+            m_board->Add( result.item, ADD_MODE::APPEND );
+
+            m_groupInfos.insert( m_groupInfos.end(), result.groupInfos.begin(),
+                                 result.groupInfos.end() );
+            m_resetKIIDMap.insert( result.resetKIIDMap.begin(), result.resetKIIDMap.end() );
+        }
+    }
+}
+
+
 void PCB_PARSER::resolveGroups( BOARD_ITEM* aParent )
 {
     auto getItem = [&]( const KIID& aId )
@@ -1469,11 +1957,11 @@ template<class T, class M>
 T PCB_PARSER::lookUpLayer( const M& aMap )
 {
     // avoid constructing another std::string, use lexer's directly
-    typename M::const_iterator it = aMap.find( curText );
+    typename M::const_iterator it = aMap.find( CurStr() );
 
     if( it == aMap.end() )
     {
-        m_undefinedLayers.insert( curText );
+        m_undefinedLayers.insert( CurStr() );
         return Rescue;
     }
 
@@ -2811,6 +3299,20 @@ FOOTPRINT* PCB_PARSER::parseFOOTPRINT( wxArrayString* aInitialComments )
 }
 
 
+struct PCB_PARSER::DEFERRED_BODY
+{
+    DEFERRED_BODY() :
+        requiredVersion( 0 )
+    {
+    }
+
+    wxString                    source;
+    int                         requiredVersion;
+    std::shared_ptr<const char> content;    ///< the file, which the items point into
+    std::vector<BOARD_SECTION>  items;
+};
+
+
 FOOTPRINT* PCB_PARSER::parseFOOTPRINT_unchecked( wxArrayString* aInitialComments )
 {
     wxCHECK_MSG( CurTok() == T_module || CurTok() == T_footprint, NULL,
@@ -2825,6 +3327,7 @@ FOOTPRINT* PCB_PARSER::parseFOOTPRINT_unchecked( wxArrayString* aInitialComments
     std::unique_ptr<FOOTPRINT> footprint = std::make_unique<FOOTPRINT>( m_board );
 
     std::map<wxString, wxString> properties;
+    DEFERRED_BODY                deferred;
 
     footprint->SetInitialComments( aInitialComments );
 
@@ -3023,61 +3526,16 @@ FOOTPRINT* PCB_PARSER::parseFOOTPRINT_unchecked( wxArrayString* aInitialComments
             break;
 
         case T_fp_text:
-        {
-            FP_TEXT* text = parseFP_TEXT();
-            text->SetParent( footprint.get() );
-            double orientation = text->GetTextAngle();
-            orientation -= footprint->GetOrientation();
-            text->SetTextAngle( orientation );
-            text->SetDrawCoord();
-
-            switch( text->GetType() )
-            {
-            case FP_TEXT::TEXT_is_REFERENCE:
-                footprint->Reference() = *text;
-                const_cast<KIID&>( footprint->Reference().m_Uuid ) = text->m_Uuid;
-                delete text;
-                break;
-
-            case FP_TEXT::TEXT_is_VALUE:
-                footprint->Value() = *text;
-                const_cast<KIID&>( footprint->Value().m_Uuid ) = text->m_Uuid;
-                delete text;
-                break;
-
-            default:
-                footprint->Add( text, ADD_MODE::APPEND );
-            }
-        }
-            break;
-
         case T_fp_arc:
-        {
-            FP_SHAPE* shape = parseFP_SHAPE();
-
-            // Drop 0 and NaN angles as these can corrupt/crash the schematic
-            if( std::isnormal( shape->GetAngle() ) )
-            {
-                shape->SetParent( footprint.get() );
-                shape->SetDrawCoord();
-                footprint->Add( shape, ADD_MODE::APPEND );
-            }
-            else
-                delete shape;
-        }
-            break;
-
         case T_fp_circle:
         case T_fp_curve:
         case T_fp_rect:
         case T_fp_line:
         case T_fp_poly:
-        {
-            FP_SHAPE* shape = parseFP_SHAPE();
-            shape->SetParent( footprint.get() );
-            shape->SetDrawCoord();
-            footprint->Add( shape, ADD_MODE::APPEND );
-        }
+        case T_model:
+            if( !deferFootprintGraphic( token, deferred ) )
+                parseFootprintGraphic( footprint.get(), token );
+
             break;
 
         case T_pad:
@@ -3091,10 +3549,6 @@ FOOTPRINT* PCB_PARSER::parseFOOTPRINT_unchecked( wxArrayString* aInitialComments
         }
             break;
 
-        case T_model:
-            footprint->Add3DModel( parse3DModel() );
-            break;
-
         case T_zone:
         {
             ZONE* zone = parseZONE( footprint.get() );
@@ -3134,7 +3588,23 @@ FOOTPRINT* PCB_PARSER::parseFOOTPRINT_unchecked( wxArrayString* aInitialComments
     // if the advanced config is set and its a general footprint load
     // This improves debugging greatly under MSVC where full std iterator debugging
     // is present and loading a massive amount of footprints can lead to 2 minute load times
-    if( !ADVANCED_CFG::GetCfg().m_SkipBoundingBoxOnFpLoad || m_board != nullptr
+    if( !deferred.items.empty() )
+    {
+        deferred.source = CurSource();
+        deferred.requiredVersion = m_requiredVersion;
+
+        auto body = std::make_shared<DEFERRED_BODY>( std::move( deferred ) );
+
+        // The bounding box is calculated once the body is parsed
+        footprint->SetDeferredBody(
+                [body]( FOOTPRINT* aFootprint )
+                {
+                    PCB_PARSER parser;
+
+                    parser.parseDeferredBody( aFootprint, *body );
+                } );
+    }
+    else if( !ADVANCED_CFG::GetCfg().m_SkipBoundingBoxOnFpLoad || m_board != nullptr
             || reader->GetSource().Contains( "clipboard" ) )
     {
         footprint->CalculateBoundingBox();
@@ -3144,6 +3614,196 @@ FOOTPRINT* PCB_PARSER::parseFOOTPRINT_unchecked( wxArrayString* aInitialComments
 }
 
 
+bool PCB_PARSER::parseFootprintGraphic( FOOTPRINT* aFootprint, T aToken )
+{
+    switch( aToken )
+    {
+    case T_fp_text:
+    {
+        FP_TEXT* text = parseFP_TEXT();
+        text->SetParent( aFootprint );
+        double orientation = text->GetTextAngle();
+        orientation -= aFootprint->GetOrientation();
+        text->SetTextAngle( orientation );
+        text->SetDrawCoord();
+
+        switch( text->GetType() )
+        {
+        case FP_TEXT::TEXT_is_REFERENCE:
+            aFootprint->Reference() = *text;
+            const_cast<KIID&>( aFootprint->Reference().m_Uuid ) = text->m_Uuid;
+            delete text;
+            break;
+
+        case FP_TEXT::TEXT_is_VALUE:
+            aFootprint->Value() = *text;
+            const_cast<KIID&>( aFootprint->Value().m_Uuid ) = text->m_Uuid;
+            delete text;
+            break;
+
+        default:
+            aFootprint->Add( text, ADD_MODE::APPEND );
+        }
+    }
+        break;
+
+    case T_fp_arc:
+    {
+        FP_SHAPE* shape = parseFP_SHAPE();
+
+        // Drop 0 and NaN angles as these can corrupt/crash the schematic
+        if( std::isnormal( shape->GetAngle() ) )
+        {
+            shape->SetParent( aFootprint );
+            shape->SetDrawCoord();
+            aFootprint->Add( shape, ADD_MODE::APPEND );
+        }
+        else
+            delete shape;
+    }
+        break;
+
+    case T_fp_circle:
+    case T_fp_curve:
+    case T_fp_rect:
+    case T_fp_line:
+    case T_fp_poly:
+    {
+        FP_SHAPE* shape = parseFP_SHAPE();
+        shape->SetParent( aFootprint );
+        shape->SetDrawCoord();
+        aFootprint->Add( shape, ADD_MODE::APPEND );
+    }
+        break;
+
+    case T_model:
+        aFootprint->Add3DModel( parse3DModel() );
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+
+bool PCB_PARSER::deferFootprintGraphic( T aToken, DEFERRED_BODY& aBody )
+{
+    // Footprints of a board are needed whole as soon as they are added to it
+    if( !m_deferFootprintBodies || m_board || readerStack.size() != 1 )
+        return false;
+
+    MAPPED_FILE_LINE_READER* mapped = dynamic_cast<MAPPED_FILE_LINE_READER*>( reader );
+
+    // The item is read back from the file content, so its lines must have been read in
+    // place, which they all are when the file ends with a newline
+    if( !mapped || mapped->Size() == 0 || mapped->Data()[mapped->Size() - 1] != '\n' )
+        return false;
+
+    const char* data = mapped->Data();
+    const char* end = data + mapped->Size();
+    const char* begin = start + curOffset;
+
+    if( begin <= data || begin >= end )
+        return false;
+
+    // The reference and value texts are part of the footprint itself
+    if( aToken == T_fp_text )
+    {
+        const char* type = next;
+
+        while( *type == ' ' || *type == '\t' )
+            ++type;
+
+        if( strncmp( type, "user", 4 ) != 0 || !isSectionSpace( type[4] ) )
+            return false;
+    }
+
+    while( begin > data && *begin != '(' )
+        --begin;
+
+    const char* lineStart = start;
+    int         line = CurLineNumber();
+
+    if( begin < lineStart )
+        return false;
+
+    BOARD_SECTION item;
+
+    item.begin  = begin;
+    item.line   = line;
+    item.column = (int) ( begin - lineStart );
+    item.token  = aToken;
+
+    // This puts back the byte the reader borrowed from the next line to terminate the
+    // current one
+    const char* resume = next;
+
+    mapped->Seek( lineStart - data, line );
+
+    const char* close = findClosingParen( begin, end, line, lineStart );
+
+    if( !close )
+    {
+        // Let the lexer report the error
+        mapped->Seek( item.begin - item.column - data, item.line );
+        readLine();
+        next = resume;
+        return false;
+    }
+
+    item.end = close + 1;
+
+    if( !aBody.content )
+        aBody.content = mapped->Content();
+
+    aBody.items.push_back( item );
+
+    // Carry on lexing after the closing parenthesis, as if the lexer had returned it
+    mapped->Seek( lineStart - data, line );
+    readLine();
+
+    next       = close + 1;
+    curOffset  = (int) ( close - start );
+    prevTok    = curTok;
+    curTok     = T_RIGHT;
+    tokenBegin = close;
+    tokenEnd   = close + 1;
+
+    return true;
+}
+
+
+void PCB_PARSER::parseDeferredBody( FOOTPRINT* aFootprint, const DEFERRED_BODY& aBody )
+{
+    m_requiredVersion = aBody.requiredVersion;
+
+    for( const BOARD_SECTION& item : aBody.items )
+    {
+        STRING_LINE_READER itemReader( sectionText( item ), aBody.source, item.line - 1 );
+
+        PushReader( &itemReader );
+
+        try
+        {
+            NextTok();      // T_LEFT
+            parseFootprintGraphic( aFootprint, NextTok() );
+        }
+        catch( ... )
+        {
+            PopReader();
+            aFootprint->CalculateBoundingBox();
+            throw;
+        }
+
+        PopReader();
+    }
+
+    aFootprint->CalculateBoundingBox();
+}
+
+
 FP_TEXT* PCB_PARSER::parseFP_TEXT()
 {
     wxCHECK_MSG( CurTok() == T_fp_text, NULL,
@@ -4505,6 +5165,10 @@ ZONE* PCB_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
 
                     if( token == T_segment )    // deprecated
                     {
+                        // Converting them changes the board, and may need the user's consent
+                        if( m_isWorker )
+                            throw DEFERRED_ITEM();
+
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
                         if( m_showLegacyZoneWarning )
                         {
@@ -4880,6 +5544,9 @@ ZONE* PCB_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
             zone->SetNetCode( net->GetNet() );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
+            if( m_isWorker )
+                throw DEFERRED_ITEM();
+
             int newnetcode = m_board->GetNetCount();
             net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
             m_board->Add( net );
@@ -83,6 +83,9 @@ class PCB_PARSER : public PCB_LEXER
     KIID_MAP            m_resetKIIDMap;     ///< if resetting UUIDs, record new ones to update groups with
 
     bool                m_showLegacyZoneWarning;
+    bool                m_isWorker;         ///< parsing board items on a worker thread, so
+                                            ///< the board must not be changed
+    bool                m_deferFootprintBodies; ///< see SetDeferFootprintBodies()
 
     // Group membership info refers to other Uuids in the file.
     // We don't want to rely on group declarations being last in the file, so
@@ -98,6 +101,16 @@ class PCB_PARSER : public PCB_LEXER
 
     std::vector<GROUP_INFO> m_groupInfos;
 
+    ///> A board item parsed by a worker thread, see parseBoardItems()
+    struct PARSED_ITEM;
+
+    ///> The unparsed graphic items and 3D models of a footprint, see parseDeferredBody()
+    struct DEFERRED_BODY;
+
+    ///> Thrown by a worker when an item must be parsed again by the main thread, because
+    ///> parsing it changes the board
+    struct DEFERRED_ITEM {};
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -165,6 +178,31 @@ class PCB_PARSER : public PCB_LEXER
 
     FP_TEXT*        parseFP_TEXT();
     FP_SHAPE*       parseFP_SHAPE();
+
+    /**
+     * Parses the graphic item or 3D model starting with @a aToken into @a aFootprint.
+     *
+     * @return false if @a aToken does not start a graphic item or a 3D model.
+     */
+    bool            parseFootprintGraphic( FOOTPRINT* aFootprint, PCB_KEYS_T::T aToken );
+
+    /**
+     * Skips the graphic item or 3D model starting with @a aToken by scanning for its closing
+     * parenthesis, and records where it is in the file in @a aBody, when footprint bodies are
+     * deferred and the item can be read back from the file.
+     *
+     * @return false if the item must be parsed now, which is also the case when its
+     *  parentheses are unbalanced so that the lexer reports the error.
+     */
+    bool            deferFootprintGraphic( PCB_KEYS_T::T aToken, DEFERRED_BODY& aBody );
+
+    /**
+     * Parses the items deferred by deferFootprintGraphic() into @a aFootprint.
+     *
+     * @throw IO_ERROR if an item cannot be parsed; the items before it are kept.
+     */
+    void            parseDeferredBody( FOOTPRINT* aFootprint, const DEFERRED_BODY& aBody );
+
     PAD*            parsePAD( FOOTPRINT* aParent = NULL );
 
     // Parse only the (option ...) inside a pad description
@@ -181,6 +219,65 @@ class PCB_PARSER : public PCB_LEXER
     // Parse a board, but do not replace PARSE_ERROR with FUTURE_FORMAT_ERROR automatically.
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Parses the top level board section starting with @a aToken.  Board items are added
+     * to the board.
+     */
+    void            parseBoardSection( PCB_KEYS_T::T aToken,
+                                       std::map<wxString, wxString>& aProperties );
+
+    /**
+     * Parses a top level board item starting with @a aToken, without adding it to the
+     * board.  These are the sections which parseBoardItems() parses on worker threads.
+     *
+     * @throw PARSE_ERROR if @a aToken does not start a board item.
+     */
+    BOARD_ITEM*     parseBoardItem( PCB_KEYS_T::T aToken );
+
+    static bool     isBoardItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Finds the top level sections following the header of a board read from a
+     * #MAPPED_FILE_LINE_READER by scanning its content for balanced parentheses, which is
+     * much faster than tokenizing it.
+     *
+     * @return false if the sections could not be found, in which case the board must be
+     *  parsed sequentially; the lexer is then back at the end of the header.
+     */
+    bool            splitBoardSections( std::vector<BOARD_SECTION>& aSections );
+
+    /**
+     * Parses the sections found by splitBoardSections() in file order.  Consecutive board
+     * items are parsed on worker threads, other sections are parsed by this parser.
+     */
+    void            parseBoardSections( const std::vector<BOARD_SECTION>& aSections,
+                                        std::map<wxString, wxString>& aProperties );
+
+    /**
+     * Parses the board items aSections[aFirst, aLast) on worker threads, and adds them to the
+     * board in file order.
+     */
+    void            parseBoardItems( const std::vector<BOARD_SECTION>& aSections, size_t aFirst,
+                                     size_t aLast );
+
+    /**
+     * Parses @a aSection with this parser.  Board items are added to the board.
+     */
+    void            parseSectionText( const BOARD_SECTION& aSection,
+                                      std::map<wxString, wxString>& aProperties );
+
+    /**
+     * Returns the text of @a aSection, indented so that offsets in its first line are the
+     * same as in the file.
+     */
+    static std::string sectionText( const BOARD_SECTION& aSection );
+
+    /**
+     * Prepares this parser to parse board items of the board being parsed by @a aParser on a
+     * worker thread, with a copy of its layer and net mappings.
+     */
+    void            initWorker( const PCB_PARSER& aParser );
+
     /**
      * Function lookUpLayer
      * parses the current token for the layer definition of a #BOARD_ITEM object.
@@ -303,7 +400,7 @@ class PCB_PARSER : public PCB_LEXER
 
     inline int parseInt()
     {
-        return (int)strtol( CurText(), NULL, 10 );
+        return (int)strtol( CurTokenText(), NULL, 10 );
     }
 
     inline int parseInt( const char* aExpected )
@@ -315,7 +412,7 @@ class PCB_PARSER : public PCB_LEXER
     inline long parseHex()
     {
         NextTok();
-        return strtol( CurText(), NULL, 16 );
+        return strtol( CurTokenText(), NULL, 16 );
     }
 
     bool parseBool();
@@ -333,10 +430,22 @@ class PCB_PARSER : public PCB_LEXER
 
 public:
 
+    ///> A top level section of a board file, e.g. a (footprint ...) or a (net ...)
+    struct BOARD_SECTION
+    {
+        const char*   begin;    ///< the opening parenthesis
+        const char*   end;      ///< just after the closing parenthesis
+        int           line;     ///< line number of begin, counted from 1
+        int           column;   ///< offset of begin in its line
+        PCB_KEYS_T::T token;    ///< the token following the opening parenthesis
+    };
+
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
         m_board( 0 ),
-        m_resetKIIDs( false )
+        m_resetKIIDs( false ),
+        m_isWorker( false ),
+        m_deferFootprintBodies( false )
     {
         init();
     }
@@ -366,6 +475,23 @@ public:
     }
 
     BOARD_ITEM* Parse();
+
+    /**
+     * Parses more top level sections into the board of the last Parse(), such as the item
+     * records of a board snapshot.  Board items are parsed on worker threads.
+     *
+     * @param aSections are the sections to parse, in file order.  Their token is found here
+     *  from their text.
+     */
+    void ParseBoardSections( std::vector<BOARD_SECTION>& aSections );
+
+    /**
+     * Leaves the graphic items and 3D models of the footprints parsed outside of a board
+     * unparsed until they are used, see FOOTPRINT::SetDeferredBody().  Only footprints read
+     * from a #MAPPED_FILE_LINE_READER are deferred, the others are parsed as usual.
+     */
+    void SetDeferFootprintBodies( bool aDefer ) { m_deferFootprintBodies = aDefer; }
+
     /**
      * Function parseFOOTPRINT
      * @param aInitialComments may be a pointer to a heap allocated initial comment block
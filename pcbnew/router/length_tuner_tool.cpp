@@ -36,6 +36,7 @@
 #include "pns_segment.h"
 #include "pns_router.h"
 #include "pns_meander_placer.h" // fixme: move settings to separate header
+#include "pns_meander_batch_tuner.h"
 #include "pns_tune_status_popup.h"
 
 #include "length_tuner_tool.h"
@@ -92,6 +93,9 @@ static TOOL_ACTION ACT_AmplDecrease( "pcbnew.LengthTuner.AmplDecrease",
         _( "Decrease Amplitude" ), _( "Decrease meander amplitude by one step." ),
         router_len_tuner_amplitude_decr_xpm );
 
+// Posted when the background tuning of the placer has a new result to display
+static TOOL_ACTION ACT_TuningUpdated( "pcbnew.LengthTuner.TuningUpdated", AS_CONTEXT );
+
 #undef _
 #define _(s) wxGetTranslation((s))
 
@@ -172,6 +176,21 @@ void LENGTH_TUNER_TOOL::performTuning()
 
     placer->UpdateSettings( m_savedMeanderSettings );
 
+    // Fit the meanders in the background, so that the tool keeps up with the cursor on long
+    // lines.  The notifier is called from the tuning thread.
+    PCB_EDIT_FRAME* editFrame = frame();
+    TOOL_MANAGER*   toolMgr = m_toolMgr;
+
+    placer->SetTuningNotifier(
+            [editFrame, toolMgr]()
+            {
+                editFrame->CallAfter(
+                        [toolMgr]()
+                        {
+                            toolMgr->PostEvent( ACT_TuningUpdated.MakeEvent() );
+                        } );
+            } );
+
     VECTOR2I end = getViewControls()->GetMousePosition();
 
     // Create an instance of PNS_TUNE_STATUS_POPUP.
@@ -204,6 +223,12 @@ void LENGTH_TUNER_TOOL::performTuning()
             m_router->Move( end, NULL );
             updateStatusPopup( statusPopup );
         }
+        else if( evt->IsAction( &ACT_TuningUpdated ) )
+        {
+            // Picks up the result of the background tuning
+            m_router->Move( end, NULL );
+            updateStatusPopup( statusPopup );
+        }
         else if( evt->IsClick( BUT_LEFT ) )
         {
             if( m_router->FixRoute( evt->Position(), NULL ) )
@@ -264,6 +289,74 @@ void LENGTH_TUNER_TOOL::setTransitions()
     Go( &LENGTH_TUNER_TOOL::MainLoop, PCB_ACTIONS::routerTuneSingleTrace.MakeEvent() );
     Go( &LENGTH_TUNER_TOOL::MainLoop, PCB_ACTIONS::routerTuneDiffPair.MakeEvent() );
     Go( &LENGTH_TUNER_TOOL::MainLoop, PCB_ACTIONS::routerTuneDiffPairSkew.MakeEvent() );
+    Go( &LENGTH_TUNER_TOOL::TuneSelectedNets, PCB_ACTIONS::routerTuneSelectedNets.MakeEvent() );
+}
+
+
+int LENGTH_TUNER_TOOL::TuneSelectedNets( const TOOL_EVENT& aEvent )
+{
+    if( m_router->RoutingInProgress() )
+        return 0;
+
+    // Sorted, so that conflicts between nets are always resolved in the same order
+    std::set<int> nets;
+
+    for( EDA_ITEM* item : selection() )
+    {
+        BOARD_CONNECTED_ITEM* connected = dynamic_cast<BOARD_CONNECTED_ITEM*>( item );
+
+        if( connected && connected->GetNetCode() > 0 )
+            nets.insert( connected->GetNetCode() );
+    }
+
+    if( nets.empty() )
+    {
+        frame()->ShowInfoBarError( _( "Select tracks of the nets to length-match first." ) );
+        return 0;
+    }
+
+    m_router->SyncWorld();
+
+    PNS::MEANDER_BATCH_TUNER tuner( m_router );
+
+    tuner.SetMeanderSettings( m_savedMeanderSettings );
+
+    wxBusyCursor dummy;
+    PNS::NODE*   tuned = tuner.Tune( std::vector<int>( nets.begin(), nets.end() ) );
+
+    if( tuned )
+    {
+        // All the nets go into a single commit, so that they can be undone at once
+        m_router->CommitRouting( tuned );
+    }
+    else
+    {
+        m_router->GetWorld()->KillChildren();
+    }
+
+    int matched = 0;
+    int failed = 0;
+
+    for( const PNS::MEANDER_BATCH_TUNER::NET_RESULT& result : tuner.Results() )
+    {
+        if( result.m_tuned && result.m_status == PNS::MEANDER_PLACER_BASE::TUNED )
+            matched++;
+        else
+            failed++;
+    }
+
+    if( failed )
+    {
+        frame()->ShowInfoBarWarning( wxString::Format( _( "%d nets length-matched, %d could "
+                                                          "not be tuned to their target length." ),
+                                                       matched, failed ) );
+    }
+    else
+    {
+        frame()->ShowInfoBarMsg( wxString::Format( _( "%d nets length-matched." ), matched ) );
+    }
+
+    return 0;
 }
 
 
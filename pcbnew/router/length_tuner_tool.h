@@ -41,6 +41,9 @@ public:
 
     int MainLoop( const TOOL_EVENT& aEvent );
 
+    ///> Length-matches the nets of the selected items
+    int TuneSelectedNets( const TOOL_EVENT& aEvent );
+
     void setTransitions() override;
 
 private:
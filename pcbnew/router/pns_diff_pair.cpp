@@ -483,6 +483,21 @@ void DP_GATEWAYS::BuildFromPrimitivePair( const DP_PRIMITIVE_PAIR& aPair, bool a
         break;
     }
 
+    case SH_ARC:
+    {
+        // The bounding box already includes the arc width.
+        const BOX2I bbox = shP->BBox();
+        int         w = bbox.GetWidth();
+        int         h = bbox.GetHeight();
+
+        if( w < h )
+            std::swap( w, h );
+
+        orthoFanDistance = ( w + 1 )* 3 / 2;
+        diagFanDistance = ( w - h );
+        break;
+    }
+
     default:
         BuildGeneric ( p0_p, p0_n, true );
         return;
@@ -51,6 +51,7 @@ DP_MEANDER_PLACER::DP_MEANDER_PLACER( ROUTER* aRouter ) :
 
 DP_MEANDER_PLACER::~DP_MEANDER_PLACER()
 {
+    stopTuning();
 }
 
 
@@ -169,14 +170,32 @@ bool DP_MEANDER_PLACER::pairOrientation( const DIFF_PAIR::COUPLED_SEGMENTS& aPai
 
 bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
 {
-//    return false;
+    // The world doesn't change while tuning, so the same (empty) branch is used to check
+    // the meanders for all cursor positions
+    if( !m_currentNode )
+        m_currentNode = m_world->Branch();
 
-    DIFF_PAIR::COUPLED_SEGMENTS_VEC coupledSegments;
+    for( const ITEM* item : m_tunedPathP.CItems() )
+    {
+        if( const LINE* l = dyn_cast<const LINE*>( item ) )
+            Dbg()->AddLine( l->CLine(), 5, 10000 );
+    }
 
-    if( m_currentNode )
-        delete m_currentNode;
+    for( const ITEM* item : m_tunedPathN.CItems() )
+    {
+        if( const LINE* l = dyn_cast<const LINE*>( item ) )
+            Dbg()->AddLine( l->CLine(), 5, 10000 );
+    }
+
+    requestTuning( aP );
+
+    return true;
+}
 
-    m_currentNode = m_world->Branch();
+
+bool DP_MEANDER_PLACER::tune( const VECTOR2I& aP, TUNING_RESULT& aResult )
+{
+    DIFF_PAIR::COUPLED_SEGMENTS_VEC coupledSegments;
 
     SHAPE_LINE_CHAIN preP, tunedP, postP;
     SHAPE_LINE_CHAIN preN, tunedN, postN;
@@ -209,26 +228,12 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
 
     m_result.SetBaselineOffset( offset );
 
-    for( const ITEM* item : m_tunedPathP.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-            Dbg()->AddLine( l->CLine(), 5, 10000 );
-    }
-
-    for( const ITEM* item : m_tunedPathN.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-            Dbg()->AddLine( l->CLine(), 5, 10000 );
-    }
-
     int curIndexP = 0, curIndexN = 0;
 
     for( const DIFF_PAIR::COUPLED_SEGMENTS& sp : coupledSegments )
     {
         SEG base = baselineSegment( sp );
 
-        Dbg()->AddSegment( base, 3 );
-
         while( sp.indexP >= curIndexP )
         {
             m_result.AddCorner( tunedP.CPoint( curIndexP ), tunedN.CPoint( curIndexN ) );
@@ -241,7 +246,7 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
             curIndexN++;
         }
 
-        m_result.MeanderSegment( base );
+        meanderSegment( m_result, base );
     }
 
     while( curIndexP < tunedP.PointCount() )
@@ -250,22 +255,25 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
     while( curIndexN < tunedN.PointCount() )
         m_result.AddCorner( tunedP.CPoint( -1 ), tunedN.CPoint( curIndexN++ ) );
 
+    if( TuningCancelled() )
+        return false;
+
     long long int dpLen = origPathLength();
 
-    m_lastStatus = TUNED;
+    aResult.m_status = TUNED;
 
     if( dpLen - m_settings.m_targetLength > m_settings.m_lengthTolerance )
     {
-        m_lastStatus = TOO_LONG;
-        m_lastLength = dpLen;
+        aResult.m_status = TOO_LONG;
+        aResult.m_length = dpLen;
     }
     else
     {
-        m_lastLength = dpLen - std::max( tunedP.Length(), tunedN.Length() );
+        aResult.m_length = dpLen - std::max( tunedP.Length(), tunedN.Length() );
         tuneLineLength( m_result, m_settings.m_targetLength - dpLen );
     }
 
-    if( m_lastStatus != TOO_LONG )
+    if( aResult.m_status != TOO_LONG )
     {
         tunedP.Clear();
         tunedN.Clear();
@@ -279,36 +287,48 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
             }
         }
 
-        m_lastLength += std::max( tunedP.Length(), tunedN.Length() );
+        aResult.m_length += std::max( tunedP.Length(), tunedN.Length() );
 
-        int comp = compareWithTolerance( m_lastLength - m_settings.m_targetLength, 0, m_settings.m_lengthTolerance );
+        int comp = compareWithTolerance( aResult.m_length - m_settings.m_targetLength, 0, m_settings.m_lengthTolerance );
 
         if( comp > 0 )
-            m_lastStatus = TOO_LONG;
+            aResult.m_status = TOO_LONG;
         else if( comp < 0 )
-            m_lastStatus = TOO_SHORT;
+            aResult.m_status = TOO_SHORT;
         else
-            m_lastStatus = TUNED;
+            aResult.m_status = TUNED;
     }
 
-    m_finalShapeP.Clear();
-    m_finalShapeP.Append( preP );
-    m_finalShapeP.Append( tunedP );
-    m_finalShapeP.Append( postP );
-    m_finalShapeP.Simplify();
+    SHAPE_LINE_CHAIN& finalShapeP = aResult.m_shapes[0];
+    SHAPE_LINE_CHAIN& finalShapeN = aResult.m_shapes[1];
+
+    finalShapeP.Append( preP );
+    finalShapeP.Append( tunedP );
+    finalShapeP.Append( postP );
+    finalShapeP.Simplify();
 
-    m_finalShapeN.Clear();
-    m_finalShapeN.Append( preN );
-    m_finalShapeN.Append( tunedN );
-    m_finalShapeN.Append( postN );
-    m_finalShapeN.Simplify();
+    finalShapeN.Append( preN );
+    finalShapeN.Append( tunedN );
+    finalShapeN.Append( postN );
+    finalShapeN.Simplify();
 
     return true;
 }
 
 
+void DP_MEANDER_PLACER::applyResult( const TUNING_RESULT& aResult )
+{
+    m_finalShapeP = aResult.m_shapes[0];
+    m_finalShapeN = aResult.m_shapes[1];
+    m_lastLength = aResult.m_length;
+    m_lastStatus = aResult.m_status;
+}
+
+
 bool DP_MEANDER_PLACER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
+    finishTuning();
+
     LINE lP( m_originPair.PLine(), m_finalShapeP );
     LINE lN( m_originPair.NLine(), m_finalShapeN );
 
@@ -323,6 +343,7 @@ bool DP_MEANDER_PLACER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForc
 
 bool DP_MEANDER_PLACER::AbortPlacement()
 {
+    stopTuning();
     m_world->KillChildren();
     return true;
 }
@@ -337,6 +358,8 @@ bool DP_MEANDER_PLACER::HasPlacedAnything() const
 
 bool DP_MEANDER_PLACER::CommitPlacement()
 {
+    stopTuning();
+
     if( m_currentNode )
         Router()->CommitRouting( m_currentNode );
 
@@ -347,6 +370,9 @@ bool DP_MEANDER_PLACER::CommitPlacement()
 
 bool DP_MEANDER_PLACER::CheckFit( MEANDER_SHAPE* aShape )
 {
+    if( TuningCancelled() )
+        return false;
+
     LINE l1( m_originPair.PLine(), aShape->CLine( 0 ) );
     LINE l2( m_originPair.NLine(), aShape->CLine( 1 ) );
 
@@ -114,12 +114,16 @@ public:
 
     bool CheckFit( MEANDER_SHAPE* aShape ) override;
 
+protected:
+    /// @copydoc MEANDER_PLACER_BASE::tune()
+    bool tune( const VECTOR2I& aP, TUNING_RESULT& aResult ) override;
+
+    /// @copydoc MEANDER_PLACER_BASE::applyResult()
+    void applyResult( const TUNING_RESULT& aResult ) override;
 
 private:
     friend class MEANDER_SHAPE;
 
-    void meanderSegment( const SEG& aBase );
-
 //    void addMeander ( PNS_MEANDER *aM );
 //    void addCorner ( const VECTOR2I& aP );
 
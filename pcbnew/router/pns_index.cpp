@@ -19,12 +19,245 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdint>
+
 #include "pns_index.h"
 #include "pns_router.h"
 
 namespace PNS {
 
 
+// need these until C++17
+constexpr size_t LAYER_INDEX::FANOUT;
+constexpr size_t LAYER_INDEX::MIN_OVERLAY_SIZE;
+constexpr size_t LAYER_INDEX::OVERLAY_RATIO;
+
+
+// Position of a point along a Hilbert curve filling a 65536 x 65536 grid. Based on the
+// branchless algorithm from http://threadlocalmutex.com/?p=126
+static uint32_t hilbertIndex( uint32_t aX, uint32_t aY )
+{
+    uint32_t a = aX ^ aY;
+    uint32_t b = 0xFFFF ^ a;
+    uint32_t c = 0xFFFF ^ ( aX | aY );
+    uint32_t d = aX & ( aY ^ 0xFFFF );
+
+    uint32_t A = a | ( b >> 1 );
+    uint32_t B = ( a >> 1 ) ^ a;
+    uint32_t C = ( ( c >> 1 ) ^ ( b & ( d >> 1 ) ) ) ^ c;
+    uint32_t D = ( ( a & ( c >> 1 ) ) ^ ( d >> 1 ) ) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ( a & ( a >> 2 ) ) ^ ( b & ( b >> 2 ) );
+    B = ( a & ( b >> 2 ) ) ^ ( b & ( ( a ^ b ) >> 2 ) );
+    C ^= ( a & ( c >> 2 ) ) ^ ( b & ( d >> 2 ) );
+    D ^= ( b & ( c >> 2 ) ) ^ ( ( a ^ b ) & ( d >> 2 ) );
+
+    a = A; b = B; c = C; d = D;
+    A = ( a & ( a >> 4 ) ) ^ ( b & ( b >> 4 ) );
+    B = ( a & ( b >> 4 ) ) ^ ( b & ( ( a ^ b ) >> 4 ) );
+    C ^= ( a & ( c >> 4 ) ) ^ ( b & ( d >> 4 ) );
+    D ^= ( b & ( c >> 4 ) ) ^ ( ( a ^ b ) & ( d >> 4 ) );
+
+    a = A; b = B; c = C; d = D;
+    C ^= ( a & ( c >> 8 ) ) ^ ( b & ( d >> 8 ) );
+    D ^= ( b & ( c >> 8 ) ) ^ ( ( a ^ b ) & ( d >> 8 ) );
+
+    a = C ^ ( C >> 1 );
+    b = D ^ ( D >> 1 );
+
+    uint32_t i0 = aX ^ aY;
+    uint32_t i1 = b | ( 0xFFFF ^ ( i0 | a ) );
+
+    i0 = ( i0 | ( i0 << 8 ) ) & 0x00FF00FF;
+    i0 = ( i0 | ( i0 << 4 ) ) & 0x0F0F0F0F;
+    i0 = ( i0 | ( i0 << 2 ) ) & 0x33333333;
+    i0 = ( i0 | ( i0 << 1 ) ) & 0x55555555;
+
+    i1 = ( i1 | ( i1 << 8 ) ) & 0x00FF00FF;
+    i1 = ( i1 | ( i1 << 4 ) ) & 0x0F0F0F0F;
+    i1 = ( i1 | ( i1 << 2 ) ) & 0x33333333;
+    i1 = ( i1 | ( i1 << 1 ) ) & 0x55555555;
+
+    return ( i1 << 1 ) | i0;
+}
+
+
+LAYER_INDEX::RECT LAYER_INDEX::makeRect( const BOX2I& aBox )
+{
+    RECT r;
+
+    r.m_minX = std::min( aBox.GetX(), aBox.GetRight() );
+    r.m_minY = std::min( aBox.GetY(), aBox.GetBottom() );
+    r.m_maxX = std::max( aBox.GetX(), aBox.GetRight() );
+    r.m_maxY = std::max( aBox.GetY(), aBox.GetBottom() );
+
+    return r;
+}
+
+
+void LAYER_INDEX::Add( ITEM* aItem, const BOX2I& aBBox )
+{
+    m_locations[aItem] = { false, m_overlayItems.size() };
+    m_overlayItems.push_back( aItem );
+    m_overlayRects.push_back( makeRect( aBBox ) );
+
+    if( m_overlayItems.size() > std::max( MIN_OVERLAY_SIZE, m_packedItems.size() / OVERLAY_RATIO ) )
+        repack();
+}
+
+
+void LAYER_INDEX::Remove( ITEM* aItem )
+{
+    auto it = m_locations.find( aItem );
+
+    if( it == m_locations.end() )
+        return;
+
+    LOCATION loc = it->second;
+    m_locations.erase( it );
+
+    if( loc.m_packed )
+    {
+        m_packedItems[loc.m_pos] = nullptr;
+        m_removedCount++;
+
+        if( m_removedCount == m_packedItems.size()
+                || m_removedCount > std::max( MIN_OVERLAY_SIZE, m_packedItems.size() / 2 ) )
+        {
+            repack();
+        }
+    }
+    else
+    {
+        if( loc.m_pos != m_overlayItems.size() - 1 )
+        {
+            m_overlayItems[loc.m_pos] = m_overlayItems.back();
+            m_overlayRects[loc.m_pos] = m_overlayRects.back();
+            m_locations[ m_overlayItems[loc.m_pos] ].m_pos = loc.m_pos;
+        }
+
+        m_overlayItems.pop_back();
+        m_overlayRects.pop_back();
+    }
+}
+
+
+void LAYER_INDEX::Pack()
+{
+    if( !m_overlayItems.empty() || m_removedCount )
+        repack();
+}
+
+
+void LAYER_INDEX::repack()
+{
+    std::vector<ITEM*> items;
+    std::vector<RECT>  rects;
+
+    items.reserve( m_packedItems.size() - m_removedCount + m_overlayItems.size() );
+    rects.reserve( items.capacity() );
+
+    for( size_t i = 0; i < m_packedItems.size(); i++ )
+    {
+        if( m_packedItems[i] )
+        {
+            items.push_back( m_packedItems[i] );
+            rects.push_back( m_packedRects[i] );
+        }
+    }
+
+    items.insert( items.end(), m_overlayItems.begin(), m_overlayItems.end() );
+    rects.insert( rects.end(), m_overlayRects.begin(), m_overlayRects.end() );
+
+    m_packedItems.clear();
+    m_packedRects.clear();
+    m_levelOffsets.clear();
+    m_overlayItems.clear();
+    m_overlayRects.clear();
+    m_removedCount = 0;
+
+    if( items.empty() )
+    {
+        m_locations.clear();
+        return;
+    }
+
+    // Order the items along a Hilbert curve, so that neighbouring leaves (and the nodes
+    // built from them) cover compact areas of the board
+    int64_t minX = INT64_MAX, minY = INT64_MAX, maxX = INT64_MIN, maxY = INT64_MIN;
+
+    for( const RECT& r : rects )
+    {
+        int64_t cx = ( (int64_t) r.m_minX + r.m_maxX ) / 2;
+        int64_t cy = ( (int64_t) r.m_minY + r.m_maxY ) / 2;
+
+        minX = std::min( minX, cx );
+        minY = std::min( minY, cy );
+        maxX = std::max( maxX, cx );
+        maxY = std::max( maxY, cy );
+    }
+
+    double scaleX = maxX > minX ? 65535.0 / ( maxX - minX ) : 0.0;
+    double scaleY = maxY > minY ? 65535.0 / ( maxY - minY ) : 0.0;
+
+    std::vector<std::pair<uint32_t, size_t>> order( items.size() );
+
+    for( size_t i = 0; i < items.size(); i++ )
+    {
+        const RECT& r = rects[i];
+        int64_t     cx = ( (int64_t) r.m_minX + r.m_maxX ) / 2;
+        int64_t     cy = ( (int64_t) r.m_minY + r.m_maxY ) / 2;
+
+        order[i] = { hilbertIndex( (uint32_t) ( ( cx - minX ) * scaleX ),
+                                   (uint32_t) ( ( cy - minY ) * scaleY ) ),
+                     i };
+    }
+
+    std::sort( order.begin(), order.end() );
+
+    m_packedItems.reserve( items.size() );
+    m_packedRects.reserve( items.size() + items.size() / ( FANOUT - 1 ) + 1 );
+
+    for( const std::pair<uint32_t, size_t>& entry : order )
+    {
+        m_locations[ items[entry.second] ] = { true, m_packedItems.size() };
+        m_packedItems.push_back( items[entry.second] );
+        m_packedRects.push_back( rects[entry.second] );
+    }
+
+    // Build the upper levels, each node covering FANOUT consecutive nodes of the level below,
+    // until the top level is small enough to be scanned directly
+    m_levelOffsets.push_back( 0 );
+    m_levelOffsets.push_back( m_packedRects.size() );
+
+    while( levelSize( m_levelOffsets.size() - 2 ) > FANOUT )
+    {
+        size_t begin = m_levelOffsets[m_levelOffsets.size() - 2];
+        size_t end = m_levelOffsets.back();
+
+        for( size_t first = begin; first < end; first += FANOUT )
+        {
+            RECT bbox = m_packedRects[first];
+
+            for( size_t i = first + 1; i < std::min( first + FANOUT, end ); i++ )
+            {
+                const RECT& r = m_packedRects[i];
+
+                bbox.m_minX = std::min( bbox.m_minX, r.m_minX );
+                bbox.m_minY = std::min( bbox.m_minY, r.m_minY );
+                bbox.m_maxX = std::max( bbox.m_maxX, r.m_maxX );
+                bbox.m_maxY = std::max( bbox.m_maxY, r.m_maxY );
+            }
+
+            m_packedRects.push_back( bbox );
+        }
+
+        m_levelOffsets.push_back( m_packedRects.size() );
+    }
+}
+
+
 void INDEX::Add( ITEM* aItem )
 {
     const LAYER_RANGE& range = aItem->Layers();
@@ -46,13 +279,13 @@ void INDEX::Add( ITEM* aItem )
                             aItem->Parent()->GetClass(),
                             aItem->Anchor( 0 ).x,
                             aItem->Anchor( 0 ).y );
-                m_subIndices[i].Add( aItem );
+                m_subIndices[i].Add( aItem, aItem->Shape()->BBox() );
             }
 
         }
         else
         {
-            m_subIndices[i].Add( aItem );
+            m_subIndices[i].Add( aItem, aItem->Shape()->BBox() );
         }
     }
 
@@ -77,8 +310,22 @@ void INDEX::Remove( ITEM* aItem )
     m_allItems.erase( aItem );
     int net = aItem->Net();
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    if( net < 0 )
+        return;
+
+    auto it = m_netMap.find( net );
+
+    if( it != m_netMap.end() )
+    {
+        NET_ITEMS_LIST& netItems = it->second;
+        auto            pos = std::find( netItems.begin(), netItems.end(), aItem );
+
+        if( pos != netItems.end() )
+        {
+            *pos = netItems.back();
+            netItems.pop_back();
+        }
+    }
 }
 
 
@@ -89,12 +336,21 @@ void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
 }
 
 
+void INDEX::Pack()
+{
+    for( LAYER_INDEX& subIndex : m_subIndices )
+        subIndex.Pack();
+}
+
+
 INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    auto it = m_netMap.find( aNet );
+
+    if( it == m_netMap.end() )
         return NULL;
 
-    return &m_netMap[aNet];
+    return &it->second;
 }
 
 };
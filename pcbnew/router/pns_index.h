@@ -22,31 +22,115 @@
 #ifndef __PNS_INDEX_H
 #define __PNS_INDEX_H
 
-#include <deque>
-#include <list>
-#include <map>
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <layers_id_colors_and_visibility.h>
-#include <geometry/shape_index.h>
+#include <math/box2.h>
 
 #include "pns_item.h"
 
 namespace PNS {
 
 
+/**
+ * LAYER_INDEX
+ *
+ * Spatial index of the items on a single layer.  Most of the items live in a packed
+ * R-tree: the items are sorted along a Hilbert curve and the tree levels are stored in flat
+ * arrays, so a query walks contiguous memory instead of chasing node pointers.  Items added
+ * after the last packing go to a small overlay that is searched linearly, and removed items
+ * leave a hole in the packed tree.  The tree is rebuilt once the overlay or the holes grow
+ * too large compared to the packed part, which keeps the cost of mutations amortized.
+ */
+class LAYER_INDEX
+{
+public:
+    LAYER_INDEX() :
+        m_removedCount( 0 )
+    {}
+
+    void Add( ITEM* aItem, const BOX2I& aBBox );
+
+    void Remove( ITEM* aItem );
+
+    /**
+     * Moves all overlay items to the packed tree.  Worth calling after a bulk update.
+     */
+    void Pack();
+
+    /**
+     * Calls aVisitor for each item whose bounding box overlaps aBox, until the visitor
+     * returns false.
+     * @return number of visited items.
+     */
+    template <class Visitor>
+    int Query( const BOX2I& aBox, Visitor& aVisitor ) const;
+
+private:
+    struct RECT
+    {
+        int m_minX, m_minY, m_maxX, m_maxY;
+
+        bool Overlaps( const RECT& aOther ) const
+        {
+            return m_minX <= aOther.m_maxX && aOther.m_minX <= m_maxX
+                    && m_minY <= aOther.m_maxY && aOther.m_minY <= m_maxY;
+        }
+    };
+
+    struct LOCATION
+    {
+        bool   m_packed;
+        size_t m_pos;
+    };
+
+    ///> Number of children of each node of the packed tree
+    static constexpr size_t FANOUT = 16;
+
+    ///> The overlay is searched linearly and is repacked once it grows beyond
+    ///> max( MIN_OVERLAY_SIZE, packed size / OVERLAY_RATIO )
+    static constexpr size_t MIN_OVERLAY_SIZE = 64;
+    static constexpr size_t OVERLAY_RATIO = 8;
+
+    static RECT makeRect( const BOX2I& aBox );
+
+    size_t levelSize( size_t aLevel ) const
+    {
+        return m_levelOffsets[aLevel + 1] - m_levelOffsets[aLevel];
+    }
+
+    template <class Visitor>
+    bool queryNode( size_t aLevel, size_t aNode, const RECT& aRect, Visitor& aVisitor,
+                    int& aCount ) const;
+
+    void repack();
+
+    std::vector<ITEM*>  m_packedItems;      ///> leaves of the tree, nullptr marks a removed item
+    std::vector<RECT>   m_packedRects;      ///> bounding boxes of all levels, leaves first
+    std::vector<size_t> m_levelOffsets;     ///> start of each level in m_packedRects, plus the end
+    size_t              m_removedCount;
+
+    std::vector<ITEM*>  m_overlayItems;
+    std::vector<RECT>   m_overlayRects;
+
+    std::unordered_map<ITEM*, LOCATION> m_locations;
+};
+
+
 /**
  * INDEX
  *
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
- * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
- * overlap and improving search time.
+ * are assigned to separate spatial subindices depending on their type and spanned layers,
+ * reducing overlap and improving search time.
  **/
 class INDEX
 {
 public:
-    typedef std::list<ITEM*>            NET_ITEMS_LIST;
-    typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
+    typedef std::vector<ITEM*>          NET_ITEMS_LIST;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
     INDEX(){};
@@ -66,6 +150,11 @@ public:
      */
     void Replace( ITEM* aOldItem, ITEM* aNewItem );
 
+    /**
+     * Packs the spatial subindices.  Should be called after adding many items at once.
+     */
+    void Pack();
+
     /**
      * Searches items in the index that are in proximity of aItem.
      * For each item, function object aVisitor is called. Only items on
@@ -120,21 +209,85 @@ public:
 private:
 
     template <class Visitor>
-    int querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const;
+    int querySingle( std::size_t aIndex, const BOX2I& aBox, Visitor& aVisitor ) const;
 
-    std::deque<ITEM_SHAPE_INDEX> m_subIndices;
-    std::map<int, NET_ITEMS_LIST> m_netMap;
+    std::vector<LAYER_INDEX> m_subIndices;
+    std::unordered_map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
 };
 
 
+template <class Visitor>
+int LAYER_INDEX::Query( const BOX2I& aBox, Visitor& aVisitor ) const
+{
+    const RECT rect = makeRect( aBox );
+    int        count = 0;
+
+    if( !m_packedItems.empty() )
+    {
+        size_t top = m_levelOffsets.size() - 2;
+
+        for( size_t node = 0; node < levelSize( top ); node++ )
+        {
+            if( !queryNode( top, node, rect, aVisitor, count ) )
+                return count;
+        }
+    }
+
+    for( size_t i = 0; i < m_overlayRects.size(); i++ )
+    {
+        if( m_overlayRects[i].Overlaps( rect ) )
+        {
+            if( !aVisitor( m_overlayItems[i] ) )
+                return count;
+
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+template <class Visitor>
+bool LAYER_INDEX::queryNode( size_t aLevel, size_t aNode, const RECT& aRect,
+                             Visitor& aVisitor, int& aCount ) const
+{
+    if( !m_packedRects[ m_levelOffsets[aLevel] + aNode ].Overlaps( aRect ) )
+        return true;
+
+    if( aLevel == 0 )
+    {
+        if( !m_packedItems[aNode] )
+            return true;
+
+        if( !aVisitor( m_packedItems[aNode] ) )
+            return false;
+
+        aCount++;
+        return true;
+    }
+
+    size_t first = aNode * FANOUT;
+    size_t last = std::min( first + FANOUT, levelSize( aLevel - 1 ) );
+
+    for( size_t child = first; child < last; child++ )
+    {
+        if( !queryNode( aLevel - 1, child, aRect, aVisitor, aCount ) )
+            return false;
+    }
+
+    return true;
+}
+
+
 template<class Visitor>
-int INDEX::querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
+int INDEX::querySingle( std::size_t aIndex, const BOX2I& aBox, Visitor& aVisitor ) const
 {
     if( aIndex >= m_subIndices.size() )
         return 0;
 
-    return m_subIndices[aIndex].Query( aShape, aMinDistance, aVisitor);
+    return m_subIndices[aIndex].Query( aBox, aVisitor );
 }
 
 template<class Visitor>
@@ -143,9 +296,12 @@ int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor ) const
     int total = 0;
 
     const LAYER_RANGE& layers = aItem->Layers();
+    BOX2I box = aItem->Shape()->BBox();
+
+    box.Inflate( aMinDistance );
 
     for( int i = layers.Start(); i <= layers.End(); ++i )
-        total += querySingle( i, aItem->Shape(), aMinDistance, aVisitor );
+        total += querySingle( i, box, aVisitor );
 
     return total;
 }
@@ -154,9 +310,12 @@ template<class Visitor>
 int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
 {
     int total = 0;
+    BOX2I box = aShape->BBox();
+
+    box.Inflate( aMinDistance );
 
     for( std::size_t i = 0; i < m_subIndices.size(); ++i )
-        total += querySingle( i, aShape, aMinDistance, aVisitor );
+        total += querySingle( i, box, aVisitor );
 
     return total;
 }
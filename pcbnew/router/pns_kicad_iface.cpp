@@ -47,6 +47,7 @@
 #include <drc/drc_engine.h>
 
 #include <memory>
+#include <mutex>
 
 #include <advanced_config.h>
 
@@ -97,6 +98,10 @@ private:
     VIA                m_dummyVia;
 
     std::map<std::pair<const PNS::ITEM*, const PNS::ITEM*>, int> m_clearanceCache;
+
+    // Guards the clearance cache and the dummy items, as the meander placers fit their
+    // meanders on a worker thread
+    std::recursive_mutex m_lock;
 };
 
 
@@ -196,6 +201,7 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
                                                 const PNS::ITEM* aItemA, const PNS::ITEM* aItemB,
                                                 int aLayer, PNS::CONSTRAINT* aConstraint )
 {
+    std::lock_guard<std::recursive_mutex> lock( m_lock );
     std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
 
     if( !drcEngine )
@@ -269,6 +275,7 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
         case PNS::CONSTRAINT_TYPE::CT_CLEARANCE:
         case PNS::CONSTRAINT_TYPE::CT_WIDTH:
         case PNS::CONSTRAINT_TYPE::CT_DIFF_PAIR_GAP:
+        case PNS::CONSTRAINT_TYPE::CT_LENGTH:
         case PNS::CONSTRAINT_TYPE::CT_VIA_DIAMETER:
         case PNS::CONSTRAINT_TYPE::CT_VIA_HOLE:
             aConstraint->m_Value = hostConstraint.GetValue();
@@ -284,6 +291,7 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 
 int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB )
 {
+    std::lock_guard<std::recursive_mutex> lock( m_lock );
     std::pair<const PNS::ITEM*, const PNS::ITEM*> key( aA, aB );
     auto it = m_clearanceCache.find( key );
 
@@ -732,6 +740,9 @@ PNS_KICAD_IFACE_BASE::PNS_KICAD_IFACE_BASE()
     m_board = nullptr;
     m_world = nullptr;
     m_debugDecorator = nullptr;
+    m_outlineChanged = false;
+    m_fullSyncRequired = false;
+    m_ownCommit = false;
 }
 
 
@@ -746,12 +757,15 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
 
 PNS_KICAD_IFACE_BASE::~PNS_KICAD_IFACE_BASE()
 {
+    delete m_ruleResolver;
+
+    if( m_board )
+        m_board->RemoveListener( this );
 }
 
 
 PNS_KICAD_IFACE::~PNS_KICAD_IFACE()
 {
-    delete m_ruleResolver;
     delete m_debugDecorator;
 
      if( m_previewItems )
@@ -1075,6 +1089,9 @@ void PNS_KICAD_IFACE_BASE::SetBoard( BOARD* aBoard )
 {
     m_board = aBoard;
     wxLogTrace( "PNS", "m_board = %p", m_board );
+
+    if( m_board )
+        m_board->AddListener( this );
 }
 
 
@@ -1152,30 +1169,145 @@ bool PNS_KICAD_IFACE::IsItemVisible( const PNS::ITEM* aItem ) const
 }
 
 
-void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
+void PNS_KICAD_IFACE_BASE::syncFootprint( PNS::NODE* aWorld, FOOTPRINT* aFootprint,
+                                          SHAPE_POLY_SET* aBoardOutline )
 {
-    int worstPadClearance = 0;
+    for( PAD* pad : aFootprint->Pads() )
+    {
+        if( std::unique_ptr<PNS::SOLID> solid = syncPad( pad ) )
+            aWorld->Add( std::move( solid ) );
 
-    m_world = aWorld;
+        m_footprintItems[ pad ] = aFootprint;
+    }
 
-    if( !m_board )
+    syncTextItem( aWorld, &aFootprint->Reference(), aFootprint->Reference().GetLayer() );
+    syncTextItem( aWorld, &aFootprint->Value(), aFootprint->Value().GetLayer() );
+
+    m_footprintItems[ &aFootprint->Reference() ] = aFootprint;
+    m_footprintItems[ &aFootprint->Value() ] = aFootprint;
+
+    for( FP_ZONE* zone : aFootprint->Zones() )
     {
-        wxLogTrace( "PNS", "No board attached, aborting sync." );
-        return;
+        syncZone( aWorld, zone, aBoardOutline );
+        m_footprintItems[ zone ] = aFootprint;
     }
 
-    for( BOARD_ITEM* gitem : m_board->Drawings() )
+    if( aFootprint->IsNetTie() )
+        return;
+
+    for( BOARD_ITEM* mgitem : aFootprint->GraphicalItems() )
     {
-        if ( gitem->Type() == PCB_SHAPE_T )
+        if( mgitem->Type() == PCB_FP_SHAPE_T )
         {
-            syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( gitem ) );
+            syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( mgitem ) );
         }
-        else if( gitem->Type() == PCB_TEXT_T )
+        else if( mgitem->Type() == PCB_FP_TEXT_T )
         {
-            syncTextItem( aWorld, static_cast<PCB_TEXT*>( gitem ), gitem->GetLayer() );
+            syncTextItem( aWorld, static_cast<FP_TEXT*>( mgitem ), mgitem->GetLayer() );
         }
+
+        m_footprintItems[ mgitem ] = aFootprint;
+    }
+}
+
+
+void PNS_KICAD_IFACE_BASE::syncBoardItem( PNS::NODE* aWorld, BOARD_ITEM* aItem,
+                                          SHAPE_POLY_SET* aBoardOutline )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_SHAPE_T:
+        syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( aItem ) );
+        break;
+
+    case PCB_TEXT_T:
+        syncTextItem( aWorld, static_cast<PCB_TEXT*>( aItem ), aItem->GetLayer() );
+        break;
+
+    case PCB_ZONE_T:
+        syncZone( aWorld, static_cast<ZONE*>( aItem ), aBoardOutline );
+        break;
+
+    case PCB_FOOTPRINT_T:
+        syncFootprint( aWorld, static_cast<FOOTPRINT*>( aItem ), aBoardOutline );
+        break;
+
+    case PCB_TRACE_T:
+        if( auto segment = syncTrack( static_cast<TRACK*>( aItem ) ) )
+            aWorld->Add( std::move( segment ) );
+
+        break;
+
+    case PCB_ARC_T:
+        if( auto arc = syncArc( static_cast<ARC*>( aItem ) ) )
+            aWorld->Add( std::move( arc ) );
+
+        break;
+
+    case PCB_VIA_T:
+        if( auto via = syncVia( static_cast<VIA*>( aItem ) ) )
+            aWorld->Add( std::move( via ) );
+
+        break;
+
+    case PCB_PAD_T:
+        if( auto solid = syncPad( static_cast<PAD*>( aItem ) ) )
+            aWorld->Add( std::move( solid ) );
+
+        m_footprintItems[ aItem ] = aItem->GetParent();
+        break;
+
+    case PCB_FP_ZONE_T:
+        syncZone( aWorld, static_cast<ZONE*>( aItem ), aBoardOutline );
+        m_footprintItems[ aItem ] = aItem->GetParent();
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void PNS_KICAD_IFACE_BASE::syncRules( PNS::NODE* aWorld )
+{
+    int worstPadClearance = 0;
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+            worstPadClearance = std::max( worstPadClearance, pad->GetLocalClearance() );
     }
 
+    int worstRuleClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    // The resolver caches clearances by item pointer, so it cannot outlive the items it
+    // has seen.  Rebuild it on every (full or incremental) sync.
+    delete m_ruleResolver;
+    m_ruleResolver = new PNS_PCBNEW_RULE_RESOLVER( m_board, this );
+
+    aWorld->SetRuleResolver( m_ruleResolver );
+    aWorld->SetMaxClearance( 4 * std::max(worstPadClearance, worstRuleClearance ) );
+}
+
+
+void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
+{
+    m_world = aWorld;
+
+    m_changedItems.clear();
+    m_footprintItems.clear();
+    m_outlineChanged = false;
+    m_fullSyncRequired = false;
+
+    if( !m_board )
+    {
+        wxLogTrace( "PNS", "No board attached, aborting sync." );
+        return;
+    }
+
+    for( BOARD_ITEM* gitem : m_board->Drawings() )
+        syncBoardItem( aWorld, gitem, nullptr );
+
     SHAPE_POLY_SET  buffer;
     SHAPE_POLY_SET* boardOutline = nullptr;
 
@@ -1183,72 +1315,168 @@ void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
         boardOutline = &buffer;
 
     for( ZONE* zone : m_board->Zones() )
-    {
         syncZone( aWorld, zone, boardOutline );
-    }
 
     for( FOOTPRINT* footprint : m_board->Footprints() )
+        syncFootprint( aWorld, footprint, boardOutline );
+
+    for( TRACK* t : m_board->Tracks() )
+        syncBoardItem( aWorld, t, nullptr );
+
+    syncRules( aWorld );
+}
+
+
+bool PNS_KICAD_IFACE_BASE::UpdateWorld( PNS::NODE* aWorld )
+{
+    if( !m_board || aWorld != m_world || m_fullSyncRequired )
+        return false;
+
+    if( !ADVANCED_CFG::GetCfg().m_IncrementalRouterSync )
+        return false;
+
+    // Rule areas are clipped to the board outline, so they follow any change to it
+    if( m_outlineChanged )
     {
-        for( PAD* pad : footprint->Pads() )
-        {
-            if( std::unique_ptr<PNS::SOLID> solid = syncPad( pad ) )
-                aWorld->Add( std::move( solid ) );
+        for( ZONE* zone : m_board->Zones() )
+            m_changedItems[ zone ] = true;
 
-            worstPadClearance = std::max( worstPadClearance, pad->GetLocalClearance() );
+        for( FOOTPRINT* footprint : m_board->Footprints() )
+        {
+            for( FP_ZONE* zone : footprint->Zones() )
+                m_changedItems[ zone ] = true;
         }
+    }
 
-        syncTextItem( aWorld, &footprint->Reference(), footprint->Reference().GetLayer() );
-        syncTextItem( aWorld, &footprint->Value(), footprint->Value().GetLayer() );
+    if( !m_changedItems.empty() )
+    {
+        std::unordered_set<const BOARD_ITEM*> staleParents;
 
-        for( FP_ZONE* zone : footprint->Zones() )
-            syncZone( aWorld, zone, boardOutline );
+        for( const std::pair<BOARD_ITEM* const, bool>& change : m_changedItems )
+            staleParents.insert( change.first );
 
-        if( footprint->IsNetTie() )
-            continue;
+        // World items of a footprint are parented to its children, not to the footprint
+        for( auto it = m_footprintItems.begin(); it != m_footprintItems.end(); )
+        {
+            if( staleParents.count( it->first ) || staleParents.count( it->second ) )
+            {
+                staleParents.insert( it->first );
+                it = m_footprintItems.erase( it );
+            }
+            else
+            {
+                ++it;
+            }
+        }
 
-        for( BOARD_ITEM* mgitem : footprint->GraphicalItems() )
+        aWorld->RemoveByParent( staleParents );
+
+        SHAPE_POLY_SET  buffer;
+        SHAPE_POLY_SET* boardOutline = nullptr;
+        bool            outlineBuilt = false;
+
+        for( const std::pair<BOARD_ITEM* const, bool>& change : m_changedItems )
         {
-            if( mgitem->Type() == PCB_FP_SHAPE_T )
+            BOARD_ITEM* item = change.first;
+
+            if( !change.second )
+                continue;
+
+            // Footprint children are re-synced along with their footprint when both changed
+            if( item->Type() == PCB_PAD_T || item->Type() == PCB_FP_ZONE_T )
             {
-                syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( mgitem ) );
+                auto parentChange = m_changedItems.find( item->GetParent() );
+
+                if( parentChange != m_changedItems.end() && parentChange->second )
+                    continue;
             }
-            else if( mgitem->Type() == PCB_FP_TEXT_T )
+
+            if( !outlineBuilt && ( item->Type() == PCB_ZONE_T || item->Type() == PCB_FP_ZONE_T
+                                   || item->Type() == PCB_FOOTPRINT_T ) )
             {
-                syncTextItem( aWorld, static_cast<FP_TEXT*>( mgitem ), mgitem->GetLayer() );
+                if( m_board->GetBoardPolygonOutlines( buffer ) )
+                    boardOutline = &buffer;
+
+                outlineBuilt = true;
             }
+
+            syncBoardItem( aWorld, item, boardOutline );
         }
+
+        wxLogTrace( "PNS", "Incremental sync: %d board items updated",
+                    (int) m_changedItems.size() );
     }
 
-    for( TRACK* t : m_board->Tracks() )
+    m_changedItems.clear();
+    m_outlineChanged = false;
+
+    syncRules( aWorld );
+
+    return true;
+}
+
+
+void PNS_KICAD_IFACE_BASE::markChanged( BOARD_ITEM* aItem, bool aOnBoard )
+{
+    switch( aItem->Type() )
     {
-        KICAD_T type = t->Type();
+    case PCB_SHAPE_T:
+    case PCB_FP_SHAPE_T:
+        if( aItem->GetLayer() == Edge_Cuts )
+            m_outlineChanged = true;
 
-        if( type == PCB_TRACE_T )
-        {
-            if( auto segment = syncTrack( t ) )
-                aWorld->Add( std::move( segment ) );
-        }
-        else if( type == PCB_ARC_T )
-        {
-            if( auto arc = syncArc( static_cast<ARC*>( t ) ) )
-                aWorld->Add( std::move( arc ) );
-        }
-        else if( type == PCB_VIA_T )
+        break;
+
+    case PCB_FOOTPRINT_T:
+        for( BOARD_ITEM* mgitem : static_cast<FOOTPRINT*>( aItem )->GraphicalItems() )
         {
-            if( auto via = syncVia( static_cast<VIA*>( t ) ) )
-                aWorld->Add( std::move( via ) );
+            if( mgitem->Type() == PCB_FP_SHAPE_T && mgitem->GetLayer() == Edge_Cuts )
+                m_outlineChanged = true;
         }
+
+        break;
+
+    case PCB_TEXT_T:
+    case PCB_ZONE_T:
+    case PCB_TRACE_T:
+    case PCB_ARC_T:
+    case PCB_VIA_T:
+    case PCB_PAD_T:
+        break;
+
+    default:
+        // Items which never make it into the world (groups, markers, nets, dimensions...)
+        return;
     }
 
-    int worstRuleClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+    m_changedItems[ aItem ] = aOnBoard;
+}
 
-    // NB: if this were ever to become a long-lived object we would need to dirty its
-    // clearance cache here....
-    delete m_ruleResolver;
-    m_ruleResolver = new PNS_PCBNEW_RULE_RESOLVER( m_board, this );
 
-    aWorld->SetRuleResolver( m_ruleResolver );
-    aWorld->SetMaxClearance( 4 * std::max(worstPadClearance, worstRuleClearance ) );
+void PNS_KICAD_IFACE_BASE::OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    if( !m_ownCommit )
+        markChanged( aBoardItem, true );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    if( !m_ownCommit )
+        markChanged( aBoardItem, false );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aBoardItem )
+{
+    // Even our own commits need this: dragging a footprint only moves its pads in the world.
+    markChanged( aBoardItem, true );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardNetSettingsChanged( BOARD& aBoard )
+{
+    m_fullSyncRequired = true;
 }
 
 
@@ -1467,7 +1695,11 @@ void PNS_KICAD_IFACE::Commit()
 
     m_fpOffsets.clear();
 
+    // The world is updated by the router itself once the commit has been pushed
+    m_ownCommit = true;
     m_commit->Push( _( "Interactive Router" ) );
+    m_ownCommit = false;
+
     m_commit = std::make_unique<BOARD_COMMIT>( m_tool );
 }
 
@@ -22,14 +22,16 @@
 #ifndef __PNS_KICAD_IFACE_H
 #define __PNS_KICAD_IFACE_H
 
+#include <unordered_map>
 #include <unordered_set>
 
+#include <board.h>
+
 #include "pns_router.h"
 
 class PNS_PCBNEW_RULE_RESOLVER;
 class PNS_PCBNEW_DEBUG_DECORATOR;
 
-class BOARD;
 class BOARD_COMMIT;
 class PCB_DISPLAY_OPTIONS;
 class PCB_TOOL_BASE;
@@ -46,7 +48,7 @@ namespace KIGFX
     class VIEW;
 }
 
-class PNS_KICAD_IFACE_BASE : public PNS::ROUTER_IFACE
+class PNS_KICAD_IFACE_BASE : public PNS::ROUTER_IFACE, public BOARD_LISTENER
 {
 public:
     PNS_KICAD_IFACE_BASE();
@@ -55,6 +57,7 @@ public:
     void EraseView() override {};
     void SetBoard( BOARD* aBoard );
     void SyncWorld( PNS::NODE* aWorld ) override;
+    bool UpdateWorld( PNS::NODE* aWorld ) override;
     bool IsAnyLayerVisible( const LAYER_RANGE& aLayer ) const override { return true; };
     bool IsOnLayer( const PNS::ITEM* aItem, int aLayer ) const override { return true; };
     bool IsItemVisible( const PNS::ITEM* aItem ) const override { return true; }
@@ -84,6 +87,11 @@ public:
     PNS::RULE_RESOLVER* GetRuleResolver() override;
     PNS::DEBUG_DECORATOR* GetDebugDecorator() override;
 
+    void OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aBoardItem ) override;
+    void OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aBoardItem ) override;
+    void OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aBoardItem ) override;
+    void OnBoardNetSettingsChanged( BOARD& aBoard ) override;
+
 protected:
     PNS_PCBNEW_RULE_RESOLVER* m_ruleResolver;
     PNS::DEBUG_DECORATOR* m_debugDecorator;
@@ -95,11 +103,27 @@ protected:
     bool syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYER_ID aLayer );
     bool syncGraphicalItem( PNS::NODE* aWorld, PCB_SHAPE* aItem );
     bool syncZone( PNS::NODE* aWorld, ZONE* aZone, SHAPE_POLY_SET* aBoardOutline );
+    void syncFootprint( PNS::NODE* aWorld, FOOTPRINT* aFootprint, SHAPE_POLY_SET* aBoardOutline );
+    void syncBoardItem( PNS::NODE* aWorld, BOARD_ITEM* aItem, SHAPE_POLY_SET* aBoardOutline );
+    void syncRules( PNS::NODE* aWorld );
+    void markChanged( BOARD_ITEM* aItem, bool aOnBoard );
     bool inheritTrackWidth( PNS::ITEM* aItem, int* aInheritedWidth );
 
 protected:
     PNS::NODE* m_world;
     BOARD*     m_board;
+
+    ///> Board items added, removed or modified since the last sync of m_world, mapped to
+    ///> whether they are (still) on the board.
+    std::unordered_map<BOARD_ITEM*, bool> m_changedItems;
+
+    ///> Footprint children (pads, texts, shapes and zones) mapped to their footprint, so
+    ///> the world items they produced can be found when the footprint changes.
+    std::unordered_map<const BOARD_ITEM*, const BOARD_ITEM*> m_footprintItems;
+
+    bool m_outlineChanged;     ///< Rule areas must be re-clipped to a new board outline
+    bool m_fullSyncRequired;   ///< A change was made that cannot be applied incrementally
+    bool m_ownCommit;          ///< Board additions/removals are already in m_world
 };
 
 class PNS_KICAD_IFACE : public PNS_KICAD_IFACE_BASE
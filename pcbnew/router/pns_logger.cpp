@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include "pns_logger.h"
 #include "pns_item.h"
 #include "pns_via.h"
@@ -50,23 +52,57 @@ void LOGGER::Clear()
 }
 
 
-void LOGGER::Save( const std::string& aFilename )
+bool LOGGER::Save( const std::string& aFilename )
 {
     FILE* f = fopen( aFilename.c_str(), "wb" );
 
     wxLogTrace( "PNS", "Saving to '%s' [%p]", aFilename.c_str(), f );
 
-    for( const auto evt : m_events )
+    if( !f )
+        return false;
+
+    for( const EVENT_ENTRY& evt : m_events )
     {
-        uint64_t id = 0;
-        if( evt.item && evt.item->Parent() )
-        {
-            const char* idString = evt.item->Parent()->m_Uuid.AsString().c_str();
-            fprintf( f, "event %d %d %d %s\n", evt.type, evt.p.x, evt.p.y, idString );
-        }
+        wxString id = ( evt.uuid == niluuid ) ? wxString( "null" ) : evt.uuid.AsString();
+
+        fprintf( f, "event %d %d %d %s\n", evt.type, evt.p.x, evt.p.y, (const char*) id.c_str() );
     }
 
     fclose( f );
+    return true;
+}
+
+
+bool LOGGER::Load( const std::string& aFilename )
+{
+    FILE* f = fopen( aFilename.c_str(), "rb" );
+
+    if( !f )
+        return false;
+
+    m_events.clear();
+
+    int  type, x, y;
+    char id[128];
+
+    while( fscanf( f, "event %d %d %d %127s ", &type, &x, &y, id ) == 4 )
+    {
+        EVENT_ENTRY ent;
+
+        ent.type = static_cast<EVENT_TYPE>( type );
+        ent.p = VECTOR2I( x, y );
+        ent.item = nullptr;
+
+        if( strcmp( id, "null" ) != 0 )
+            ent.uuid = KIID( wxString( id ) );
+
+        m_events.push_back( ent );
+    }
+
+    bool ok = feof( f );
+
+    fclose( f );
+    return ok;
 }
 
 
@@ -78,6 +114,9 @@ void LOGGER::Log( LOGGER::EVENT_TYPE evt, VECTOR2I pos, const ITEM* item )
     ent.p = pos;
     ent.item = item;
 
+    if( item && item->Parent() )
+        ent.uuid = item->Parent()->m_Uuid;
+
     m_events.push_back( ent );
 
 }
@@ -28,6 +28,7 @@
 #include <sstream>
 
 #include <math/vector2d.h>
+#include <kiid.h>
 
 class SHAPE_LINE_CHAIN;
 class SHAPE;
@@ -52,12 +53,24 @@ public:
         VECTOR2I p;
         EVENT_TYPE type;
         const ITEM* item;
+        KIID uuid = niluuid;    ///> UUID of the board item the event refers to
     };
 
     LOGGER();
     ~LOGGER();
 
-    void Save( const std::string& aFilename );
+    /**
+     * Writes the events to a file, one per line: "event <type> <x> <y> <uuid>", with
+     * "null" in place of the UUID for events that don't refer to a board item.
+     */
+    bool Save( const std::string& aFilename );
+
+    /**
+     * Reads events written by Save(), replacing the current ones.  The events of a loaded
+     * log only carry the UUIDs of their board items, the item pointers are null.
+     */
+    bool Load( const std::string& aFilename );
+
     void Clear();
     void Log( EVENT_TYPE evt, VECTOR2I pos, const ITEM* item = nullptr );
 
@@ -62,6 +62,10 @@ void MEANDERED_LINE::MeanderSegment( const SEG& aBase, int aBaseIndex )
 
     do
     {
+        // Don't waste time on a line the placer is no longer interested in
+        if( m_placer->TuningCancelled() )
+            break;
+
         MEANDER_SHAPE m( m_placer, m_width, m_dual );
 
         m.SetBaselineOffset( m_baselineOffset );
@@ -472,12 +472,32 @@ public:
      */
     void MeanderSegment( const SEG& aSeg, int aBaseIndex = 0 );
 
+    /**
+     * Function Width()
+     *
+     * @return width of the meandered line.
+     */
+    int Width() const
+    {
+        return m_width;
+    }
+
     /// @copydoc MEANDER_SHAPE::SetBaselineOffset()
     void SetBaselineOffset( int aOffset )
     {
         m_baselineOffset = aOffset;
     }
 
+    /**
+     * Function BaselineOffset()
+     *
+     * @return the parallel offset between the base segment and the meandered line.
+     */
+    int BaselineOffset() const
+    {
+        return m_baselineOffset;
+    }
+
     /**
      * Function Meanders()
      *
@@ -0,0 +1,266 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <set>
+
+#include "pns_meander_batch_tuner.h"
+#include "pns_node.h"
+#include "pns_router.h"
+#include "pns_segment.h"
+
+namespace PNS {
+
+MEANDER_BATCH_TUNER::MEANDER_BATCH_TUNER( ROUTER* aRouter ) :
+    ALGO_BASE( aRouter )
+{
+}
+
+
+MEANDER_BATCH_TUNER::~MEANDER_BATCH_TUNER()
+{
+}
+
+
+bool MEANDER_BATCH_TUNER::findLine( NODE* aWorld, int aNet, LINE& aLine )
+{
+    std::set<ITEM*> segments, visited;
+    long long int   longest = -1;
+
+    aWorld->AllItemsInNet( aNet, segments, ITEM::SEGMENT_T );
+
+    for( ITEM* item : segments )
+    {
+        if( visited.count( item ) )
+            continue;
+
+        LINE line = aWorld->AssembleLine( static_cast<SEGMENT*>( item ) );
+
+        for( LINKED_ITEM* link : line.Links() )
+            visited.insert( link );
+
+        if( line.CLine().Length() > longest )
+        {
+            longest = line.CLine().Length();
+            aLine = line;
+        }
+    }
+
+    return longest >= 0;
+}
+
+
+bool MEANDER_BATCH_TUNER::startJob( NODE* aWorld, JOB& aJob )
+{
+    // MEANDER_PLACER starts from a segment; the start point is snapped onto it
+    SEGMENT* start = nullptr;
+
+    for( LINKED_ITEM* link : aJob.m_line.Links() )
+    {
+        if( link->OfKind( ITEM::SEGMENT_T ) )
+        {
+            start = static_cast<SEGMENT*>( link );
+            break;
+        }
+    }
+
+    if( !start )
+        return false;
+
+    aJob.m_placer = std::make_unique<MEANDER_PLACER>( Router() );
+
+    return aJob.m_placer->start( aWorld, aJob.m_line.CPoint( 0 ), start );
+}
+
+
+void MEANDER_BATCH_TUNER::runJob( JOB& aJob )
+{
+    MEANDER_SETTINGS settings( m_settings );
+
+    settings.m_targetLength = aJob.m_targetLength;
+    settings.m_lengthTolerance = aJob.m_tolerance;
+
+    aJob.m_placer->UpdateSettings( settings );
+    aJob.m_placer->Move( aJob.m_line.CPoint( -1 ), nullptr );
+}
+
+
+NODE* MEANDER_BATCH_TUNER::Tune( const std::vector<int>& aNets )
+{
+    NODE*            world = Router()->GetWorld();
+    RULE_RESOLVER*   resolver = Router()->GetRuleResolver();
+    std::vector<JOB> jobs;
+    long long int    longest = 0;
+
+    m_results.clear();
+
+    // Branching the world is not thread safe, so all the placers are started (and their
+    // branches created) here
+    for( int net : aNets )
+    {
+        NET_RESULT result;
+
+        result.m_net = net;
+        result.m_tuned = false;
+        result.m_targetLength = 0;
+        result.m_length = 0;
+        result.m_status = MEANDER_PLACER_BASE::TOO_SHORT;
+
+        m_results.push_back( result );
+
+        JOB job;
+
+        job.m_net = net;
+
+        // Diff pairs must keep their coupling, which only DP_MEANDER_PLACER does
+        if( resolver->DpCoupledNet( net ) >= 0 )
+            continue;
+
+        if( !findLine( world, net, job.m_line ) || !startJob( world, job ) )
+            continue;
+
+        job.m_targetLength = -1;
+        job.m_tolerance = m_settings.m_lengthTolerance;
+
+        CONSTRAINT constraint;
+        ITEM*      item = job.m_line.GetLink( 0 );
+
+        if( resolver->QueryConstraint( CONSTRAINT_TYPE::CT_LENGTH, item, nullptr,
+                                       item->Layers().Start(), &constraint ) )
+        {
+            const MINOPTMAX<int>& value = constraint.m_Value;
+
+            if( value.HasOpt() )
+            {
+                job.m_targetLength = value.Opt();
+
+                if( value.HasMin() && value.HasMax() )
+                {
+                    job.m_tolerance = std::min( value.Opt() - value.Min(),
+                                                value.Max() - value.Opt() );
+                }
+            }
+            else if( value.HasMin() && value.HasMax() )
+            {
+                job.m_targetLength = ( (long long int) value.Min() + value.Max() ) / 2;
+                job.m_tolerance = ( value.Max() - value.Min() ) / 2;
+            }
+            else if( value.HasMin() )
+            {
+                job.m_targetLength = value.Min();
+            }
+        }
+
+        longest = std::max( longest, job.m_placer->origPathLength() );
+        jobs.push_back( std::move( job ) );
+    }
+
+    if( jobs.empty() )
+        return nullptr;
+
+    // Nets without a length rule are matched to the longest one
+    for( JOB& job : jobs )
+    {
+        if( job.m_targetLength < 0 )
+            job.m_targetLength = longest;
+    }
+
+    // All the placers query the rule resolver, which serializes its callers, so the nets are
+    // tuned one after the other
+    for( JOB& job : jobs )
+        runJob( job );
+
+    // Merge the tuned lines.  The meanders of each net have only been checked against the
+    // original board, so a line running into the meanders of a previously merged net is
+    // tuned again, this time against the merged branch.  If it still collides, the net
+    // keeps its original line and is reported as not tuned.
+    NODE* merged = world->Branch();
+
+    for( JOB& job : jobs )
+    {
+        MEANDER_PLACER* placer = job.m_placer.get();
+        LINE            tuned = placer->Trace();
+        JOB             retry;
+        bool            clear = true;
+
+        if( merged->CheckColliding( &tuned ) )
+        {
+            retry.m_net = job.m_net;
+            retry.m_line = job.m_line;
+            retry.m_targetLength = job.m_targetLength;
+            retry.m_tolerance = job.m_tolerance;
+
+            clear = false;
+
+            if( startJob( merged, retry ) )
+            {
+                runJob( retry );
+                placer = retry.m_placer.get();
+                tuned = placer->Trace();
+                clear = !merged->CheckColliding( &tuned );
+            }
+        }
+
+        NET_RESULT& result = *std::find_if( m_results.begin(), m_results.end(),
+                                            [&]( const NET_RESULT& aResult )
+                                            {
+                                                return aResult.m_net == job.m_net;
+                                            } );
+
+        result.m_tuned = clear;
+        result.m_targetLength = job.m_targetLength;
+
+        if( clear )
+        {
+            result.m_length = placer->m_lastLength;
+            result.m_status = placer->TuningStatus();
+        }
+        else
+        {
+            result.m_length = job.m_placer->origPathLength();
+
+            if( result.m_length < job.m_targetLength - job.m_tolerance )
+                result.m_status = MEANDER_PLACER_BASE::TOO_SHORT;
+            else if( result.m_length > job.m_targetLength + job.m_tolerance )
+                result.m_status = MEANDER_PLACER_BASE::TOO_LONG;
+            else
+                result.m_status = MEANDER_PLACER_BASE::TUNED;
+        }
+
+        // The retry placer's branches must be gone before the merged branch is modified
+        retry.m_placer.reset();
+        merged->KillChildren();
+
+        if( !clear )
+            continue;
+
+        LINE original( job.m_line );
+
+        merged->Remove( original );
+        merged->Add( tuned );
+    }
+
+    // The branches of the placers are released when the merged branch is committed or the
+    // children of the world are killed
+    jobs.clear();
+
+    return merged;
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_MEANDER_BATCH_TUNER_H
+#define __PNS_MEANDER_BATCH_TUNER_H
+
+#include <memory>
+#include <vector>
+
+#include "pns_algo_base.h"
+#include "pns_line.h"
+#include "pns_meander.h"
+#include "pns_meander_placer.h"
+
+namespace PNS {
+
+class NODE;
+class ROUTER;
+
+/**
+ * MEANDER_BATCH_TUNER
+ *
+ * Length-matches a group of nets in one go.  The longest routed line of each net is
+ * meandered from end to end with a MEANDER_PLACER.  Nets with a length rule are tuned to
+ * its optimum (or the middle of its min/max range), the others to the length of the
+ * longest net of the group.
+ *
+ * The nets are first tuned one by one, each on its own branch of the world.  The tuned
+ * lines are then merged into a single branch; a line colliding with the meanders of a
+ * previously merged net is tuned again against the merged branch, and left untouched (and
+ * reported as not tuned) if it still collides.
+ */
+class MEANDER_BATCH_TUNER : public ALGO_BASE
+{
+public:
+    ///> Outcome of the tuning of a single net.  m_tuned is false when the net kept its
+    ///> original line, m_length and m_status are then those of the original line.
+    struct NET_RESULT
+    {
+        int                                 m_net;
+        bool                                m_tuned;
+        long long int                       m_targetLength;
+        long long int                       m_length;
+        MEANDER_PLACER_BASE::TUNING_STATUS  m_status;
+    };
+
+    MEANDER_BATCH_TUNER( ROUTER* aRouter );
+    ~MEANDER_BATCH_TUNER();
+
+    /**
+     * Function SetMeanderSettings()
+     *
+     * Sets the meander shape settings (amplitude, spacing, corners) used for all nets, and
+     * the tolerance for nets without a length rule.
+     */
+    void SetMeanderSettings( const MEANDER_SETTINGS& aSettings )
+    {
+        m_settings = aSettings;
+    }
+
+    /**
+     * Function Tune()
+     *
+     * Tunes the nets aNets.
+     * @return a branch of the router's world holding the tuned lines of all nets, to be
+     * committed with ROUTER::CommitRouting(), or NULL if none of the nets could be tuned.
+     */
+    NODE* Tune( const std::vector<int>& aNets );
+
+    /**
+     * Function Results()
+     *
+     * @return the outcome of the last Tune() call for each of the requested nets.
+     */
+    const std::vector<NET_RESULT>& Results() const
+    {
+        return m_results;
+    }
+
+private:
+    struct JOB
+    {
+        int                             m_net;
+        LINE                            m_line;
+        std::unique_ptr<MEANDER_PLACER> m_placer;
+        long long int                   m_targetLength;
+        int                             m_tolerance;
+    };
+
+    ///> Finds the longest line of aNet in aWorld
+    bool findLine( NODE* aWorld, int aNet, LINE& aLine );
+
+    ///> Creates a placer for aJob, tuning its line against aWorld
+    bool startJob( NODE* aWorld, JOB& aJob );
+
+    ///> Meanders the whole line of aJob
+    void runJob( JOB& aJob );
+
+    MEANDER_SETTINGS        m_settings;
+    std::vector<NET_RESULT> m_results;
+};
+
+}
+
+#endif    // __PNS_MEANDER_BATCH_TUNER_H
@@ -40,11 +40,13 @@ MEANDER_PLACER::MEANDER_PLACER( ROUTER* aRouter ) :
     m_initialSegment = NULL;
     m_lastLength = 0;
     m_lastStatus = TOO_SHORT;
+    m_tuneTarget = 0;
 }
 
 
 MEANDER_PLACER::~MEANDER_PLACER()
 {
+    stopTuning();
 }
 
 
@@ -58,6 +60,12 @@ NODE* MEANDER_PLACER::CurrentNode( bool aLoopsRemoved ) const
 
 
 bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
+{
+    return start( Router()->GetWorld(), aP, aStartItem );
+}
+
+
+bool MEANDER_PLACER::start( NODE* aWorld, const VECTOR2I& aP, ITEM* aStartItem )
 {
     VECTOR2I p;
 
@@ -71,10 +79,9 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 
     p = m_initialSegment->Seg().NearestPoint( aP );
 
-    m_currentNode = NULL;
     m_currentStart = p;
 
-    m_world = Router()->GetWorld()->Branch();
+    m_world = aWorld->Branch();
     m_originLine = m_world->AssembleLine( m_initialSegment );
 
     m_padToDieLenth = GetTotalPadToDieLength( m_originLine );
@@ -84,6 +91,10 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 
     m_world->Remove( m_originLine );
 
+    // The world doesn't change while tuning, so the same (empty) branch is used to check
+    // the meanders for all cursor positions
+    m_currentNode = m_world->Branch();
+
     m_currentWidth = m_originLine.Width();
     m_currentEnd = VECTOR2I( 0, 0 );
 
@@ -114,12 +125,36 @@ bool MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
 
 bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, long long int aTargetLength )
 {
-    SHAPE_LINE_CHAIN pre, tuned, post;
+    if( aTargetLength != m_tuneTarget )
+    {
+        stopTuning();
+        m_tuneTarget = aTargetLength;
+    }
 
-    if( m_currentNode )
-        delete m_currentNode;
+    if( !m_currentNode )
+        m_currentNode = m_world->Branch();
 
-    m_currentNode = m_world->Branch();
+    // No debug decorator when tuning in batch
+    if( Dbg() )
+    {
+        for( const ITEM* item : m_tunedPath.CItems() )
+        {
+            if( const LINE* l = dyn_cast<const LINE*>( item ) )
+            {
+                Dbg()->AddLine( l->CLine(), 5, 30000 );
+            }
+        }
+    }
+
+    requestTuning( aP );
+
+    return true;
+}
+
+
+bool MEANDER_PLACER::tune( const VECTOR2I& aP, TUNING_RESULT& aResult )
+{
+    SHAPE_LINE_CHAIN pre, tuned, post;
 
     cutTunedLine( m_originLine.CLine(), m_currentStart, aP, pre, tuned, post );
 
@@ -131,32 +166,27 @@ bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, long long int a
     {
         const SEG s = tuned.CSegment( i );
         m_result.AddCorner( s.A );
-        m_result.MeanderSegment( s );
+        meanderSegment( m_result, s );
         m_result.AddCorner( s.B );
     }
 
+    if( TuningCancelled() )
+        return false;
+
     long long int lineLen = origPathLength();
 
-    m_lastLength = lineLen;
-    m_lastStatus = TUNED;
+    aResult.m_length = lineLen;
+    aResult.m_status = TUNED;
 
-    if( compareWithTolerance( lineLen, aTargetLength, m_settings.m_lengthTolerance ) > 0 )
+    if( compareWithTolerance( lineLen, m_tuneTarget, m_settings.m_lengthTolerance ) > 0 )
     {
-        m_lastStatus = TOO_LONG;
+        aResult.m_status = TOO_LONG;
     } else {
-        m_lastLength = lineLen - tuned.Length();
-        tuneLineLength( m_result, aTargetLength - lineLen );
-    }
-
-    for( const ITEM* item : m_tunedPath.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-        {
-            Dbg()->AddLine( l->CLine(), 5, 30000 );
-        }
+        aResult.m_length = lineLen - tuned.Length();
+        tuneLineLength( m_result, m_tuneTarget - lineLen );
     }
 
-    if( m_lastStatus != TOO_LONG )
+    if( aResult.m_status != TOO_LONG )
     {
         tuned.Clear();
 
@@ -168,33 +198,44 @@ bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, long long int a
             }
         }
 
-        m_lastLength += tuned.Length();
+        aResult.m_length += tuned.Length();
 
-        int comp = compareWithTolerance( m_lastLength - aTargetLength, 0, m_settings.m_lengthTolerance );
+        int comp = compareWithTolerance( aResult.m_length - m_tuneTarget, 0, m_settings.m_lengthTolerance );
 
         if( comp > 0 )
-            m_lastStatus = TOO_LONG;
+            aResult.m_status = TOO_LONG;
         else if( comp < 0 )
-            m_lastStatus = TOO_SHORT;
+            aResult.m_status = TOO_SHORT;
         else
-            m_lastStatus = TUNED;
+            aResult.m_status = TUNED;
     }
 
-    m_finalShape.Clear();
-    m_finalShape.Append( pre );
-    m_finalShape.Append( tuned );
-    m_finalShape.Append( post );
-    m_finalShape.Simplify();
+    SHAPE_LINE_CHAIN& finalShape = aResult.m_shapes[0];
+
+    finalShape.Append( pre );
+    finalShape.Append( tuned );
+    finalShape.Append( post );
+    finalShape.Simplify();
 
     return true;
 }
 
 
+void MEANDER_PLACER::applyResult( const TUNING_RESULT& aResult )
+{
+    m_finalShape = aResult.m_shapes[0];
+    m_lastLength = aResult.m_length;
+    m_lastStatus = aResult.m_status;
+}
+
+
 bool MEANDER_PLACER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
     if( !m_currentNode )
         return false;
 
+    finishTuning();
+
     m_currentTrace = LINE( m_originLine, m_finalShape );
     m_currentNode->Add( m_currentTrace );
     CommitPlacement();
@@ -205,6 +246,7 @@ bool MEANDER_PLACER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFi
 
 bool MEANDER_PLACER::AbortPlacement()
 {
+    stopTuning();
     m_world->KillChildren();
     return true;
 }
@@ -218,6 +260,8 @@ bool MEANDER_PLACER::HasPlacedAnything() const
 
 bool MEANDER_PLACER::CommitPlacement()
 {
+    stopTuning();
+
     if( m_currentNode )
         Router()->CommitRouting( m_currentNode );
 
@@ -229,6 +273,9 @@ bool MEANDER_PLACER::CommitPlacement()
 
 bool MEANDER_PLACER::CheckFit( MEANDER_SHAPE* aShape )
 {
+    if( TuningCancelled() )
+        return false;
+
     LINE l( m_originLine, aShape->CLine( 0 ) );
 
     if( m_currentNode->CheckColliding( &l ) )
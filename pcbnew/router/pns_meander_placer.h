@@ -97,9 +97,30 @@ public:
     /// @copydoc MEANDER_PLACER_BASE::CheckFit()
     bool CheckFit ( MEANDER_SHAPE* aShape ) override;
 
+    /**
+     * Function Trace()
+     *
+     * @return the tuned line for the last cursor position.
+     */
+    const LINE Trace() const
+    {
+        return LINE( m_originLine, m_finalShape );
+    }
+
 protected:
+    friend class MEANDER_BATCH_TUNER;
+
+    ///> Starts tuning the line of aStartItem against aWorld rather than the router's world
+    bool start( NODE* aWorld, const VECTOR2I& aP, ITEM* aStartItem );
+
     bool doMove( const VECTOR2I& aP, ITEM* aEndItem, long long int aTargetLength );
 
+    /// @copydoc MEANDER_PLACER_BASE::tune()
+    bool tune( const VECTOR2I& aP, TUNING_RESULT& aResult ) override;
+
+    /// @copydoc MEANDER_PLACER_BASE::applyResult()
+    void applyResult( const TUNING_RESULT& aResult ) override;
+
     void setWorld( NODE* aWorld );
 
     virtual long long int origPathLength() const;
@@ -120,6 +141,9 @@ protected:
 
     long long int m_lastLength;
     TUNING_STATUS m_lastStatus;
+
+    ///> length the line is being tuned to
+    long long int m_tuneTarget;
 };
 
 }
@@ -27,7 +27,10 @@
 namespace PNS {
 
 MEANDER_PLACER_BASE::MEANDER_PLACER_BASE( ROUTER* aRouter ) :
-        PLACEMENT_ALGO( aRouter )
+        PLACEMENT_ALGO( aRouter ),
+        m_fitSlot( 0 ),
+        m_tuningCancelled( false ),
+        m_workerRunning( false )
 {
     m_world = NULL;
     m_currentWidth = 0;
@@ -37,11 +40,15 @@ MEANDER_PLACER_BASE::MEANDER_PLACER_BASE( ROUTER* aRouter ) :
 
 MEANDER_PLACER_BASE::~MEANDER_PLACER_BASE()
 {
+    // Derived placers stop the worker in their destructors, as tune() uses their state
+    stopTuning();
 }
 
 
 void MEANDER_PLACER_BASE::AmplitudeStep( int aSign )
 {
+    invalidateTuning();
+
     int a = m_settings.m_maxAmplitude + aSign * m_settings.m_step;
     a = std::max( a,  m_settings.m_minAmplitude );
 
@@ -51,6 +58,8 @@ void MEANDER_PLACER_BASE::AmplitudeStep( int aSign )
 
 void MEANDER_PLACER_BASE::SpacingStep( int aSign )
 {
+    invalidateTuning();
+
     int s = m_settings.m_spacing + aSign * m_settings.m_step;
     s = std::max( s, 2 * m_currentWidth );
 
@@ -60,10 +69,190 @@ void MEANDER_PLACER_BASE::SpacingStep( int aSign )
 
 void MEANDER_PLACER_BASE::UpdateSettings( const MEANDER_SETTINGS& aSettings )
 {
+    invalidateTuning();
+
     m_settings = aSettings;
 }
 
 
+void MEANDER_PLACER_BASE::SetTuningNotifier( std::function<void()> aNotifier )
+{
+    stopTuning();
+
+    m_tuningNotifier = aNotifier;
+}
+
+
+bool MEANDER_PLACER_BASE::runTuning( const VECTOR2I& aP, TUNING_RESULT& aResult )
+{
+    m_fitSlot = 0;
+
+    return tune( aP, aResult );
+}
+
+
+void MEANDER_PLACER_BASE::requestTuning( const VECTOR2I& aP )
+{
+    if( !m_tuningNotifier )
+    {
+        TUNING_RESULT result;
+
+        if( runTuning( aP, result ) )
+            applyResult( result );
+
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock( m_tuningLock );
+
+    if( m_readyResult )
+    {
+        applyResult( *m_readyResult );
+        m_readyResult = NULLOPT;
+    }
+
+    // Already computed or being computed
+    if( m_lastRequest && *m_lastRequest == aP )
+        return;
+
+    m_lastRequest = aP;
+    m_pendingRequest = aP;
+
+    // Whatever the worker is doing now is stale
+    m_tuningCancelled = true;
+
+    if( !m_workerRunning )
+    {
+        m_workerRunning = true;
+        m_tuningWorker = std::async( std::launch::async, &MEANDER_PLACER_BASE::tuningWorker,
+                                     this );
+    }
+}
+
+
+void MEANDER_PLACER_BASE::tuningWorker()
+{
+    while( true )
+    {
+        VECTOR2I p;
+
+        {
+            std::lock_guard<std::mutex> lock( m_tuningLock );
+
+            if( !m_pendingRequest )
+            {
+                m_workerRunning = false;
+                return;
+            }
+
+            p = *m_pendingRequest;
+            m_pendingRequest = NULLOPT;
+            m_tuningCancelled = false;
+        }
+
+        TUNING_RESULT result;
+
+        if( !runTuning( p, result ) )
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock( m_tuningLock );
+            m_readyResult = std::move( result );
+        }
+
+        m_tuningNotifier();
+    }
+}
+
+
+void MEANDER_PLACER_BASE::finishTuning()
+{
+    if( m_tuningWorker.valid() )
+        m_tuningWorker.wait();
+
+    std::lock_guard<std::mutex> lock( m_tuningLock );
+
+    if( m_readyResult )
+    {
+        applyResult( *m_readyResult );
+        m_readyResult = NULLOPT;
+    }
+}
+
+
+void MEANDER_PLACER_BASE::stopTuning()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_tuningLock );
+
+        m_pendingRequest = NULLOPT;
+        m_tuningCancelled = true;
+
+        // The request being processed may not complete
+        m_lastRequest = NULLOPT;
+    }
+
+    if( m_tuningWorker.valid() )
+        m_tuningWorker.wait();
+
+    m_tuningCancelled = false;
+}
+
+
+void MEANDER_PLACER_BASE::invalidateTuning()
+{
+    stopTuning();
+
+    m_fitCache.clear();
+}
+
+
+void MEANDER_PLACER_BASE::meanderSegment( MEANDERED_LINE& aLine, const SEG& aBase,
+                                          int aBaseIndex )
+{
+    size_t slot = m_fitSlot++;
+
+    if( slot < m_fitCache.size() )
+    {
+        const FITTED_SEGMENT& fitted = m_fitCache[slot];
+
+        if( fitted.m_base == aBase && fitted.m_baseIndex == aBaseIndex
+                && fitted.m_width == aLine.Width()
+                && fitted.m_baselineOffset == aLine.BaselineOffset() )
+        {
+            for( const MEANDER_SHAPE& m : fitted.m_meanders )
+                aLine.AddMeander( new MEANDER_SHAPE( m ) );
+
+            return;
+        }
+
+        // The meanders of the following segments were checked against the ones of this
+        // segment, so they can't be reused either
+        m_fitCache.resize( slot );
+    }
+
+    size_t first = aLine.Meanders().size();
+
+    aLine.MeanderSegment( aBase, aBaseIndex );
+
+    // A cancelled fit may be incomplete
+    if( TuningCancelled() || slot != m_fitCache.size() )
+        return;
+
+    FITTED_SEGMENT fitted;
+
+    fitted.m_base = aBase;
+    fitted.m_baseIndex = aBaseIndex;
+    fitted.m_width = aLine.Width();
+    fitted.m_baselineOffset = aLine.BaselineOffset();
+
+    for( size_t i = first; i < aLine.Meanders().size(); i++ )
+        fitted.m_meanders.push_back( *aLine.Meanders()[i] );
+
+    m_fitCache.push_back( std::move( fitted ) );
+}
+
+
 void MEANDER_PLACER_BASE::cutTunedLine( const SHAPE_LINE_CHAIN& aOrigin,
                                             const VECTOR2I& aTuneStart,
                                             const VECTOR2I& aCursorPos,
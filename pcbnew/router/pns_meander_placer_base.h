@@ -22,6 +22,13 @@
 #ifndef __PNS_MEANDER_PLACER_BASE_H
 #define __PNS_MEANDER_PLACER_BASE_H
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <core/optional.h>
 #include <math/vector2d.h>
 
 #include <geometry/shape.h>
@@ -122,7 +129,99 @@ public:
 
     int GetTotalPadToDieLength( const LINE& aLine ) const;
 
+    /**
+     * Function SetTuningNotifier()
+     *
+     * Enables background tuning: Move() hands the cursor position over to a worker
+     * thread and returns immediately, cancelling the job still running for an older
+     * cursor position.  aNotifier is called from the worker thread each time a new
+     * result is ready; the caller is then expected to call Move() again (with the same
+     * position) to pick it up.  Without a notifier, Move() tunes synchronously.
+     * @param aNotifier the function to call when a result is ready
+     */
+    void SetTuningNotifier( std::function<void()> aNotifier );
+
+    /**
+     * Function TuningCancelled()
+     *
+     * @return true if the meanders being fitted are no longer needed, because the
+     * cursor has moved on or the tuning has been stopped.
+     */
+    bool TuningCancelled() const
+    {
+        return m_tuningCancelled;
+    }
+
 protected:
+    ///> Tuned shape(s) and length of the meandered line(s) for a given cursor position
+    struct TUNING_RESULT
+    {
+        ///> one shape for a single line, P and N shapes for a differential pair
+        SHAPE_LINE_CHAIN m_shapes[2];
+        long long int    m_length = 0;
+        TUNING_STATUS    m_status = TOO_SHORT;
+    };
+
+    /**
+     * Function tune()
+     *
+     * Fits the meanders for the cursor position aP.  Called either synchronously or on
+     * the background worker, in the latter case concurrently with the main thread which
+     * only accesses the placer through Move() and the accessors of the last result.
+     * @return false if the tuning was cancelled before completion.
+     */
+    virtual bool tune( const VECTOR2I& aP, TUNING_RESULT& aResult ) = 0;
+
+    /**
+     * Function applyResult()
+     *
+     * Makes aResult the current (displayed) result of the placer.  Always called on the
+     * main thread.
+     */
+    virtual void applyResult( const TUNING_RESULT& aResult ) = 0;
+
+    /**
+     * Function requestTuning()
+     *
+     * Tunes the line(s) for the cursor position aP, either immediately or, when a
+     * tuning notifier is set, on the background worker.  Picks up the latest result
+     * finished by the worker.
+     */
+    void requestTuning( const VECTOR2I& aP );
+
+    /**
+     * Function finishTuning()
+     *
+     * Waits until the background worker has processed the last requested cursor
+     * position and makes its result current.
+     */
+    void finishTuning();
+
+    /**
+     * Function stopTuning()
+     *
+     * Cancels the pending and running jobs and waits for the background worker to
+     * exit.  Must be called before the state used by tune() is modified or destroyed.
+     */
+    void stopTuning();
+
+    /**
+     * Function invalidateTuning()
+     *
+     * Stops the tuning and drops the cached meanders, so that the next request is
+     * computed from scratch.  To be called when the meandering settings change.
+     */
+    void invalidateTuning();
+
+    /**
+     * Function meanderSegment()
+     *
+     * Adds the meanders fitted on aBase to aLine, like MEANDERED_LINE::MeanderSegment().
+     * The n-th call of a tune() pass is served from the cache if the base segments
+     * of this and all preceding calls are the same as in the previous pass: as the
+     * cursor moves, only the tail of the tuned line gets refitted.
+     */
+    void meanderSegment( MEANDERED_LINE& aLine, const SEG& aBase, int aBaseIndex = 0 );
 
     /**
      * Function cutTunedLine()
@@ -171,6 +270,39 @@ protected:
     MEANDER_SETTINGS m_settings;
     ///> current end point
     VECTOR2I m_currentEnd;
+
+private:
+    ///> Meanders fitted on a base segment, before their length adjustment
+    struct FITTED_SEGMENT
+    {
+        SEG                        m_base;
+        int                        m_baseIndex;
+        int                        m_width;
+        int                        m_baselineOffset;
+        std::vector<MEANDER_SHAPE> m_meanders;
+    };
+
+    ///> runs tune() from the start of the fitted segment cache
+    bool runTuning( const VECTOR2I& aP, TUNING_RESULT& aResult );
+
+    ///> main loop of the background worker
+    void tuningWorker();
+
+    ///> fitted segments of the last tune() pass, in call order
+    std::vector<FITTED_SEGMENT> m_fitCache;
+    ///> index of the next meanderSegment() call in the current tune() pass
+    size_t m_fitSlot;
+
+    std::function<void()> m_tuningNotifier;
+    std::future<void>     m_tuningWorker;
+    std::mutex            m_tuningLock;
+    std::atomic<bool>     m_tuningCancelled;
+
+    ///> the following fields are protected by m_tuningLock
+    bool               m_workerRunning;
+    OPT<VECTOR2I>      m_pendingRequest;
+    OPT<VECTOR2I>      m_lastRequest;
+    OPT<TUNING_RESULT> m_readyResult;
 };
 
 }
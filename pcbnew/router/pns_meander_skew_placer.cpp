@@ -43,6 +43,8 @@ MEANDER_SKEW_PLACER::MEANDER_SKEW_PLACER ( ROUTER* aRouter ) :
 
 MEANDER_SKEW_PLACER::~MEANDER_SKEW_PLACER( )
 {
+    // origPathLength() is called by the tuning worker
+    stopTuning();
 }
 
 
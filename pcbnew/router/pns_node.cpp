@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <deque>
 #include <vector>
 #include <cassert>
 #include <utility>
@@ -311,20 +313,29 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
 
     obs_list.reserve( 100 );
 
-    int n = 0;
-
     for( int i = 0; i < line.SegmentCount(); i++ )
     {
         const SEGMENT s( *aItem, line.CSegment( i ) );
-        n += QueryColliding( &s, obs_list, aKindMask );
+        QueryColliding( &s, obs_list, aKindMask );
     }
 
     if( aItem->EndsWithVia() )
-        n += QueryColliding( &aItem->Via(), obs_list, aKindMask );
+        QueryColliding( &aItem->Via(), obs_list, aKindMask );
 
-    if( !n )
+    if( obs_list.empty() )
         return OPT_OBSTACLE();
 
+    // An obstacle usually collides with several segments of the line. Keep only its first
+    // occurrence, so that its hull is built and intersected once.
+    std::unordered_set<ITEM*> uniqueObstacles;
+
+    obs_list.erase( std::remove_if( obs_list.begin(), obs_list.end(),
+                                    [&]( const OBSTACLE& aObs )
+                                    {
+                                        return !uniqueObstacles.insert( aObs.m_item ).second;
+                                    } ),
+                    obs_list.end() );
+
     LINE& aLine = (LINE&) *aItem;
 
     OBSTACLE nearest;
@@ -1342,6 +1353,33 @@ void NODE::RemoveByMarker( int aMarker )
         Remove( item );
 }
 
+
+void NODE::RemoveByParent( const std::unordered_set<const BOARD_ITEM*>& aParents )
+{
+    if( !isRoot() || aParents.empty() )
+        return;
+
+    std::vector<ITEM*> garbage;
+
+    for( ITEM* item : *m_index )
+    {
+        if( item->Parent() && aParents.count( item->Parent() ) )
+            garbage.push_back( item );
+    }
+
+    for( ITEM* item : garbage )
+        Remove( item );
+
+    releaseGarbage();
+}
+
+
+void NODE::PackIndex()
+{
+    m_index->Pack();
+}
+
+
 SEGMENT* NODE::findRedundantSegment( const VECTOR2I& A, const VECTOR2I& B, const LAYER_RANGE& lr,
                                      int aNet )
 {
@@ -441,6 +441,14 @@ public:
 
     void RemoveByMarker( int aMarker );
 
+    ///> Removes (and frees) all items whose parent is in aParents. Applicable only to the
+    ///> root node.
+    void RemoveByParent( const std::unordered_set<const BOARD_ITEM*>& aParents );
+
+    ///> Packs the spatial index after a bulk update, so that the following queries
+    ///> don't have to scan the recently added items linearly.
+    void PackIndex();
+
     ITEM* FindItemByParent( const BOARD_ITEM* aParent );
 
     bool HasChildren() const
@@ -854,6 +854,14 @@ OPTIMIZER::BREAKOUT_LIST OPTIMIZER::computeBreakouts( int aWidth,
             return rectBreakouts( aWidth, &rect, aPermitDiagonal );
         }
 
+        case SH_ARC:
+        {
+            // Graphic arcs are the only arc solids; break out of their bounding box.
+            const BOX2I      bbox = shape->BBox();
+            const SHAPE_RECT rect( bbox.GetPosition(), bbox.GetWidth(), bbox.GetHeight() );
+            return rectBreakouts( aWidth, &rect, aPermitDiagonal );
+        }
+
         case SH_CIRCLE:
             return circleBreakouts( aWidth, shape, aPermitDiagonal );
 
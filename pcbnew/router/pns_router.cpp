@@ -82,20 +82,41 @@ ROUTER* ROUTER::GetInstance()
 }
 
 
+void ROUTER::MakeCurrent()
+{
+    theRouter = this;
+}
+
+
 ROUTER::~ROUTER()
 {
     ClearWorld();
-    theRouter = nullptr;
+
+    if( theRouter == this )
+        theRouter = nullptr;
+
     delete m_logger;
 }
 
 
 void ROUTER::SyncWorld()
 {
+    // An idle world only has to catch up with the changes made to the board since the
+    // last sync, as long as the interface is able to track them.
+    if( m_world && !RoutingInProgress() )
+    {
+        m_world->KillChildren();
+        m_placer.reset();
+
+        if( m_iface->UpdateWorld( m_world.get() ) )
+            return;
+    }
+
     ClearWorld();
 
     m_world = std::make_unique<NODE>( );
     m_iface->SyncWorld( m_world.get() );
+    m_world->PackIndex();
 
 }
 
@@ -156,6 +177,12 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM_SET aStartItems, int aDragM
     m_dragger->SetLogger( m_logger );
     m_dragger->SetDebugDecorator ( m_iface->GetDebugDecorator () );
 
+    if( m_logger )
+    {
+        for( ITEM* item : aStartItems.CItems() )
+            m_logger->Log( LOGGER::EVT_START_DRAG, aP, item );
+    }
+
     if( m_dragger->Start ( aP, aStartItems ) )
     {
         m_state = DRAG_SEGMENT;
@@ -463,6 +490,9 @@ void ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_ABORT, m_currentEnd );
+
     m_placer.reset();
     m_dragger.reset();
 
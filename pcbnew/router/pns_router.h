@@ -96,6 +96,7 @@ enum DRAG_MODE
         virtual ~ROUTER_IFACE() {};
 
         virtual void SyncWorld( NODE* aNode ) = 0;
+        virtual bool UpdateWorld( NODE* aNode ) = 0;
         virtual void AddItem( ITEM* aItem ) = 0;
         virtual void RemoveItem( ITEM* aItem ) = 0;
         virtual bool IsAnyLayerVisible( const LAYER_RANGE& aLayer ) const = 0;
@@ -137,6 +138,9 @@ public:
 
     static ROUTER* GetInstance();
 
+    ///> Makes this router the one returned by GetInstance()
+    void MakeCurrent();
+
     void ClearWorld();
     void SyncWorld();
 
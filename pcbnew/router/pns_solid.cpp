@@ -22,6 +22,7 @@
 #include <math/vector2d.h>
 
 #include <geometry/shape.h>
+#include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_rect.h>
 #include <geometry/shape_circle.h>
@@ -66,6 +67,13 @@ static const SHAPE_LINE_CHAIN buildHullForPrimitiveShape( const SHAPE* aShape, i
 
         return ConvexHull( *convex, cl );
     }
+
+    case SH_ARC:
+    {
+        const SHAPE_ARC* arc = static_cast<const SHAPE_ARC*>( aShape );
+
+        return ArcHull( *arc, aClearance, aWalkaroundThickness );
+    }
     default:
     {
         wxLogError("Unsupported hull shape: %d", aShape->Type() );
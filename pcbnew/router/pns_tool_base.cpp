@@ -79,6 +79,22 @@ TOOL_BASE::~TOOL_BASE()
 
 void TOOL_BASE::Reset( RESET_REASON aReason )
 {
+    // The router world follows the board through BOARD_LISTENER events, so re-activating
+    // the tool only has to apply the changes made since it was last used.  The interface
+    // falls back to a full sync when it can't (see ADVANCED_CFG::m_IncrementalRouterSync).
+    if( aReason == RUN && m_router && m_iface && m_iface->GetBoard() == board() )
+    {
+        m_router->MakeCurrent();
+        m_router->SyncWorld();
+        m_router->UpdateSizes( m_savedSizes );
+        return;
+    }
+
+    // If the board has been replaced, the old one (and its listener list) is already gone,
+    // otherwise the interface stops listening to it when deleted
+    if( m_iface && m_iface->GetBoard() != board() )
+        m_iface->SetBoard( nullptr );
+
     delete m_gridHelper;
     delete m_iface;
     delete m_router;
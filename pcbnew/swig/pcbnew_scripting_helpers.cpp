@@ -415,8 +415,12 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
     if( fp == nullptr )
         return false;
 
-    std::map<KIID, EDA_ITEM*> itemMap;
-    aBoard->FillItemMap( itemMap );
+    auto getItem =
+            [&]( const KIID& aId ) -> EDA_ITEM*
+            {
+                BOARD_ITEM* item = aBoard->GetItem( aId );
+                return item && item->Type() != NOT_USED ? item : nullptr;
+            };
 
     fprintf( fp, "** Drc report for %s **\n", TO_UTF8( aBoard->GetFileName() ) );
 
@@ -429,7 +433,7 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
     for( const std::shared_ptr<DRC_ITEM>& item : violations )
     {
         SEVERITY severity = static_cast<SEVERITY>( bds.GetSeverity( item->GetErrorCode() ) );
-        fprintf( fp, "%s", TO_UTF8( item->ShowReport( aUnits, severity, itemMap ) ) );
+        fprintf( fp, "%s", TO_UTF8( item->ShowReport( aUnits, severity, getItem ) ) );
     }
 
     fprintf( fp, "\n** Found %d unconnected pads **\n", static_cast<int>( unconnected.size() ) );
@@ -437,7 +441,7 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
     for( const std::shared_ptr<DRC_ITEM>& item : unconnected )
     {
         SEVERITY severity = static_cast<SEVERITY>( bds.GetSeverity( item->GetErrorCode() ) );
-        fprintf( fp, "%s", TO_UTF8( item->ShowReport( aUnits, severity, itemMap ) ) );
+        fprintf( fp, "%s", TO_UTF8( item->ShowReport( aUnits, severity, getItem ) ) );
     }
 
     fprintf( fp, "\n** Found %d Footprint errors **\n", static_cast<int>( footprints.size() ) );
@@ -445,7 +449,7 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
     for( const std::shared_ptr<DRC_ITEM>& item : footprints )
     {
         SEVERITY severity = static_cast<SEVERITY>( bds.GetSeverity( item->GetErrorCode() ) );
-        fprintf( fp, "%s", TO_UTF8( item->ShowReport( aUnits, severity, itemMap ) ) );
+        fprintf( fp, "%s", TO_UTF8( item->ShowReport( aUnits, severity, getItem ) ) );
     }
 
     fprintf( fp, "\n** End of Report **\n" );
@@ -1308,6 +1308,13 @@ TOOL_ACTION PCB_ACTIONS::routerTuneDiffPairSkew( "pcbnew.LengthTuner.TuneDiffPai
         _( "Tune skew of a differential pair" ), "",
         ps_diff_pair_tune_phase_xpm, AF_ACTIVATE, (void*) PNS::PNS_MODE_TUNE_DIFF_PAIR_SKEW );
 
+TOOL_ACTION PCB_ACTIONS::routerTuneSelectedNets( "pcbnew.LengthTuner.TuneSelectedNets",
+        AS_GLOBAL, 0, "",
+        _( "Tune Lengths of Selected Nets" ),
+        _( "Length-match the nets of the selected tracks to their length rules or to the "
+           "longest of them" ),
+        ps_tune_length_xpm );
+
 TOOL_ACTION PCB_ACTIONS::routerInlineDrag( "pcbnew.InteractiveRouter.InlineDrag",
         AS_CONTEXT );
 
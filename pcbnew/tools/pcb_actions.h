@@ -190,6 +190,9 @@ public:
     /// Activation of the Push and Shove router (skew tuning mode)
     static TOOL_ACTION routerTuneDiffPairSkew;
 
+    /// Length-matching of the nets of the selected items in one go
+    static TOOL_ACTION routerTuneSelectedNets;
+
     static TOOL_ACTION routerUndoLastSegment;
 
     /// Activation of the Push and Shove settings dialogs
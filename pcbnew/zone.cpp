@@ -992,8 +992,8 @@ void ZONE::HatchBorder()
     #define MAXPTS 200      // Usually we store only few values per one hatch line
                             // depending on the complexity of the zone outline
 
-    static std::vector<VECTOR2I> pointbuffer;
-    pointbuffer.clear();
+    // Not static: zones are hatched on worker threads when boards are loaded
+    std::vector<VECTOR2I> pointbuffer;
     pointbuffer.reserve( MAXPTS + 2 );
 
     for( int a = min_a; a < max_a; a += spacing )
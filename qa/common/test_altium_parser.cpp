@@ -0,0 +1,297 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_altium_parser.cpp
+ *
+ * Checks that ALTIUM_PARSER reads records crossing the end of its buffer, and skips data
+ * beyond it, as if the whole stream was in memory.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <common/plugins/altium/altium_parser.h>
+
+#include <compoundfilereader.h>
+
+#include <cstring>
+
+
+///> ALTIUM_PARSER::BUFFER_SIZE, the size of the buffer refills
+static const size_t REFILL_SIZE = 1024 * 1024;
+
+static const size_t SECTOR_SIZE = 512;
+static const uint32_t END_OF_CHAIN = 0xFFFFFFFE;
+static const uint32_t FAT_SECTOR = 0xFFFFFFFD;
+static const uint32_t NO_STREAM = 0xFFFFFFFF;
+
+
+/**
+ * Builds a version 3 compound file holding aContent in a single stream named aName.  The
+ * content must be larger than the mini stream cutoff (4096 bytes).
+ */
+static std::string makeCompoundFile( const std::string& aName, const std::string& aContent )
+{
+    size_t dataSectors = ( aContent.size() + SECTOR_SIZE - 1 ) / SECTOR_SIZE;
+    size_t fatSectors = 1;
+
+    // The FAT covers its own sectors, the directory sector and the stream
+    while( fatSectors * SECTOR_SIZE / 4 < fatSectors + 1 + dataSectors )
+        fatSectors++;
+
+    BOOST_REQUIRE( aContent.size() >= 4096 );
+    BOOST_REQUIRE( fatSectors <= 109 );
+
+    size_t      dirSector = fatSectors;
+    size_t      firstDataSector = dirSector + 1;
+    std::string file( SECTOR_SIZE * ( 1 + firstDataSector + dataSectors ), '\0' );
+
+    CFB::COMPOUND_FILE_HDR* hdr = reinterpret_cast<CFB::COMPOUND_FILE_HDR*>( &file[0] );
+
+    memcpy( hdr->signature, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8 );
+    hdr->minorVersion = 0x3E;
+    hdr->majorVersion = 3;
+    hdr->byteOrder = 0xFFFE;
+    hdr->sectorShift = 9;
+    hdr->miniSectorShift = 6;
+    hdr->numFATSector = fatSectors;
+    hdr->firstDirectorySectorLocation = dirSector;
+    hdr->miniStreamCutoffSize = 4096;
+    hdr->firstMiniFATSectorLocation = END_OF_CHAIN;
+    hdr->firstDIFATSectorLocation = END_OF_CHAIN;
+
+    for( size_t i = 0; i < 109; i++ )
+        hdr->headerDIFAT[i] = i < fatSectors ? i : NO_STREAM;
+
+    auto sector =
+            [&]( size_t aSector )
+            {
+                return &file[SECTOR_SIZE * ( 1 + aSector )];
+            };
+
+    uint32_t* fat = reinterpret_cast<uint32_t*>( sector( 0 ) );
+
+    for( size_t i = 0; i < fatSectors * SECTOR_SIZE / 4; i++ )
+        fat[i] = NO_STREAM;
+
+    for( size_t i = 0; i < fatSectors; i++ )
+        fat[i] = FAT_SECTOR;
+
+    fat[dirSector] = END_OF_CHAIN;
+
+    for( size_t i = 0; i < dataSectors; i++ )
+        fat[firstDataSector + i] = i + 1 < dataSectors ? firstDataSector + i + 1 : END_OF_CHAIN;
+
+    CFB::COMPOUND_FILE_ENTRY* entries = reinterpret_cast<CFB::COMPOUND_FILE_ENTRY*>(
+            sector( dirSector ) );
+
+    for( size_t i = 0; i < SECTOR_SIZE / sizeof( CFB::COMPOUND_FILE_ENTRY ); i++ )
+        entries[i].leftSiblingID = entries[i].rightSiblingID = entries[i].childID = NO_STREAM;
+
+    auto setName =
+            []( CFB::COMPOUND_FILE_ENTRY& aEntry, const std::string& aEntryName )
+            {
+                for( size_t i = 0; i < aEntryName.size(); i++ )
+                    aEntry.name[i] = aEntryName[i];
+
+                aEntry.nameLen = ( aEntryName.size() + 1 ) * 2;
+            };
+
+    setName( entries[0], "Root Entry" );
+    entries[0].type = 5;
+    entries[0].childID = 1;
+    entries[0].startSectorLocation = END_OF_CHAIN;
+
+    setName( entries[1], aName );
+    entries[1].type = 2;
+    entries[1].startSectorLocation = firstDataSector;
+    entries[1].size = aContent.size();
+
+    memcpy( sector( firstDataSector ), aContent.data(), aContent.size() );
+
+    return file;
+}
+
+
+template <typename T>
+static void append( std::string& aStream, T aValue )
+{
+    aStream.append( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+}
+
+
+/**
+ * Appends a record made of its type, and a subrecord starting with the record index.
+ */
+static void appendRecord( std::string& aStream, uint8_t aType, int32_t aIndex,
+                          uint32_t aSubrecordLength )
+{
+    append<uint8_t>( aStream, aType );
+    append<uint32_t>( aStream, aSubrecordLength );
+    append<int32_t>( aStream, aIndex );
+    aStream.append( aSubrecordLength - sizeof( int32_t ), char( aIndex ) );
+}
+
+
+struct ALTIUM_PARSER_FIXTURE
+{
+    /**
+     * Maps aContent in a compound file, and opens a parser on it.
+     */
+    ALTIUM_PARSER& Open( const std::string& aContent )
+    {
+        m_file = makeCompoundFile( "Data", aContent );
+        m_reader = std::make_unique<CFB::CompoundFileReader>( m_file.data(), m_file.size() );
+
+        const CFB::COMPOUND_FILE_ENTRY* entry = FindStream( *m_reader, "Data" );
+
+        BOOST_REQUIRE( entry );
+        BOOST_REQUIRE_EQUAL( entry->size, aContent.size() );
+
+        m_parser = std::make_unique<ALTIUM_PARSER>( *m_reader, entry );
+        return *m_parser;
+    }
+
+    std::string                              m_file;
+    std::unique_ptr<CFB::CompoundFileReader> m_reader;
+    std::unique_ptr<ALTIUM_PARSER>           m_parser;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( AltiumParser, ALTIUM_PARSER_FIXTURE )
+
+
+/**
+ * Records of all sizes, the index of one of them straddling the end of the first buffer.
+ */
+BOOST_AUTO_TEST_CASE( RecordsAcrossRefills )
+{
+    std::string           stream;
+    std::vector<uint32_t> lengths;
+
+    // The index of the second record starts 2 bytes before the end of the first buffer
+    lengths.push_back( REFILL_SIZE - 12 );
+
+    for( uint32_t i = 0; 5 + REFILL_SIZE + lengths.size() * 150 < 3 * REFILL_SIZE; i++ )
+        lengths.push_back( 4 + i % 300 );
+
+    for( size_t i = 0; i < lengths.size(); i++ )
+        appendRecord( stream, uint8_t( i ), i, lengths[i] );
+
+    ALTIUM_PARSER& parser = Open( stream );
+    size_t         offset = 0;
+
+    for( size_t i = 0; i < lengths.size(); i++ )
+    {
+        BOOST_TEST_CONTEXT( "Record " << i )
+        {
+            BOOST_CHECK_EQUAL( parser.GetOffset(), offset );
+            BOOST_CHECK_EQUAL( parser.Read<uint8_t>(), uint8_t( i ) );
+            BOOST_CHECK_EQUAL( parser.ReadAndSetSubrecordLength(), lengths[i] );
+            BOOST_CHECK_EQUAL( parser.Read<int32_t>(), int32_t( i ) );
+            BOOST_CHECK_EQUAL( parser.GetRemainingSubrecordBytes(), lengths[i] - 4 );
+
+            if( lengths[i] > 4 )
+                BOOST_CHECK_EQUAL( parser.Read<uint8_t>(), uint8_t( i ) );
+
+            parser.SkipSubrecord();
+            offset += 5 + lengths[i];
+        }
+    }
+
+    BOOST_CHECK_EQUAL( parser.GetRemainingBytes(), 0 );
+    BOOST_CHECK( !parser.HasParsingError() );
+}
+
+
+/**
+ * Subrecords, skipped bytes and properties larger than the buffer.
+ */
+BOOST_AUTO_TEST_CASE( SkipPastBuffer )
+{
+    std::string stream;
+    std::string name( REFILL_SIZE * 3 / 2, 'n' );
+    std::string properties = "|RECORD=7|NAME=" + name + "|";
+
+    appendRecord( stream, 1, 0, 10 );
+    appendRecord( stream, 2, 1, 3 * REFILL_SIZE );
+    appendRecord( stream, 3, 2, 8 );
+
+    append<uint32_t>( stream, 2 * REFILL_SIZE );
+    stream.append( 2 * REFILL_SIZE, 's' );
+    append<int32_t>( stream, 1234 );
+
+    append<uint32_t>( stream, properties.size() + 1 );
+    stream.append( properties.c_str(), properties.size() + 1 );
+    append<int32_t>( stream, 42 );
+
+    ALTIUM_PARSER& parser = Open( stream );
+
+    for( int i = 0; i < 3; i++ )
+    {
+        BOOST_TEST_CONTEXT( "Record " << i )
+        {
+            BOOST_CHECK_EQUAL( parser.Read<uint8_t>(), i + 1 );
+            parser.ReadAndSetSubrecordLength();
+            BOOST_CHECK_EQUAL( parser.Read<int32_t>(), i );
+            parser.SkipSubrecord();
+        }
+    }
+
+    parser.Skip( parser.Read<uint32_t>() );
+    BOOST_CHECK_EQUAL( parser.Read<int32_t>(), 1234 );
+
+    std::map<wxString, wxString> kv = parser.ReadProperties();
+
+    BOOST_CHECK( kv[wxT( "RECORD" )] == wxT( "7" ) );
+    BOOST_CHECK_EQUAL( kv[wxT( "NAME" )].length(), name.size() );
+
+    BOOST_CHECK_EQUAL( parser.Read<int32_t>(), 42 );
+    BOOST_CHECK_EQUAL( parser.GetRemainingBytes(), 0 );
+    BOOST_CHECK( !parser.HasParsingError() );
+}
+
+
+BOOST_AUTO_TEST_CASE( SkipWithoutSubrecord )
+{
+    ALTIUM_PARSER& parser = Open( std::string( 4096, '\0' ) );
+
+    parser.SkipSubrecord();
+    BOOST_CHECK( parser.HasParsingError() );
+}
+
+
+BOOST_AUTO_TEST_CASE( ReadPastEnd )
+{
+    ALTIUM_PARSER& parser = Open( std::string( 4096, '\0' ) );
+
+    parser.Skip( 4090 );
+    BOOST_CHECK_EQUAL( parser.Read<int32_t>(), 0 );
+    BOOST_CHECK( !parser.HasParsingError() );
+
+    BOOST_CHECK_EQUAL( parser.Read<int32_t>(), 0 );
+    BOOST_CHECK( parser.HasParsingError() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,6 +31,10 @@
 // Code under test
 #include <kicad_string.h>
 
+#include <cerrno>
+#include <cmath>
+#include <limits>
+
 /**
  * Declare the test suite
  */
@@ -107,4 +111,70 @@ BOOST_AUTO_TEST_CASE( NaturalNumberCompare )
     }
 }
 
+/**
+ * Test the #StrToDoubleC method against strtod() in the "C" locale.
+ */
+BOOST_AUTO_TEST_CASE( StrToDouble )
+{
+    const std::vector<std::string> cases = {
+        "0", "-0", "1", "+1.5", "-2147.483647", "0.00005", ".5", "7.", "1e5", "1.25E-3",
+        "  42", "0.1", "3.14159265358979", "9007199254740993", "123456789012345678901234",
+        "1.7976931348623157e308", "1e400", "1e-400", "12abc", "1e", "1e+", "e5", "-", "",
+        "inf", "nan", "0x10"
+    };
+
+    for( const std::string& c : cases )
+    {
+        char* end;
+        char* refEnd;
+
+        errno = 0;
+        double value = StrToDoubleC( c.c_str(), &end );
+        int    error = errno;
+
+        errno = 0;
+        double ref = strtod( c.c_str(), &refEnd );
+
+        BOOST_TEST_CONTEXT( "\"" << c << "\"" )
+        {
+            BOOST_CHECK( value == ref || ( std::isnan( value ) && std::isnan( ref ) ) );
+            BOOST_CHECK_EQUAL( std::signbit( value ), std::signbit( ref ) );
+            BOOST_CHECK_EQUAL( end - c.c_str(), refEnd - c.c_str() );
+            BOOST_CHECK_EQUAL( error, errno );
+        }
+    }
+}
+
+/**
+ * Test the #FormatScaledInt method.
+ */
+BOOST_AUTO_TEST_CASE( ScaledInt )
+{
+    using CASE = std::pair<std::pair<long long, int>, std::string>;
+
+    const std::vector<CASE> cases = {
+        { { 0, 0 }, "0" },
+        { { 0, 6 }, "0" },
+        { { 120, 0 }, "120" },
+        { { 120, 1 }, "12" },
+        { { 125, 1 }, "12.5" },
+        { { -350000, 6 }, "-0.35" },
+        { { 50, 6 }, "0.00005" },
+        { { -1, 6 }, "-0.000001" },
+        { { 1000000, 6 }, "1" },
+        { { -2147483648LL, 6 }, "-2147.483648" },
+        { { 2147483647, 4 }, "214748.3647" },
+        { { std::numeric_limits<long long>::min(), 0 }, "-9223372036854775808" },
+    };
+
+    for( const auto& c : cases )
+    {
+        char buf[32];
+        int  len = FormatScaledInt( buf, c.first.first, c.first.second );
+
+        BOOST_CHECK_EQUAL( std::string( buf, len ), c.second );
+        BOOST_CHECK_EQUAL( std::string( buf ), c.second );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
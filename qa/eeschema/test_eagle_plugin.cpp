@@ -25,7 +25,19 @@
 #include <unit_test_utils/unit_test_utils.h>
 
 #include <kiway.h>
+#include <locale_io.h>
 #include <sch_io_mgr.h>
+#include <sch_line.h>
+#include <sch_plugins/eagle/sch_eagle_plugin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_text.h>
+
+#include <wx/xml/xml.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
 
 #include "eeschema_test_utils.h"
 
@@ -67,3 +79,167 @@ BOOST_AUTO_TEST_CASE( Load )
     // const SCH_SHEET* sheet = pi->Load( fn.GetFullPath(), nullptr );
     // BOOST_CHECK_NE( nullptr, sheet );
 }
+
+
+/**
+ * VECTOR2 compares by length, so equal lists of points could be sorted differently with it.
+ */
+static bool lexicalLess( const VECTOR2I& aA, const VECTOR2I& aB )
+{
+    return aA.x < aB.x || ( aA.x == aB.x && aA.y < aB.y );
+}
+
+
+class TEST_SCH_EAGLE_PLUGIN_FIXTURE
+{
+public:
+    TEST_SCH_EAGLE_PLUGIN_FIXTURE()
+    {
+        m_sheet.SetScreen( new SCH_SCREEN );
+        m_plugin.m_currentSheet = &m_sheet;
+    }
+
+    /**
+     * Load the segments of a net and remember the net of each of them.
+     */
+    void loadSegments( wxXmlNode* aSegmentsNode, const wxString& aNetName )
+    {
+        m_plugin.loadSegments( aSegmentsNode, aNetName, wxEmptyString );
+        m_segmentNets.resize( m_plugin.m_segments.size(), aNetName );
+    }
+
+    /**
+     * @return the intersections found by loadSegments().
+     */
+    std::vector<VECTOR2I> intersections() const
+    {
+        std::vector<VECTOR2I> result = m_plugin.m_wireIntersections;
+
+        std::sort( result.begin(), result.end(), lexicalLess );
+        return result;
+    }
+
+    /**
+     * @return the intersections of the loaded wires, as found by loadSegments() before it used
+     *         an R-tree: each wire was tested against every wire loaded before it, except the
+     *         wires of the segments already labelled with its net.
+     */
+    std::vector<VECTOR2I> allPairsIntersections() const
+    {
+        const std::vector<SCH_EAGLE_PLUGIN::SEG_DESC>& segments = m_plugin.m_segments;
+        std::vector<VECTOR2I>                          result;
+
+        for( size_t k = 0; k < segments.size(); k++ )
+        {
+            for( size_t i = 0; i < segments[k].segs.size(); i++ )
+            {
+                for( size_t j = 0; j <= k; j++ )
+                {
+                    const SCH_EAGLE_PLUGIN::SEG_DESC& desc = segments[j];
+
+                    // The labels of a segment are loaded after its wires
+                    if( j < k && !desc.labels.empty()
+                            && desc.labels.front()->GetText() == m_segmentNets[k] )
+                    {
+                        continue;
+                    }
+
+                    size_t count = ( j < k ) ? desc.segs.size() : i;
+
+                    for( size_t s = 0; s < count; s++ )
+                    {
+                        OPT_VECTOR2I p = segments[k].segs[i].Intersect( desc.segs[s], true );
+
+                        if( p )
+                            result.push_back( *p );
+                    }
+                }
+            }
+        }
+
+        std::sort( result.begin(), result.end(), lexicalLess );
+        return result;
+    }
+
+    SCH_EAGLE_PLUGIN      m_plugin;
+    SCH_SHEET             m_sheet;
+    std::vector<wxString> m_segmentNets;
+};
+
+
+/**
+ * Create a <segments> node of random wires on a small grid, so that the wires of different
+ * segments and nets cross and overlap.  Every third segment has a label.
+ */
+static wxXmlNode* makeSegments( std::mt19937& aRng, int aSegmentCount )
+{
+    std::uniform_int_distribution<int> coord( 0, 8 );
+    std::uniform_int_distribution<int> wireCount( 1, 5 );
+
+    auto pos =
+            [&]()
+            {
+                return wxString::Format( "%.2f", 2.54 * coord( aRng ) );
+            };
+
+    wxXmlNode* segments = new wxXmlNode( wxXML_ELEMENT_NODE, "segments" );
+
+    for( int i = 0; i < aSegmentCount; i++ )
+    {
+        wxXmlNode* segment = new wxXmlNode( segments, wxXML_ELEMENT_NODE, "segment" );
+
+        if( i % 3 == 0 )
+        {
+            wxXmlNode* label = new wxXmlNode( segment, wxXML_ELEMENT_NODE, "label" );
+
+            label->AddAttribute( "x", pos() );
+            label->AddAttribute( "y", pos() );
+            label->AddAttribute( "size", "1.778" );
+            label->AddAttribute( "layer", "95" );
+        }
+
+        for( int w = wireCount( aRng ); w > 0; w-- )
+        {
+            wxXmlNode* wire = new wxXmlNode( segment, wxXML_ELEMENT_NODE, "wire" );
+
+            wire->AddAttribute( "x1", pos() );
+            wire->AddAttribute( "y1", pos() );
+            wire->AddAttribute( "x2", pos() );
+            wire->AddAttribute( "y2", pos() );
+            wire->AddAttribute( "width", "0.1524" );
+            wire->AddAttribute( "layer", "91" );
+        }
+    }
+
+    return segments;
+}
+
+
+/**
+ * Check that the R-tree search of loadSegments() finds the same wire intersections as the
+ * former test of every pair of wires.
+ */
+BOOST_FIXTURE_TEST_CASE( WireIntersections, TEST_SCH_EAGLE_PLUGIN_FIXTURE )
+{
+    LOCALE_IO    toggle;
+    std::mt19937 rng( 1 );
+
+    std::uniform_int_distribution<int> segmentCount( 1, 4 );
+
+    for( int net = 0; net < 20; net++ )
+    {
+        // Some nets are loaded twice, as a net spread over two sheets
+        wxString                   netName = wxString::Format( "N%d", net % 15 );
+        std::unique_ptr<wxXmlNode> segments( makeSegments( rng, segmentCount( rng ) ) );
+
+        loadSegments( segments.get(), netName );
+    }
+
+    std::vector<VECTOR2I> expected = allPairsIntersections();
+
+    BOOST_REQUIRE( !expected.empty() );
+
+    std::vector<VECTOR2I> found = intersections();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+}
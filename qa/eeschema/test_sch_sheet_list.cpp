@@ -27,6 +27,9 @@
 #include <settings/settings_manager.h>
 #include <wildcards_and_files_ext.h>
 
+#include <algorithm>
+#include <tuple>
+
 
 class TEST_SCH_SHEET_LIST_FIXTURE
 {
@@ -119,4 +122,95 @@ BOOST_AUTO_TEST_CASE( TestSheetListPageProperties )
 }
 
 
+/**
+ * Sub-sheets are loaded in parallel, and sheets using the same file share its screen
+ */
+BOOST_AUTO_TEST_CASE( TestSharedSheetScreens )
+{
+    loadSchematic( "complex_hierarchy" );
+
+    std::vector<SCH_SHEET*> subSheets;
+
+    for( SCH_ITEM* item : m_schematic.RootScreen()->Items().OfType( SCH_SHEET_T ) )
+        subSheets.push_back( static_cast<SCH_SHEET*>( item ) );
+
+    BOOST_REQUIRE_EQUAL( subSheets.size(), 2 );
+    BOOST_CHECK( subSheets[0]->GetScreen() != nullptr );
+    BOOST_CHECK( subSheets[0]->GetScreen() == subSheets[1]->GetScreen() );
+    BOOST_CHECK_EQUAL( subSheets[0]->GetScreen()->GetRefCount(), 2 );
+    BOOST_CHECK( !subSheets[0]->GetScreen()->Items().empty() );
+
+    SCH_SCREENS screens( m_schematic.Root() );
+
+    BOOST_CHECK_EQUAL( screens.GetCount(), 2 );
+}
+
+
+/**
+ * Describes the R-tree of a screen: the bounding box of each item with the number of items
+ * the R-tree finds overlapping it.
+ */
+static std::vector<std::tuple<int, int, int, int, int>> describeRTree( SCH_SCREEN* aScreen )
+{
+    std::vector<std::tuple<int, int, int, int, int>> desc;
+
+    for( SCH_ITEM* item : aScreen->Items() )
+    {
+        EDA_RECT bbox = item->GetBoundingBox();
+        int      found = 0;
+
+        for( SCH_ITEM* other : aScreen->Items().Overlapping( bbox ) )
+        {
+            (void) other;
+            found++;
+        }
+
+        desc.emplace_back( bbox.GetX(), bbox.GetY(), bbox.GetWidth(), bbox.GetHeight(), found );
+    }
+
+    std::sort( desc.begin(), desc.end() );
+
+    return desc;
+}
+
+
+/**
+ * The sub-sheets of a level are parsed by several workers.  Their screens must be the same
+ * as when each file is loaded alone, on this thread.
+ */
+BOOST_AUTO_TEST_CASE( TestParallelSheetsSameAsSequential )
+{
+    loadSchematic( "video" );
+
+    std::vector<SCH_SHEET*> subSheets;
+
+    for( SCH_ITEM* item : m_schematic.RootScreen()->Items().OfType( SCH_SHEET_T ) )
+        subSheets.push_back( static_cast<SCH_SHEET*>( item ) );
+
+    BOOST_REQUIRE_EQUAL( subSheets.size(), 7 );
+
+    for( SCH_SHEET* sheet : subSheets )
+    {
+        SCH_SCREEN* screen = sheet->GetScreen();
+
+        BOOST_REQUIRE( screen );
+        BOOST_TEST_MESSAGE( screen->GetFileName() );
+
+        SCHEMATIC schematic( nullptr );
+
+        schematic.SetProject( &m_manager.Prj() );
+        schematic.SetRoot( m_pi->Load( screen->GetFileName(), &schematic ) );
+
+        BOOST_REQUIRE( m_pi->GetError().IsEmpty() );
+
+        SCH_SCREEN* alone = schematic.RootScreen();
+
+        alone->UpdateLocalLibSymbolLinks();
+
+        BOOST_CHECK_EQUAL( screen->Items().size(), alone->Items().size() );
+        BOOST_CHECK( describeRTree( screen ) == describeRTree( alone ) );
+    }
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,179 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_polygon_triangulation.cpp
+ *
+ * Checks that PolygonTriangulation covers its polygons exactly, and that triangulating the
+ * polygons of a set in parallel gives the same triangles.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/polygon_triangulation.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+#include <cmath>
+#include <random>
+
+
+static SHAPE_LINE_CHAIN makeStar( std::mt19937& aRng, const VECTOR2I& aCenter, int aMinRadius,
+                                  int aMaxRadius, int aCount )
+{
+    std::uniform_int_distribution<int> radius( aMinRadius, aMaxRadius );
+    SHAPE_LINE_CHAIN                   chain;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        double angle = 2.0 * M_PI * i / aCount;
+        int    r = radius( aRng );
+
+        chain.Append( aCenter.x + r * cos( angle ), aCenter.y + r * sin( angle ) );
+    }
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+/**
+ * A fractured star with aHoles small stars cut out of it.
+ */
+static SHAPE_POLY_SET makeFractured( std::mt19937& aRng, int aVertices, int aHoles )
+{
+    SHAPE_POLY_SET                     set( makeStar( aRng, { 0, 0 }, 500000, 1000000,
+                                                      aVertices ) );
+    SHAPE_POLY_SET                     holes;
+    std::uniform_int_distribution<int> coord( -500000, 500000 );
+
+    for( int i = 0; i < aHoles; i++ )
+        holes.AddOutline( makeStar( aRng, { coord( aRng ), coord( aRng ) }, 10000, 40000, 12 ) );
+
+    set.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+    set.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    return set;
+}
+
+
+static double trianglesArea( const SHAPE_POLY_SET::TRIANGULATED_POLYGON& aTriangles )
+{
+    double area = 0.0;
+
+    for( size_t i = 0; i < aTriangles.GetTriangleCount(); i++ )
+    {
+        VECTOR2I a, b, c;
+
+        aTriangles.GetTriangle( i, a, b, c );
+        area += std::abs( (double) ( b - a ).Cross( c - a ) ) / 2.0;
+    }
+
+    return area;
+}
+
+
+BOOST_AUTO_TEST_SUITE( Triangulation )
+
+
+/**
+ * The triangles must cover the polygon without overlapping, so their areas add up to the
+ * area of the polygon.  The large cases use the radix sort of the z-order values.
+ */
+BOOST_AUTO_TEST_CASE( CoversPolygon )
+{
+    std::mt19937 rng( 7 );
+
+    for( int vertices : { 3, 20, 400, 5000 } )
+    {
+        for( int holes : { 0, 10, 200 } )
+        {
+            SHAPE_POLY_SET set = makeFractured( rng, vertices, holes );
+
+            for( int i = 0; i < set.OutlineCount(); i++ )
+            {
+                BOOST_TEST_CONTEXT( vertices << " vertices, " << holes << " holes" )
+                {
+                    SHAPE_POLY_SET::TRIANGULATED_POLYGON result;
+                    PolygonTriangulation                 tess( result );
+                    double area = std::abs( set.COutline( i ).Area() );
+
+                    BOOST_CHECK( tess.TesselatePolygon( set.COutline( i ) ) );
+                    BOOST_CHECK_CLOSE( trianglesArea( result ), area, 1e-6 );
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * CacheTriangulation() of a large set triangulates its polygons in parallel
+ */
+BOOST_AUTO_TEST_CASE( ParallelCache )
+{
+    std::mt19937   rng( 8 );
+    SHAPE_POLY_SET set;
+
+    for( int i = 0; i < 40; i++ )
+    {
+        set.AddOutline( makeStar( rng, { ( i % 8 ) * 3000000, ( i / 8 ) * 3000000 }, 500000,
+                                  1000000, 200 ) );
+    }
+
+    int            threshold = SHAPE_POLY_SET::GetParallelThreshold();
+    SHAPE_POLY_SET serial( set );
+    SHAPE_POLY_SET parallel( set );
+
+    SHAPE_POLY_SET::SetParallelThreshold( 0 );
+    serial.CacheTriangulation( false );
+    SHAPE_POLY_SET::SetParallelThreshold( 1 );
+    parallel.CacheTriangulation( false );
+    SHAPE_POLY_SET::SetParallelThreshold( threshold );
+
+    BOOST_CHECK( serial.IsTriangulationUpToDate() );
+    BOOST_CHECK( parallel.IsTriangulationUpToDate() );
+    BOOST_REQUIRE_EQUAL( parallel.TriangulatedPolyCount(), serial.TriangulatedPolyCount() );
+
+    for( unsigned i = 0; i < serial.TriangulatedPolyCount(); i++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* a = serial.TriangulatedPolygon( i );
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* b = parallel.TriangulatedPolygon( i );
+
+        BOOST_REQUIRE_EQUAL( a->GetTriangleCount(), b->GetTriangleCount() );
+
+        for( size_t j = 0; j < a->GetTriangleCount(); j++ )
+        {
+            VECTOR2I a0, a1, a2, b0, b1, b2;
+
+            a->GetTriangle( j, a0, a1, a2 );
+            b->GetTriangle( j, b0, b1, b2 );
+
+            BOOST_CHECK( a0 == b0 && a1 == b1 && a2 == b2 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/seg.h>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+#include <random>
+
+
+/**
+ * Checks that the batched kernels, with the instruction set aIsa, return all the segments
+ * of aPts that SEG finds closer than aDist to aP and aSeg.
+ */
+static void checkKernels( const std::vector<VECTOR2I>& aPts, const VECTOR2I& aP, const SEG& aSeg,
+                          int aDist, SEG_BATCH_ISA aIsa )
+{
+    const int   n = aPts.size();
+    SEG::ecoord distSq = SEG::Square( aDist );
+    int         nextPt = FindSegmentNear( aPts.data(), n, 0, aP, aDist, aIsa );
+    int         nextSeg = FindSegmentNear( aPts.data(), n, 0, aSeg, aDist, aIsa );
+
+    for( int i = 0; i < n - 1; i++ )
+    {
+        SEG         s( aPts[i], aPts[i + 1] );
+        SEG::ecoord dPt = s.SquaredDistance( aP );
+        SEG::ecoord dSeg = s.SquaredDistance( aSeg );
+
+        if( nextPt < i )
+            nextPt = FindSegmentNear( aPts.data(), n, i, aP, aDist, aIsa );
+
+        if( nextSeg < i )
+            nextSeg = FindSegmentNear( aPts.data(), n, i, aSeg, aDist, aIsa );
+
+        if( dPt == 0 || dPt < distSq )
+            BOOST_CHECK_EQUAL( nextPt, i );
+
+        if( dSeg == 0 || dSeg < distSq || s.Collide( aSeg, aDist ) )
+            BOOST_CHECK_EQUAL( nextSeg, i );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+
+/**
+ * The kernels must never skip a segment that SEG finds colliding, whatever the scale of
+ * the coordinates
+ */
+BOOST_AUTO_TEST_CASE( NoMissedCollisions )
+{
+    std::mt19937 rng( 1 );
+
+    for( int range : { 100, 1000000, 400000000, 2000000000 } )
+    {
+        std::uniform_int_distribution<int> coord( -range / 2, range / 2 );
+        std::uniform_int_distribution<int> dist( 0, range / 8 );
+
+        for( int iter = 0; iter < 200; iter++ )
+        {
+            std::vector<VECTOR2I> pts( 2 + iter % 20 );
+
+            for( VECTOR2I& pt : pts )
+                pt = VECTOR2I( coord( rng ), coord( rng ) );
+
+            // Zero-length segments
+            if( iter % 5 == 0 )
+                pts[1] = pts[0];
+
+            VECTOR2I p( coord( rng ), coord( rng ) );
+            SEG      seg( VECTOR2I( coord( rng ), coord( rng ) ),
+                          VECTOR2I( coord( rng ), coord( rng ) ) );
+
+            for( SEG_BATCH_ISA isa : { SEG_BATCH_ISA::SCALAR, SEG_BATCH_ISA::SSE2,
+                                       SEG_BATCH_ISA::AVX2 } )
+            {
+                if( SegBatchIsaSupported( isa ) )
+                    checkKernels( pts, p, seg, iter % 3 ? dist( rng ) : 0, isa );
+            }
+        }
+    }
+}
+
+
+/**
+ * Touching and collinear segments are corner cases of the intersection filter
+ */
+BOOST_AUTO_TEST_CASE( TouchingSegments )
+{
+    const std::vector<VECTOR2I> pts = { { 0, 0 }, { 100, 0 }, { 100, 100 }, { 0, 100 },
+                                        { 0, 200 }, { 300, 200 }, { 300, 0 } };
+
+    for( SEG_BATCH_ISA isa : { SEG_BATCH_ISA::SCALAR, SEG_BATCH_ISA::SSE2,
+                               SEG_BATCH_ISA::AVX2 } )
+    {
+        if( !SegBatchIsaSupported( isa ) )
+            continue;
+
+        checkKernels( pts, { 100, 50 }, SEG( { 100, 50 }, { 200, 50 } ), 0, isa );
+        checkKernels( pts, { 50, 0 }, SEG( { 150, 0 }, { 250, 0 } ), 0, isa );
+        checkKernels( pts, { 300, 100 }, SEG( { 300, 100 }, { 300, 300 } ), 0, isa );
+        checkKernels( pts, { 200, 201 }, SEG( { -100, 201 }, { 400, 199 } ), 1, isa );
+    }
+}
+
+
+/**
+ * SHAPE_LINE_CHAIN::Collide() filters its segments with the kernels: check the results
+ * against a plain loop over the segments, including the closing segment
+ */
+BOOST_AUTO_TEST_CASE( LineChainCollide )
+{
+    std::mt19937                       rng( 2 );
+    std::uniform_int_distribution<int> coord( -100000, 100000 );
+
+    for( int iter = 0; iter < 500; iter++ )
+    {
+        SHAPE_LINE_CHAIN chain;
+
+        for( int i = 0; i < 3 + iter % 30; i++ )
+            chain.Append( coord( rng ), coord( rng ) );
+
+        chain.SetClosed( iter % 2 );
+
+        VECTOR2I p( coord( rng ), coord( rng ) );
+        SEG      seg( VECTOR2I( coord( rng ), coord( rng ) ), VECTOR2I( coord( rng ), coord( rng ) ) );
+        int      clearance = 10000;
+
+        SEG::ecoord minPt = VECTOR2I::ECOORD_MAX;
+        SEG::ecoord minSeg = VECTOR2I::ECOORD_MAX;
+
+        for( int i = 0; i < chain.SegmentCount(); i++ )
+        {
+            minPt = std::min( minPt, chain.CSegment( i ).SquaredDistance( p ) );
+            minSeg = std::min( minSeg, chain.CSegment( i ).SquaredDistance( seg ) );
+        }
+
+        int actual = -1;
+
+        // Points and segments inside closed chains are colliding whatever the distance
+        if( !chain.IsClosed() || !chain.PointInside( p, clearance ) )
+        {
+            BOOST_CHECK_EQUAL( chain.Collide( p, clearance, &actual ),
+                               minPt == 0 || minPt < SEG::Square( clearance ) );
+
+            if( actual >= 0 )
+                BOOST_CHECK_EQUAL( actual, (int) sqrt( minPt ) );
+        }
+
+        actual = -1;
+
+        if( !chain.IsClosed() || !chain.PointInside( seg.A ) )
+        {
+            BOOST_CHECK_EQUAL( chain.Collide( seg, clearance, &actual ),
+                               minSeg == 0 || minSeg < SEG::Square( clearance ) );
+
+            if( actual >= 0 )
+                BOOST_CHECK_EQUAL( actual, (int) sqrt( minSeg ) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -24,6 +24,7 @@
 #include <geometry/shape_arc.h>
 
 #include <geometry/shape_line_chain.h>
+#include <geometry/shape_segment.h>
 
 #include <unit_test_utils/geometry.h>
 #include <unit_test_utils/numeric.h>
@@ -31,6 +32,8 @@
 
 #include "geom_test_utils.h"
 
+#include <random>
+
 BOOST_AUTO_TEST_SUITE( ShapeArc )
 
 /**
@@ -612,4 +615,173 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 }
 
 
+/**
+ * Arcs going both ways, below and beyond a half turn
+ */
+BOOST_AUTO_TEST_CASE( SliceContainsPoint )
+{
+    const SHAPE_ARC quarter( { 0, 0 }, { 1000, 0 }, 90 );
+    const SHAPE_ARC reversed( { 0, 0 }, { 1000, 0 }, -90 );
+    const SHAPE_ARC large( { 0, 0 }, { 1000, 0 }, 270 );
+
+    BOOST_CHECK( quarter.SliceContainsPoint( quarter.GetArcMid() * 5 ) );
+    BOOST_CHECK( !quarter.SliceContainsPoint( VECTOR2I( 0, 0 ) - quarter.GetArcMid() ) );
+    BOOST_CHECK( quarter.SliceContainsPoint( { 10, 0 } ) );
+    BOOST_CHECK( !reversed.SliceContainsPoint( quarter.GetArcMid() ) );
+    BOOST_CHECK( reversed.SliceContainsPoint( reversed.GetArcMid() ) );
+    BOOST_CHECK( large.SliceContainsPoint( VECTOR2I( 0, 0 ) - quarter.GetArcMid() ) );
+    BOOST_CHECK( !large.SliceContainsPoint( reversed.GetArcMid() ) );
+}
+
+
+static SEG::ecoord chainDistance( const SHAPE_LINE_CHAIN& aChain, const SEG& aSeg )
+{
+    SEG::ecoord dist_sq = VECTOR2I::ECOORD_MAX;
+
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+        dist_sq = std::min( dist_sq, aChain.CSegment( i ).SquaredDistance( aSeg ) );
+
+    return dist_sq;
+}
+
+
+static SEG::ecoord chainDistance( const SHAPE_LINE_CHAIN& aChain, const SHAPE_LINE_CHAIN& aOther )
+{
+    SEG::ecoord dist_sq = VECTOR2I::ECOORD_MAX;
+
+    for( int i = 0; i < aOther.SegmentCount(); i++ )
+        dist_sq = std::min( dist_sq, chainDistance( aChain, aOther.CSegment( i ) ) );
+
+    return dist_sq;
+}
+
+
+static SHAPE_ARC randomArc( std::mt19937& aRng )
+{
+    std::uniform_int_distribution<int>     coord( -200000, 200000 );
+    std::uniform_int_distribution<int>     radius( 20000, 200000 );
+    std::uniform_real_distribution<double> angle( 10.0, 350.0 );
+    std::uniform_real_distribution<double> start( 0.0, 2 * M_PI );
+
+    VECTOR2I center( coord( aRng ), coord( aRng ) );
+    VECTOR2I p = center + VECTOR2I( radius( aRng ), 0 ).Rotate( start( aRng ) );
+
+    return SHAPE_ARC( center, p, aRng() % 2 ? angle( aRng ) : -angle( aRng ) );
+}
+
+
+/**
+ * The distances computed on the arcs match the ones of fine polylines, to the accuracy of
+ * the polylines.
+ */
+BOOST_AUTO_TEST_CASE( DistanceMatchesPolyline )
+{
+    const int    accuracy = 20;
+    std::mt19937 rng( 3 );
+
+    std::uniform_int_distribution<int> coord( -400000, 400000 );
+
+    auto checkNearest =
+            [&]( const SHAPE_ARC& aArc, const VECTOR2I& aNearest )
+            {
+                BOOST_CHECK_LE( std::abs( ( aNearest - aArc.GetCenter() ).EuclideanNorm()
+                                          - aArc.GetRadius() ), 2 );
+                BOOST_CHECK( aArc.SliceContainsPoint( aNearest )
+                             || ( aNearest - aArc.GetP0() ).EuclideanNorm() <= 2
+                             || ( aNearest - aArc.GetP1() ).EuclideanNorm() <= 2 );
+            };
+
+    for( int i = 0; i < 100; i++ )
+    {
+        const SHAPE_ARC        arc = randomArc( rng );
+        const SHAPE_ARC        other = randomArc( rng );
+        const SHAPE_LINE_CHAIN chain = arc.ConvertToPolyline( accuracy );
+        const SHAPE_LINE_CHAIN otherChain = other.ConvertToPolyline( accuracy );
+
+        BOOST_TEST_CONTEXT( "Arc " << i )
+        {
+            VECTOR2I p( coord( rng ), coord( rng ) );
+            SEG      seg( p, VECTOR2I( coord( rng ), coord( rng ) ) );
+            VECTOR2I nearest;
+
+            double d = sqrt( arc.SquaredDistance( p, &nearest ) );
+            BOOST_CHECK_LE( std::abs( d - sqrt( chainDistance( chain, SEG( p, p ) ) ) ),
+                            accuracy + 2 );
+            checkNearest( arc, nearest );
+
+            d = sqrt( arc.SquaredDistance( seg, &nearest ) );
+            BOOST_CHECK_LE( std::abs( d - sqrt( chainDistance( chain, seg ) ) ), accuracy + 2 );
+            checkNearest( arc, nearest );
+
+            d = sqrt( arc.SquaredDistance( other, &nearest ) );
+            BOOST_CHECK_LE( std::abs( d - sqrt( chainDistance( chain, otherChain ) ) ),
+                            2 * accuracy + 2 );
+            checkNearest( arc, nearest );
+        }
+    }
+}
+
+
+/**
+ * Collisions account for the width of the arc, like the ones of segments do
+ */
+BOOST_AUTO_TEST_CASE( CollideWidth )
+{
+    const SHAPE_ARC     arc( { 0, 0 }, { 100000, 0 }, 90, 20000 );
+    const SHAPE_SEGMENT seg( { 150000, -50000 }, { 150000, 200000 }, 10000 );
+    const SHAPE_ARC     inner( { 0, 0 }, { 60000, 0 }, 90, 10000 );
+    int                 actual = 0;
+
+    // The segment edge is 35000 away from the arc edge
+    BOOST_CHECK( !arc.Collide( &seg, 35000 ) );
+    BOOST_CHECK( arc.Collide( &seg, 35001, &actual, nullptr ) );
+    BOOST_CHECK_EQUAL( actual, 35000 );
+    BOOST_CHECK( seg.Collide( &arc, 35001, &actual, nullptr ) );
+    BOOST_CHECK_EQUAL( actual, 35000 );
+
+    // Concentric arcs, 40000 - 10000 - 5000 apart
+    BOOST_CHECK( !arc.Collide( &inner, 25000 ) );
+    BOOST_CHECK( arc.Collide( &inner, 25001, &actual, nullptr ) );
+    BOOST_CHECK_EQUAL( actual, 25000 );
+
+    // Outside the sector of the arc only its ends count
+    BOOST_CHECK( !arc.Collide( VECTOR2I( -100000, 0 ), 100000 ) );
+    BOOST_CHECK( arc.Collide( VECTOR2I( -100000, 0 ), 131422, &actual, nullptr ) );
+}
+
+
+/**
+ * The translation vectors of the arc collisions move the other shape clear of the arc
+ */
+BOOST_AUTO_TEST_CASE( CollideMTV )
+{
+    const SHAPE_ARC  arc( { 0, 0 }, { 100000, 0 }, 90, 20000 );
+    SHAPE_SEGMENT    seg( { 150000, -50000 }, { 150000, 200000 }, 10000 );
+    SHAPE_ARC        facing( { 230000, 0 }, { 130000, 0 }, 45, 10000 );
+    SHAPE_LINE_CHAIN chain( { VECTOR2I( 150000, -50000 ), VECTOR2I( 150000, 200000 ) } );
+    VECTOR2I         mtv;
+
+    // 35000 between the edges, pushed out to the right by the missing 5000
+    BOOST_CHECK( arc.Collide( &seg, 40000, &mtv ) );
+    BOOST_CHECK_LE( std::abs( mtv.x - 5000 ), 2 );
+    BOOST_CHECK_LE( std::abs( mtv.y ), 2 );
+    seg.Move( mtv );
+    BOOST_CHECK( !arc.Collide( &seg, 40000 ) );
+
+    // 40000 between the arc edge and the chain
+    BOOST_CHECK( arc.Collide( &chain, 45000, &mtv ) );
+    BOOST_CHECK_LE( std::abs( mtv.x - 5000 ), 2 );
+    BOOST_CHECK_LE( std::abs( mtv.y ), 2 );
+    chain.Move( mtv );
+    BOOST_CHECK( !arc.Collide( &chain, 45000 ) );
+
+    // 15000 between the start of the arc and an arc bulging towards it
+    BOOST_CHECK( arc.Collide( &facing, 20000, &mtv ) );
+    BOOST_CHECK_LE( std::abs( mtv.x - 5000 ), 2 );
+    BOOST_CHECK_LE( std::abs( mtv.y ), 2 );
+    facing.Move( mtv );
+    BOOST_CHECK( !arc.Collide( &facing, 20000 ) );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
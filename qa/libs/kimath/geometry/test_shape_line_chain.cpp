@@ -59,4 +59,71 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 }
 
 
+/**
+ * Chains without arcs don't store the shape indices, check that they follow the points when
+ * arcs come and go.
+ */
+BOOST_AUTO_TEST_CASE( ArcIndices )
+{
+    const SHAPE_ARC  arc( VECTOR2I( 0, 5000 ), VECTOR2I( 0, 4000 ), 90 );
+    SHAPE_LINE_CHAIN chain( { VECTOR2I( 0, 0 ), VECTOR2I( 0, 1000 ), VECTOR2I( 0, 1000 ),
+                              VECTOR2I( 1000, 3000 ) } );
+
+    auto checkShapes =
+            [&]( const SHAPE_LINE_CHAIN& aChain )
+            {
+                BOOST_REQUIRE_EQUAL( aChain.CShapes().size(), aChain.CPoints().size() );
+
+                for( int i = 0; i < aChain.PointCount(); i++ )
+                {
+                    BOOST_CHECK_EQUAL( aChain.CShapes()[i], aChain.ArcIndex( i ) );
+                    BOOST_CHECK( aChain.ArcIndex( i ) < (ssize_t) aChain.ArcCount() );
+                }
+            };
+
+    chain.Simplify();
+    BOOST_CHECK_EQUAL( chain.PointCount(), 3 );
+    checkShapes( chain );
+
+    chain.Append( arc );
+    int arcStart = chain.PointCount() - arc.ConvertToPolyline().PointCount();
+
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 1 );
+    BOOST_CHECK_EQUAL( chain.ArcIndex( arcStart ), 0 );
+    BOOST_CHECK_EQUAL( chain.ArcIndex( 0 ), -1 );
+    checkShapes( chain );
+
+    chain.Append( VECTOR2I( 10000, 10000 ) );
+    BOOST_CHECK_EQUAL( chain.ArcIndex( -1 + chain.PointCount() ), -1 );
+    checkShapes( chain );
+
+    SHAPE_LINE_CHAIN other( { VECTOR2I( -1000, 0 ), VECTOR2I( -2000, 0 ) } );
+
+    other.Append( chain );
+    BOOST_CHECK_EQUAL( other.ArcCount(), 1 );
+    BOOST_CHECK_EQUAL( other.ArcIndex( arcStart + 2 ), 0 );
+    checkShapes( other );
+
+    other.Replace( 0, 0, chain );
+    BOOST_CHECK_EQUAL( other.ArcCount(), 2 );
+    BOOST_CHECK_EQUAL( other.ArcIndex( arcStart ), 1 );
+    checkShapes( other );
+
+    checkShapes( other.Reverse() );
+
+    chain.Remove( arcStart, chain.PointCount() - 2 );
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 0 );
+    checkShapes( chain );
+
+    chain.Insert( 1, VECTOR2I( 0, 500 ) );
+    chain.Replace( 1, 2, VECTOR2I( 0, 700 ) );
+    BOOST_CHECK_EQUAL( chain.CPoint( 1 ), VECTOR2I( 0, 700 ) );
+    checkShapes( chain );
+
+    SHAPE_LINE_CHAIN moved( std::move( other ) );
+    BOOST_CHECK_EQUAL( moved.ArcCount(), 2 );
+    checkShapes( moved );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,256 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_edge_index.cpp
+ *
+ * Compares the queries of large SHAPE_POLY_SETs, which use an edge index after a few calls,
+ * with the same queries made polygon by polygon (which never use it).
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+#include <cmath>
+#include <random>
+
+
+/**
+ * Returns a star shaped contour around aCenter, with vertices on a 10 nm grid so that many
+ * queries are at the same distance from several edges, or exactly on them.
+ */
+static SHAPE_LINE_CHAIN makeStar( std::mt19937& aRng, const VECTOR2I& aCenter, int aMinRadius,
+                                  int aMaxRadius, int aCount )
+{
+    std::uniform_int_distribution<int> radius( aMinRadius / 10, aMaxRadius / 10 );
+    SHAPE_LINE_CHAIN                   chain;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        double angle = 2.0 * M_PI * i / aCount;
+        int    r = radius( aRng ) * 10;
+
+        chain.Append( aCenter.x + KiROUND( r * cos( angle ) / 10 ) * 10,
+                      aCenter.y + KiROUND( r * sin( angle ) / 10 ) * 10 );
+    }
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+/**
+ * A grid of star polygons, most with a hole, and a large polygon overlapping some of them.
+ */
+static SHAPE_POLY_SET makeSet( std::mt19937& aRng )
+{
+    SHAPE_POLY_SET set;
+
+    for( int x = 0; x < 8; x++ )
+    {
+        for( int y = 0; y < 6; y++ )
+        {
+            VECTOR2I center( x * 100000, y * 100000 );
+
+            set.AddOutline( makeStar( aRng, center, 30000, 60000, 24 ) );
+
+            if( ( x + y ) % 3 )
+                set.AddHole( makeStar( aRng, center, 5000, 25000, 12 ) );
+        }
+    }
+
+    set.AddOutline( makeStar( aRng, VECTOR2I( 350000, 250000 ), 100000, 250000, 40 ) );
+
+    return set;
+}
+
+
+/**
+ * The queries of SHAPE_POLY_SET, made one polygon at a time.
+ */
+static bool refContains( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP, int aAccuracy )
+{
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        if( aSet.Contains( aP, i, aAccuracy ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+template <typename QUERY>
+static SEG::ecoord refDistance( const SHAPE_POLY_SET& aSet, const QUERY& aQuery,
+                                VECTOR2I* aNearest )
+{
+    SEG::ecoord minDistance = VECTOR2I::ECOORD_MAX;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        VECTOR2I    nearest;
+        SEG::ecoord d = aSet.SquaredDistanceToPolygon( aQuery, i, &nearest );
+
+        if( d < minDistance )
+        {
+            minDistance = d;
+            *aNearest = nearest;
+        }
+    }
+
+    return minDistance;
+}
+
+
+/**
+ * Random points around the set, and points on its vertices and edges.
+ */
+static std::vector<VECTOR2I> makePoints( std::mt19937& aRng, const SHAPE_POLY_SET& aSet )
+{
+    std::vector<VECTOR2I>              points;
+    std::uniform_int_distribution<int> coord( -100000, 900000 );
+
+    for( int i = 0; i < 2000; i++ )
+        points.emplace_back( coord( aRng ) / 10 * 10, coord( aRng ) / 10 * 10 );
+
+    int count = 0;
+
+    for( auto it = aSet.CIterateSegmentsWithHoles(); it; it++ )
+    {
+        if( count++ % 7 )
+            continue;
+
+        points.push_back( ( *it ).A );
+        points.push_back( ( ( *it ).A + ( *it ).B ) / 2 );
+    }
+
+    return points;
+}
+
+
+static void checkQueries( std::mt19937& aRng, const SHAPE_POLY_SET& aSet )
+{
+    std::vector<VECTOR2I>              points = makePoints( aRng, aSet );
+    std::uniform_int_distribution<int> length( -80000, 80000 );
+
+    for( const VECTOR2I& p : points )
+    {
+        BOOST_TEST_CONTEXT( "Point " << p )
+        {
+            for( int accuracy : { 0, 1, 5, 2000 } )
+            {
+                BOOST_CHECK_EQUAL( aSet.Contains( p, -1, accuracy ),
+                                   refContains( aSet, p, accuracy ) );
+            }
+
+            VECTOR2I    nearest, refNearest;
+            SEG::ecoord d = aSet.SquaredDistance( p, &nearest );
+
+            BOOST_CHECK_EQUAL( d, refDistance( aSet, p, &refNearest ) );
+            BOOST_CHECK_EQUAL( nearest, refNearest );
+
+            for( int clearance : { 0, 100, 20000 } )
+            {
+                bool refCollide = d == 0 || d < SEG::Square( clearance );
+                int  actual = -1;
+
+                BOOST_CHECK_EQUAL( aSet.Collide( p, clearance, &actual, &nearest ), refCollide );
+
+                if( refCollide )
+                {
+                    BOOST_CHECK_EQUAL( actual, (int) sqrt( d ) );
+                    BOOST_CHECK_EQUAL( nearest, refNearest );
+                }
+            }
+
+            SEG seg( p, p + VECTOR2I( length( aRng ), length( aRng ) ) );
+
+            d = aSet.SquaredDistance( seg, &nearest );
+
+            BOOST_CHECK_EQUAL( d, refDistance( aSet, seg, &refNearest ) );
+            BOOST_CHECK_EQUAL( nearest, refNearest );
+
+            for( int clearance : { 0, 100, 20000 } )
+            {
+                bool refCollide = d == 0 || d < SEG::Square( clearance );
+
+                BOOST_CHECK_EQUAL( aSet.Collide( seg, clearance ), refCollide );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( ShapePolySetEdgeIndex )
+
+
+BOOST_AUTO_TEST_CASE( Queries )
+{
+    std::mt19937   rng( 1 );
+    SHAPE_POLY_SET set = makeSet( rng );
+
+    checkQueries( rng, set );
+}
+
+
+/**
+ * The index built by the queries must not survive changes of the set
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    std::mt19937   rng( 2 );
+    SHAPE_POLY_SET set = makeSet( rng );
+
+    checkQueries( rng, set );
+
+    set.Move( VECTOR2I( 12340, -5670 ) );
+    checkQueries( rng, set );
+
+    set.SetVertex( 10, VECTOR2I( 200000, 200000 ) );
+    checkQueries( rng, set );
+
+    set.Outline( 3 ).SetPoint( 2, VECTOR2I( 310000, 120000 ) );
+    checkQueries( rng, set );
+
+    set.DeletePolygon( 0 );
+    checkQueries( rng, set );
+
+    set.AddOutline( makeStar( rng, VECTOR2I( 50000, 50000 ), 20000, 90000, 30 ) );
+    checkQueries( rng, set );
+
+    SHAPE_POLY_SET copy;
+
+    copy = set;
+    copy.Rotate( 0.5, VECTOR2I( 400000, 300000 ) );
+    checkQueries( rng, copy );
+
+    set.BooleanSubtract( copy, SHAPE_POLY_SET::PM_FAST );
+    checkQueries( rng, set );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
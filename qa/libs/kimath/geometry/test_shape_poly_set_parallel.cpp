@@ -0,0 +1,325 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_parallel.cpp
+ *
+ * Compares the results of the parallel (strip) mode of the SHAPE_POLY_SET operations with
+ * the serial ones.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+#include <algorithm>
+#include <random>
+
+
+typedef std::vector<std::pair<int, int>> RING;
+typedef std::vector<RING>                POLY;
+
+
+/**
+ * Returns aSet simplified, with its rings starting at their lowest vertex and its holes and
+ * polygons sorted, so that equal polygon sets give equal vectors.
+ */
+static std::vector<POLY> normalize( const SHAPE_POLY_SET& aSet )
+{
+    SHAPE_POLY_SET    set( aSet );
+    std::vector<POLY> polys;
+
+    set.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    for( int i = 0; i < set.OutlineCount(); i++ )
+    {
+        POLY poly;
+
+        for( int j = -1; j < set.HoleCount( i ); j++ )
+        {
+            const SHAPE_LINE_CHAIN& chain = j < 0 ? set.COutline( i ) : set.CHole( i, j );
+            RING                    ring;
+
+            for( int k = 0; k < chain.PointCount(); k++ )
+                ring.emplace_back( chain.CPoint( k ).x, chain.CPoint( k ).y );
+
+            std::rotate( ring.begin(), std::min_element( ring.begin(), ring.end() ), ring.end() );
+            poly.push_back( ring );
+        }
+
+        std::sort( poly.begin() + 1, poly.end() );
+        polys.push_back( poly );
+    }
+
+    std::sort( polys.begin(), polys.end() );
+
+    return polys;
+}
+
+
+/**
+ * Builds something looking like the copper of a board: a large outline with holes, and many
+ * overlapping pads and tracks.
+ */
+static void makeCopper( std::mt19937& aRng, int aCount, SHAPE_POLY_SET& aPlane,
+                        SHAPE_POLY_SET& aItems )
+{
+    const int size = 100000000;
+
+    std::uniform_int_distribution<int> coord( 0, size );
+    std::uniform_int_distribution<int> small( 200000, 3000000 );
+
+    aPlane.NewOutline();
+    aPlane.Append( 0, 0 );
+    aPlane.Append( size, 0 );
+    aPlane.Append( size, size );
+    aPlane.Append( size / 2, size / 2 + 1234567 );
+    aPlane.Append( 0, size );
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        VECTOR2I c( coord( aRng ), coord( aRng ) );
+        int      r = small( aRng );
+
+        if( i % 3 == 0 )
+        {
+            // Track
+            VECTOR2I d( small( aRng ) * 3, small( aRng ) - 1500000 );
+
+            aItems.NewOutline();
+            aItems.Append( c.x, c.y );
+            aItems.Append( c.x + d.x, c.y + d.y );
+            aItems.Append( c.x + d.x, c.y + d.y + r / 2 );
+            aItems.Append( c.x, c.y + r / 2 );
+        }
+        else
+        {
+            // Round pad
+            aItems.NewOutline();
+
+            for( int j = 0; j < 16; j++ )
+            {
+                double a = j * M_PI / 8;
+                aItems.Append( c.x + KiROUND( r * cos( a ) ), c.y + KiROUND( r * sin( a ) ) );
+            }
+        }
+
+        if( i % 5 == 0 )
+        {
+            // Hole in the plane
+            aPlane.NewHole();
+            aPlane.Append( c.x - r, c.y - r, 0, -1 );
+            aPlane.Append( c.x - r, c.y + r, 0, -1 );
+            aPlane.Append( c.x + r, c.y + r, 0, -1 );
+            aPlane.Append( c.x + r, c.y - r, 0, -1 );
+        }
+    }
+}
+
+
+static double totalArea( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    // The holes have a negative area
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        area += aSet.COutline( i ).Area();
+
+        for( int j = 0; j < aSet.HoleCount( i ); j++ )
+            area += aSet.CHole( i, j ).Area();
+    }
+
+    return area;
+}
+
+
+/**
+ * Runs aOperation serially and with aThreshold as the parallel threshold, and checks that
+ * the results are the same polygons once simplified.
+ */
+template <typename OPERATION>
+static void checkParallel( const SHAPE_POLY_SET& aInput, int aThreshold, OPERATION aOperation )
+{
+    int            saved = SHAPE_POLY_SET::GetParallelThreshold();
+    SHAPE_POLY_SET serial( aInput );
+    SHAPE_POLY_SET parallel( aInput );
+
+    SHAPE_POLY_SET::SetParallelThreshold( 0 );
+    aOperation( serial );
+
+    SHAPE_POLY_SET::SetParallelThreshold( aThreshold );
+    aOperation( parallel );
+
+    SHAPE_POLY_SET::SetParallelThreshold( 0 );
+
+    BOOST_CHECK( normalize( serial ) == normalize( parallel ) );
+
+    // The symmetric difference of the results must be empty
+    SHAPE_POLY_SET serialOnly( serial );
+    SHAPE_POLY_SET parallelOnly( parallel );
+
+    serialOnly.BooleanSubtract( parallel, SHAPE_POLY_SET::PM_FAST );
+    parallelOnly.BooleanSubtract( serial, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( totalArea( serialOnly ), 0.0 );
+    BOOST_CHECK_EQUAL( totalArea( parallelOnly ), 0.0 );
+
+    SHAPE_POLY_SET::SetParallelThreshold( saved );
+}
+
+
+BOOST_AUTO_TEST_SUITE( ShapePolySetParallel )
+
+
+BOOST_AUTO_TEST_CASE( Booleans )
+{
+    std::mt19937 rng( 1 );
+
+    for( int count : { 10, 200, 1000 } )
+    {
+        SHAPE_POLY_SET plane, items;
+
+        makeCopper( rng, count, plane, items );
+
+        BOOST_TEST_CONTEXT( count << " items" )
+        {
+            for( SHAPE_POLY_SET::POLYGON_MODE mode : { SHAPE_POLY_SET::PM_FAST,
+                                                       SHAPE_POLY_SET::PM_STRICTLY_SIMPLE } )
+            {
+                // The strictly simple operations always run serially
+                checkParallel( items, 1,
+                               [&]( SHAPE_POLY_SET& aSet )
+                               {
+                                   aSet.Simplify( mode );
+                               } );
+
+                checkParallel( plane, 1,
+                               [&]( SHAPE_POLY_SET& aSet )
+                               {
+                                   aSet.BooleanSubtract( items, mode );
+                               } );
+
+                checkParallel( plane, 1,
+                               [&]( SHAPE_POLY_SET& aSet )
+                               {
+                                   aSet.BooleanIntersection( items, mode );
+                               } );
+
+                checkParallel( plane, 1,
+                               [&]( SHAPE_POLY_SET& aSet )
+                               {
+                                   aSet.BooleanAdd( items, mode );
+                               } );
+            }
+        }
+    }
+}
+
+
+/**
+ * @return true if the outlines and holes of aA and aB have the same vertices in the same
+ *  order, without simplifying them.
+ */
+static bool sameVertices( const SHAPE_POLY_SET& aA, const SHAPE_POLY_SET& aB )
+{
+    if( aA.OutlineCount() != aB.OutlineCount() )
+        return false;
+
+    for( int i = 0; i < aA.OutlineCount(); i++ )
+    {
+        if( aA.HoleCount( i ) != aB.HoleCount( i ) )
+            return false;
+
+        for( int j = -1; j < aA.HoleCount( i ); j++ )
+        {
+            const SHAPE_LINE_CHAIN& a = j < 0 ? aA.COutline( i ) : aA.CHole( i, j );
+            const SHAPE_LINE_CHAIN& b = j < 0 ? aB.COutline( i ) : aB.CHole( i, j );
+
+            if( a.CPoints() != b.CPoints() )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Inflate() must stay serial above the parallel threshold: Clipper places the intersections
+ * of nearly parallel edges on scan lines depending on all the input vertices, so offsetting
+ * strips would move them.  Strips would also start the outlines at other vertices, so the
+ * result must be the serial one vertex for vertex, not only once simplified.
+ */
+BOOST_AUTO_TEST_CASE( InflateStaysSerial )
+{
+    std::mt19937 rng( 2 );
+    int          saved = SHAPE_POLY_SET::GetParallelThreshold();
+
+    for( int count : { 200, 1000 } )
+    {
+        SHAPE_POLY_SET plane, items;
+
+        makeCopper( rng, count, plane, items );
+        plane.BooleanSubtract( items, SHAPE_POLY_SET::PM_FAST );
+
+        BOOST_TEST_CONTEXT( count << " items" )
+        {
+            for( int amount : { 250000, -250000 } )
+            {
+                SHAPE_POLY_SET serial( plane );
+                SHAPE_POLY_SET aboveThreshold( plane );
+
+                SHAPE_POLY_SET::SetParallelThreshold( 0 );
+                serial.Inflate( amount, 16, SHAPE_POLY_SET::ROUND_ALL_CORNERS );
+
+                SHAPE_POLY_SET::SetParallelThreshold( 1 );
+                aboveThreshold.Inflate( amount, 16, SHAPE_POLY_SET::ROUND_ALL_CORNERS );
+
+                BOOST_CHECK( sameVertices( serial, aboveThreshold ) );
+            }
+        }
+    }
+
+    SHAPE_POLY_SET::SetParallelThreshold( saved );
+}
+
+
+BOOST_AUTO_TEST_CASE( Fracture )
+{
+    std::mt19937   rng( 3 );
+    SHAPE_POLY_SET plane, items;
+
+    makeCopper( rng, 1000, plane, items );
+    plane.BooleanSubtract( items, SHAPE_POLY_SET::PM_FAST );
+
+    checkParallel( plane, 1,
+                   [&]( SHAPE_POLY_SET& aSet )
+                   {
+                       aSet.Fracture( SHAPE_POLY_SET::PM_FAST );
+                   } );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,589 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file geometry_benchmark.cpp
+ *
+ * Times the main kimath geometry operations on the tracks and filled zones of a board:
+ * SEG tests, SHAPE_LINE_CHAIN queries, SHAPE_POLY_SET booleans, Inflate(), Fracture(),
+ * triangulation and collisions.  The board file is only scanned for its segments and
+ * filled polygons, so the tool does not need pcbnew.
+ *
+ * Each case is run several times and the best and median times are reported, along with
+ * a checksum of its result (a count of collisions, vertices, triangles...) which must not
+ * change from one commit to the next unless the geometry code is meant to give different
+ * results.  With --json the report is a single JSON object, for scripts tracking the
+ * timings of successive commits.
+ */
+
+#include <qa_utils/utility_registry.h>
+
+#include <convert_basic_shapes_to_polygon.h>
+#include <geometry/seg.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_segment.h>
+#include <math/util.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+#ifndef QA_DATA_LOCATION
+    #define QA_DATA_LOCATION "???"
+#endif
+
+
+/// The shapes of a board used by the benchmarks
+struct BOARD_SHAPES
+{
+    std::vector<SHAPE_SEGMENT>    m_tracks;
+    std::vector<SHAPE_LINE_CHAIN> m_zones;     ///< the outlines of the filled zone polygons
+};
+
+
+/// A timed operation and the untimed preparation of its input
+struct BENCHMARK_CASE
+{
+    std::string                  m_name;
+    std::function<void()>        m_prepare;
+    std::function<long long()>   m_run;         ///< returns the checksum
+};
+
+
+struct BENCHMARK_RESULT
+{
+    std::string m_name;
+    double      m_best;     ///< ms
+    double      m_median;   ///< ms
+    long long   m_checksum;
+};
+
+
+static int toIU( const char* aMillimeters )
+{
+    return KiROUND( strtod( aMillimeters, nullptr ) * 1e6 );
+}
+
+
+/**
+ * Returns the position of the parenthesis closing the list opened at aOpen.
+ */
+static size_t closingParen( const std::string& aText, size_t aOpen )
+{
+    int depth = 0;
+
+    for( size_t i = aOpen; i < aText.size(); i++ )
+    {
+        if( aText[i] == '(' )
+            depth++;
+        else if( aText[i] == ')' && --depth == 0 )
+            return i;
+    }
+
+    return aText.size();
+}
+
+
+/**
+ * Reads the coordinates following aToken (e.g. "(start") in aText[aBegin, aEnd).
+ */
+static bool readPoint( const std::string& aText, size_t aBegin, size_t aEnd, const char* aToken,
+                       VECTOR2I& aPoint )
+{
+    size_t pos = aText.find( aToken, aBegin );
+
+    if( pos >= aEnd )
+        return false;
+
+    const char* p = aText.c_str() + pos + strlen( aToken );
+    char*       next;
+
+    aPoint.x = KiROUND( strtod( p, &next ) * 1e6 );
+    aPoint.y = KiROUND( strtod( next, nullptr ) * 1e6 );
+
+    return true;
+}
+
+
+/**
+ * Collects the track segments and the filled zone polygons of a .kicad_pcb file.
+ */
+static bool loadBoard( const std::string& aFileName, BOARD_SHAPES& aShapes )
+{
+    std::ifstream file( aFileName );
+
+    if( !file )
+        return false;
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    const std::string text = buffer.str();
+
+    for( size_t pos = text.find( "(segment" ); pos != std::string::npos;
+            pos = text.find( "(segment", pos + 1 ) )
+    {
+        size_t   end = closingParen( text, pos );
+        VECTOR2I start, finish;
+        size_t   width = text.find( "(width", pos );
+
+        if( readPoint( text, pos, end, "(start", start )
+                && readPoint( text, pos, end, "(end", finish ) && width < end )
+        {
+            aShapes.m_tracks.emplace_back( SEG( start, finish ),
+                                           toIU( text.c_str() + width + 6 ) );
+        }
+    }
+
+    for( size_t pos = text.find( "(filled_polygon" ); pos != std::string::npos;
+            pos = text.find( "(filled_polygon", pos + 1 ) )
+    {
+        size_t           end = closingParen( text, pos );
+        SHAPE_LINE_CHAIN chain;
+        VECTOR2I         p;
+
+        for( size_t xy = text.find( "(xy", pos ); xy < end; xy = text.find( "(xy", xy + 1 ) )
+        {
+            readPoint( text, xy, end, "(xy", p );
+            chain.Append( p );
+        }
+
+        if( chain.PointCount() >= 3 )
+        {
+            chain.SetClosed( true );
+            aShapes.m_zones.push_back( chain );
+        }
+    }
+
+    return !aShapes.m_tracks.empty() && !aShapes.m_zones.empty();
+}
+
+
+/**
+ * Repeats the shapes aCopies times side by side, to make a larger board.
+ */
+static void replicate( BOARD_SHAPES& aShapes, int aCopies )
+{
+    BOX2I bbox = aShapes.m_zones[0].BBox();
+
+    for( const SHAPE_LINE_CHAIN& zone : aShapes.m_zones )
+        bbox.Merge( zone.BBox() );
+
+    BOARD_SHAPES copies = aShapes;
+
+    for( int i = 1; i < aCopies; i++ )
+    {
+        VECTOR2I offset( i * bbox.GetWidth() * 11 / 10, 0 );
+
+        for( SHAPE_SEGMENT track : copies.m_tracks )
+        {
+            track.Move( offset );
+            aShapes.m_tracks.push_back( track );
+        }
+
+        for( SHAPE_LINE_CHAIN zone : copies.m_zones )
+        {
+            zone.Move( offset );
+            aShapes.m_zones.push_back( zone );
+        }
+    }
+}
+
+
+static std::string jsonEscape( const std::string& aText )
+{
+    std::string escaped;
+
+    for( char c : aText )
+    {
+        if( c == '"' || c == '\\' )
+            escaped += '\\';
+
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+
+static BENCHMARK_RESULT runCase( const BENCHMARK_CASE& aCase, int aRepeat )
+{
+    std::vector<double> times;
+    BENCHMARK_RESULT    result;
+
+    result.m_name = aCase.m_name;
+    result.m_checksum = 0;
+
+    for( int i = 0; i < aRepeat; i++ )
+    {
+        if( aCase.m_prepare )
+            aCase.m_prepare();
+
+        PROF_COUNTER counter;
+        long long    checksum = aCase.m_run();
+
+        counter.Stop();
+        times.push_back( counter.msecs() );
+
+        // Every run has to give the same result
+        if( i > 0 && checksum != result.m_checksum )
+            result.m_checksum = -1;
+        else
+            result.m_checksum = checksum;
+    }
+
+    std::sort( times.begin(), times.end() );
+
+    result.m_best = times.front();
+    result.m_median = times[times.size() / 2];
+
+    return result;
+}
+
+
+int geometry_benchmark_main( int argc, char* argv[] )
+{
+    std::string fileName = std::string( QA_DATA_LOCATION ) + "/complex_hierarchy.kicad_pcb";
+    std::string filter;
+    bool        json = false;
+    int         repeat = 5;
+    int         copies = 1;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        std::string arg = argv[i];
+
+        if( arg == "--json" )
+            json = true;
+        else if( arg.compare( 0, 9, "--repeat=" ) == 0 )
+            repeat = std::max( 1, atoi( arg.c_str() + 9 ) );
+        else if( arg.compare( 0, 9, "--copies=" ) == 0 )
+            copies = std::max( 1, atoi( arg.c_str() + 9 ) );
+        else if( arg.compare( 0, 9, "--filter=" ) == 0 )
+            filter = arg.substr( 9 );
+        else if( arg.size() > 1 && arg[0] == '-' )
+        {
+            printf( "usage: geometry_benchmark [--json] [--repeat=N] [--copies=N] "
+                    "[--filter=NAME] [board.kicad_pcb]\n" );
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+        }
+        else
+            fileName = arg;
+    }
+
+    BOARD_SHAPES shapes;
+
+    if( !loadBoard( fileName, shapes ) )
+    {
+        fprintf( stderr, "no tracks or filled zones found in '%s'\n", fileName.c_str() );
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+    }
+
+    replicate( shapes, copies );
+
+    const int clearance = 200000;
+    const int maxError = 5000;
+
+    // The inputs shared by the cases
+    std::vector<SEG> segs;
+    SHAPE_POLY_SET   zones;
+    SHAPE_POLY_SET   trackOutlines;
+
+    for( const SHAPE_SEGMENT& track : shapes.m_tracks )
+    {
+        segs.push_back( track.GetSeg() );
+        TransformOvalToPolygon( trackOutlines, (wxPoint) track.GetSeg().A,
+                                (wxPoint) track.GetSeg().B, track.GetWidth(), maxError,
+                                ERROR_OUTSIDE );
+    }
+
+    for( const SHAPE_LINE_CHAIN& zone : shapes.m_zones )
+        zones.AddOutline( zone );
+
+    BOX2I bbox = zones.BBox();
+
+    for( const SEG& seg : segs )
+        bbox.Merge( BOX2I( seg.A, seg.B - seg.A ).Normalize() );
+
+    // A grid of query points over the board
+    std::vector<VECTOR2I> points;
+
+    for( int i = 0; i < 100; i++ )
+    {
+        for( int j = 0; j < 100; j++ )
+        {
+            points.emplace_back( bbox.GetX() + bbox.GetWidth() / 100 * i,
+                                 bbox.GetY() + bbox.GetHeight() / 100 * j );
+        }
+    }
+
+    SHAPE_POLY_SET work;
+    SHAPE_POLY_SET withHoles;
+
+    withHoles.BooleanSubtract( zones, trackOutlines, SHAPE_POLY_SET::PM_FAST );
+
+    std::vector<BENCHMARK_CASE> cases = {
+        {
+            "seg_collide", nullptr,
+            [&]()
+            {
+                long long hits = 0;
+
+                for( const SEG& a : segs )
+                {
+                    for( const SEG& b : segs )
+                        hits += a.Collide( b, clearance );
+                }
+
+                return hits;
+            }
+        },
+        {
+            "seg_intersect", nullptr,
+            [&]()
+            {
+                long long hits = 0;
+
+                for( const SEG& a : segs )
+                {
+                    for( const SEG& b : segs )
+                        hits += (bool) a.Intersect( b );
+                }
+
+                return hits;
+            }
+        },
+        {
+            "line_chain_point_inside", nullptr,
+            [&]()
+            {
+                long long inside = 0;
+
+                for( const SHAPE_LINE_CHAIN& zone : shapes.m_zones )
+                {
+                    for( const VECTOR2I& p : points )
+                        inside += zone.PointInside( p );
+                }
+
+                return inside;
+            }
+        },
+        {
+            "line_chain_collide_seg", nullptr,
+            [&]()
+            {
+                long long hits = 0;
+
+                for( const SHAPE_LINE_CHAIN& zone : shapes.m_zones )
+                {
+                    for( const SEG& seg : segs )
+                        hits += zone.Collide( seg, clearance );
+                }
+
+                return hits;
+            }
+        },
+        {
+            "poly_union",
+            [&]()
+            {
+                work = trackOutlines;
+            },
+            [&]()
+            {
+                work.Simplify( SHAPE_POLY_SET::PM_FAST );
+                return (long long) work.TotalVertices();
+            }
+        },
+        {
+            "poly_subtract", nullptr,
+            [&]()
+            {
+                work.BooleanSubtract( zones, trackOutlines, SHAPE_POLY_SET::PM_FAST );
+                return (long long) work.TotalVertices();
+            }
+        },
+        {
+            "poly_inflate",
+            [&]()
+            {
+                work = withHoles;
+            },
+            [&]()
+            {
+                work.Inflate( clearance, 16 );
+                return (long long) work.TotalVertices();
+            }
+        },
+        {
+            "poly_fracture",
+            [&]()
+            {
+                work = withHoles;
+            },
+            [&]()
+            {
+                work.Fracture( SHAPE_POLY_SET::PM_FAST );
+                return (long long) work.TotalVertices();
+            }
+        },
+        {
+            "poly_triangulate",
+            [&]()
+            {
+                work = withHoles;
+                work.Fracture( SHAPE_POLY_SET::PM_FAST );
+            },
+            [&]()
+            {
+                long long triangles = 0;
+
+                work.CacheTriangulation( false );
+
+                for( unsigned i = 0; i < work.TriangulatedPolyCount(); i++ )
+                    triangles += work.TriangulatedPolygon( i )->GetTriangleCount();
+
+                return triangles;
+            }
+        },
+        {
+            "poly_collide", nullptr,
+            [&]()
+            {
+                long long hits = 0;
+
+                // The zones keep their own clearance to the tracks, larger than ours
+                for( const SEG& seg : segs )
+                    hits += withHoles.Collide( seg, 4 * clearance );
+
+                for( const VECTOR2I& p : points )
+                    hits += withHoles.Collide( p, clearance );
+
+                return hits;
+            }
+        },
+        {
+            "poly_distance_point", nullptr,
+            [&]()
+            {
+                long long sum = 0;
+
+                for( const VECTOR2I& p : points )
+                    sum += KiROUND( sqrt( withHoles.SquaredDistance( p ) ) ) / 1000;
+
+                return sum;
+            }
+        },
+        {
+            "shape_collide", nullptr,
+            [&]()
+            {
+                long long hits = 0;
+
+                for( const SHAPE_SEGMENT& track : shapes.m_tracks )
+                {
+                    for( const SHAPE_LINE_CHAIN& zone : shapes.m_zones )
+                        hits += track.Collide( &zone, clearance );
+
+                    for( const SHAPE_SEGMENT& other : shapes.m_tracks )
+                        hits += track.Collide( &other, clearance );
+                }
+
+                return hits;
+            }
+        },
+    };
+
+    std::vector<BENCHMARK_RESULT> results;
+
+    if( !json )
+    {
+        printf( "%s: %d tracks, %d zone vertices\n", fileName.c_str(), (int) segs.size(),
+                zones.TotalVertices() );
+        printf( "  %-24s %12s %12s %14s\n", "case", "best ms", "median ms", "checksum" );
+    }
+
+    for( const BENCHMARK_CASE& benchmarkCase : cases )
+    {
+        if( !filter.empty() && benchmarkCase.m_name.find( filter ) == std::string::npos )
+            continue;
+
+        results.push_back( runCase( benchmarkCase, repeat ) );
+
+        const BENCHMARK_RESULT& r = results.back();
+
+        if( !json )
+        {
+            printf( "  %-24s %12.3f %12.3f %14lld\n", r.m_name.c_str(), r.m_best, r.m_median,
+                    r.m_checksum );
+        }
+    }
+
+    if( json )
+    {
+        printf( "{\n  \"board\": \"%s\",\n  \"copies\": %d,\n  \"repeat\": %d,\n",
+                jsonEscape( fileName ).c_str(), copies, repeat );
+        printf( "  \"tracks\": %d,\n  \"zone_vertices\": %d,\n  \"results\": [\n",
+                (int) segs.size(), zones.TotalVertices() );
+
+        for( size_t i = 0; i < results.size(); i++ )
+        {
+            const BENCHMARK_RESULT& r = results[i];
+
+            printf( "    { \"name\": \"%s\", \"best_ms\": %.6f, \"median_ms\": %.6f, "
+                    "\"checksum\": %lld }%s\n",
+                    r.m_name.c_str(), r.m_best, r.m_median, r.m_checksum,
+                    i + 1 < results.size() ? "," : "" );
+        }
+
+        printf( "  ]\n}\n" );
+    }
+
+    for( const BENCHMARK_RESULT& r : results )
+    {
+        if( r.m_checksum < 0 )
+        {
+            fprintf( stderr, "%s gave different results from one run to the next\n",
+                     r.m_name.c_str() );
+            return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+        }
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "geometry_benchmark",
+        "Benchmark the kimath geometry operations on the shapes of a board",
+        geometry_benchmark_main,
+} );
@@ -0,0 +1,267 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file seg_batch_benchmark.cpp
+ *
+ * Compares testing every segment of a polyline with SEG against filtering the segments
+ * with the batched kernels of seg_batch.h first, for each instruction set supported by
+ * the CPU.  The polyline is a random walk, similar to a zone outline or a long track.
+ */
+
+#include <qa_utils/utility_registry.h>
+
+#include <geometry/seg.h>
+#include <geometry/seg_batch.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+
+struct QUERY
+{
+    VECTOR2I m_p;
+    SEG      m_seg;
+};
+
+
+static int exactPointHits( const std::vector<VECTOR2I>& aPts, const VECTOR2I& aP, int aDist )
+{
+    SEG::ecoord distSq = SEG::Square( aDist );
+    int         hits = 0;
+
+    for( size_t i = 0; i + 1 < aPts.size(); i++ )
+    {
+        SEG::ecoord d = SEG( aPts[i], aPts[i + 1] ).SquaredDistance( aP );
+
+        if( d == 0 || d < distSq )
+            hits++;
+    }
+
+    return hits;
+}
+
+
+static int exactSegHits( const std::vector<VECTOR2I>& aPts, const SEG& aSeg, int aDist )
+{
+    SEG::ecoord distSq = SEG::Square( aDist );
+    int         hits = 0;
+
+    for( size_t i = 0; i + 1 < aPts.size(); i++ )
+    {
+        SEG::ecoord d = SEG( aPts[i], aPts[i + 1] ).SquaredDistance( aSeg );
+
+        if( d == 0 || d < distSq )
+            hits++;
+    }
+
+    return hits;
+}
+
+
+static int batchedPointHits( const std::vector<VECTOR2I>& aPts, const VECTOR2I& aP, int aDist,
+                             SEG_BATCH_ISA aIsa )
+{
+    SEG::ecoord distSq = SEG::Square( aDist );
+    int         n = aPts.size();
+    int         hits = 0;
+
+    for( int i = FindSegmentNear( aPts.data(), n, 0, aP, aDist, aIsa ); i < n - 1;
+            i = FindSegmentNear( aPts.data(), n, i + 1, aP, aDist, aIsa ) )
+    {
+        SEG::ecoord d = SEG( aPts[i], aPts[i + 1] ).SquaredDistance( aP );
+
+        if( d == 0 || d < distSq )
+            hits++;
+    }
+
+    return hits;
+}
+
+
+static int batchedSegHits( const std::vector<VECTOR2I>& aPts, const SEG& aSeg, int aDist,
+                           SEG_BATCH_ISA aIsa )
+{
+    SEG::ecoord distSq = SEG::Square( aDist );
+    int         n = aPts.size();
+    int         hits = 0;
+
+    for( int i = FindSegmentNear( aPts.data(), n, 0, aSeg, aDist, aIsa ); i < n - 1;
+            i = FindSegmentNear( aPts.data(), n, i + 1, aSeg, aDist, aIsa ) )
+    {
+        SEG::ecoord d = SEG( aPts[i], aPts[i + 1] ).SquaredDistance( aSeg );
+
+        if( d == 0 || d < distSq )
+            hits++;
+    }
+
+    return hits;
+}
+
+
+/**
+ * Runs aFunc for all the queries and prints the time per query.
+ * @return the total number of colliding segments found
+ */
+template <typename FUNC>
+static long long run( const std::string& aName, const std::vector<QUERY>& aQueries,
+                      double aReference, double& aTime, FUNC aFunc )
+{
+    long long    hits = 0;
+    PROF_COUNTER cnt( aName );
+
+    for( const QUERY& q : aQueries )
+        hits += aFunc( q );
+
+    cnt.Stop();
+
+    aTime = cnt.msecs() * 1e6 / aQueries.size();
+
+    printf( "  %-16s %10.1f ns/query  %8.2fx  (%lld hits)\n", aName.c_str(), aTime,
+            aReference > 0.0 ? aReference / aTime : 1.0, hits );
+
+    return hits;
+}
+
+
+static const char* isaName( SEG_BATCH_ISA aIsa )
+{
+    switch( aIsa )
+    {
+    case SEG_BATCH_ISA::SCALAR: return "batched scalar";
+    case SEG_BATCH_ISA::SSE2:   return "batched SSE2";
+    case SEG_BATCH_ISA::AVX2:   return "batched AVX2";
+    }
+
+    return "";
+}
+
+
+int seg_batch_benchmark_main( int argc, char* argv[] )
+{
+    int pointCount = 1000;
+    int queryCount = 20000;
+
+    if( argc > 1 )
+        pointCount = std::max( 2, atoi( argv[1] ) );
+
+    if( argc > 2 )
+        queryCount = std::max( 1, atoi( argv[2] ) );
+
+    // A random walk of 0.5 mm steps, queried around its vertices with a 0.2 mm clearance
+    const int step = 500000;
+    const int clearance = 200000;
+
+    std::mt19937                       rng( 42 );
+    std::uniform_int_distribution<int> stepDist( -step, step );
+    std::vector<VECTOR2I>              pts;
+    VECTOR2I                           p( 0, 0 );
+
+    for( int i = 0; i < pointCount; i++ )
+    {
+        pts.push_back( p );
+        p += VECTOR2I( stepDist( rng ), stepDist( rng ) );
+    }
+
+    std::uniform_int_distribution<int> vertexDist( 0, pointCount - 1 );
+    std::uniform_int_distribution<int> offsetDist( -2 * step, 2 * step );
+    std::vector<QUERY>                 queries;
+
+    for( int i = 0; i < queryCount; i++ )
+    {
+        QUERY    q;
+        VECTOR2I base = pts[vertexDist( rng )];
+
+        q.m_p = base + VECTOR2I( offsetDist( rng ), offsetDist( rng ) );
+        q.m_seg = SEG( q.m_p, q.m_p + VECTOR2I( stepDist( rng ), stepDist( rng ) ) );
+        queries.push_back( q );
+    }
+
+    std::vector<SEG_BATCH_ISA> isas;
+
+    for( SEG_BATCH_ISA isa : { SEG_BATCH_ISA::SCALAR, SEG_BATCH_ISA::SSE2, SEG_BATCH_ISA::AVX2 } )
+    {
+        if( SegBatchIsaSupported( isa ) )
+            isas.push_back( isa );
+    }
+
+    printf( "%d segments, %d queries\n", pointCount - 1, queryCount );
+
+    bool   ok = true;
+    double reference = 0.0;
+    double time = 0.0;
+
+    printf( "point/segment:\n" );
+
+    long long expected = run( "exact", queries, 0.0, reference,
+                              [&]( const QUERY& q )
+                              {
+                                  return exactPointHits( pts, q.m_p, clearance );
+                              } );
+
+    for( SEG_BATCH_ISA isa : isas )
+    {
+        ok &= expected == run( isaName( isa ), queries, reference, time,
+                               [&]( const QUERY& q )
+                               {
+                                   return batchedPointHits( pts, q.m_p, clearance, isa );
+                               } );
+    }
+
+    printf( "segment/segment:\n" );
+
+    expected = run( "exact", queries, 0.0, reference,
+                    [&]( const QUERY& q )
+                    {
+                        return exactSegHits( pts, q.m_seg, clearance );
+                    } );
+
+    for( SEG_BATCH_ISA isa : isas )
+    {
+        ok &= expected == run( isaName( isa ), queries, reference, time,
+                               [&]( const QUERY& q )
+                               {
+                                   return batchedSegHits( pts, q.m_seg, clearance, isa );
+                               } );
+    }
+
+    if( !ok )
+    {
+        printf( "the batched kernels missed some collisions\n" );
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "seg_batch_benchmark",
+        "Benchmark the batched segment distance kernels against the exact SEG tests",
+        seg_batch_benchmark_main,
+} );
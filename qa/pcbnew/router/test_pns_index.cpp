@@ -0,0 +1,249 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_index.cpp
+ *
+ * Checks the packed R-tree of the router spatial index against a brute force search, through
+ * random sequences of additions, removals and packing.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <router/pns_index.h>
+#include <router/pns_segment.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+
+
+/**
+ * The items of a LAYER_INDEX and a brute force model of it.
+ */
+class LAYER_INDEX_FIXTURE
+{
+public:
+    LAYER_INDEX_FIXTURE() :
+            m_rng( 1 )
+    {
+    }
+
+    BOX2I randomBox( int aMaxSize )
+    {
+        std::uniform_int_distribution<int> pos( -1000000, 1000000 );
+        std::uniform_int_distribution<int> size( -aMaxSize, aMaxSize );
+
+        return BOX2I( VECTOR2I( pos( m_rng ), pos( m_rng ) ),
+                      VECTOR2I( size( m_rng ), size( m_rng ) ) );
+    }
+
+    void add( const BOX2I& aBox )
+    {
+        m_items.push_back( std::make_unique<PNS::SEGMENT>() );
+
+        PNS::ITEM* item = m_items.back().get();
+
+        m_index.Add( item, aBox );
+        m_boxes[item] = aBox;
+    }
+
+    void remove( PNS::ITEM* aItem )
+    {
+        m_index.Remove( aItem );
+        m_boxes.erase( aItem );
+    }
+
+    void removeRandom()
+    {
+        if( m_boxes.empty() )
+            return;
+
+        std::uniform_int_distribution<size_t> pick( 0, m_boxes.size() - 1 );
+
+        remove( std::next( m_boxes.begin(), pick( m_rng ) )->first );
+    }
+
+    /**
+     * Check that the index finds the same items as a brute force search of the model.
+     */
+    void checkQuery( const BOX2I& aBox )
+    {
+        std::vector<PNS::ITEM*> found;
+        std::vector<PNS::ITEM*> expected;
+
+        auto visitor =
+                [&]( PNS::ITEM* aItem ) -> bool
+                {
+                    found.push_back( aItem );
+                    return true;
+                };
+
+        int count = m_index.Query( aBox, visitor );
+
+        BOX2I query = aBox;
+        query.Normalize();
+
+        for( const std::pair<PNS::ITEM* const, BOX2I>& entry : m_boxes )
+        {
+            BOX2I box = entry.second;
+            box.Normalize();
+
+            if( box.GetX() <= query.GetRight() && query.GetX() <= box.GetRight()
+                    && box.GetY() <= query.GetBottom() && query.GetY() <= box.GetBottom() )
+            {
+                expected.push_back( entry.first );
+            }
+        }
+
+        BOOST_CHECK_EQUAL( count, (int) found.size() );
+
+        std::sort( found.begin(), found.end() );
+        std::sort( expected.begin(), expected.end() );
+
+        BOOST_CHECK( found == expected );
+    }
+
+    /**
+     * Check queries of random boxes, and one covering all the items.
+     */
+    void checkQueries( int aCount )
+    {
+        for( int i = 0; i < aCount; i++ )
+            checkQuery( randomBox( 200000 ) );
+
+        checkQuery( BOX2I( VECTOR2I( -2000000, -2000000 ), VECTOR2I( 4000000, 4000000 ) ) );
+    }
+
+    std::mt19937                               m_rng;
+    PNS::LAYER_INDEX                           m_index;
+    std::vector<std::unique_ptr<PNS::SEGMENT>> m_items;
+    std::map<PNS::ITEM*, BOX2I>                m_boxes;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsLayerIndex, LAYER_INDEX_FIXTURE )
+
+
+/**
+ * Random mixes of additions, removals and packing, so that items are found in the packed
+ * tree, in the overlay and after both kinds of repacking.
+ */
+BOOST_AUTO_TEST_CASE( RandomOperations )
+{
+    std::uniform_int_distribution<int> operation( 0, 99 );
+
+    for( int step = 0; step < 20000; step++ )
+    {
+        int op = operation( m_rng );
+
+        if( op < 55 )
+            add( randomBox( op < 5 ? 1000000 : 50000 ) );
+        else if( op < 90 )
+            removeRandom();
+        else if( op < 91 )
+            m_index.Pack();
+        else
+            checkQuery( randomBox( 200000 ) );
+    }
+
+    checkQueries( 100 );
+
+    m_index.Pack();
+    checkQueries( 100 );
+}
+
+
+/**
+ * Removing every packed item empties the tree, which must then accept new items.
+ */
+BOOST_AUTO_TEST_CASE( RemoveAllPacked )
+{
+    for( int i = 0; i < 1000; i++ )
+        add( randomBox( 50000 ) );
+
+    m_index.Pack();
+
+    // Removed in creation order, which is not the order of the packed tree
+    for( const std::unique_ptr<PNS::SEGMENT>& item : m_items )
+    {
+        remove( item.get() );
+
+        if( m_boxes.size() % 100 == 0 )
+            checkQueries( 10 );
+    }
+
+    checkQueries( 10 );
+
+    for( int i = 0; i < 10; i++ )
+        add( randomBox( 50000 ) );
+
+    checkQueries( 10 );
+
+    // Fewer items than the size of the overlay, so that they are all packed by Pack()
+    m_index.Pack();
+
+    for( int i = 0; i < 10; i++ )
+        remove( m_items[m_items.size() - 1 - i].get() );
+
+    checkQueries( 10 );
+
+    // Removing an item twice, or an item which was never added, must not change the index
+    remove( m_items.front().get() );
+    checkQueries( 10 );
+}
+
+
+/**
+ * The query stops at the first item for which the visitor returns false.
+ */
+BOOST_AUTO_TEST_CASE( StopVisiting )
+{
+    for( int i = 0; i < 500; i++ )
+        add( BOX2I( VECTOR2I( i * 100, 0 ), VECTOR2I( 50, 50 ) ) );
+
+    m_index.Pack();
+
+    for( int i = 0; i < 10; i++ )
+        add( BOX2I( VECTOR2I( i * 100, 1000 ), VECTOR2I( 50, 50 ) ) );
+
+    for( int stopAt : { 1, 5, 200, 505 } )
+    {
+        int  calls = 0;
+        auto visitor =
+                [&]( PNS::ITEM* aItem ) -> bool
+                {
+                    return ++calls < stopAt;
+                };
+
+        int count = m_index.Query( BOX2I( VECTOR2I( -100, -100 ), VECTOR2I( 100000, 2000 ) ),
+                                   visitor );
+
+        BOOST_CHECK_EQUAL( calls, stopAt );
+        BOOST_CHECK_EQUAL( count, stopAt - 1 );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,200 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_meander_batch_tuner.cpp
+ *
+ * Checks that the batch tuner brings each net to its target length: the length rule of the
+ * net if it has one, the length of the longest net of the group otherwise.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <drc/drc_engine.h>
+#include <property_mgr.h>
+#include <track.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_meander_batch_tuner.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_segment.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <cstdlib>
+#include <set>
+
+
+/**
+ * The nets of the test board, each routed as a single straight track.
+ */
+struct TUNED_NET
+{
+    int           m_code;
+    const char*   m_name;
+    int           m_routedLength;
+    long long int m_targetLength;
+    int           m_tolerance;
+};
+
+
+static const int TOLERANCE = 100000;
+
+
+// The longest net sets the target of the nets without a length rule.  RULE has a rule with
+// a 1 mm tolerance, shorter than the longest net.
+static const std::vector<TUNED_NET> nets = {
+    { 1, "TUNE_A", 40000000, 50000000, TOLERANCE },
+    { 2, "TUNE_B", 30000000, 50000000, TOLERANCE },
+    { 3, "LONGEST", 50000000, 50000000, TOLERANCE },
+    { 4, "RULE", 20000000, 35000000, 1000000 },
+};
+
+
+static const char* RULES =
+        "(version 20200610)\n"
+        "(rule \"length\"\n"
+        "    (condition \"A.NetName == 'RULE'\")\n"
+        "    (constraint length (min 34mm) (opt 35mm) (max 36mm)))\n";
+
+
+static std::unique_ptr<BOARD> createBoard()
+{
+    std::unique_ptr<BOARD> board = std::make_unique<BOARD>();
+
+    for( size_t i = 0; i < nets.size(); i++ )
+    {
+        board->Add( new NETINFO_ITEM( board.get(), nets[i].m_name, nets[i].m_code ) );
+
+        TRACK* track = new TRACK( board.get() );
+
+        track->SetStart( wxPoint( 0, i * 10000000 ) );
+        track->SetEnd( wxPoint( nets[i].m_routedLength, i * 10000000 ) );
+        track->SetWidth( 200000 );
+        track->SetLayer( F_Cu );
+        track->SetNetCode( nets[i].m_code );
+        board->Add( track );
+    }
+
+    return board;
+}
+
+
+/**
+ * @return the length of the routed line of aNet in aNode.
+ */
+static long long int lineLength( PNS::NODE* aNode, int aNet )
+{
+    std::set<PNS::ITEM*> segments;
+
+    aNode->AllItemsInNet( aNet, segments, PNS::ITEM::SEGMENT_T );
+
+    BOOST_REQUIRE( !segments.empty() );
+
+    PNS::LINE line = aNode->AssembleLine( static_cast<PNS::SEGMENT*>( *segments.begin() ) );
+
+    // The line must be the whole net, not a piece of it
+    BOOST_CHECK_EQUAL( line.LinkCount(), (int) segments.size() );
+
+    return line.CLine().Length();
+}
+
+
+BOOST_AUTO_TEST_SUITE( PnsMeanderBatchTuner )
+
+
+BOOST_AUTO_TEST_CASE( TuneNets )
+{
+    PROPERTY_MANAGER::Instance().Rebuild();
+
+    std::unique_ptr<BOARD> board = createBoard();
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+    wxFileName             rulesFile( wxFileName::CreateTempFileName( "pns_batch_tuner" ) );
+
+    {
+        wxFFile file( rulesFile.GetFullPath(), "w" );
+
+        BOOST_REQUIRE( file.IsOpened() && file.Write( RULES ) );
+    }
+
+    bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+    bds.m_DRCEngine->InitEngine( rulesFile );
+
+    wxRemoveFile( rulesFile.GetFullPath() );
+
+    PNS_KICAD_IFACE_BASE  iface;
+    PNS::ROUTER           router;
+    PNS::ROUTING_SETTINGS settings( nullptr, "" );
+
+    iface.SetBoard( board.get() );
+    router.SetInterface( &iface );
+    router.LoadSettings( &settings );
+    router.SyncWorld();
+
+    PNS::MEANDER_SETTINGS meanderSettings;
+
+    meanderSettings.m_lengthTolerance = TOLERANCE;
+
+    PNS::MEANDER_BATCH_TUNER tuner( &router );
+    std::vector<int>         codes;
+
+    for( const TUNED_NET& net : nets )
+        codes.push_back( net.m_code );
+
+    tuner.SetMeanderSettings( meanderSettings );
+
+    PNS::NODE* tuned = tuner.Tune( codes );
+
+    BOOST_REQUIRE( tuned );
+    BOOST_REQUIRE_EQUAL( tuner.Results().size(), nets.size() );
+
+    for( size_t i = 0; i < nets.size(); i++ )
+    {
+        const TUNED_NET&                            net = nets[i];
+        const PNS::MEANDER_BATCH_TUNER::NET_RESULT& result = tuner.Results()[i];
+
+        BOOST_TEST_CONTEXT( "Net " << net.m_name )
+        {
+            BOOST_CHECK_EQUAL( result.m_net, net.m_code );
+            BOOST_CHECK( result.m_tuned );
+            BOOST_CHECK_EQUAL( result.m_targetLength, net.m_targetLength );
+            BOOST_CHECK_EQUAL( result.m_status, PNS::MEANDER_PLACER_BASE::TUNED );
+            BOOST_CHECK_LE( std::abs( result.m_length - net.m_targetLength ), net.m_tolerance );
+
+            // The returned branch holds the tuned line
+            long long int length = lineLength( tuned, net.m_code );
+
+            BOOST_CHECK_LE( std::abs( length - net.m_targetLength ), net.m_tolerance );
+        }
+    }
+
+    router.GetWorld()->KillChildren();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
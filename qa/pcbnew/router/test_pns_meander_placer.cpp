@@ -0,0 +1,262 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_meander_placer.cpp
+ *
+ * Checks that the meanders fitted for a cursor position and reused for the next one give the
+ * same tuned line as fitting them again from scratch.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <board.h>
+#include <track.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_meander_placer.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_segment.h>
+
+#include <atomic>
+#include <set>
+
+
+static const int LINE_NET = 1;
+
+
+/**
+ * A single track with corners, to be tuned from its first segment.
+ */
+static std::unique_ptr<BOARD> createBoard()
+{
+    std::unique_ptr<BOARD> board = std::make_unique<BOARD>();
+
+    board->Add( new NETINFO_ITEM( board.get(), "LINE", LINE_NET ) );
+
+    const std::vector<wxPoint> points = { { 0, 0 },
+                                          { 20000000, 0 },
+                                          { 30000000, 10000000 },
+                                          { 50000000, 10000000 },
+                                          { 60000000, 0 },
+                                          { 80000000, 0 } };
+
+    for( size_t i = 1; i < points.size(); i++ )
+    {
+        TRACK* track = new TRACK( board.get() );
+
+        track->SetStart( points[i - 1] );
+        track->SetEnd( points[i] );
+        track->SetWidth( 200000 );
+        track->SetLayer( F_Cu );
+        track->SetNetCode( LINE_NET );
+        board->Add( track );
+    }
+
+    return board;
+}
+
+
+/**
+ * Counts the meanders checked by the placer, so that a test can tell how many were fitted
+ * rather than taken from the fit cache.
+ */
+class TEST_MEANDER_PLACER : public PNS::MEANDER_PLACER
+{
+public:
+    TEST_MEANDER_PLACER( PNS::ROUTER* aRouter ) :
+            PNS::MEANDER_PLACER( aRouter ),
+            m_checkCount( 0 )
+    {
+    }
+
+    bool CheckFit( PNS::MEANDER_SHAPE* aShape ) override
+    {
+        m_checkCount++;
+        return PNS::MEANDER_PLACER::CheckFit( aShape );
+    }
+
+    long long int LastLength() const { return m_lastLength; }
+
+    void FinishTuning() { finishTuning(); }
+
+    int m_checkCount;
+};
+
+
+class MEANDER_PLACER_FIXTURE
+{
+public:
+    MEANDER_PLACER_FIXTURE() :
+            m_board( createBoard() ),
+            m_settings( nullptr, "" )
+    {
+        m_iface.SetBoard( m_board.get() );
+        m_router.SetInterface( &m_iface );
+        m_router.LoadSettings( &m_settings );
+        m_router.SyncWorld();
+
+        m_meanderSettings.m_targetLength = 150000000;
+    }
+
+    /**
+     * Start tuning the line from the first point of its first segment.
+     */
+    void start( TEST_MEANDER_PLACER& aPlacer )
+    {
+        std::set<PNS::ITEM*> segments;
+        PNS::ITEM*           first = nullptr;
+
+        m_router.GetWorld()->AllItemsInNet( LINE_NET, segments, PNS::ITEM::SEGMENT_T );
+
+        for( PNS::ITEM* item : segments )
+        {
+            if( static_cast<PNS::SEGMENT*>( item )->Seg().Contains( VECTOR2I( 1000000, 0 ) ) )
+                first = item;
+        }
+
+        BOOST_REQUIRE( first );
+        BOOST_REQUIRE( aPlacer.Start( VECTOR2I( 0, 0 ), first ) );
+
+        aPlacer.UpdateSettings( m_meanderSettings );
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    PNS_KICAD_IFACE_BASE   m_iface;
+    PNS::ROUTER            m_router;
+    PNS::ROUTING_SETTINGS  m_settings;
+    PNS::MEANDER_SETTINGS  m_meanderSettings;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsMeanderPlacer, MEANDER_PLACER_FIXTURE )
+
+
+/**
+ * The cursor moves along the line, changing the end of the tuned part.  After each move, the
+ * placer fitting from its cache must give the same line as a new placer.
+ */
+BOOST_AUTO_TEST_CASE( FitCache )
+{
+    const std::vector<VECTOR2I> cursor = { { 70000000, 0 },
+                                           { 76000000, 0 },
+                                           { 64000000, 0 },
+                                           { 80000000, 0 },
+                                           { 40000000, 10000000 },
+                                           { 78000000, 0 } };
+
+    TEST_MEANDER_PLACER warm( &m_router );
+
+    start( warm );
+
+    int reusedMoves = 0;
+
+    for( size_t i = 0; i < cursor.size(); i++ )
+    {
+        TEST_MEANDER_PLACER cold( &m_router );
+
+        start( cold );
+
+        warm.m_checkCount = 0;
+        warm.Move( cursor[i], nullptr );
+        cold.Move( cursor[i], nullptr );
+
+        BOOST_TEST_CONTEXT( "Cursor " << cursor[i] )
+        {
+            // Trace() returns a copy, which must outlive the references to its line
+            const PNS::LINE         warmTrace = warm.Trace();
+            const PNS::LINE         coldTrace = cold.Trace();
+            const SHAPE_LINE_CHAIN& warmLine = warmTrace.CLine();
+            const SHAPE_LINE_CHAIN& coldLine = coldTrace.CLine();
+
+            BOOST_CHECK( warmLine.CPoints() == coldLine.CPoints() );
+            BOOST_CHECK_EQUAL( warmLine.Length(), coldLine.Length() );
+            BOOST_CHECK_EQUAL( warm.LastLength(), cold.LastLength() );
+            BOOST_CHECK_EQUAL( warm.TuningStatus(), cold.TuningStatus() );
+
+            // The meanders of the segments before the cursor are not fitted again
+            BOOST_CHECK_LE( warm.m_checkCount, cold.m_checkCount );
+        }
+
+        if( warm.m_checkCount < cold.m_checkCount )
+            reusedMoves++;
+
+        cold.AbortPlacement();
+    }
+
+    // Every move but the first one keeps the start of the tuned part
+    BOOST_CHECK_EQUAL( reusedMoves, (int) cursor.size() - 1 );
+
+    // The same position again is entirely taken from the cache
+    warm.m_checkCount = 0;
+    warm.Move( cursor.back(), nullptr );
+    BOOST_CHECK_EQUAL( warm.m_checkCount, 0 );
+
+    warm.AbortPlacement();
+}
+
+
+/**
+ * With a tuning notifier, the meanders are fitted on the background worker.  Once the worker
+ * has caught up with the last cursor position, the line is the same as fitted synchronously.
+ */
+BOOST_AUTO_TEST_CASE( Background )
+{
+    const std::vector<VECTOR2I> cursor = { { 70000000, 0 },
+                                           { 64000000, 0 },
+                                           { 40000000, 10000000 },
+                                           { 78000000, 0 } };
+
+    std::atomic<int>    notifications( 0 );
+    TEST_MEANDER_PLACER background( &m_router );
+
+    start( background );
+    background.SetTuningNotifier( [&]() { notifications++; } );
+
+    for( const VECTOR2I& p : cursor )
+        background.Move( p, nullptr );
+
+    background.FinishTuning();
+
+    BOOST_CHECK_GE( notifications.load(), 1 );
+
+    TEST_MEANDER_PLACER cold( &m_router );
+
+    start( cold );
+    cold.Move( cursor.back(), nullptr );
+
+    const PNS::LINE backgroundTrace = background.Trace();
+    const PNS::LINE coldTrace = cold.Trace();
+
+    BOOST_CHECK( backgroundTrace.CLine().CPoints() == coldTrace.CLine().CPoints() );
+    BOOST_CHECK_EQUAL( background.LastLength(), cold.LastLength() );
+    BOOST_CHECK_EQUAL( background.TuningStatus(), cold.TuningStatus() );
+
+    cold.AbortPlacement();
+    background.AbortPlacement();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,396 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_world_sync.cpp
+ *
+ * Checks that the router world updated from the board change notifications is the same as
+ * a world rebuilt from scratch, after additions, removals and changes of each kind of board
+ * item the router knows about.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_shape.h>
+#include <pcb_text.h>
+#include <track.h>
+#include <zone.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_segment.h>
+#include <router/pns_solid.h>
+#include <router/pns_via.h>
+
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @return a description of every item of aWorld, with its kind, net, layers, parent and
+ * geometry.
+ */
+static std::multiset<std::string> describeWorld( PNS::NODE* aWorld, BOARD* aBoard )
+{
+    std::multiset<std::string> items;
+    std::set<int>              nets = { -1 };
+
+    for( NETINFO_ITEM* net : aBoard->GetNetInfo() )
+        nets.insert( net->GetNet() );
+
+    for( int net : nets )
+    {
+        std::set<PNS::ITEM*> netItems;
+
+        aWorld->AllItemsInNet( net, netItems );
+
+        for( PNS::ITEM* item : netItems )
+        {
+            std::ostringstream desc;
+
+            desc << item->KindStr() << " net " << item->Net() << " layers "
+                 << item->Layers().Start() << "-" << item->Layers().End() << " parent "
+                 << item->Parent() << " routable " << item->IsRoutable();
+
+            if( const SHAPE* shape = item->Shape() )
+            {
+                BOX2I bbox = shape->BBox();
+
+                desc << " shape " << shape->Type() << " " << bbox.GetPosition() << " "
+                     << bbox.GetSize();
+            }
+
+            switch( item->Kind() )
+            {
+            case PNS::ITEM::SEGMENT_T:
+            {
+                const PNS::SEGMENT* seg = static_cast<const PNS::SEGMENT*>( item );
+                desc << " seg " << seg->Seg().A << " " << seg->Seg().B << " " << seg->Width();
+                break;
+            }
+
+            case PNS::ITEM::VIA_T:
+            {
+                const PNS::VIA* via = static_cast<const PNS::VIA*>( item );
+                desc << " via " << via->Pos() << " " << via->Diameter() << " " << via->Drill();
+                break;
+            }
+
+            case PNS::ITEM::SOLID_T:
+            {
+                const PNS::SOLID* solid = static_cast<const PNS::SOLID*>( item );
+                desc << " solid " << solid->Pos() << " " << solid->Offset();
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            items.insert( desc.str() );
+        }
+    }
+
+    return items;
+}
+
+
+struct WORLD_SYNC_FIXTURE
+{
+    WORLD_SYNC_FIXTURE() :
+            m_board( std::make_unique<BOARD>() ),
+            m_settings( nullptr, "" )
+    {
+        for( int net = 1; net <= 3; net++ )
+            m_board->Add( new NETINFO_ITEM( m_board.get(), wxString::Format( "N%d", net ), net ) );
+
+        m_outline = new PCB_SHAPE( m_board.get() );
+        m_outline->SetShape( S_RECT );
+        m_outline->SetLayer( Edge_Cuts );
+        m_outline->SetStart( wxPoint( -10000000, -10000000 ) );
+        m_outline->SetEnd( wxPoint( 60000000, 60000000 ) );
+        m_outline->SetWidth( 100000 );
+        m_board->Add( m_outline );
+
+        for( int i = 0; i < 5; i++ )
+            m_board->Add( makeTrack( i ) );
+
+        m_iface = std::make_unique<PNS_KICAD_IFACE_BASE>();
+        m_iface->SetBoard( m_board.get() );
+        m_router.SetInterface( m_iface.get() );
+        m_router.LoadSettings( &m_settings );
+        m_router.SyncWorld();
+    }
+
+    ~WORLD_SYNC_FIXTURE()
+    {
+        m_router.ClearWorld();
+    }
+
+    TRACK* makeTrack( int aIndex )
+    {
+        TRACK* track = new TRACK( m_board.get() );
+
+        track->SetStart( wxPoint( 0, aIndex * 2000000 ) );
+        track->SetEnd( wxPoint( 20000000, aIndex * 2000000 ) );
+        track->SetWidth( 250000 );
+        track->SetLayer( aIndex % 2 ? B_Cu : F_Cu );
+        track->SetNetCode( 1 + aIndex % 3 );
+
+        return track;
+    }
+
+    FOOTPRINT* makeFootprint()
+    {
+        FOOTPRINT* footprint = new FOOTPRINT( m_board.get() );
+
+        for( int i = 0; i < 2; i++ )
+        {
+            PAD* pad = new PAD( footprint );
+
+            pad->SetName( wxString::Format( "%d", i + 1 ) );
+            pad->SetShape( PAD_SHAPE_RECT );
+            pad->SetSize( wxSize( 1000000, 1500000 ) );
+            pad->SetAttribute( PAD_ATTRIB_SMD );
+            pad->SetLayerSet( PAD::SMDMask() );
+            pad->SetPos0( wxPoint( i * 2000000, 0 ) );
+            pad->SetNetCode( 1 + i );
+            footprint->Add( pad );
+        }
+
+        footprint->SetReference( "R1" );
+        footprint->SetPosition( wxPoint( 30000000, 30000000 ) );
+
+        return footprint;
+    }
+
+    ZONE* makeRuleArea()
+    {
+        ZONE* zone = new ZONE( m_board.get() );
+
+        zone->SetIsRuleArea( true );
+        zone->SetDoNotAllowTracks( true );
+        zone->SetLayer( F_Cu );
+        zone->AppendCorner( wxPoint( 40000000, 0 ), -1 );
+        zone->AppendCorner( wxPoint( 50000000, 0 ), -1 );
+        zone->AppendCorner( wxPoint( 50000000, 10000000 ), -1 );
+        zone->AppendCorner( wxPoint( 40000000, 10000000 ), -1 );
+
+        return zone;
+    }
+
+    /**
+     * Applies the board changes to the router world and compares it with a world rebuilt
+     * from the board.
+     */
+    void checkWorld( const std::string& aStep )
+    {
+        BOOST_TEST_CONTEXT( aStep )
+        {
+            // The update must not fall back to a full sync, or there is nothing to compare
+            BOOST_REQUIRE( m_iface->UpdateWorld( m_router.GetWorld() ) );
+
+            PNS_KICAD_IFACE_BASE fullIface;
+            PNS::NODE            fullWorld;
+
+            fullIface.SetBoard( m_board.get() );
+            fullIface.SyncWorld( &fullWorld );
+
+            std::multiset<std::string> updated = describeWorld( m_router.GetWorld(),
+                                                                m_board.get() );
+            std::multiset<std::string> full = describeWorld( &fullWorld, m_board.get() );
+
+            BOOST_CHECK_EQUAL_COLLECTIONS( updated.begin(), updated.end(), full.begin(),
+                                           full.end() );
+            BOOST_CHECK_EQUAL( m_router.GetWorld()->JointCount(), fullWorld.JointCount() );
+        }
+    }
+
+    /**
+     * Removes aItem from the board, keeping it alive until the end of the test like the
+     * undo buffer does.
+     */
+    void remove( BOARD_ITEM* aItem )
+    {
+        m_board->Remove( aItem );
+        m_removed.emplace_back( aItem );
+    }
+
+    std::unique_ptr<BOARD>                   m_board;
+    std::vector<std::unique_ptr<BOARD_ITEM>> m_removed;
+    PCB_SHAPE*                               m_outline;
+    std::unique_ptr<PNS_KICAD_IFACE_BASE>    m_iface;
+    PNS::ROUTING_SETTINGS                    m_settings;
+    PNS::ROUTER                              m_router;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsWorldSync, WORLD_SYNC_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( Tracks )
+{
+    TRACK* track = makeTrack( 5 );
+
+    m_board->Add( track );
+    checkWorld( "add track" );
+
+    track->SetEnd( wxPoint( 15000000, 12000000 ) );
+    track->SetWidth( 400000 );
+    m_board->OnItemChanged( track );
+    checkWorld( "change track" );
+
+    track->SetLayer( B_Cu );
+    track->SetNetCode( 3 );
+    m_board->OnItemChanged( track );
+    checkWorld( "change track layer and net" );
+
+    remove( track );
+    checkWorld( "remove track" );
+
+    remove( m_board->Tracks().front() );
+    checkWorld( "remove original track" );
+}
+
+
+BOOST_AUTO_TEST_CASE( Vias )
+{
+    VIA* via = new VIA( m_board.get() );
+
+    via->SetPosition( wxPoint( 20000000, 0 ) );
+    via->SetWidth( 800000 );
+    via->SetDrill( 400000 );
+    via->SetLayerPair( F_Cu, B_Cu );
+    via->SetNetCode( 1 );
+    m_board->Add( via );
+    checkWorld( "add via" );
+
+    via->SetPosition( wxPoint( 20000000, 2000000 ) );
+    via->SetNetCode( 2 );
+    m_board->OnItemChanged( via );
+    checkWorld( "move via" );
+
+    remove( via );
+    checkWorld( "remove via" );
+}
+
+
+BOOST_AUTO_TEST_CASE( Footprints )
+{
+    FOOTPRINT* footprint = makeFootprint();
+
+    m_board->Add( footprint );
+    checkWorld( "add footprint" );
+
+    footprint->SetPosition( wxPoint( 35000000, 25000000 ) );
+    footprint->SetOrientation( 900 );
+    m_board->OnItemChanged( footprint );
+    checkWorld( "move footprint" );
+
+    PAD* pad = footprint->Pads().front();
+
+    pad->SetSize( wxSize( 2000000, 500000 ) );
+    pad->SetNetCode( 3 );
+    m_board->OnItemChanged( pad );
+    checkWorld( "change pad" );
+
+    remove( footprint );
+    checkWorld( "remove footprint" );
+}
+
+
+BOOST_AUTO_TEST_CASE( Zones )
+{
+    ZONE* zone = makeRuleArea();
+
+    m_board->Add( zone );
+    checkWorld( "add rule area" );
+
+    zone->Move( wxPoint( -5000000, 5000000 ) );
+    m_board->OnItemChanged( zone );
+    checkWorld( "move rule area" );
+
+    zone->SetLayerSet( LSET( 2, F_Cu, B_Cu ) );
+    m_board->OnItemChanged( zone );
+    checkWorld( "change rule area layers" );
+
+    remove( zone );
+    checkWorld( "remove rule area" );
+}
+
+
+BOOST_AUTO_TEST_CASE( BoardOutline )
+{
+    ZONE* zone = makeRuleArea();
+
+    // The rule area sticks out of the outline once it shrinks
+    m_board->Add( zone );
+    checkWorld( "add rule area" );
+
+    m_outline->SetEnd( wxPoint( 45000000, 45000000 ) );
+    m_board->OnItemChanged( m_outline );
+    checkWorld( "change outline" );
+
+    remove( m_outline );
+    checkWorld( "remove outline" );
+
+    PCB_SHAPE* outline = new PCB_SHAPE( m_board.get() );
+
+    outline->SetShape( S_CIRCLE );
+    outline->SetLayer( Edge_Cuts );
+    outline->SetStart( wxPoint( 25000000, 25000000 ) );
+    outline->SetEnd( wxPoint( 60000000, 25000000 ) );
+    outline->SetWidth( 100000 );
+    m_board->Add( outline );
+    checkWorld( "add circular outline" );
+}
+
+
+BOOST_AUTO_TEST_CASE( Texts )
+{
+    PCB_TEXT* text = new PCB_TEXT( m_board.get() );
+
+    text->SetText( "COPPER" );
+    text->SetLayer( F_Cu );
+    text->SetTextPos( wxPoint( 5000000, 30000000 ) );
+    m_board->Add( text );
+    checkWorld( "add text" );
+
+    text->SetText( "LONGER COPPER TEXT" );
+    m_board->OnItemChanged( text );
+    checkWorld( "change text" );
+
+    remove( text );
+    checkWorld( "remove text" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
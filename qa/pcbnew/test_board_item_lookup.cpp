@@ -0,0 +1,146 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_board_item_lookup.cpp
+ *
+ * Checks that BOARD::GetItem() finds the items of the board through its KIID index while
+ * items are added, removed and changed.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_text.h>
+#include <track.h>
+
+
+static bool isDeleted( const BOARD_ITEM* aItem )
+{
+    return aItem && aItem->Type() == NOT_USED;
+}
+
+
+BOOST_AUTO_TEST_SUITE( BoardItemLookup )
+
+
+BOOST_AUTO_TEST_CASE( AddRemove )
+{
+    BOARD                    board;
+    std::vector<BOARD_ITEM*> items;
+
+    for( int i = 0; i < 100; i++ )
+    {
+        TRACK*    track = new TRACK( &board );
+        PCB_TEXT* text = new PCB_TEXT( &board );
+
+        board.Add( track );
+        board.Add( text );
+        items.push_back( track );
+        items.push_back( text );
+    }
+
+    FOOTPRINT* footprint = new FOOTPRINT( &board );
+    PAD*       pad = new PAD( footprint );
+
+    footprint->Add( pad );
+    board.Add( footprint );
+
+    BOOST_CHECK( board.GetItem( niluuid ) == nullptr );
+    BOOST_CHECK( board.GetItem( board.m_Uuid ) == &board );
+    BOOST_CHECK( board.GetItem( footprint->m_Uuid ) == footprint );
+    BOOST_CHECK( board.GetItem( pad->m_Uuid ) == pad );
+    BOOST_CHECK( board.GetItem( footprint->Reference().m_Uuid ) == &footprint->Reference() );
+
+    for( BOARD_ITEM* item : items )
+        BOOST_CHECK( board.GetItem( item->m_Uuid ) == item );
+
+    for( size_t i = 0; i < items.size(); i += 2 )
+    {
+        KIID id = items[i]->m_Uuid;
+
+        board.Remove( items[i] );
+        delete items[i];
+
+        BOOST_CHECK( isDeleted( board.GetItem( id ) ) );
+        BOOST_CHECK( board.GetItem( items[i + 1]->m_Uuid ) == items[i + 1] );
+    }
+
+    KIID footprintId = footprint->m_Uuid;
+    KIID padId = pad->m_Uuid;
+
+    board.Remove( footprint );
+
+    BOOST_CHECK( isDeleted( board.GetItem( footprintId ) ) );
+    BOOST_CHECK( isDeleted( board.GetItem( padId ) ) );
+
+    board.Add( footprint );
+
+    BOOST_CHECK( board.GetItem( padId ) == pad );
+}
+
+
+/**
+ * Items are still found when they change behind the back of the board
+ */
+BOOST_AUTO_TEST_CASE( ChangedItems )
+{
+    BOARD      board;
+    FOOTPRINT* footprint = new FOOTPRINT( &board );
+    TRACK*     track = new TRACK( &board );
+
+    board.Add( footprint );
+    board.Add( track );
+
+    // A pad added to a footprint already on the board
+    PAD* pad = new PAD( footprint );
+
+    footprint->Add( pad );
+    BOOST_CHECK( board.GetItem( pad->m_Uuid ) == pad );
+
+    // A new KIID given to an item already on the board
+    KIID oldId = track->m_Uuid;
+
+    const_cast<KIID&>( track->m_Uuid ) = KIID();
+
+    BOOST_CHECK( board.GetItem( track->m_Uuid ) == track );
+    BOOST_CHECK( isDeleted( board.GetItem( oldId ) ) );
+
+    board.Remove( track );
+    delete track;
+
+    BOOST_CHECK( isDeleted( board.GetItem( oldId ) ) );
+
+    // A pad removed from its footprint
+    KIID padId = pad->m_Uuid;
+
+    footprint->Remove( pad );
+    delete pad;
+
+    BOOST_CHECK( isDeleted( board.GetItem( padId ) ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
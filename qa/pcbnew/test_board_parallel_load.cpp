@@ -0,0 +1,244 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_board_parallel_load.cpp
+ *
+ * Checks that a board loaded by PCB_IO::Load(), which parses the board items on worker
+ * threads, is the same as the board parsed sequentially from a FILE_LINE_READER.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <boost/filesystem.hpp>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_group.h>
+#include <track.h>
+#include <zone.h>
+#include <pcbnew_utils/board_file_utils.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <richio.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+
+/**
+ * A board with enough items to be parsed by several threads.
+ */
+static std::unique_ptr<BOARD> createBoard()
+{
+    std::unique_ptr<BOARD> board = std::make_unique<BOARD>();
+
+    for( int i = 1; i <= 20; i++ )
+        board->Add( new NETINFO_ITEM( board.get(), wxString::Format( "NET%d", i ), i ) );
+
+    board->Add( new NETINFO_ITEM( board.get(), "ZONE_NET", 21 ) );
+
+    PCB_GROUP* group = new PCB_GROUP( board.get() );
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        TRACK* track = new TRACK( board.get() );
+
+        track->SetStart( wxPoint( i * 10000, 0 ) );
+        track->SetEnd( wxPoint( i * 10000, 500000 ) );
+        track->SetWidth( 250000 );
+        track->SetLayer( i % 2 ? F_Cu : B_Cu );
+        track->SetNetCode( 1 + i % 20 );
+        board->Add( track );
+
+        if( i % 10 == 0 )
+            group->AddItem( track );
+    }
+
+    for( int i = 0; i < 300; i++ )
+    {
+        VIA* via = new VIA( board.get() );
+
+        via->SetPosition( wxPoint( i * 30000, 600000 ) );
+        via->SetWidth( 800000 );
+        via->SetDrill( 400000 );
+        via->SetLayerPair( F_Cu, B_Cu );
+        via->SetNetCode( 1 + i % 20 );
+        board->Add( via );
+    }
+
+    for( int i = 0; i < 100; i++ )
+    {
+        FOOTPRINT* footprint = new FOOTPRINT( board.get() );
+        PAD*       pad = new PAD( footprint );
+
+        footprint->SetReference( wxString::Format( "R%d", i ) );
+        pad->SetName( "1" );
+        pad->SetSize( wxSize( 1000000, 1000000 ) );
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( PAD::SMDMask() );
+        pad->SetNetCode( 1 + i % 20 );
+        footprint->Add( pad );
+        footprint->SetPosition( wxPoint( i * 100000, 2000000 ) );
+        board->Add( footprint );
+    }
+
+    board->Add( group );
+
+    ZONE* zone = new ZONE( board.get() );
+
+    zone->SetLayer( F_Cu );
+    zone->SetNetCode( 21 );
+    zone->AppendCorner( wxPoint( 0, 0 ), -1 );
+    zone->AppendCorner( wxPoint( 10000000, 0 ), -1 );
+    zone->AppendCorner( wxPoint( 10000000, 10000000 ), -1 );
+    board->Add( zone );
+
+    return board;
+}
+
+
+static std::string readFile( const std::string& aFilename )
+{
+    std::ifstream     file( aFilename, std::ios::binary );
+    std::stringstream text;
+
+    text << file.rdbuf();
+
+    return text.str();
+}
+
+
+static std::string formatBoard( BOARD* aBoard )
+{
+    PCB_IO io;
+
+    io.Format( aBoard );
+
+    return io.GetStringOutput( true );
+}
+
+
+/**
+ * Loads aFilename through the worker threads of PCB_IO::Load() and sequentially, and checks
+ * that both boards are formatted the same.
+ */
+static void checkLoad( const std::string& aFilename )
+{
+    PCB_IO                 io;
+    std::unique_ptr<BOARD> parallel( io.Load( aFilename, nullptr, nullptr ) );
+
+    FILE_LINE_READER       reader( aFilename );
+    std::unique_ptr<BOARD> sequential( PCB_IO().DoLoad( reader, nullptr, nullptr ) );
+
+    BOOST_REQUIRE( parallel && sequential );
+    BOOST_CHECK_EQUAL( parallel->Tracks().size(), sequential->Tracks().size() );
+    BOOST_CHECK_EQUAL( parallel->Footprints().size(), sequential->Footprints().size() );
+    BOOST_CHECK_EQUAL( parallel->Groups().size(), sequential->Groups().size() );
+    BOOST_CHECK_EQUAL( parallel->GetNetCount(), sequential->GetNetCount() );
+    BOOST_CHECK( formatBoard( parallel.get() ) == formatBoard( sequential.get() ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE( BoardParallelLoad )
+
+
+BOOST_AUTO_TEST_CASE( SameAsSequential )
+{
+    std::unique_ptr<BOARD> board = createBoard();
+    auto path = boost::filesystem::temp_directory_path() / "parallel_load_tst.kicad_pcb";
+
+    ::KI_TEST::DumpBoardToFile( *board, path.string() );
+
+    checkLoad( path.string() );
+
+    boost::filesystem::remove( path );
+}
+
+
+/**
+ * A zone naming a net which is not on the board adds the net, which renumbers the nets of the
+ * items parsed after it on the worker threads.
+ */
+BOOST_AUTO_TEST_CASE( ZoneAddingNet )
+{
+    std::unique_ptr<BOARD> board = createBoard();
+    auto path = boost::filesystem::temp_directory_path() / "parallel_load_net_tst.kicad_pcb";
+
+    ::KI_TEST::DumpBoardToFile( *board, path.string() );
+
+    std::string text = readFile( path.string() );
+    size_t      name = text.find( "(net_name " );
+
+    BOOST_REQUIRE( name != std::string::npos );
+
+    name += strlen( "(net_name " );
+    text.replace( name, text.find( ')', name ) - name, "NEW_NET" );
+
+    // Move the zone before the tracks so that items parsed on other threads follow it
+    size_t zoneStart = text.rfind( "\n", name ) + 1;
+    size_t zoneEnd = text.find( "\n  )\n", zoneStart ) + 5;
+    size_t firstTrack = text.find( "  (segment " );
+
+    BOOST_REQUIRE( firstTrack < zoneStart );
+
+    std::string zone = text.substr( zoneStart, zoneEnd - zoneStart );
+
+    text.erase( zoneStart, zoneEnd - zoneStart );
+    text.insert( firstTrack, zone );
+
+    std::ofstream( path.string(), std::ios::binary ) << text;
+
+    checkLoad( path.string() );
+
+    boost::filesystem::remove( path );
+}
+
+
+BOOST_AUTO_TEST_CASE( ParseError )
+{
+    std::unique_ptr<BOARD> board = createBoard();
+    auto path = boost::filesystem::temp_directory_path() / "parallel_load_err_tst.kicad_pcb";
+
+    ::KI_TEST::DumpBoardToFile( *board, path.string() );
+
+    std::string text = readFile( path.string() );
+    size_t      via = text.rfind( "(via " );
+
+    BOOST_REQUIRE( via != std::string::npos );
+
+    text.insert( via + strlen( "(via " ), "(bogus) " );
+    std::ofstream( path.string(), std::ios::binary ) << text;
+
+    PCB_IO           io;
+    FILE_LINE_READER reader( path.string() );
+
+    BOOST_CHECK_THROW( io.Load( path.string(), nullptr, nullptr ), IO_ERROR );
+    BOOST_CHECK_THROW( PCB_IO().DoLoad( reader, nullptr, nullptr ), IO_ERROR );
+
+    boost::filesystem::remove( path );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
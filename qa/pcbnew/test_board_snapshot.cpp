@@ -0,0 +1,219 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_board_snapshot.cpp
+ *
+ * Checks that a board written by PCB_IO::SaveSnapshot() loads back as the same board.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <boost/filesystem.hpp>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_group.h>
+#include <track.h>
+#include <zone.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <richio.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+
+/**
+ * A board with enough items to be formatted and parsed by several threads.
+ */
+static std::unique_ptr<BOARD> createBoard()
+{
+    std::unique_ptr<BOARD> board = std::make_unique<BOARD>();
+
+    for( int i = 1; i <= 20; i++ )
+        board->Add( new NETINFO_ITEM( board.get(), wxString::Format( "NET%d", i ), i ) );
+
+    board->Add( new NETINFO_ITEM( board.get(), "ZONE_NET", 21 ) );
+
+    PCB_GROUP* group = new PCB_GROUP( board.get() );
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        TRACK* track = new TRACK( board.get() );
+
+        track->SetStart( wxPoint( i * 10000, 0 ) );
+        track->SetEnd( wxPoint( i * 10000, 500000 ) );
+        track->SetWidth( 250000 );
+        track->SetLayer( i % 2 ? F_Cu : B_Cu );
+        track->SetNetCode( 1 + i % 20 );
+        board->Add( track );
+
+        if( i % 10 == 0 )
+            group->AddItem( track );
+    }
+
+    for( int i = 0; i < 300; i++ )
+    {
+        VIA* via = new VIA( board.get() );
+
+        via->SetPosition( wxPoint( i * 30000, 600000 ) );
+        via->SetWidth( 800000 );
+        via->SetDrill( 400000 );
+        via->SetLayerPair( F_Cu, B_Cu );
+        via->SetNetCode( 1 + i % 20 );
+        board->Add( via );
+    }
+
+    for( int i = 0; i < 100; i++ )
+    {
+        FOOTPRINT* footprint = new FOOTPRINT( board.get() );
+        PAD*       pad = new PAD( footprint );
+
+        footprint->SetReference( wxString::Format( "R%d", i ) );
+        pad->SetName( "1" );
+        pad->SetSize( wxSize( 1000000, 1000000 ) );
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( PAD::SMDMask() );
+        pad->SetNetCode( 1 + i % 20 );
+        footprint->Add( pad );
+        footprint->SetPosition( wxPoint( i * 100000, 2000000 ) );
+        board->Add( footprint );
+    }
+
+    board->Add( group );
+
+    ZONE* zone = new ZONE( board.get() );
+
+    zone->SetLayer( F_Cu );
+    zone->SetNetCode( 21 );
+    zone->AppendCorner( wxPoint( 0, 0 ), -1 );
+    zone->AppendCorner( wxPoint( 10000000, 0 ), -1 );
+    zone->AppendCorner( wxPoint( 10000000, 10000000 ), -1 );
+    board->Add( zone );
+
+    return board;
+}
+
+
+static std::string readFile( const std::string& aFilename )
+{
+    std::ifstream     file( aFilename, std::ios::binary );
+    std::stringstream text;
+
+    text << file.rdbuf();
+
+    return text.str();
+}
+
+
+static std::string formatBoard( BOARD* aBoard )
+{
+    PCB_IO io;
+
+    io.Format( aBoard );
+
+    return io.GetStringOutput( true );
+}
+
+
+BOOST_AUTO_TEST_SUITE( BoardSnapshot )
+
+
+BOOST_AUTO_TEST_CASE( SaveAndLoad )
+{
+    std::unique_ptr<BOARD> board = createBoard();
+    auto path = boost::filesystem::temp_directory_path() / "snapshot_tst.kicad_pcb";
+
+    PCB_IO().SaveSnapshot( path.string(), board.get() );
+
+    std::string data = readFile( path.string() );
+
+    BOOST_CHECK( PCB_IO::IsSnapshot( data.data(), data.size() ) );
+
+    std::unique_ptr<BOARD> loaded( PCB_IO().Load( path.string(), nullptr, nullptr ) );
+
+    BOOST_REQUIRE( loaded );
+    BOOST_CHECK_EQUAL( loaded->Tracks().size(), board->Tracks().size() );
+    BOOST_CHECK_EQUAL( loaded->Footprints().size(), board->Footprints().size() );
+    BOOST_CHECK_EQUAL( loaded->Zones().size(), board->Zones().size() );
+    BOOST_CHECK_EQUAL( loaded->Groups().size(), board->Groups().size() );
+    BOOST_CHECK_EQUAL( loaded->GetNetCount(), board->GetNetCount() );
+    BOOST_CHECK( formatBoard( loaded.get() ) == formatBoard( board.get() ) );
+
+    boost::filesystem::remove( path );
+}
+
+
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    std::unique_ptr<BOARD> board = createBoard();
+    auto path = boost::filesystem::temp_directory_path() / "snapshot_trunc_tst.kicad_pcb";
+
+    PCB_IO().SaveSnapshot( path.string(), board.get() );
+
+    std::string data = readFile( path.string() );
+
+    std::ofstream( path.string(), std::ios::binary ) << data.substr( 0, data.size() / 2 );
+
+    BOOST_CHECK_THROW( PCB_IO().Load( path.string(), nullptr, nullptr ), IO_ERROR );
+
+    boost::filesystem::remove( path );
+}
+
+
+
+/**
+ * The version follows the magic string; a snapshot written by a newer version is refused.
+ */
+BOOST_AUTO_TEST_CASE( UnsupportedVersion )
+{
+    std::unique_ptr<BOARD> board = createBoard();
+    auto path = boost::filesystem::temp_directory_path() / "snapshot_version_tst.kicad_pcb";
+
+    PCB_IO().SaveSnapshot( path.string(), board.get() );
+
+    std::string data = readFile( path.string() );
+    uint32_t    version = 0;
+    size_t      versionOffset = strlen( "KiCadPcbSnapshot" );
+
+    BOOST_REQUIRE( data.size() > versionOffset + sizeof( version ) );
+
+    memcpy( &version, &data[versionOffset], sizeof( version ) );
+    BOOST_CHECK_EQUAL( version, 1u );
+
+    version++;
+    memcpy( &data[versionOffset], &version, sizeof( version ) );
+
+    std::ofstream( path.string(), std::ios::binary ) << data;
+
+    BOOST_CHECK( PCB_IO::IsSnapshot( data.data(), data.size() ) );
+    BOOST_CHECK_THROW( PCB_IO().Load( path.string(), nullptr, nullptr ), IO_ERROR );
+
+    boost::filesystem::remove( path );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,258 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_footprint_deferred_body.cpp
+ *
+ * Checks that the footprints of a library are cached with deferred graphic items and 3D
+ * models, and that these are loaded as they were saved when first used.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <footprint.h>
+#include <fp_shape.h>
+#include <fp_text.h>
+#include <pad.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <plugins/kicad/pcb_parser.h>
+#include <richio.h>
+
+
+static std::unique_ptr<FOOTPRINT> createFootprint()
+{
+    std::unique_ptr<FOOTPRINT> footprint = std::make_unique<FOOTPRINT>( nullptr );
+
+    footprint->SetFPID( LIB_ID( wxEmptyString, "R1" ) );
+    footprint->SetReference( "R**" );
+    footprint->SetValue( "R1" );
+
+    for( int i = 0; i < 2; i++ )
+    {
+        PAD* pad = new PAD( footprint.get() );
+
+        pad->SetName( wxString::Format( "%d", i + 1 ) );
+        pad->SetSize( wxSize( 800000, 950000 ) );
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( PAD::SMDMask() );
+        pad->SetPos0( wxPoint( i ? 825000 : -825000, 0 ) );
+        pad->SetPosition( pad->GetPos0() );
+        footprint->Add( pad );
+    }
+
+    for( int i = 0; i < 4; i++ )
+    {
+        FP_SHAPE* line = new FP_SHAPE( footprint.get() );
+
+        line->SetLayer( F_Fab );
+        line->SetWidth( 100000 );
+        line->SetStart0( wxPoint( -800000 + i * 100000, -400000 ) );
+        line->SetEnd0( wxPoint( 800000, 400000 - i * 100000 ) );
+        line->SetDrawCoord();
+        footprint->Add( line );
+    }
+
+    FP_TEXT* text = new FP_TEXT( footprint.get() );
+
+    text->SetText( "${REFERENCE} \"(quoted)\"" );
+    text->SetLayer( F_Fab );
+    footprint->Add( text );
+
+    FP_3DMODEL model;
+
+    model.m_Filename = "R_0603.wrl";
+    footprint->Models().push_back( model );
+
+    return footprint;
+}
+
+
+static std::string readFile( const boost::filesystem::path& aPath )
+{
+    std::ifstream      file( aPath.string(), std::ios::binary );
+    std::ostringstream text;
+
+    text << file.rdbuf();
+    return text.str();
+}
+
+
+static void writeFile( const boost::filesystem::path& aPath, const std::string& aText )
+{
+    std::ofstream file( aPath.string(), std::ios::binary | std::ios::trunc );
+
+    file << aText;
+}
+
+
+/**
+ * @return @a aText with the first @a aFind replaced by @a aReplace.
+ */
+static std::string replaceFirst( std::string aText, const std::string& aFind,
+                                 const std::string& aReplace )
+{
+    size_t pos = aText.find( aFind );
+
+    BOOST_REQUIRE( pos != std::string::npos );
+    return aText.replace( pos, aFind.size(), aReplace );
+}
+
+
+static std::string formatFootprint( const FOOTPRINT* aFootprint )
+{
+    PCB_IO io;
+
+    io.Format( const_cast<FOOTPRINT*>( aFootprint ) );
+
+    return io.GetStringOutput( true );
+}
+
+
+/**
+ * Checks the cached bounding box, which is used without being recalculated by HitTest()
+ * and the painter.
+ */
+static void checkBoundingBox( const FOOTPRINT* aFootprint, const FOOTPRINT* aExpected )
+{
+    EDA_RECT bbox = aFootprint->GetBoundingBoxBase();
+
+    BOOST_CHECK( bbox.GetOrigin() == aExpected->GetBoundingBoxBase().GetOrigin() );
+    BOOST_CHECK( bbox.GetSize() == aExpected->GetBoundingBoxBase().GetSize() );
+
+    // Inside the graphic lines, away from the pads
+    BOOST_CHECK( aFootprint->HitTest( wxPoint( 0, 350000 ) ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE( FootprintDeferredBody )
+
+
+BOOST_AUTO_TEST_CASE( LibraryFootprint )
+{
+    std::unique_ptr<FOOTPRINT> footprint = createFootprint();
+    auto path = boost::filesystem::temp_directory_path() / "deferred_body_tst.pretty";
+    wxString libPath = path.string();
+
+    boost::filesystem::remove_all( path );
+
+    PCB_IO().FootprintLibCreate( libPath );
+    PCB_IO().FootprintSave( libPath, footprint.get() );
+
+    // The footprint parsed as usual
+    FILE_LINE_READER           reader( ( path / "R1.kicad_mod" ).string() );
+    PCB_PARSER                 parser( &reader );
+    std::unique_ptr<FOOTPRINT> expected( static_cast<FOOTPRINT*>( parser.Parse() ) );
+
+    PCB_IO           io;
+    const FOOTPRINT* cached = io.GetEnumeratedFootprint( libPath, "R1" );
+
+    BOOST_REQUIRE( cached );
+    BOOST_CHECK( cached->HasDeferredBody() );
+    BOOST_CHECK_EQUAL( cached->Pads().size(), 2 );
+    BOOST_CHECK( cached->GetReference() == "R**" );
+    BOOST_CHECK( cached->HasDeferredBody() );
+
+    // A copy loads the body of the cached footprint
+    std::unique_ptr<FOOTPRINT> loaded( io.FootprintLoad( libPath, "R1" ) );
+
+    BOOST_REQUIRE( loaded );
+    BOOST_CHECK( !cached->HasDeferredBody() );
+    BOOST_CHECK_EQUAL( loaded->GraphicalItems().size(), expected->GraphicalItems().size() );
+    BOOST_CHECK_EQUAL( loaded->Models().size(), 1 );
+    BOOST_CHECK( formatFootprint( loaded.get() ) == formatFootprint( expected.get() ) );
+    BOOST_CHECK( loaded->GetBoundingBox().GetOrigin() == expected->GetBoundingBox().GetOrigin() );
+    BOOST_CHECK( loaded->GetBoundingBox().GetSize() == expected->GetBoundingBox().GetSize() );
+    checkBoundingBox( loaded.get(), expected.get() );
+
+    // Assignments load the body of the footprint they copy too
+    PCB_IO    assignIo;
+    FOOTPRINT assigned( nullptr );
+
+    cached = assignIo.GetEnumeratedFootprint( libPath, "R1" );
+
+    BOOST_REQUIRE( cached && cached->HasDeferredBody() );
+    assigned = *cached;
+    checkBoundingBox( &assigned, expected.get() );
+
+    PCB_IO    moveIo;
+    FOOTPRINT moved( nullptr );
+
+    cached = moveIo.GetEnumeratedFootprint( libPath, "R1" );
+
+    BOOST_REQUIRE( cached && cached->HasDeferredBody() );
+    moved = std::move( *const_cast<FOOTPRINT*>( cached ) );
+    checkBoundingBox( &moved, expected.get() );
+    BOOST_CHECK_EQUAL( moved.GraphicalItems().size(), expected->GraphicalItems().size() );
+
+    boost::filesystem::remove_all( path );
+}
+
+
+/**
+ * Parse errors in the deferred items are reported when the footprint is loaded, and
+ * unbalanced parentheses when the library is.
+ */
+BOOST_AUTO_TEST_CASE( ParseErrors )
+{
+    std::unique_ptr<FOOTPRINT> footprint = createFootprint();
+    auto path = boost::filesystem::temp_directory_path() / "deferred_body_err_tst.pretty";
+    auto file = path / "R1.kicad_mod";
+    wxString libPath = path.string();
+
+    boost::filesystem::remove_all( path );
+
+    PCB_IO().FootprintLibCreate( libPath );
+    PCB_IO().FootprintSave( libPath, footprint.get() );
+
+    std::string text = readFile( file );
+
+    writeFile( file, replaceFirst( text, "(width ", "(width x" ) );
+
+    PCB_IO           io;
+    const FOOTPRINT* cached = io.GetEnumeratedFootprint( libPath, "R1" );
+
+    BOOST_REQUIRE( cached );
+    BOOST_CHECK( cached->HasDeferredBody() );
+    BOOST_CHECK_THROW( io.FootprintLoad( libPath, "R1" ), IO_ERROR );
+
+    // The footprint is left out of the cache until its file changes
+    std::unique_ptr<FOOTPRINT> loaded( io.FootprintLoad( libPath, "R1" ) );
+
+    BOOST_CHECK( !loaded );
+
+    writeFile( file, replaceFirst( text, "(fp_line (start", "(fp_line ((start" ) );
+
+    wxArrayString names;
+
+    BOOST_CHECK_THROW( PCB_IO().FootprintEnumerate( names, libPath, true ), IO_ERROR );
+
+    boost::filesystem::remove_all( path );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,227 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file eagle_import.cpp
+ *
+ * Imports Eagle designs and reports the import time and the peak memory use of the process, so
+ * that changes to the Eagle importers can be measured on big designs.
+ *
+ * This file is built in qa_pcbnew_tools, where it imports boards with EAGLE_PLUGIN, and in
+ * qa_eeschema_tools, where it imports schematics with SCH_EAGLE_PLUGIN.
+ */
+
+#include <qa_utils/utility_registry.h>
+
+#include <profile.h>
+
+#ifdef EESCHEMA
+#include <sch_plugins/eagle/sch_eagle_plugin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <schematic.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+#else
+#include <board.h>
+#include <footprint.h>
+#include <plugins/eagle/eagle_plugin.h>
+#endif
+
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <sys/resource.h>
+#endif
+
+
+/**
+ * @return the peak resident memory of the process in kB, or 0 if unknown on this platform.
+ */
+static long peakMemory()
+{
+#if defined( __unix__ ) || defined( __APPLE__ )
+    struct rusage usage;
+
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0;
+
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;      // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+
+#ifdef EESCHEMA
+#define EAGLE_FILE_KIND "schematic"
+#else
+#define EAGLE_FILE_KIND "board"
+#endif
+
+
+#ifdef EESCHEMA
+/**
+ * Import an Eagle schematic.  As an import from the schematic editor does, this writes the
+ * symbol library and the symbol library table of the design next to the file.
+ *
+ * @param aTime is set to the time spent in SCH_EAGLE_PLUGIN::Load(), in ms.
+ * @return the number of items of the imported sheets.
+ */
+static size_t importFile( const wxString& aFileName, double& aTime )
+{
+    SETTINGS_MANAGER manager( true );
+    wxFileName       pro( aFileName );
+
+    pro.SetExt( ProjectFileExtension );
+    manager.LoadProject( pro.GetFullPath() );
+
+    SCHEMATIC        schematic( &manager.Prj() );
+    SCH_EAGLE_PLUGIN plugin;
+    PROF_COUNTER     timer;
+
+    schematic.SetRoot( plugin.Load( aFileName, &schematic ) );
+    timer.Stop();
+    aTime = timer.msecs();
+
+    SCH_SCREENS screens( schematic.Root() );
+    size_t      items = 0;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        items += screen->Items().size();
+
+    schematic.Reset();
+
+    return items;
+}
+#else
+/**
+ * Import an Eagle board.
+ *
+ * @param aTime is set to the time spent in EAGLE_PLUGIN::Load(), in ms.
+ * @return the number of footprints, tracks, drawings and zones of the board.
+ */
+static size_t importFile( const wxString& aFileName, double& aTime )
+{
+    EAGLE_PLUGIN           plugin;
+    PROF_COUNTER           timer;
+    std::unique_ptr<BOARD> board( plugin.Load( aFileName, nullptr, nullptr ) );
+
+    timer.Stop();
+    aTime = timer.msecs();
+
+    return board->Footprints().size() + board->Tracks().size() + board->Drawings().size()
+           + board->Zones().size();
+}
+#endif
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "repeat", _( "number of imports of each file (default 1)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "Eagle " EAGLE_FILE_KIND " file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum EAGLE_IMPORT_RET_CODES
+{
+    IMPORT_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int eagle_import_main( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program imports Eagle " EAGLE_FILE_KIND "s and reports the "
+                               "import time and the peak memory use." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long repeat = 1;
+
+    if( cl_parser.Found( "repeat", &repeat ) && repeat < 1 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    printf( "%-40s %8s %10s %10s %12s\n", "file", "items", "min [ms]", "mean [ms]",
+            "peak [kB]" );
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+    {
+        const wxString filename = cl_parser.GetParam( i );
+        double         minTime = 0.0;
+        double         totalTime = 0.0;
+        size_t         items = 0;
+
+        for( long run = 0; run < repeat; run++ )
+        {
+            double time = 0.0;
+
+            try
+            {
+                items = importFile( filename, time );
+            }
+            catch( const IO_ERROR& ioe )
+            {
+                fprintf( stderr, "%s: %s\n", (const char*) filename.utf8_str(),
+                         (const char*) ioe.What().utf8_str() );
+                return EAGLE_IMPORT_RET_CODES::IMPORT_FAILED;
+            }
+
+            minTime = run == 0 ? time : std::min( minTime, time );
+            totalTime += time;
+        }
+
+        // The peak is the one of the whole process, so it includes the files imported before
+        printf( "%-40s %8d %10.3f %10.3f %12ld\n", (const char*) filename.utf8_str(), (int) items,
+                minTime, totalTime / repeat, peakMemory() );
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "eagle_import",
+        "Import Eagle " EAGLE_FILE_KIND "s and report the import time and peak memory",
+        eagle_import_main,
+} );
@@ -0,0 +1,149 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <board.h>
+#include <track.h>
+#include <profile.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_line.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_segment.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+
+enum NEAREST_OBSTACLE_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+/**
+ * Runs NODE::NearestObstacle() for each line in aLines, aRepeat times, and prints
+ * the time per call.
+ */
+static void benchmark( PNS::NODE* aWorld, const std::vector<PNS::LINE>& aLines, int aRepeat,
+                       const std::string& aName )
+{
+    int hits = 0;
+
+    PROF_COUNTER cnt( aName );
+
+    for( int i = 0; i < aRepeat; i++ )
+    {
+        for( const PNS::LINE& line : aLines )
+        {
+            if( aWorld->NearestObstacle( &line ) )
+                hits++;
+        }
+    }
+
+    cnt.Stop();
+
+    int calls = aRepeat * aLines.size();
+
+    printf( "%s: %d calls, %d hits, %.3f us/call\n", aName.c_str(), calls, hits,
+            calls ? cnt.msecs() * 1000.0 / calls : 0.0 );
+}
+
+
+int pns_nearest_obstacle_main( int argc, char* argv[] )
+{
+    std::string filename;
+    int         repeat = 10;
+
+    if( argc > 1 )
+        filename = argv[1];
+
+    if( argc > 2 )
+        repeat = std::max( 1, atoi( argv[2] ) );
+
+    std::unique_ptr<BOARD> brd = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !brd )
+        return NEAREST_OBSTACLE_RET_CODES::LOAD_FAILED;
+
+    PNS_KICAD_IFACE_BASE iface;
+    PNS::ROUTER          router;
+
+    iface.SetBoard( brd.get() );
+    router.SetInterface( &iface );
+
+    PROF_COUNTER syncCnt( "sync world" );
+    router.SyncWorld();
+    syncCnt.Show();
+
+    PNS::NODE* world = router.GetWorld();
+
+    // Collect the routed lines of the board, each line only once
+    std::vector<PNS::LINE> lines, shiftedLines;
+    std::set<PNS::ITEM*>   visited;
+
+    for( TRACK* track : brd->Tracks() )
+    {
+        if( track->Type() != PCB_TRACE_T )
+            continue;
+
+        PNS::ITEM* item = world->FindItemByParent( track );
+
+        if( !item || !item->OfKind( PNS::ITEM::SEGMENT_T ) || visited.count( item ) )
+            continue;
+
+        PNS::LINE line = world->AssembleLine( static_cast<PNS::SEGMENT*>( item ) );
+
+        for( PNS::LINKED_ITEM* link : line.Links() )
+            visited.insert( link );
+
+        // The board is usually DRC-clean, so also query the lines moved by their width to
+        // get realistic collisions
+        SHAPE_LINE_CHAIN shifted = line.CLine();
+        shifted.Move( VECTOR2I( line.Width(), line.Width() ) );
+
+        shiftedLines.emplace_back( line, shifted );
+        lines.push_back( std::move( line ) );
+    }
+
+    printf( "%d segments in %d lines\n", (int) visited.size(), (int) lines.size() );
+
+    benchmark( world, lines, repeat, "nearest obstacle (in place)" );
+    benchmark( world, shiftedLines, repeat, "nearest obstacle (shifted)" );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "pns_nearest_obstacle",
+        "Benchmark PNS::NODE::NearestObstacle() on the tracks of a PCB",
+        pns_nearest_obstacle_main,
+} );
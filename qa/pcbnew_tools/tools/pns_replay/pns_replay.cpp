@@ -0,0 +1,365 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_replay.cpp
+ *
+ * Replays a routing session recorded by PNS::LOGGER (saved by the router tool's debug
+ * key, see ROUTER_TOOL::handleCommonEvents()) on a board, without the GUI.  Prints the
+ * latency of the router calls for each kind of event and the geometry of the routed
+ * board, so that the performance and results of router changes can be compared.
+ *
+ * Only the events recorded by the logger are replayed: layer switches, via placement
+ * and posture changes made during the session are not.
+ */
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <board.h>
+#include <netinfo.h>
+#include <profile.h>
+
+#include <geometry/shape_arc.h>
+
+#include <router/pns_arc.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_segment.h>
+#include <router/pns_sizes_settings.h>
+#include <router/pns_via.h>
+
+#include <wx/cmdline.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "m", "mode",
+            _( "routing mode: walkaround (default), shove or mark" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "o", "output",
+            _( "write the geometry of the routed board to this file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "board file" ).mb_str(), wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "router log file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum PNS_REPLAY_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE: return "start route";
+    case PNS::LOGGER::EVT_START_DRAG:  return "start drag";
+    case PNS::LOGGER::EVT_FIX:         return "fix";
+    case PNS::LOGGER::EVT_MOVE:        return "move";
+    case PNS::LOGGER::EVT_ABORT:       return "abort";
+    default:                           return "unknown";
+    }
+}
+
+
+/**
+ * Returns the nearest-rank percentile aPercent of the sorted samples aSamples.
+ */
+static double percentile( const std::vector<double>& aSamples, double aPercent )
+{
+    if( aSamples.empty() )
+        return 0.0;
+
+    size_t rank = (size_t) std::ceil( aPercent / 100.0 * aSamples.size() );
+
+    return aSamples[ std::max<size_t>( rank, 1 ) - 1 ];
+}
+
+
+/**
+ * Returns one line of text for each track and via of the world, sorted so that the
+ * output of two runs can be compared with diff.
+ */
+static std::vector<std::string> worldGeometry( PNS::NODE* aWorld, BOARD* aBoard )
+{
+    std::vector<std::string> lines;
+    char                     buf[256];
+
+    for( NETINFO_ITEM* net : aBoard->GetNetInfo() )
+    {
+        std::set<PNS::ITEM*> items;
+
+        aWorld->AllItemsInNet( net->GetNetCode(), items,
+                               PNS::ITEM::SEGMENT_T | PNS::ITEM::ARC_T | PNS::ITEM::VIA_T );
+
+        for( PNS::ITEM* item : items )
+        {
+            if( PNS::SEGMENT* seg = dyn_cast<PNS::SEGMENT*>( item ) )
+            {
+                snprintf( buf, sizeof( buf ), "segment %d %d %d %d %d %d %d", seg->Net(),
+                          seg->Layer(), seg->Seg().A.x, seg->Seg().A.y, seg->Seg().B.x,
+                          seg->Seg().B.y, seg->Width() );
+            }
+            else if( PNS::ARC* arc = dyn_cast<PNS::ARC*>( item ) )
+            {
+                const SHAPE_ARC* shape = static_cast<const SHAPE_ARC*>( arc->Shape() );
+
+                snprintf( buf, sizeof( buf ), "arc %d %d %d %d %d %d %d %d %d", arc->Net(),
+                          arc->Layer(), shape->GetP0().x, shape->GetP0().y,
+                          shape->GetArcMid().x, shape->GetArcMid().y, shape->GetP1().x,
+                          shape->GetP1().y, arc->Width() );
+            }
+            else if( PNS::VIA* via = dyn_cast<PNS::VIA*>( item ) )
+            {
+                snprintf( buf, sizeof( buf ), "via %d %d %d %d %d %d %d", via->Net(),
+                          via->Layers().Start(), via->Layers().End(), via->Pos().x,
+                          via->Pos().y, via->Diameter(), via->Drill() );
+            }
+            else
+            {
+                continue;
+            }
+
+            lines.emplace_back( buf );
+        }
+    }
+
+    std::sort( lines.begin(), lines.end() );
+
+    return lines;
+}
+
+
+int pns_replay_main( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program replays a routing session recorded by the "
+                               "interactive router and reports the router latency." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    PNS::PNS_MODE mode = PNS::RM_Walkaround;
+    wxString      modeName;
+
+    if( cl_parser.Found( "mode", &modeName ) )
+    {
+        if( modeName == "shove" )
+            mode = PNS::RM_Shove;
+        else if( modeName == "mark" )
+            mode = PNS::RM_MarkObstacles;
+        else if( modeName != "walkaround" )
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    std::unique_ptr<BOARD> brd =
+            KI_TEST::ReadBoardFromFileOrStream( cl_parser.GetParam( 0 ).ToStdString() );
+
+    if( !brd )
+        return PNS_REPLAY_RET_CODES::LOAD_FAILED;
+
+    PNS::LOGGER log;
+
+    if( !log.Load( cl_parser.GetParam( 1 ).ToStdString() ) )
+    {
+        fprintf( stderr, "Could not read the router log\n" );
+        return PNS_REPLAY_RET_CODES::LOAD_FAILED;
+    }
+
+    PNS_KICAD_IFACE_BASE  iface;
+    PNS::ROUTER           router;
+    PNS::ROUTING_SETTINGS settings( nullptr, "" );
+
+    settings.SetMode( mode );
+
+    iface.SetBoard( brd.get() );
+    router.SetInterface( &iface );
+    router.LoadSettings( &settings );
+    router.SetMode( PNS::PNS_MODE_ROUTE_SINGLE );
+    router.SyncWorld();
+
+    // Board items are looked up in the world at the time of the event, as routing replaces
+    // the router items of the tracks it modifies
+    auto findItem =
+            [&]( const KIID& aId ) -> PNS::ITEM*
+            {
+                if( aId == niluuid )
+                    return nullptr;
+
+                BOARD_ITEM* parent = brd->GetItem( aId );
+
+                if( !parent || parent == DELETED_BOARD_ITEM::GetInstance() )
+                    return nullptr;
+
+                return router.QueryItemByParent( parent );
+            };
+
+    std::map<PNS::LOGGER::EVENT_TYPE, std::vector<double>> latencies;
+    int                                                     failedStarts = 0;
+
+    const std::vector<PNS::LOGGER::EVENT_ENTRY>& events = log.GetEvents();
+
+    for( size_t i = 0; i < events.size(); i++ )
+    {
+        const PNS::LOGGER::EVENT_ENTRY& evt = events[i];
+        PNS::ITEM*                      item = findItem( evt.uuid );
+        PROF_COUNTER timer;
+
+        switch( evt.type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+        {
+            PNS::SIZES_SETTINGS sizes( router.Sizes() );
+            int                 layer = item ? item->Layers().Start() : F_Cu;
+
+            if( item && item->Layers().Overlaps( F_Cu ) )
+                layer = F_Cu;
+
+            iface.ImportSizes( sizes, item, -1 );
+            sizes.AddLayerPair( F_Cu, B_Cu );
+            router.UpdateSizes( sizes );
+
+            if( !router.StartRouting( evt.p, item, layer ) )
+                failedStarts++;
+
+            break;
+        }
+
+        case PNS::LOGGER::EVT_START_DRAG:
+        {
+            // The router logs one event per item when dragging several items at once (e.g.
+            // the pads of a footprint), all at the same position
+            PNS::ITEM_SET dragItems;
+
+            if( item )
+                dragItems.Add( item );
+
+            while( i + 1 < events.size() && events[i + 1].type == PNS::LOGGER::EVT_START_DRAG
+                    && events[i + 1].p == evt.p )
+            {
+                if( PNS::ITEM* other = findItem( events[++i].uuid ) )
+                    dragItems.Add( other );
+            }
+
+            int dragMode = ( dragItems.Size() > 1 ) ? PNS::DM_COMPONENT : PNS::DM_ANY;
+
+            if( dragItems.Empty() || !router.StartDragging( evt.p, dragItems, dragMode ) )
+                failedStarts++;
+
+            break;
+        }
+
+        case PNS::LOGGER::EVT_MOVE:
+            router.Move( evt.p, item );
+            break;
+
+        case PNS::LOGGER::EVT_FIX:
+            if( router.RoutingInProgress() && router.FixRoute( evt.p, item ) )
+                router.StopRouting();
+
+            break;
+
+        case PNS::LOGGER::EVT_ABORT:
+            router.StopRouting();
+            break;
+        }
+
+        latencies[evt.type].push_back( timer.msecs() );
+    }
+
+    router.StopRouting();
+
+    printf( "%d events, %d failed route/drag starts\n", (int) events.size(),
+            failedStarts );
+    printf( "%-12s %8s %10s %10s %10s %10s %10s\n", "event", "count", "mean [ms]", "p50",
+            "p90", "p99", "max" );
+
+    for( std::pair<const PNS::LOGGER::EVENT_TYPE, std::vector<double>>& entry : latencies )
+    {
+        std::vector<double>& samples = entry.second;
+
+        std::sort( samples.begin(), samples.end() );
+
+        double total = 0.0;
+
+        for( double sample : samples )
+            total += sample;
+
+        printf( "%-12s %8d %10.3f %10.3f %10.3f %10.3f %10.3f\n", eventName( entry.first ),
+                (int) samples.size(), total / samples.size(), percentile( samples, 50 ),
+                percentile( samples, 90 ), percentile( samples, 99 ), samples.back() );
+    }
+
+    std::vector<std::string> geometry = worldGeometry( router.GetWorld(), brd.get() );
+
+    printf( "final geometry: %d tracks and vias\n", (int) geometry.size() );
+
+    wxString outputName;
+
+    if( cl_parser.Found( "output", &outputName ) )
+    {
+        FILE* f = fopen( outputName.c_str(), "wb" );
+
+        if( !f )
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+        for( const std::string& line : geometry )
+            fprintf( f, "%s\n", line.c_str() );
+
+        fclose( f );
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "pns_replay",
+        "Replay a recorded interactive router session and report the router latency",
+        pns_replay_main,
+} );
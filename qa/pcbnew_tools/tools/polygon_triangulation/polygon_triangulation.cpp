@@ -33,8 +33,12 @@
 
 #include <board.h>
 #include <profile.h>
+#include <zone.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdio>
+#include <cstdlib>
 #include <thread>
 #include <unordered_set>
 #include <utility>
@@ -200,74 +204,136 @@ aResult->clear();
 enum POLY_TRI_RET_CODES
 {
     LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    MISMATCH
 };
 
 
+/**
+ * Triangulates copies of all the polygon sets, from aThreads threads each taking the next
+ * set, and returns the number of triangles.
+ */
+static size_t triangulateAll( const std::vector<SHAPE_POLY_SET>& aPolys, size_t aThreads )
+{
+    std::atomic<size_t> nextPoly( 0 );
+    std::atomic<size_t> triangles( 0 );
+
+    auto worker =
+            [&]()
+            {
+                for( size_t ii = nextPoly++; ii < aPolys.size(); ii = nextPoly++ )
+                {
+                    SHAPE_POLY_SET poly = aPolys[ii];
+
+                    poly.CacheTriangulation();
+
+                    for( unsigned jj = 0; jj < poly.TriangulatedPolyCount(); jj++ )
+                        triangles += poly.TriangulatedPolygon( jj )->GetTriangleCount();
+                }
+            };
+
+    std::vector<std::thread> threads;
+
+    for( size_t ii = 1; ii < aThreads; ii++ )
+        threads.emplace_back( worker );
+
+    worker();
+
+    for( std::thread& thread : threads )
+        thread.join();
+
+    return triangles;
+}
+
+
 int polygon_triangulation_main( int argc, char *argv[] )
 {
     std::string filename;
+    int         repeat = 1;
 
     if( argc > 1 )
         filename = argv[1];
 
+    if( argc > 2 )
+        repeat = std::max( 1, atoi( argv[2] ) );
+
     auto brd = KI_TEST::ReadBoardFromFileOrStream( filename );
 
     if( !brd )
         return POLY_TRI_RET_CODES::LOAD_FAILED;
 
+    std::vector<SHAPE_POLY_SET> polys;
+    int                         vertices = 0;
+
+    for( int areaId = 0; areaId < brd->GetAreaCount(); areaId++ )
+    {
+        ZONE* zone = brd->GetArea( areaId );
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            polys.push_back( zone->GetFilledPolysList( layer ) );
+            vertices += polys.back().TotalVertices();
+        }
+    }
+
+    printf( "%d zone fills, %d vertices\n", (int) polys.size(), vertices );
 
-    PROF_COUNTER cnt( "allBoard" );
+    // The same fills are triangulated one after the other, with and without the parallel
+    // triangulation of the polygons of each fill, and then from one thread per core (as the
+    // zone filler does), which leaves little room for the parallel triangulation.
+    size_t cores = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+    int    threshold = SHAPE_POLY_SET::GetParallelThreshold();
 
+    struct RUN
+    {
+        const char* m_name;
+        size_t      m_threads;
+        int         m_threshold;
+    };
 
-    std::atomic<size_t> zonesToTriangulate( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    const RUN runs[] = {
+        { "serial", 1, 0 },
+        { "parallel polygons", 1, 1 },
+        { "parallel fills", cores, 0 },
+        { "parallel both", cores, 1 },
+    };
 
-    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    bool   ok = true;
+    size_t expected = 0;
+    double reference = 0.0;
+
+    for( const RUN& run : runs )
     {
-        std::thread t = std::thread( [&brd, &zonesToTriangulate, &threadsFinished]() {
-            for( size_t areaId = zonesToTriangulate.fetch_add( 1 );
-                        areaId < static_cast<size_t>( brd->GetAreaCount() );
-                        areaId = zonesToTriangulate.fetch_add( 1 ) )
-            {
-                auto zone = brd->GetArea( areaId );
+        SHAPE_POLY_SET::SetParallelThreshold( run.m_threshold );
 
-                // NOTE: this could be refactored to do multiple layers from the same zone in
-                // parallel, but since the test case doesn't have any of these, I'm not bothering
-                // to do that right now.
-                for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
-                {
-                    SHAPE_POLY_SET poly = zone->GetFilledPolysList( layer );
+        size_t       triangles = 0;
+        PROF_COUNTER cnt( run.m_name );
 
-                    poly.CacheTriangulation();
+        for( int ii = 0; ii < repeat; ii++ )
+            triangles = triangulateAll( polys, run.m_threads );
 
-                    (void) poly;
-#if 0
-                PROF_COUNTER unfrac("unfrac");
-                poly.Unfracture( SHAPE_POLY_SET::PM_FAST );
-                unfrac.Show();
+        cnt.Stop();
 
-                PROF_COUNTER triangulate("triangulate");
+        double time = cnt.msecs() / repeat;
 
-                for(int i =0; i< poly.OutlineCount(); i++)
-                {
-                    poly.triangulatePoly( &poly.Polygon(i) );
-                }
-                triangulate.Show();
-#endif
-                }
-            }
+        if( reference == 0.0 )
+        {
+            reference = time;
+            expected = triangles;
+        }
 
-            threadsFinished++;
-        } );
+        printf( "  %-18s %10.2f ms  %6.2fx  (%zu triangles)\n", run.m_name, time,
+                time > 0.0 ? reference / time : 1.0, triangles );
 
-        t.detach();
+        ok &= triangles == expected;
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    SHAPE_POLY_SET::SetParallelThreshold( threshold );
 
-    cnt.Show();
+    if( !ok )
+    {
+        printf( "the parallel triangulations differ from the serial one\n" );
+        return POLY_TRI_RET_CODES::MISMATCH;
+    }
 
     return KI_TEST::RET_CODES::OK;
 }
@@ -275,6 +341,6 @@ int polygon_triangulation_main( int argc, char *argv[] )
 
 static bool registered = UTILITY_REGISTRY::Register( {
         "polygon_triangulation",
-        "Process polygon triangulation on a PCB",
+        "Benchmark the triangulation of the zone fills of a PCB",
         polygon_triangulation_main,
 } );